@@ -194,10 +194,42 @@ bool FPU::OnCompletion(unsigned int unit, const Result& res) const
     return true;
 }
 
+// Returns the number of cycles that p_Pipeline has skipped while
+// sleeping. Every pipeline has advanced once in each of these cycles.
+CycleNo FPU::GetSleptCycles() const
+{
+    if (m_sleep_cycle == INFINITE_CYCLES)
+    {
+        return 0;
+    }
+    return m_active.GetClock().GetCycleNo() - m_sleep_cycle - 1;
+}
+
 Result FPU::DoPipeline()
 {
+    const CycleNo now = GetKernel()->GetActiveClock()->GetCycleNo();
+    if (m_sleep_cycle != INFINITE_CYCLES)
+    {
+        // Catch up with the cycles we slept through
+        const CycleNo slept = GetSleptCycles();
+        COMMIT
+        {
+            for (auto& unit : m_units)
+                for (auto& p : unit.slots)
+                    p.state += slept;
+            m_last_source = (m_last_source + slept) % m_sources.size();
+            m_sleep_cycle = INFINITE_CYCLES;
+        }
+    }
+
+    // Until the commit, the states and the source rotation still lag
+    // behind by the cycles we slept through.
+    const CycleNo lag = GetSleptCycles();
+    const size_t first_source = (m_last_source + lag) % m_sources.size();
+
     size_t num_units_active = 0, num_units_failed = 0;
     size_t num_units_full = 0;
+    CycleNo wakeup = INFINITE_CYCLES;
     for (size_t i = 0; i < m_units.size(); ++i)
     {
         // Advance a pipeline
@@ -209,7 +241,18 @@ Result FPU::DoPipeline()
 
             bool advance = true;
             Result&  res = unit.slots.front();
-            if (res.state == unit.latency)
+            if (res.state + lag < unit.latency)
+            {
+                // Nothing to do for this unit until the front operation completes
+                wakeup = std::min(wakeup, now + unit.latency - res.state - lag);
+            }
+            else
+            {
+                // Don't sleep while results are written back
+                wakeup = 0;
+            }
+
+            if (res.state + lag == unit.latency)
             {
                 // This operation has completed
                 // Write back result
@@ -252,7 +295,7 @@ Result FPU::DoPipeline()
     }
 
     size_t num_sources_failed = 0, num_sources_active = 0;
-    for (size_t i = m_last_source; i < m_last_source + m_sources.size(); ++i)
+    for (size_t i = first_source; i < first_source + m_sources.size(); ++i)
     {
         size_t source_id = i % m_sources.size();
 
@@ -273,7 +316,7 @@ Result FPU::DoPipeline()
                 // See if the unit can accept a new request
                 // Do this check after the Acquire phase, when the actual pipeline has
                 // moved on and made room for our request.
-                if (!unit.slots.empty() && (!unit.pipelined || unit.slots.back().state == 1))
+                if (!unit.slots.empty() && (!unit.pipelined || unit.slots.back().state + lag == 1))
                 {
                     // The unit is busy or cannot accept a new operation
                     num_sources_failed++;
@@ -303,6 +346,16 @@ Result FPU::DoPipeline()
 
     if (num_units_full > 0) {
         m_active.Write(true);
+
+        if (num_sources_active == 0 && wakeup != 0 && wakeup != INFINITE_CYCLES)
+        {
+            // All pipelines are just counting down; sleep until the first
+            // operation completes or a new operation arrives.
+            COMMIT {
+                GetKernel()->GetActiveClock()->SleepProcess(p_Pipeline, wakeup);
+                m_sleep_cycle = now;
+            }
+        }
     } else {
         m_active.Clear();
     }
@@ -326,6 +379,7 @@ FPU::FPU(const std::string& name, Object& parent, Clock& clock, size_t num_input
       m_sources(),
       m_units(),
       m_last_source(0),
+      InitStateVariable(sleep_cycle, INFINITE_CYCLES),
       InitProcess(p_Pipeline, DoPipeline)
 {
     m_active.Sensitive(p_Pipeline);
@@ -463,6 +517,7 @@ void FPU::Cmd_Read(std::ostream& out, const std::vector<std::string>& /*argument
     out << endl;
 
     // Print the execution units
+    const CycleNo slept = GetSleptCycles();
     size_t i = 0;
     for (auto& unit : m_units)
     {
@@ -490,7 +545,7 @@ void FPU::Cmd_Read(std::ostream& out, const std::vector<std::string>& /*argument
             out << "---+----+---------------------+-------+--------------------" << endl;
             for (auto& p : unit.slots)
             {
-                out << setw(2) << p.state << " | "
+                out << setw(2) << p.state + slept << " | "
                     << setw(2) << p.size * 8 << " | "
                     << setw(20) << setprecision(12) << p.value.tofloat(p.size)  << " | "
                     << p.address.str() << " | ";
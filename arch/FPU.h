@@ -102,6 +102,9 @@ private:
     std::vector<size_t>  m_mapping[FPU_NUM_OPS];  ///< List of units for each FPU op
 
     DefineStateVariable(size_t, last_source);
+    DefineStateVariable(CycleNo, sleep_cycle);    ///< Cycle at which p_Pipeline went to sleep, INFINITE_CYCLES if awake
+
+    CycleNo GetSleptCycles() const;
     Simulator::Result DoPipeline();
 
     void Cleanup();
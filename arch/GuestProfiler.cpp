@@ -0,0 +1,241 @@
+#include "GuestProfiler.h"
+#include "symtable.h"
+#include "arch/drisc/DRISC.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <fnmatch.h>
+
+using namespace std;
+
+namespace Simulator
+{
+    GuestProfiler::GuestProfiler(Kernel& kernel, const vector<DRISC*>& procs, const SymbolTable& symtable)
+        : m_kernel(kernel),
+          m_procs(procs),
+          m_symtable(symtable),
+          m_cores(procs.size()),
+          m_interval(0),
+          m_handler(0)
+    {
+    }
+
+    GuestProfiler::~GuestProfiler()
+    {
+        SetInterval(0);
+    }
+
+    void GuestProfiler::SetInterval(CycleNo interval)
+    {
+        if (m_interval != 0)
+        {
+            m_kernel.RemoveIntervalHandler(m_handler);
+        }
+        m_interval = interval;
+        if (m_interval != 0)
+        {
+            m_handler = m_kernel.AddIntervalHandler(m_interval, [this]{ Sample(); });
+        }
+    }
+
+    void GuestProfiler::Sample()
+    {
+        for (size_t i = 0; i < m_procs.size(); ++i)
+        {
+            CoreProfile& core = m_cores[i];
+            MemAddr pc;
+            bool stalled;
+            core.samples++;
+            if (!m_procs[i]->GetPipeline().GetSamplePC(pc, stalled))
+            {
+                core.idle++;
+            }
+            else if (stalled)
+            {
+                core.stalled++;
+                core.pcs[pc].stalled++;
+            }
+            else
+            {
+                core.pcs[pc].executing++;
+            }
+        }
+    }
+
+    bool GuestProfiler::HasSamples() const
+    {
+        for (auto& core : m_cores)
+            if (core.samples > 0)
+                return true;
+        return false;
+    }
+
+    void GuestProfiler::Reset()
+    {
+        for (auto& core : m_cores)
+            core = CoreProfile();
+    }
+
+    // The samples of a function or an instruction.
+    struct ProfileLine
+    {
+        string   name;
+        uint64_t executing;
+        uint64_t stalled;
+
+        ProfileLine() : name(), executing(0), stalled(0) {}
+        ProfileLine(const string& n, uint64_t e, uint64_t s) : name(n), executing(e), stalled(s) {}
+
+        uint64_t total() const { return executing + stalled; }
+    };
+
+    static void PrintLines(ostream& os, vector<ProfileLine>& lines, uint64_t samples, size_t count)
+    {
+        sort(lines.begin(), lines.end(), [](const ProfileLine& a, const ProfileLine& b) {
+                return a.total() != b.total() ? a.total() > b.total() : a.name < b.name;
+            });
+
+        os << "     samples  self%  cumul%  stalled%  name" << endl;
+        uint64_t cumul = 0;
+        for (size_t i = 0; i < lines.size() && i < count; ++i)
+        {
+            const ProfileLine& l = lines[i];
+            cumul += l.total();
+            os << setw(12) << l.total()
+               << setw(7) << setprecision(2) << 100.0 * l.total() / samples
+               << setw(8) << 100.0 * cumul / samples
+               << setw(10) << 100.0 * l.stalled / l.total()
+               << "  " << l.name << endl;
+        }
+        if (lines.size() > count)
+        {
+            os << "     (" << lines.size() - count << " more)" << endl;
+        }
+    }
+
+    void GuestProfiler::Print(ostream& os, const string& pat, size_t count) const
+    {
+        if (m_interval == 0)
+            os << "Guest PC samples (sampling is disabled)" << endl << endl;
+        else
+            os << "Guest PC samples every " << m_interval << " master cycles" << endl << endl;
+        os << "core            samples  executing%  stalled%   idle%" << endl;
+
+        // Add up the samples of the selected cores per instruction
+        map<MemAddr, PCCount> pcs;
+        uint64_t samples = 0, stalled = 0, idle = 0;
+        for (size_t i = 0; i < m_procs.size(); ++i)
+        {
+            const string& name = m_procs[i]->GetName();
+            if (FNM_NOMATCH == fnmatch(pat.c_str(), name.c_str(), 0))
+                continue;
+
+            const CoreProfile& core = m_cores[i];
+            const double n = max<uint64_t>(core.samples, 1);
+            os << setw(12) << left << name << right
+               << setw(11) << core.samples << fixed << setprecision(2)
+               << setw(12) << 100.0 * (core.samples - core.stalled - core.idle) / n
+               << setw(10) << 100.0 * core.stalled / n
+               << setw(8)  << 100.0 * core.idle / n << endl;
+            os.unsetf(ios::floatfield);
+
+            samples += core.samples;
+            stalled += core.stalled;
+            idle    += core.idle;
+            for (auto& p : core.pcs)
+            {
+                PCCount& c = pcs[p.first];
+                c.executing += p.second.executing;
+                c.stalled   += p.second.stalled;
+            }
+        }
+
+        const uint64_t busy = samples - idle;
+        if (busy == 0)
+        {
+            os << endl << "No samples with instructions." << endl;
+            return;
+        }
+
+        // Group the instructions per function; the instructions
+        // outside of any symbol are listed on their own.
+        map<string, ProfileLine> functions;
+        vector<ProfileLine> hotspots;
+        for (auto& p : pcs)
+        {
+            MemAddr start;
+            string name;
+            if (!m_symtable.FindSymbol(p.first, start, name))
+            {
+                name = m_symtable[p.first];
+            }
+            ProfileLine& f = functions[name];
+            f.name       = name;
+            f.executing += p.second.executing;
+            f.stalled   += p.second.stalled;
+
+            ostringstream addr;
+            addr << "0x" << hex << p.first << ' ' << m_symtable[p.first];
+            hotspots.push_back(ProfileLine(addr.str(), p.second.executing, p.second.stalled));
+        }
+
+        vector<ProfileLine> lines;
+        for (auto& f : functions)
+            lines.push_back(f.second);
+
+        os << fixed << endl
+           << "Functions (" << busy << " samples with instructions, "
+           << setprecision(2) << 100.0 * stalled / busy << "% stalled):" << endl;
+        PrintLines(os, lines, busy, count);
+
+        os << endl << "Instructions:" << endl;
+        PrintLines(os, hotspots, busy, count);
+        os.unsetf(ios::floatfield);
+    }
+
+    void GuestProfiler::WriteFolded(ostream& os) const
+    {
+        // Symbolize every instruction only once
+        map<MemAddr, string> names;
+        for (size_t i = 0; i < m_procs.size(); ++i)
+        {
+            const CoreProfile& core = m_cores[i];
+            const string& cpu = m_procs[i]->GetName();
+
+            map<string, PCCount> functions;
+            for (auto& p : core.pcs)
+            {
+                auto n = names.find(p.first);
+                if (n == names.end())
+                {
+                    MemAddr start;
+                    string name;
+                    if (!m_symtable.FindSymbol(p.first, start, name))
+                    {
+                        name = m_symtable[p.first];
+                    }
+                    // Semicolons and spaces separate the fields
+                    replace(name.begin(), name.end(), ';', '_');
+                    replace(name.begin(), name.end(), ' ', '_');
+                    n = names.insert(make_pair(p.first, name)).first;
+                }
+                PCCount& c = functions[n->second];
+                c.executing += p.second.executing;
+                c.stalled   += p.second.stalled;
+            }
+
+            for (auto& f : functions)
+            {
+                if (f.second.executing > 0)
+                    os << cpu << ';' << f.first << ' ' << f.second.executing << endl;
+                if (f.second.stalled > 0)
+                    os << cpu << ';' << f.first << ";[stalled] " << f.second.stalled << endl;
+            }
+            if (core.idle > 0)
+                os << cpu << ";[idle] " << core.idle << endl;
+        }
+    }
+}
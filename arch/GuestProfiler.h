@@ -0,0 +1,85 @@
+// -*- c++ -*-
+#ifndef GUESTPROFILER_H
+#define GUESTPROFILER_H
+
+#include <sim/kernel.h>
+#include <sim/flatmap.h>
+#include <arch/simtypes.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Simulator
+{
+    class DRISC;
+    class SymbolTable;
+
+    /// Samples the PC of every core at regular intervals, to find
+    /// where the guest programs spend simulated time. A sample is the
+    /// instruction a core executed in the last cycle, or the one that
+    /// held up its pipeline, so that the profile also shows where the
+    /// cores wait. The histograms are kept per core and symbolized
+    /// only when a report is made.
+    class GuestProfiler
+    {
+        struct PCCount
+        {
+            uint64_t executing;
+            uint64_t stalled;
+
+            PCCount() : executing(0), stalled(0) {}
+        };
+
+        struct CoreProfile
+        {
+            FlatMap<MemAddr, PCCount> pcs;
+            uint64_t                  samples;
+            uint64_t                  stalled;
+            uint64_t                  idle;
+
+            CoreProfile() : pcs(), samples(0), stalled(0), idle(0) {}
+        };
+
+        Kernel&                   m_kernel;
+        const std::vector<DRISC*>& m_procs;
+        const SymbolTable&        m_symtable;
+        std::vector<CoreProfile>  m_cores;
+        CycleNo                   m_interval;   ///< Master cycles between samples, 0 if disabled
+        size_t                    m_handler;    ///< Interval handler in the kernel
+
+        void Sample();
+
+    public:
+        GuestProfiler(Kernel& kernel, const std::vector<DRISC*>& procs, const SymbolTable& symtable);
+        GuestProfiler(const GuestProfiler&) = delete;
+        GuestProfiler& operator=(const GuestProfiler&) = delete;
+        ~GuestProfiler();
+
+        // Samples every interval master cycles from now on, or stops
+        // sampling if interval is 0. The samples so far are kept.
+        void SetInterval(CycleNo interval);
+        CycleNo GetInterval() const { return m_interval; }
+
+        // Whether there are samples to report.
+        bool HasSamples() const;
+
+        void Reset();
+
+        /**
+         * @brief Print the samples per core, and the count functions and
+         * instructions with the most samples on the cores matching pat.
+         */
+        void Print(std::ostream& os, const std::string& pat = "*", size_t count = 20) const;
+
+        /**
+         * @brief Write the samples as folded stacks for flame graphs.
+         * Each line is the core, the function and, for samples where
+         * the core was stalled, "[stalled]", separated by semicolons and
+         * followed by the number of samples.
+         */
+        void WriteFolded(std::ostream& os) const;
+    };
+}
+
+#endif
@@ -1,6 +1,10 @@
 #include "MGSystem.h"
+#include "GuestProfiler.h"
+#include "Timeline.h"
 
 #include "arch/drisc/DRISC.h"
+#include "arch/mem/TracePlayer.h"
+#include "arch/mem/MemoryRecorder.h"
 
 #ifdef ENABLE_MEM_SERIAL
 #include "arch/mem/SerialMemory.h"
@@ -36,6 +40,7 @@
 #include "arch/dev/JoyInput.h"
 
 #include "sim/rusage.h"
+#include "sim/checkpoint.h"
 #include "sim/getclassname.h"
 
 #include <sstream>
@@ -393,6 +398,38 @@ void MGSystem::PrintCoreStats(ostream& os) const {
        << "# tcreates: total number of threads created" << endl;
 }
 
+void MGSystem::PrintPlayerStats(ostream& os) const {
+    uint64_t nreads = 0, nwrites = 0, nbytes = 0, latency = 0;
+    CycleNo  maxlatency = 0, first = numeric_limits<CycleNo>::max(), last = 0;
+
+    for (const TracePlayer* p : m_players)
+    {
+        uint64_t r, w, b, l;
+        CycleNo  m, f, e;
+        p->GetStatistics(r, w, b, l, m, f, e);
+        nreads += r; nwrites += w; nbytes += b; latency += l;
+        maxlatency = max(maxlatency, m);
+        if (r + w > 0)
+        {
+            first = min(first, f);
+            last  = max(last, e);
+        }
+    }
+    const CycleNo span = (last > first) ? last - first : 0;
+
+    os << "## trace player statistics:" << endl
+       << m_players.size() << "\t# number of trace players" << endl
+       << nreads << "\t# number of reads replayed" << endl
+       << nwrites << "\t# number of writes replayed" << endl
+       << nbytes << "\t# number of bytes read and written" << endl
+       << fixed << setprecision(2)
+       << ((nreads + nwrites) ? (double)latency / (nreads + nwrites) : 0.) << "\t# average request latency (player cycles)" << endl
+       << maxlatency << "\t# maximum request latency (player cycles)" << endl
+       << span << "\t# player cycles from first request to last completion" << endl
+       << (span ? (double)nbytes / span : 0.) << "\t# bandwidth (bytes per player cycle)" << endl;
+    os.unsetf(ios::floatfield);
+}
+
 void MGSystem::PrintMemoryStatistics(ostream& os) const {
     uint64_t nr = 0, nrb = 0, nw = 0, nwb = 0, nrext = 0, nwext = 0;
 
@@ -409,7 +446,7 @@ void MGSystem::PrintMemoryStatistics(ostream& os) const {
 void MGSystem::PrintState(const vector<string>& /*unused*/) const
 {
     // This should be all non-idle processes
-    for (const Clock* clock = GetKernel()->GetActiveClocks(); clock != NULL; clock = clock->GetNext())
+    for (const Clock* clock : GetKernel()->GetActiveClocks())
     {
         if (clock->GetActiveProcesses() != NULL || clock->GetActiveStorages() != NULL || clock->GetActiveArbitrators() != NULL)
         {
@@ -421,6 +458,9 @@ void MGSystem::PrintState(const vector<string>& /*unused*/) const
                 cout << "- the following processes are powered:" << endl;
                 for (const Process* process = clock->GetActiveProcesses(); process != NULL; process = process->GetNext())
                 {
+                    if (process->IsSleeping())
+                        continue;
+
                     cout << "  - " << process->GetName() << " (";
                     switch (process->GetState())
                     {
@@ -455,9 +495,25 @@ void MGSystem::PrintState(const vector<string>& /*unused*/) const
         }
     }
 
+    if (GetKernel()->GetNumSleepingProcesses() > 0)
+    {
+        cout << endl
+             << "The following processes are sleeping:" << endl;
+        for (const Process* process : GetKernel()->GetAllProcesses())
+        {
+            if (process->IsSleeping())
+            {
+                cout << "  - " << process->GetName() << " (until cycle " << dec << process->GetWakeupCycle() << ")" << endl;
+            }
+        }
+    }
+
     for (DRISC* p : m_procs)
         if (!p->IsIdle())
             cout << p->GetName() << ": non-empty" << endl;
+    for (TracePlayer* p : m_players)
+        if (!p->IsDone())
+            cout << p->GetName() << ": non-empty" << endl;
 }
 
 void MGSystem::PrintAllStatistics(ostream& os) const
@@ -472,11 +528,115 @@ void MGSystem::PrintAllStatistics(ostream& os) const
        << ru.GetUserTime() << "\t# total real time in user mode (us)" << endl
        << ru.GetSystemTime() << "\t# total real time in system mode (us)" << endl
        << ru.GetMaxResidentSize() << "\t# maximum resident set size (Kibytes)" << endl;
-    PrintCoreStats(os);
+    if (m_players.empty())
+        PrintCoreStats(os);
+    else
+        PrintPlayerStats(os);
     os << "## memory statistics:" << endl;
     PrintMemoryStatistics(os);
 }
 
+// Returns whether a process of one of the components, or of their
+// children, is powered: it has work to do or is sleeping.
+static bool HasActiveProcesses(const Kernel& kernel, const vector<string>& components)
+{
+    for (const Clock* clock : kernel.GetActiveClocks())
+    {
+        for (const Process* process = clock->GetActiveProcesses(); process != NULL; process = process->GetNext())
+        {
+            const string& name = process->GetName();
+            for (const string& c : components)
+            {
+                if (name.compare(0, c.size(), c) == 0 && (name[c.size()] == ':' || name[c.size()] == '.'))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+void MGSystem::SetDirectMemory(bool enable)
+{
+    if (enable && !m_memory->HasCurrentContents())
+    {
+        throw runtime_error("Direct-memory mode is not supported by this memory system, since it keeps data in its caches");
+    }
+
+    if (enable && !IsDirectMemory())
+    {
+        // The requests in flight would reach the memory after the direct
+        // accesses of direct-memory mode, and an older store could overwrite a
+        // newer one. So the caches stop sending requests, and the system
+        // runs until the memory and the caches have no more work.
+        vector<string> components(1, dynamic_cast<const Object&>(*m_memory).GetName());
+        for (DRISC* p : m_procs)
+        {
+            components.push_back(p->GetICache().GetName());
+            components.push_back(p->GetDCache().GetName());
+            p->SetDraining(true);
+        }
+
+        try
+        {
+            while (HasActiveProcesses(*GetKernel(), components))
+            {
+                const RunState state = GetKernel()->Step(1);
+                if (state == STATE_ABORTED)
+                {
+                    throw runtime_error("Interrupted while waiting for the memory system to become idle");
+                }
+                if (state == STATE_IDLE && HasActiveProcesses(*GetKernel(), components))
+                {
+                    throw runtime_error("Deadlock while waiting for the memory system to become idle");
+                }
+            }
+        }
+        catch (...)
+        {
+            for (DRISC* p : m_procs)
+                p->SetDraining(false);
+            throw;
+        }
+
+        for (DRISC* p : m_procs)
+            p->SetDraining(false);
+    }
+
+    for (DRISC* p : m_procs)
+        p->SetDirectMemory(enable);
+}
+
+bool MGSystem::IsDirectMemory() const
+{
+    return !m_procs.empty() && m_procs[0]->IsDirectMemory();
+}
+
+void MGSystem::SaveCheckpoint(const string& filename) const
+{
+    if (IsDirectMemory())
+    {
+        throw runtime_error("Cannot save a checkpoint in direct-memory mode; use 'switch' first");
+    }
+    if (m_trace != NULL)
+    {
+        throw runtime_error("Cannot save a checkpoint while replaying a memory trace");
+    }
+    Checkpoint::Save(GetKernel()->GetVariableRegistry(), filename);
+}
+
+void MGSystem::LoadCheckpoint(const string& filename)
+{
+    if (IsDirectMemory())
+    {
+        throw runtime_error("Cannot load a checkpoint in direct-memory mode; use 'switch' first");
+    }
+    if (m_trace != NULL)
+    {
+        throw runtime_error("Cannot load a checkpoint while replaying a memory trace");
+    }
+    Checkpoint::Load(GetKernel()->GetVariableRegistry(), filename);
+}
+
 // Steps the entire system this many cycles
 void MGSystem::Step(CycleNo nCycles)
 {
@@ -505,6 +665,11 @@ void MGSystem::Step(CycleNo nCycles)
             {
                 goto deadlock;
             }
+        for (TracePlayer* p : m_players)
+            if (!p->IsDone())
+            {
+                goto deadlock;
+            }
 
         // If all cores are done, but there are still some remaining
         // processes, and all the remaining processes are stalled,
@@ -513,7 +678,7 @@ void MGSystem::Step(CycleNo nCycles)
         // either there are no processes at all, or they are all
         // stalled. Deadlock only exists in the latter case, so
         // we only check for the existence of an active process.
-        for (const Clock* clock = GetKernel()->GetActiveClocks(); clock != NULL; clock = clock->GetNext())
+        for (const Clock* clock : GetKernel()->GetActiveClocks())
         {
             if (clock->GetActiveProcesses() != NULL)
             {
@@ -539,7 +704,7 @@ void MGSystem::Step(CycleNo nCycles)
         // See how many processes are in each of the states
         unsigned int num_stalled = 0, num_running = 0;
 
-        for (const Clock* clock = GetKernel()->GetActiveClocks(); clock != NULL; clock = clock->GetNext())
+        for (const Clock* clock : GetKernel()->GetActiveClocks())
         {
             for (const Process* process = clock->GetActiveProcesses(); process != NULL; process = process->GetNext())
             {
@@ -604,16 +769,22 @@ MGSystem::MGSystem(Config& config, bool quiet)
       m_clock(0),
       m_root(0),
       m_procs(),
+      m_trace(0),
+      m_players(),
+      m_recorder(0),
       m_fpus(),
       m_ics(),
       m_ioifs(),
       m_devices(),
       m_symtable(),
+      m_profiler(0),
+      m_timeline(0),
       m_breakpoints(),
       m_memory(0),
       m_objdump_cmd(),
       m_bootrom(0),
-      m_selector(0)
+      m_selector(0),
+      m_random()
 {
 #ifdef STATIC_KERNEL
     Kernel::InitGlobalKernel();
@@ -621,6 +792,12 @@ MGSystem::MGSystem(Config& config, bool quiet)
     auto& kernel = *GetKernel();
     kernel.AttachConfig(config);
 
+    // This continues the sequence of rand() from srand(RandomSeed).
+    initstate(GetTopConfOpt("RandomSeed", unsigned, 1), m_random.state, sizeof m_random.state);
+    kernel.GetVariableRegistry().RegisterVariable(&m_random, "system.random", SVC_STATE, Serialization::SV_OTHER, 0, 0,
+                                                  &Serialization::serializer<StreamSerializer, RandomState>,
+                                                  &Serialization::serializer<BinarySerializer, RandomState>);
+
     auto default_core_freq = GetTopConf("CoreFreq", Clock::Frequency);
     m_root = new Object("", kernel);
     m_breakpoints.AttachKernel(kernel);
@@ -635,6 +812,14 @@ MGSystem::MGSystem(Config& config, bool quiet)
 
     PSize numProcessors = GetTopConf("NumProcessors", PSize);
 
+    // With a memory trace, players replay the requests of the clients
+    // in the trace, and there are no cores.
+    string traceFile = GetTopConfOpt("TraceFile", string, "");
+    if (!traceFile.empty())
+    {
+        numProcessors = 0;
+    }
+
     const size_t numProcessorsPerFPU = GetTopConf("NumProcessorsPerFPU", size_t);
     const PSize  numFPUs             = (numProcessors + numProcessorsPerFPU - 1) / numProcessorsPerFPU;
 
@@ -703,6 +888,20 @@ MGSystem::MGSystem(Config& config, bool quiet)
     memadmin->SetSymbolTable(m_symtable);
     m_breakpoints.SetSymbolTable(m_symtable);
 
+    // The memory clients see the recorder instead of the memory when
+    // their requests are recorded.
+    IMemory* clientmem = m_memory;
+    string recordFile = GetTopConfOpt("RecordTraceFile", string, "");
+    if (!recordFile.empty())
+    {
+        m_recorder = new MemoryRecorder("recorder", *m_root, *m_memory, recordFile);
+        clientmem = m_recorder;
+        if (!quiet)
+        {
+            clog << "recording memory requests to " << recordFile << endl;
+        }
+    }
+
     // Create the event selector
     Clock& selclock = kernel.CreateClock(GetTopConf("EventCheckFreq", Clock::Frequency));
     m_selector = new Selector("selector", *m_root, selclock);
@@ -778,7 +977,7 @@ MGSystem::MGSystem(Config& config, bool quiet)
         if (m_clock == 0)
             m_clock = &coreclock;
         m_procs[i]   = new DRISC(name, *m_root, coreclock, i, m_procs, m_breakpoints);
-        m_procs[i]->ConnectMemory(m_memory, memadmin);
+        m_procs[i]->ConnectMemory(clientmem, memadmin);
         m_procs[i]->ConnectFPU(m_fpus[i / numProcessorsPerFPU]);
 
         if (GetTopSubConfOpt(name, "EnableIO", bool, false)) // I/O disabled unless specified
@@ -804,8 +1003,41 @@ MGSystem::MGSystem(Config& config, bool quiet)
         clog << numProcessors << " cores instantiated." << endl;
     }
 
-    // Create the I/O devices
-    vector<string> dev_names = config.getWordList("IODevices");
+    // Create the trace players
+    if (!traceFile.empty())
+    {
+        m_trace = new TraceFeed(traceFile, GetTopConfOpt("TraceStartCycle", CycleNo, 0));
+        if (m_trace->GetNumClients() == 0)
+        {
+            throw runtime_error("Memory trace " + traceFile + " has no clients");
+        }
+
+        // The players register with the memory in the order of the
+        // clients in the trace, so they get the same client IDs.
+        m_players.resize(m_trace->GetNumClients());
+        for (size_t i = 0; i < m_players.size(); ++i)
+        {
+            auto name = "player" + to_string(i);
+            Clock& playerclock = kernel.CreateClock(GetTopSubConfOpt(name, "Freq", Clock::Frequency, default_core_freq));
+            if (m_clock == 0)
+                m_clock = &playerclock;
+            m_players[i] = new TracePlayer(name, *m_root, playerclock, *m_trace, i);
+            m_players[i]->ConnectMemory(clientmem);
+        }
+        if (!quiet)
+        {
+            clog << m_players.size() << " trace players instantiated for "
+                 << m_trace->GetReader().GetNumRecords() << " requests from " << traceFile << "." << endl;
+        }
+    }
+
+    // Create the I/O devices. Without cores, there is nothing for
+    // them to boot or talk to.
+    vector<string> dev_names;
+    if (traceFile.empty())
+    {
+        dev_names = config.getWordList("IODevices");
+    }
     size_t numIODevices = dev_names.size();
 
     m_devices.resize(numIODevices);
@@ -923,6 +1155,37 @@ MGSystem::MGSystem(Config& config, bool quiet)
     for (auto proc : m_procs)
         proc->Initialize();
 
+    size_t numThreads = GetTopConfOpt("KernelThreads", size_t, 1);
+    kernel.SetNumThreads(numThreads);
+    if (numThreads > 1 && !quiet)
+    {
+        clog << "running the acquire phase of the cycles on " << numThreads << " host threads" << endl;
+    }
+
+    m_profiler = new GuestProfiler(kernel, m_procs, m_symtable);
+    CycleNo profileInterval = GetTopConfOpt("GuestProfileInterval", CycleNo, 0);
+    if (profileInterval > 0)
+    {
+        m_profiler->SetInterval(profileInterval);
+        if (!quiet)
+        {
+            clog << "sampling the PCs of the cores every " << profileInterval << " cycles" << endl;
+        }
+    }
+
+    string timelineFile = GetTopConfOpt("TimelineFile", string, "");
+    if (!timelineFile.empty())
+    {
+        m_timeline = new Timeline(kernel, m_procs, timelineFile,
+                                  GetTopConfOpt("TimelineFlushInterval", CycleNo, 10000));
+        for (auto proc : m_procs)
+            proc->SetTimeline(m_timeline);
+        if (!quiet)
+        {
+            clog << "recording family and thread events to " << timelineFile << endl;
+        }
+    }
+
     // Check for bootable ROMs. This must happen after I/O bus
     // initialization because the ROM contents are loaded then.
     for (auto rom : aroms)
@@ -935,7 +1198,7 @@ MGSystem::MGSystem(Config& config, bool quiet)
             m_bootrom = rom;
         }
 
-    if (m_bootrom == NULL)
+    if (m_bootrom == NULL && m_trace == NULL)
     {
         cerr << "Warning: No bootable ROM configured." << endl;
     }
@@ -1039,6 +1302,8 @@ MGSystem::MGSystem(Config& config, bool quiet)
 
 MGSystem::~MGSystem()
 {
+    delete m_timeline;
+    delete m_profiler;
     for (auto ioif : m_ioifs)
         delete ioif;
     for (auto iob : m_ics)
@@ -1047,6 +1312,10 @@ MGSystem::~MGSystem()
         delete dev;
     for (auto proc : m_procs)
         delete proc;
+    for (auto player : m_players)
+        delete player;
+    delete m_trace;
+    delete m_recorder;
     for (auto fpu : m_fpus)
         delete fpu;
     delete m_selector;
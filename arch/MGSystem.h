@@ -10,6 +10,8 @@
 #include <utility>
 #include <string>
 #include <map>
+#include <cstdlib>
+#include <cstring>
 
 namespace Simulator {
 
@@ -21,6 +23,11 @@ namespace Simulator {
     class IOMessageInterface;
     class DRISC;
     class IMemory;
+    class TraceFeed;
+    class TracePlayer;
+    class MemoryRecorder;
+    class GuestProfiler;
+    class Timeline;
 
     class MGSystem
     {
@@ -30,18 +37,51 @@ namespace Simulator {
         Clock*                      m_clock;    ///< Master clock for the system
         Object*                     m_root;     ///< Root object for the system
         std::vector<DRISC*>         m_procs;
+        TraceFeed*                  m_trace;    ///< Memory trace replayed instead of running cores
+        std::vector<TracePlayer*>   m_players;
+        MemoryRecorder*             m_recorder; ///< Records the requests to the memory, if enabled
         std::vector<FPU*>           m_fpus;
         std::vector<IC::IInterconnect<IOPayload>*> m_ics;
         std::vector<IOMessageInterface*> m_ioifs;
         std::vector<Object*>        m_devices;
 
         SymbolTable                 m_symtable;
+        GuestProfiler*              m_profiler; ///< Samples the PCs of the cores
+        Timeline*                   m_timeline; ///< Records the families and threads, if enabled
         BreakPointManager           m_breakpoints;
         IMemory*                    m_memory;
         std::string                 m_objdump_cmd;
         ActiveROM*                  m_bootrom;
         Selector*                   m_selector;
 
+        // The state of rand(), which generates the family capabilities.
+        // It is kept here so that checkpoints include it.
+        struct RandomState
+        {
+            char state[128];
+
+            SERIALIZE(arch)
+            {
+                // setstate() stores the position of rand() in the
+                // array of the state it switches away from, and
+                // resumes from the position in the new array.
+                if (arch.reading())
+                {
+                    setstate(state);
+                    arch & Serialization::binary(state, sizeof state);
+                }
+                else
+                {
+                    char loaded[sizeof state];
+                    arch & Serialization::binary(loaded, sizeof loaded);
+                    setstate(loaded);
+                    memcpy(state, loaded, sizeof state);
+                    setstate(state);
+                }
+            }
+        };
+        RandomState                 m_random;
+
         // Writes the current configuration into memory and returns its address
         MemAddr WriteConfiguration();
 
@@ -83,6 +123,7 @@ namespace Simulator {
         void PrintAllFamilyCompletions(std::ostream& os) const;
         void PrintFamilyCompletions(std::ostream& os) const;
         void PrintCoreStats(std::ostream& os) const;
+        void PrintPlayerStats(std::ostream& os) const;
         void PrintAllStatistics(std::ostream& os) const;
 
 #ifdef STATIC_KERNEL
@@ -93,12 +134,31 @@ namespace Simulator {
 #endif
 
         const SymbolTable& GetSymTable() const { return m_symtable; }
+        const IMemory& GetMemory() const { return *m_memory; }
 	BreakPointManager& GetBreakPointManager() { return m_breakpoints; }
+        GuestProfiler& GetGuestProfiler() { return *m_profiler; }
+        const GuestProfiler& GetGuestProfiler() const { return *m_profiler; }
 
         // Steps the entire system this many cycles
         void Step(CycleNo nCycles);
         void Abort() { GetKernel()->Abort(); }
 
+        // Enables or disables direct-memory mode on all cores. In this mode,
+        // loads and stores go directly to the memory contents, so this
+        // is not supported by memory systems with caches (CDMA, ZLCDMA).
+        // The pipelines are still simulated cycle by cycle. Before the
+        // mode starts, the simulation runs until the requests in flight
+        // have completed.
+        void SetDirectMemory(bool enable);
+        bool IsDirectMemory() const;
+
+        // Saves or restores the state of the whole simulation. A
+        // checkpoint can only be restored into a system with the same
+        // configuration and program, before it has started or between
+        // steps, and not in direct-memory mode.
+        void SaveCheckpoint(const std::string& filename) const;
+        void LoadCheckpoint(const std::string& filename);
+
         MGSystem(Config& config, bool quiet);
         MGSystem(const MGSystem&) = delete;
         MGSystem& operator=(const MGSystem&) = delete;
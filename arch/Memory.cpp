@@ -1,11 +1,154 @@
 #include "arch/Memory.h"
 #include <iomanip>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
 namespace Simulator
 {
 
+namespace line {
+
+    // Byte masks for every 8-bit pattern: byte i of s_expand[b] is
+    // 0xff if bit i of b is set, 0 otherwise.
+    static const struct ExpandTable
+    {
+        uint64_t masks[256];
+        ExpandTable()
+        {
+            for (unsigned b = 0; b < 256; ++b)
+            {
+                masks[b] = 0;
+                for (unsigned i = 0; i < 8; ++i)
+                    if (b & (1U << i))
+                        masks[b] |= (uint64_t)0xff << (i * 8);
+            }
+        }
+    } s_expand;
+
+    static inline uint64_t load64(const char* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+    static inline void store64(char* p, uint64_t v) { memcpy(p, &v, 8); }
+
+#ifdef __AVX2__
+    // Expand 32 mask bits into a vector of 32 byte masks.
+    static inline __m256i expand32(uint32_t bits)
+    {
+        // Copy byte k of the mask to bytes 8k..8k+7, then keep one bit
+        // per byte and compare.
+        const __m256i shuffle = _mm256_setr_epi64x(0, 0x0101010101010101LL, 0x0202020202020202LL, 0x0303030303030303LL);
+        const __m256i select  = _mm256_set1_epi64x(0x8040201008040201LL);
+        __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(bits), shuffle);
+        return _mm256_cmpeq_epi8(_mm256_and_si256(v, select), select);
+    }
+#endif
+
+#ifdef __SSE2__
+    // Expand 16 mask bits into a vector of 16 byte masks.
+    static inline __m128i expand16(uint32_t bits)
+    {
+        return _mm_set_epi64x(s_expand.masks[(bits >> 8) & 0xff], s_expand.masks[bits & 0xff]);
+    }
+#endif
+
+    // Merge the bytes of src selected by bits into dst. sz is at most 64.
+    static inline void merge(char* dst, const char* src, uint64_t bits, size_t sz)
+    {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 32 <= sz; i += 32, bits >>= 32)
+        {
+            __m256i m = expand32((uint32_t)bits);
+            __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+            __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+            _mm256_storeu_si256((__m256i*)(dst + i), _mm256_blendv_epi8(d, s, m));
+        }
+#endif
+#if defined(__SSE2__)
+        for (; i + 16 <= sz; i += 16, bits >>= 16)
+        {
+            __m128i m = expand16((uint32_t)bits);
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+            __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(m, s), _mm_andnot_si128(m, d)));
+        }
+#endif
+        for (; i + 8 <= sz; i += 8, bits >>= 8)
+        {
+            uint64_t m = s_expand.masks[bits & 0xff];
+            store64(dst + i, (load64(dst + i) & ~m) | (load64(src + i) & m));
+        }
+        for (; i < sz; ++i, bits >>= 1)
+        {
+            if (bits & 1)
+                dst[i] = src[i];
+        }
+    }
+
+    void blit(char* dst, const char* src, const LineMask& mask, size_t sz)
+    {
+        assert(sz <= MAX_MEMORY_OPERATION_SIZE);
+        if (mask.all(sz))
+            memcpy(dst, src, sz);
+        else if (mask.any())
+            merge(dst, src, mask.bits(), sz);
+    }
+
+    void blitnot(char* dst, const char* src, const LineMask& mask, size_t sz)
+    {
+        blit(dst, src, ~mask, sz);
+    }
+
+    void setif(char* dst, char value, const LineMask& mask, size_t sz)
+    {
+        char src[MAX_MEMORY_OPERATION_SIZE];
+        memset(src, value, sz);
+        blit(dst, src, mask, sz);
+    }
+
+    bool equal(const char* a, const char* b, const LineMask& mask, size_t sz)
+    {
+        assert(sz <= MAX_MEMORY_OPERATION_SIZE);
+        uint64_t bits = mask.bits();
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 32 <= sz; i += 32, bits >>= 32)
+        {
+            __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+            __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+            uint32_t eq = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+            if (~eq & (uint32_t)bits)
+                return false;
+        }
+#endif
+#if defined(__SSE2__)
+        for (; i + 16 <= sz; i += 16, bits >>= 16)
+        {
+            __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+            uint32_t eq = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+            if (~eq & (uint32_t)bits & 0xffff)
+                return false;
+        }
+#endif
+        for (; i + 8 <= sz; i += 8, bits >>= 8)
+        {
+            if ((load64(a + i) ^ load64(b + i)) & s_expand.masks[bits & 0xff])
+                return false;
+        }
+        for (; i < sz; ++i, bits >>= 1)
+        {
+            if ((bits & 1) && a[i] != b[i])
+                return false;
+        }
+        return true;
+    }
+
+}
+
 IMemoryAdmin::~IMemoryAdmin()
 {}
 
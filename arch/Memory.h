@@ -15,14 +15,72 @@ namespace Simulator
 // allocate fixed-size arrays in request buffers.
 static const size_t MAX_MEMORY_OPERATION_SIZE = 64;
 
+// Byte-enable mask for a memory line, one bit per byte of the line.
+// This has no constructors so it can live in the anonymous message
+// structs of the networks; like the data it describes, a
+// default-initialized mask is undefined.
+class LineMask
+{
+    uint64_t m_bits;
+
+    static_assert(MAX_MEMORY_OPERATION_SIZE <= 64, "LineMask only holds 64 bytes");
+
+public:
+    // Mask with the given bits set.
+    static LineMask Bits(uint64_t bits) { LineMask m; m.m_bits = bits; return m; }
+
+    // Mask with the bytes [offset, offset + size) set. Bytes past the
+    // end of the mask are left out.
+    static LineMask Range(size_t offset, size_t size)
+    {
+        if (size == 0 || offset >= 64)
+            return Bits(0);
+        return Bits(((size < 64) ? ((uint64_t)1 << size) - 1 : ~(uint64_t)0) << offset);
+    }
+
+    bool     operator[](size_t i) const { return (m_bits >> i) & 1; }
+    uint64_t bits() const { return m_bits; }
+
+    void set(size_t i) { m_bits |= (uint64_t)1 << i; }
+    void reset() { m_bits = 0; }
+
+    // Number of bytes set
+    size_t count() const
+    {
+#ifdef __GNUC__
+        return __builtin_popcountll(m_bits);
+#else
+        uint64_t x = m_bits - ((m_bits >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        return (x * 0x0101010101010101ULL) >> 56;
+#endif
+    }
+    bool   any()   const { return m_bits != 0; }
+    bool   none()  const { return m_bits == 0; }
+
+    // Whether all the bytes in a line of the given size are set
+    bool   all(size_t size) const { return (~m_bits & Range(0, size).m_bits) == 0; }
+
+    LineMask  operator~() const { return Bits(~m_bits); }
+    LineMask  operator&(const LineMask& o) const { return Bits(m_bits & o.m_bits); }
+    LineMask  operator|(const LineMask& o) const { return Bits(m_bits | o.m_bits); }
+    LineMask& operator&=(const LineMask& o) { m_bits &= o.m_bits; return *this; }
+    LineMask& operator|=(const LineMask& o) { m_bits |= o.m_bits; return *this; }
+    bool      operator==(const LineMask& o) const { return m_bits == o.m_bits; }
+    bool      operator!=(const LineMask& o) const { return m_bits != o.m_bits; }
+
+    SERIALIZE(a) { a & Serialization::bitmask(&m_bits, MAX_MEMORY_OPERATION_SIZE); }
+};
+
 struct MemData
 {
-    char    data[MAX_MEMORY_OPERATION_SIZE];
-    bool    mask[MAX_MEMORY_OPERATION_SIZE];
+    char     data[MAX_MEMORY_OPERATION_SIZE];
+    LineMask mask;
     SERIALIZE(a) {
         a & "[md"
             & Serialization::binary(data, MAX_MEMORY_OPERATION_SIZE)
-            & Serialization::bitvec(mask, MAX_MEMORY_OPERATION_SIZE)
+            & mask
             & "]";
     }
 };
@@ -62,6 +120,22 @@ namespace line {
                 dst[i] = src;
     }
 
+    // Versions for line data with a LineMask. These use SIMD
+    // instructions where the host supports them. sz is at most
+    // MAX_MEMORY_OPERATION_SIZE.
+
+    // Copy the bytes of src selected by mask to dst.
+    void blit(char* dst, const char* src, const LineMask& mask, size_t sz);
+
+    // Copy the bytes of src not selected by mask to dst.
+    void blitnot(char* dst, const char* src, const LineMask& mask, size_t sz);
+
+    // Set the bytes of dst selected by mask to value.
+    void setif(char* dst, char value, const LineMask& mask, size_t sz);
+
+    // Returns whether the bytes of a and b selected by mask are equal.
+    bool equal(const char* a, const char* b, const LineMask& mask, size_t sz);
+
 }
 
 class IMemory;
@@ -72,7 +146,7 @@ public:
     virtual bool OnMemoryReadCompleted(MemAddr addr, const char* data) = 0;
     virtual bool OnMemoryWriteCompleted(WClientID wid) = 0;
     virtual bool OnMemoryInvalidated(MemAddr addr) = 0;
-    virtual bool OnMemorySnooped(MemAddr /* addr */, const char* /*data*/, const bool* /*mask*/) { return true; }
+    virtual bool OnMemorySnooped(MemAddr /* addr */, const char* /*data*/, const LineMask& /*mask*/) { return true; }
 
     virtual ~IMemoryCallback() {}
 
@@ -100,6 +174,16 @@ public:
 
     virtual void Initialize() {}
 
+    // Returns true if the memory contents seen through IMemoryAdmin are
+    // always up to date, i.e. the memory system does not hold newer data
+    // in caches or messages of its own.
+    virtual bool HasCurrentContents() const { return true; }
+
+    // Returns true if the memory system keeps state that affects its
+    // timing, such as caches, directories or open DRAM rows, which the
+    // direct accesses of direct-memory mode do not update.
+    virtual bool HasTimingState() const { return false; }
+
     virtual ~IMemory() {}
 
     virtual void GetMemoryStatistics(uint64_t& nreads, uint64_t& nwrites,
@@ -116,7 +200,9 @@ public:
     virtual bool CheckPermissions(MemAddr address, MemSize size, int access) const = 0;
 
     virtual void Read (MemAddr address, void* data, MemSize size) const = 0;
-    virtual void Write(MemAddr address, const void* data, const bool* mask, MemSize size) = 0;
+    // If mask is not NULL, only the bytes it selects are written; size
+    // is then at most MAX_MEMORY_OPERATION_SIZE.
+    virtual void Write(MemAddr address, const void* data, const LineMask* mask, MemSize size) = 0;
 
     virtual SymbolTable& GetSymbolTable() const = 0;
     virtual void SetSymbolTable(SymbolTable& symtable) = 0;
@@ -0,0 +1,166 @@
+#include "PageTable.h"
+
+#include <sim/except.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/mman.h>
+
+using namespace std;
+
+namespace Simulator
+{
+
+thread_local PageTable::TLBEntry PageTable::t_tlb[TLB_SIZE];
+
+// Source of the identifiers of page tables; 0 is never used, so that
+// the empty TLB entries match no table.
+static atomic<uint64_t> g_nextId(1);
+
+void PageTable::Remember(MemAddr pn, Page* page) const
+{
+    TLBEntry& e = t_tlb[pn % TLB_SIZE];
+    e.table = m_id;
+    e.pn    = pn;
+    e.page  = page;
+}
+
+PageTable::Page* PageTable::Lookup(MemAddr pn) const
+{
+    const void* node = m_root;
+    for (unsigned int level = 0; node != NULL && level < NUM_LEVELS; ++level)
+    {
+        node = static_cast<const Node*>(node)->children[GetIndex(pn, level)];
+    }
+
+    Page* page = static_cast<Page*>(const_cast<void*>(node));
+    if (page != NULL)
+    {
+        Remember(pn, page);
+    }
+    return page;
+}
+
+PageTable::Page* PageTable::Allocate(MemAddr address, bool& created)
+{
+    const MemAddr pn = address >> PAGE_BITS;
+
+    created = false;
+    Page* page = Find(address);
+    if (page != NULL)
+    {
+        return page;
+    }
+
+    if (m_root == NULL)
+    {
+        m_root = new Node();
+    }
+
+    // Walk down the tree, creating the missing nodes
+    Node* node = m_root;
+    for (unsigned int level = 0; level + 1 < NUM_LEVELS; ++level)
+    {
+        void*& child = node->children[GetIndex(pn, level)];
+        if (child == NULL)
+        {
+            child = new Node();
+        }
+        node = static_cast<Node*>(child);
+    }
+
+    page = AllocatePage();
+    node->children[GetIndex(pn, NUM_LEVELS - 1)] = page;
+    ++m_numPages;
+    created = true;
+
+    Remember(pn, page);
+    return page;
+}
+
+PageTable::Page* PageTable::AllocatePage()
+{
+    if (m_chunks.empty() || m_chunkUsed == CHUNK_PAGES)
+    {
+        // Map a new chunk. We map twice the size and trim the excess,
+        // so that the chunk is aligned to its size and the host can use
+        // a huge page for it. Anonymous mappings are zero-filled.
+        const size_t chunk_size = CHUNK_PAGES * PAGE_SIZE;
+        void* p = mmap(NULL, 2 * chunk_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            throw exceptf<>("Unable to allocate %zu bytes for memory pages: %s", chunk_size, strerror(errno));
+        }
+
+        char* base  = static_cast<char*>(p);
+        char* begin = reinterpret_cast<char*>(((uintptr_t)base + chunk_size - 1) & ~(uintptr_t)(chunk_size - 1));
+        char* end   = begin + chunk_size;
+        if (begin > base)
+        {
+            munmap(base, begin - base);
+        }
+        if (end < base + 2 * chunk_size)
+        {
+            munmap(end, base + 2 * chunk_size - end);
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(begin, chunk_size, MADV_HUGEPAGE);
+#endif
+        m_chunks.push_back(reinterpret_cast<Page*>(begin));
+        m_chunkUsed = 0;
+    }
+    return m_chunks.back() + m_chunkUsed++;
+}
+
+void PageTable::FreeNode(Node* node, unsigned int level)
+{
+    if (level + 1 < NUM_LEVELS)
+    {
+        for (size_t i = 0; i < FANOUT; ++i)
+        {
+            if (node->children[i] != NULL)
+            {
+                FreeNode(static_cast<Node*>(node->children[i]), level + 1);
+            }
+        }
+    }
+    delete node;
+}
+
+void PageTable::Clear()
+{
+    if (m_root != NULL)
+    {
+        FreeNode(m_root, 0);
+        m_root = NULL;
+    }
+    for (auto p : m_chunks)
+    {
+        munmap(p, CHUNK_PAGES * PAGE_SIZE);
+    }
+    m_chunks.clear();
+    m_chunkUsed = 0;
+    m_numPages  = 0;
+
+    // Invalidate the translations in the TLBs of all threads
+    m_id = g_nextId.fetch_add(1, memory_order_relaxed);
+}
+
+PageTable::PageTable()
+    : m_root(NULL),
+      m_numPages(0),
+      m_chunks(),
+      m_chunkUsed(0),
+      m_id(g_nextId.fetch_add(1, memory_order_relaxed))
+{
+}
+
+PageTable::~PageTable()
+{
+    Clear();
+}
+
+}
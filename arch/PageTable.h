@@ -0,0 +1,149 @@
+// -*- c++ -*-
+#ifndef PAGETABLE_H
+#define PAGETABLE_H
+
+#include <arch/simtypes.h>
+#include <sim/serialization.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+
+// This class maps page-aligned addresses to pages of memory, using a
+// multi-level radix tree. The pages are allocated on demand from an
+// arena of large, zero-filled chunks.
+// A small direct-mapped cache of recent translations sits in front of
+// the tree, so that the common case of repeated accesses to the same
+// few pages does not walk the tree at all. Every host thread has its
+// own, since the kernel can run processes on several threads.
+class PageTable
+{
+public:
+    // Size of each page. Must be a power of two.
+    static const unsigned int PAGE_BITS = 12;
+    static const size_t       PAGE_SIZE = (size_t)1 << PAGE_BITS;
+
+    struct Page
+    {
+        char data[PAGE_SIZE];
+        SERIALIZE(a) { a & Serialization::binary(data, PAGE_SIZE); }
+    };
+
+    // Returns the page containing address, or NULL if it was never
+    // allocated.
+    Page* Find(MemAddr address) const
+    {
+        const MemAddr pn = address >> PAGE_BITS;
+        const TLBEntry& e = t_tlb[pn % TLB_SIZE];
+        if (e.table == m_id && e.pn == pn)
+            return e.page;
+        return Lookup(pn);
+    }
+
+    // Returns the page containing address, allocating a zero-filled
+    // page if needed. created is set if the page is new.
+    Page* Allocate(MemAddr address, bool& created);
+
+    // Number of allocated pages.
+    size_t GetNumPages() const { return m_numPages; }
+
+    // Release all pages.
+    void Clear();
+
+    // Calls f(address, page) for all allocated pages, in ascending
+    // address order.
+    template<typename F>
+    void ForEach(F f) const { if (m_root != NULL) ForEach(m_root, 0, 0, f); }
+
+    // The page table is serialized as a sequence of (address, page)
+    // pairs, like a std::map<MemAddr, Page>.
+    SERIALIZE(a)
+    {
+        std::vector<std::pair<MemAddr, Page> > vec;
+        if (a.reading())
+        {
+            vec.reserve(m_numPages);
+            ForEach([&](MemAddr addr, const Page& page) { vec.push_back(std::make_pair(addr, page)); });
+        }
+        a & vec;
+        if (!a.reading())
+        {
+            Clear();
+            bool created;
+            for (auto& p : vec)
+                *Allocate(p.first, created) = p.second;
+        }
+    }
+
+    PageTable();
+    PageTable(const PageTable&) = delete;
+    PageTable& operator=(const PageTable&) = delete;
+    ~PageTable();
+
+private:
+    // Every node in the tree resolves LEVEL_BITS bits of the page
+    // number. The root resolves the most significant bits.
+    static const unsigned int ADDR_BITS   = sizeof(MemAddr) * 8;
+    static const unsigned int PN_BITS     = ADDR_BITS - PAGE_BITS;
+    static const unsigned int LEVEL_BITS  = 13;
+    static const unsigned int NUM_LEVELS  = (PN_BITS + LEVEL_BITS - 1) / LEVEL_BITS;
+    static const size_t       FANOUT      = (size_t)1 << LEVEL_BITS;
+
+    // Pages are allocated from chunks of this many pages (2 MiB), which
+    // the host can back with huge pages.
+    static const size_t       CHUNK_PAGES = 512;
+
+    static const size_t       TLB_SIZE    = 16;
+
+    struct Node
+    {
+        void* children[FANOUT];   ///< Child nodes, or pages at the last level
+    };
+
+    struct TLBEntry
+    {
+        uint64_t table;           ///< m_id of the page table of the entry
+        MemAddr  pn;              ///< Page number
+        Page*    page;            ///< Page
+    };
+
+    static size_t GetIndex(MemAddr pn, unsigned int level)
+    {
+        return (size_t)(pn >> ((NUM_LEVELS - 1 - level) * LEVEL_BITS)) & (FANOUT - 1);
+    }
+
+    Page* Lookup(MemAddr pn) const;
+    void  Remember(MemAddr pn, Page* page) const;
+    Page* AllocatePage();
+    void  FreeNode(Node* node, unsigned int level);
+
+    template<typename F>
+    void ForEach(const Node* node, unsigned int level, MemAddr pn, F& f) const
+    {
+        for (size_t i = 0; i < FANOUT; ++i)
+        {
+            const void* child = node->children[i];
+            if (child == NULL)
+                continue;
+            const MemAddr cpn = (pn << LEVEL_BITS) | i;
+            if (level + 1 == NUM_LEVELS)
+                f(cpn << PAGE_BITS, *static_cast<const Page*>(child));
+            else
+                ForEach(static_cast<const Node*>(child), level + 1, cpn, f);
+        }
+    }
+
+    Node*               m_root;       ///< Root of the tree
+    size_t              m_numPages;   ///< Number of allocated pages
+    std::vector<Page*>  m_chunks;     ///< Chunks of pages in the arena
+    size_t              m_chunkUsed;  ///< Pages used in the last chunk
+    uint64_t            m_id;         ///< Identifies the table and its pages in the TLBs
+
+    static thread_local TLBEntry t_tlb[TLB_SIZE]; ///< Recent translations of this host thread
+};
+
+}
+#endif
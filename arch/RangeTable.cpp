@@ -0,0 +1,230 @@
+#include "RangeTable.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+namespace Simulator
+{
+
+const RangeTable::Range* RangeTable::Find(MemAddr address, MemSize size) const
+{
+    const MemAddr pn = address >> PAGE_BITS;
+    const Node* node = m_root;
+    for (unsigned int level = 0; node != NULL && level < NUM_LEVELS; ++level)
+    {
+        const uintptr_t slot = node->slots[GetIndex(pn, level)];
+        switch (slot & SLOT_MASK)
+        {
+        case SLOT_RANGE:
+        {
+            const Range* range = reinterpret_cast<const Range*>(slot & ~(uintptr_t)SLOT_MASK);
+            return Contains(*range, address, size) ? range : NULL;
+        }
+
+        case SLOT_LIST:
+            for (const Range* range : *reinterpret_cast<const RangeList*>(slot & ~(uintptr_t)SLOT_MASK))
+            {
+                if (Contains(*range, address, size))
+                {
+                    return range;
+                }
+            }
+            return NULL;
+
+        default:
+            node = reinterpret_cast<const Node*>(slot);
+            break;
+        }
+    }
+    return NULL;
+}
+
+void RangeTable::UpdateLeaf(uintptr_t& slot, const Range* range, bool insert)
+{
+    const uintptr_t tagged = reinterpret_cast<uintptr_t>(range) | SLOT_RANGE;
+    if (insert)
+    {
+        if (slot == 0)
+        {
+            slot = tagged;
+        }
+        else if ((slot & SLOT_MASK) == SLOT_RANGE)
+        {
+            // A second range shares the page
+            RangeList* list = new RangeList;
+            list->push_back(reinterpret_cast<const Range*>(slot & ~(uintptr_t)SLOT_MASK));
+            list->push_back(range);
+            slot = reinterpret_cast<uintptr_t>(list) | SLOT_LIST;
+        }
+        else
+        {
+            reinterpret_cast<RangeList*>(slot & ~(uintptr_t)SLOT_MASK)->push_back(range);
+        }
+    }
+    else if (slot == tagged)
+    {
+        slot = 0;
+    }
+    else
+    {
+        assert((slot & SLOT_MASK) == SLOT_LIST);
+        RangeList* list = reinterpret_cast<RangeList*>(slot & ~(uintptr_t)SLOT_MASK);
+        list->erase(find(list->begin(), list->end(), range));
+        if (list->size() == 1)
+        {
+            slot = reinterpret_cast<uintptr_t>(list->front()) | SLOT_RANGE;
+            delete list;
+        }
+    }
+}
+
+void RangeTable::Update(Node* node, unsigned int level, MemAddr base, const Range* range, bool insert)
+{
+    // Find the slots of this node that the range overlaps. base is the
+    // first page number of the node.
+    const unsigned int shift = GetSlotShift(level);
+    const MemAddr      first = range->address >> PAGE_BITS;
+    const MemAddr      last  = (range->address + (range->size - 1)) >> PAGE_BITS;
+    const size_t       lo    = (first > base) ? (size_t)((first - base) >> shift) : 0;
+    const size_t       hi    = (size_t)min<MemAddr>((last - base) >> shift, FANOUT - 1);
+
+    for (size_t i = lo; i <= hi; ++i)
+    {
+        uintptr_t& slot = node->slots[i];
+        if (level + 1 == NUM_LEVELS)
+        {
+            UpdateLeaf(slot, range, insert);
+            continue;
+        }
+
+        // The slot covers the pages [slot_first, slot_last]
+        const MemAddr slot_first = base + ((MemAddr)i << shift);
+        const MemAddr slot_last  = slot_first + (((MemAddr)1 << shift) - 1);
+        if (range->address <= (slot_first << PAGE_BITS) &&
+            range->size - 1 >= ((slot_last << PAGE_BITS) | (PageTable::PAGE_SIZE - 1)) - range->address)
+        {
+            // The range covers the entire slot, and no other range
+            // can overlap it.
+            assert(insert ? slot == 0 : slot == (reinterpret_cast<uintptr_t>(range) | SLOT_RANGE));
+            slot = insert ? reinterpret_cast<uintptr_t>(range) | SLOT_RANGE : 0;
+            continue;
+        }
+
+        if (slot == 0)
+        {
+            assert(insert);
+            slot = reinterpret_cast<uintptr_t>(new Node());
+        }
+        assert((slot & SLOT_MASK) == SLOT_NODE);
+
+        Node* child = reinterpret_cast<Node*>(slot);
+        Update(child, level + 1, slot_first, range, insert);
+        if (!insert && all_of(child->slots, child->slots + FANOUT, [](uintptr_t s) { return s == 0; }))
+        {
+            // The last range in the child is gone
+            delete child;
+            slot = 0;
+        }
+    }
+}
+
+void RangeTable::Insert(MemAddr address, MemSize size, ProcessID owner, int permissions)
+{
+    assert(size != 0);
+
+    Range* range = new Range;
+    range->address     = address;
+    range->size        = size;
+    range->owner       = owner;
+    range->permissions = permissions;
+
+    if (m_root == NULL)
+    {
+        m_root = new Node();
+    }
+    Update(m_root, 0, 0, range, true);
+}
+
+void RangeTable::Remove(MemAddr address)
+{
+    const Range* range = Find(address, 1);
+    assert(range != NULL && range->address == address);
+
+    Update(m_root, 0, 0, range, false);
+    delete range;
+}
+
+void RangeTable::FreeNode(Node* node, unsigned int level, MemAddr base, RangeList& ranges)
+{
+    const unsigned int shift = GetSlotShift(level);
+    for (size_t i = 0; i < FANOUT; ++i)
+    {
+        const uintptr_t slot  = node->slots[i];
+        const MemAddr   first = base + ((MemAddr)i << shift);
+        switch (slot & SLOT_MASK)
+        {
+        case SLOT_RANGE:
+        {
+            // A range is collected from the slot of its first page
+            const Range* range = reinterpret_cast<const Range*>(slot & ~(uintptr_t)SLOT_MASK);
+            if ((range->address >> PAGE_BITS) - first < ((MemAddr)1 << shift))
+            {
+                ranges.push_back(range);
+            }
+            break;
+        }
+
+        case SLOT_LIST:
+        {
+            const RangeList* list = reinterpret_cast<const RangeList*>(slot & ~(uintptr_t)SLOT_MASK);
+            for (const Range* range : *list)
+            {
+                if ((range->address >> PAGE_BITS) == first)
+                {
+                    ranges.push_back(range);
+                }
+            }
+            delete list;
+            break;
+        }
+
+        default:
+            if (slot != 0)
+            {
+                FreeNode(reinterpret_cast<Node*>(slot), level + 1, first, ranges);
+            }
+            break;
+        }
+    }
+    delete node;
+}
+
+void RangeTable::Clear()
+{
+    if (m_root != NULL)
+    {
+        // Other slots may still refer to a range when it is found, so
+        // the ranges are deleted after the walk.
+        RangeList ranges;
+        FreeNode(m_root, 0, 0, ranges);
+        m_root = NULL;
+        for (const Range* range : ranges)
+        {
+            delete range;
+        }
+    }
+}
+
+RangeTable::RangeTable()
+    : m_root(NULL)
+{
+}
+
+RangeTable::~RangeTable()
+{
+    Clear();
+}
+
+}
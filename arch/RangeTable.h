@@ -0,0 +1,99 @@
+// -*- c++ -*-
+#ifndef RANGETABLE_H
+#define RANGETABLE_H
+
+#include <arch/simtypes.h>
+#include <arch/PageTable.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Simulator
+{
+
+// This class finds the reservation range that contains an address,
+// using a multi-level radix tree over the page numbers like PageTable.
+// A range is stored in the highest slots that it covers completely, so
+// that even the largest ranges take few slots. The slot of a page that
+// is covered partially lists the (few) ranges that overlap the page.
+// A lookup thus walks at most NUM_LEVELS nodes, however many ranges
+// exist, and inserting or removing a range only updates its own slots.
+class RangeTable
+{
+public:
+    struct Range
+    {
+        MemAddr   address;      ///< Start of the range
+        MemSize   size;         ///< Size of the range, never 0
+        ProcessID owner;        ///< Owner of the range
+        int       permissions;  ///< Permissions of the range
+    };
+
+    // Returns the range that contains [address, address+size), or NULL
+    // if no single range contains it.
+    const Range* Find(MemAddr address, MemSize size) const;
+
+    // Adds a range. It must not overlap with any other range.
+    void Insert(MemAddr address, MemSize size, ProcessID owner, int permissions);
+
+    // Removes the range that starts at address.
+    void Remove(MemAddr address);
+
+    // Removes all ranges.
+    void Clear();
+
+    RangeTable();
+    RangeTable(const RangeTable&) = delete;
+    RangeTable& operator=(const RangeTable&) = delete;
+    ~RangeTable();
+
+private:
+    static const unsigned int PAGE_BITS   = PageTable::PAGE_BITS;
+    static const unsigned int ADDR_BITS   = sizeof(MemAddr) * 8;
+    static const unsigned int PN_BITS     = ADDR_BITS - PAGE_BITS;
+    static const unsigned int LEVEL_BITS  = 13;
+    static const unsigned int NUM_LEVELS  = (PN_BITS + LEVEL_BITS - 1) / LEVEL_BITS;
+    static const size_t       FANOUT      = (size_t)1 << LEVEL_BITS;
+
+    // A slot holds a child node, a range or, at the last level, a list
+    // of ranges. The low bits of the pointer tell which.
+    enum SlotType
+    {
+        SLOT_NODE  = 0,
+        SLOT_RANGE = 1,
+        SLOT_LIST  = 2,
+        SLOT_MASK  = 3,
+    };
+
+    typedef std::vector<const Range*> RangeList;
+
+    struct Node
+    {
+        uintptr_t slots[FANOUT];  ///< Empty slots are 0
+    };
+
+    // Number of pages covered by a slot at the given level, as a shift.
+    static unsigned int GetSlotShift(unsigned int level)
+    {
+        return (NUM_LEVELS - 1 - level) * LEVEL_BITS;
+    }
+
+    static size_t GetIndex(MemAddr pn, unsigned int level)
+    {
+        return (size_t)(pn >> GetSlotShift(level)) & (FANOUT - 1);
+    }
+
+    static bool Contains(const Range& range, MemAddr address, MemSize size)
+    {
+        return address >= range.address && range.size >= size && address - range.address <= range.size - size;
+    }
+
+    void Update(Node* node, unsigned int level, MemAddr base, const Range* range, bool insert);
+    void UpdateLeaf(uintptr_t& slot, const Range* range, bool insert);
+    void FreeNode(Node* node, unsigned int level, MemAddr base, RangeList& ranges);
+
+    Node* m_root;    ///< Root of the tree
+};
+
+}
+#endif
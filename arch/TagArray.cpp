@@ -0,0 +1,90 @@
+#include "arch/TagArray.h"
+#include <sim/ctz.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace Simulator
+{
+
+// Returns the first index in [i, n) with the tag, or n. MemAddr is 64
+// or 32 bits wide depending on the target; the search for its width
+// compares as many tags per vector as fit.
+#if MEMSIZE_WIDTH == 64
+static size_t SearchTags(const MemAddr* tags, MemAddr tag, size_t i, size_t n)
+{
+#if defined(__AVX2__)
+    const __m256i t4 = _mm256_set1_epi64x(tag);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i e = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(tags + i)), t4);
+        int m = _mm256_movemask_pd(_mm256_castsi256_pd(e));
+        if (m != 0)
+            return i + ctz(m);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i t2 = _mm_set1_epi64x(tag);
+    for (; i + 2 <= n; i += 2)
+    {
+        // SSE2 has no 64-bit compare: a tag matches if both its halves do
+        __m128i e = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(tags + i)), t2);
+        e = _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+        int m = _mm_movemask_pd(_mm_castsi128_pd(e));
+        if (m != 0)
+            return i + ctz(m);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        if (tags[i] == tag)
+            return i;
+    }
+    return n;
+}
+#else
+static size_t SearchTags(const MemAddr* tags, MemAddr tag, size_t i, size_t n)
+{
+#if defined(__AVX2__)
+    const __m256i t8 = _mm256_set1_epi32((int)tag);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i e = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(tags + i)), t8);
+        int m = _mm256_movemask_ps(_mm256_castsi256_ps(e));
+        if (m != 0)
+            return i + ctz(m);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i t4 = _mm_set1_epi32((int)tag);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i e = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(tags + i)), t4);
+        int m = _mm_movemask_ps(_mm_castsi128_ps(e));
+        if (m != 0)
+            return i + ctz(m);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        if (tags[i] == tag)
+            return i;
+    }
+    return n;
+}
+#endif
+
+size_t TagArray::Search(const MemAddr* tags, MemAddr tag, size_t from) const
+{
+    return SearchTags(tags, tag, from, m_assoc);
+}
+
+TagArray::TagArray(size_t sets, size_t assoc)
+    : m_tags(sets * assoc, 0),
+      m_mru(sets),
+      m_assoc(assoc)
+{
+}
+
+}
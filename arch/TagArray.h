@@ -0,0 +1,82 @@
+// -*- c++ -*-
+#ifndef TAGARRAY_H
+#define TAGARRAY_H
+
+#include "simtypes.h"
+#include <sim/serialization.h>
+
+#include <atomic>
+#include <vector>
+
+namespace Simulator
+{
+
+// The address tags of a set-associative cache, stored apart from the
+// lines so that a set is searched with a few vector compares instead
+// of a walk over the line structures. The cache keeps the tag in its
+// lines as well, and must update the tag here whenever it changes it
+// in a line.
+//
+// The tags of empty lines are left in place, so a lookup asks the
+// cache whether the matching way holds a line. Each set also
+// remembers the way that hit last, which is tried before the search.
+// Since the lines present in a set have distinct tags, this gives the
+// same result as a search in way order. Snoops from other cores can
+// look up a set while the kernel runs the cores on several host
+// threads, so the remembered ways are relaxed atomics.
+class TagArray
+{
+    std::vector<MemAddr>                m_tags;   ///< The tags, set by set
+    std::vector<std::atomic<uint32_t> > m_mru;    ///< The most recently hit way of each set
+    size_t                              m_assoc;  ///< Number of ways in a set
+
+    // Returns the first way in [from, m_assoc) with the tag, or m_assoc.
+    size_t Search(const MemAddr* tags, MemAddr tag, size_t from) const;
+
+public:
+    TagArray(size_t sets, size_t assoc);
+
+    MemAddr&       operator[](size_t index)       { return m_tags[index]; }
+    const MemAddr& operator[](size_t index) const { return m_tags[index]; }
+
+    // Finds the way of a set that holds a line with the tag, or returns
+    // the associativity if there is none. present(index) must tell
+    // whether the line at an index in the cache is valid.
+    template <typename P>
+    size_t Find(size_t set, MemAddr tag, P present)
+    {
+        const size_t base = set * m_assoc;
+        size_t way = m_mru[set].load(std::memory_order_relaxed);
+        if (m_tags[base + way] == tag && present(base + way))
+        {
+            return way;
+        }
+
+        way = Lookup(set, tag, present);
+        if (way < m_assoc)
+        {
+            m_mru[set].store((uint32_t)way, std::memory_order_relaxed);
+        }
+        return way;
+    }
+
+    // Same as Find, but without training the predictor.
+    template <typename P>
+    size_t Lookup(size_t set, MemAddr tag, P present) const
+    {
+        const size_t   base = set * m_assoc;
+        const MemAddr* tags = &m_tags[base];
+        size_t way = Search(tags, tag, 0);
+        while (way < m_assoc && !present(base + way))
+        {
+            way = Search(tags, tag, way + 1);
+        }
+        return way;
+    }
+
+    SERIALIZE(arch) { arch & "tags" & m_tags; }
+};
+
+}
+
+#endif
@@ -0,0 +1,299 @@
+#include "Timeline.h"
+#include "arch/drisc/DRISC.h"
+#include <sim/except.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+namespace Simulator
+{
+
+// The threads of a core are shown after its families
+static const unsigned THREAD_TRACK = 1u << 16;
+
+// Batches of events that can wait for the writer before the
+// simulation waits as well
+static const size_t MAX_PENDING = 16;
+
+// Formatted text that is buffered before it is written
+static const size_t OUTPUT_SIZE = 1 << 16;
+
+Timeline::Timeline(Kernel& kernel, const vector<DRISC*>& procs, const string& filename, CycleNo interval)
+    : m_kernel(kernel),
+      m_filename(filename),
+      m_file(),
+      m_events(),
+      m_handler(0),
+      m_queue(),
+      m_lock(),
+      m_ready(),
+      m_done(),
+      m_stop(false),
+      m_thread(),
+      m_failed(false),
+      m_error(),
+      m_families(),
+      m_threads(),
+      m_named(),
+      m_text(),
+      m_first(true),
+      m_last(0)
+{
+    if (interval == 0)
+    {
+        throw InvalidArgumentException("TimelineFlushInterval must be greater than zero");
+    }
+
+    m_file.open(filename.c_str(), ios::out | ios::trunc);
+    if (!m_file)
+    {
+        throw exceptf<IOException>("Unable to create timeline %s: %s", filename.c_str(), strerror(errno));
+    }
+
+    m_text = "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"timestamps\":\"master cycles\"},\"traceEvents\":[\n";
+    for (size_t i = 0; i < procs.size(); ++i)
+    {
+        WriteEvent("M", "process_name", NULL, i, 0, 0, 0, "{\"name\":\"" + procs[i]->GetName() + "\"}");
+        WriteEvent("M", "process_sort_index", NULL, i, 0, 0, 0, "{\"sort_index\":" + to_string(i) + "}");
+    }
+
+    m_thread = thread(&Timeline::Drain, this);
+    m_handler = m_kernel.AddIntervalHandler(interval, [this]{ Flush(); });
+}
+
+Timeline::~Timeline()
+{
+    try
+    {
+        Close();
+    }
+    catch (const exception& e)
+    {
+        cerr << "Warning: timeline " << m_filename << " is incomplete: " << e.what() << endl;
+    }
+}
+
+void Timeline::Close()
+{
+    if (!m_thread.joinable())
+        return;
+
+    m_kernel.RemoveIntervalHandler(m_handler);
+    Flush();
+    {
+        lock_guard<mutex> lock(m_lock);
+        m_stop = true;
+    }
+    m_ready.notify_one();
+    m_thread.join();
+    if (m_failed.load(memory_order_acquire))
+    {
+        rethrow_exception(m_error);
+    }
+
+    m_file.close();
+    if (!m_file)
+    {
+        throw exceptf<IOException>("Unable to write timeline %s", m_filename.c_str());
+    }
+}
+
+// Runs at the end of a cycle: hands the events to the writer, waiting
+// if it is too far behind.
+void Timeline::Flush()
+{
+    if (m_events.empty())
+        return;
+
+    // The buffer keeps the same capacity for the next interval
+    vector<Event> batch;
+    batch.reserve(m_events.size());
+    batch.swap(m_events);
+
+    unique_lock<mutex> lock(m_lock);
+    m_done.wait(lock, [this]{ return m_queue.size() < MAX_PENDING || m_failed.load(memory_order_acquire); });
+    if (m_failed.load(memory_order_acquire))
+    {
+        rethrow_exception(m_error);
+    }
+    m_queue.push_back(move(batch));
+    lock.unlock();
+    m_ready.notify_one();
+}
+
+// Runs on its own host thread: formats the batches of events until
+// Close() stops it, then ends the spans that are still open.
+void Timeline::Drain()
+{
+    try
+    {
+        for (;;)
+        {
+            vector<Event> batch;
+            {
+                unique_lock<mutex> lock(m_lock);
+                m_ready.wait(lock, [this]{ return !m_queue.empty() || m_stop; });
+                if (m_queue.empty())
+                    break;
+                batch = move(m_queue.front());
+                m_queue.pop_front();
+            }
+            m_done.notify_one();
+
+            for (const Event& e : batch)
+            {
+                Write(e);
+            }
+            Output(false);
+        }
+
+        for (auto& f : m_families)
+            WriteSpan("family", f.first.first, f.first.second, f.second, m_last);
+        for (auto& t : m_threads)
+            WriteSpan("thread", t.first.first, THREAD_TRACK + t.first.second, t.second, m_last);
+        m_text += "\n]}\n";
+        Output(true);
+    }
+    catch (...)
+    {
+        lock_guard<mutex> lock(m_lock);
+        m_error = current_exception();
+        m_failed.store(true, memory_order_release);
+        m_done.notify_one();
+    }
+}
+
+void Timeline::Output(bool all)
+{
+    if (all || m_text.size() >= OUTPUT_SIZE)
+    {
+        m_file.write(m_text.data(), m_text.size());
+        m_text.clear();
+        if (all)
+            m_file.flush();
+        if (!m_file)
+        {
+            throw exceptf<IOException>("Unable to write timeline %s", m_filename.c_str());
+        }
+    }
+}
+
+void Timeline::WriteEvent(const char* ph, const string& name, const char* cat, PID pid, unsigned track,
+                          CycleNo cycle, CycleNo dur, const string& args)
+{
+    m_text += m_first ? "" : ",\n";
+    m_first = false;
+    m_text += "{\"name\":\"" + name + "\",\"ph\":\"" + ph + "\"";
+    if (cat != NULL)
+        m_text += string(",\"cat\":\"") + cat + "\"";
+    m_text += ",\"ts\":" + to_string(cycle);
+    if (ph[0] == 'X')
+        m_text += ",\"dur\":" + to_string(dur);
+    else if (ph[0] == 'i')
+        m_text += ",\"s\":\"t\"";
+    m_text += ",\"pid\":" + to_string(pid) + ",\"tid\":" + to_string(track);
+    if (!args.empty())
+        m_text += ",\"args\":" + args;
+    m_text += "}";
+}
+
+void Timeline::WriteSpan(const char* cat, PID pid, unsigned track, const Span& span, CycleNo end)
+{
+    const string args = (track < THREAD_TRACK)
+        ? "{\"place size\":" + to_string(span.arg) + "}"
+        : "{\"index\":" + to_string(span.arg) + "}";
+    WriteEvent("X", "F" + to_string(span.fid), cat, pid, track, span.start, end - span.start, args);
+}
+
+void Timeline::NameTrack(PID pid, unsigned track, const string& name)
+{
+    if (m_named.insert(make_pair(pid, track)).second)
+    {
+        WriteEvent("M", "thread_name", NULL, pid, track, 0, 0, "{\"name\":\"" + name + "\"}");
+        WriteEvent("M", "thread_sort_index", NULL, pid, track, 0, 0, "{\"sort_index\":" + to_string(track) + "}");
+    }
+}
+
+void Timeline::Write(const Event& e)
+{
+    m_last = max(m_last, e.cycle);
+
+    if (e.type >= THREAD_CREATED)
+    {
+        const unsigned track = THREAD_TRACK + e.tid;
+        const auto key = make_pair(e.pid, e.tid);
+        auto t = m_threads.find(key);
+        switch (e.type)
+        {
+        case THREAD_CREATED:
+            if (t != m_threads.end())
+            {
+                // The context was reused without a termination
+                WriteSpan("thread", e.pid, track, t->second, e.cycle);
+            }
+            NameTrack(e.pid, track, "T" + to_string(e.tid));
+            m_threads[key] = Span{e.cycle, e.arg, e.fid};
+            break;
+
+        case THREAD_ACTIVATED:
+            WriteEvent("i", "activate", "thread", e.pid, track, e.cycle, 0, "");
+            break;
+
+        default:
+            if (t != m_threads.end())
+            {
+                WriteSpan("thread", e.pid, track, t->second, e.cycle);
+                m_threads.erase(t);
+            }
+            break;
+        }
+        return;
+    }
+
+    const unsigned track = e.fid;
+    const auto key = make_pair(e.pid, e.fid);
+    auto f = m_families.find(key);
+    switch (e.type)
+    {
+    case FAMILY_ALLOCATED:
+        if (f != m_families.end())
+        {
+            WriteSpan("family", e.pid, track, f->second, e.cycle);
+        }
+        NameTrack(e.pid, track, "F" + to_string(e.fid));
+        m_families[key] = Span{e.cycle, e.arg, e.fid};
+        break;
+
+    case FAMILY_RELEASED:
+        if (f != m_families.end())
+        {
+            WriteSpan("family", e.pid, track, f->second, e.cycle);
+            m_families.erase(f);
+        }
+        break;
+
+    case FAMILY_CREATED:
+        WriteEvent("i", "create", "family", e.pid, track, e.cycle, 0, "{\"threads\":" + to_string(e.arg) + "}");
+        break;
+    case FAMILY_TERMINATED:
+        WriteEvent("i", "terminate", "family", e.pid, track, e.cycle, 0, "");
+        break;
+    case FAMILY_SYNC:
+        WriteEvent("i", "sync", "family", e.pid, track, e.cycle, 0, "{\"from\":" + to_string(e.arg) + "}");
+        break;
+    case FAMILY_SYNCHRONIZED:
+        WriteEvent("i", "synchronized", "family", e.pid, track, e.cycle, 0, "");
+        break;
+    case FAMILY_DETACHED:
+        WriteEvent("i", "detach", "family", e.pid, track, e.cycle, 0, "");
+        break;
+    default:
+        break;
+    }
+}
+
+}
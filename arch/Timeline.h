@@ -0,0 +1,128 @@
+// -*- c++ -*-
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <sim/kernel.h>
+#include <arch/simtypes.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Simulator
+{
+    class DRISC;
+
+    // Records the lifecycle of the families and threads on every core
+    // into a trace that Chrome's about:tracing and the Perfetto UI
+    // show as a timeline, to see how the work spreads over the cores.
+    //
+    // The cores record the events in the commit phase, into a buffer.
+    // Every TimelineFlushInterval master cycles, the simulation hands
+    // the buffer to a host thread, which formats the events as JSON and
+    // writes them to the file; the simulation only pays for storing the
+    // events.
+    //
+    // In the trace, every core is a process with a track per family
+    // context and a track per thread context. A family shows as a span
+    // from its allocation to its release, with instant events for its
+    // creation, termination, synchronization and detachment; a thread
+    // shows as a span from its creation to its termination. The
+    // timestamps are master cycles.
+    class Timeline
+    {
+    public:
+        enum EventType
+        {
+            FAMILY_ALLOCATED,       ///< A family context was allocated; arg is the place size
+            FAMILY_CREATED,         ///< Thread creation started; arg is the number of threads on the core
+            FAMILY_TERMINATED,      ///< All threads on the core have terminated
+            FAMILY_SYNC,            ///< A sync was requested; arg is the core of the requester
+            FAMILY_SYNCHRONIZED,    ///< The family completed on this core and the ones before it
+            FAMILY_DETACHED,        ///< The family was detached
+            FAMILY_RELEASED,        ///< The family context was freed
+            THREAD_CREATED,         ///< A thread was allocated; arg is its logical index
+            THREAD_ACTIVATED,       ///< A thread was queued for execution
+            THREAD_TERMINATED,      ///< A thread finished
+        };
+
+        struct Event
+        {
+            CycleNo   cycle;
+            uint64_t  arg;
+            PID       pid;
+            LFID      fid;
+            TID       tid;
+            EventType type;
+        };
+
+    private:
+        // The state of the spans that are open in the trace
+        struct Span
+        {
+            CycleNo  start;
+            uint64_t arg;
+            LFID     fid;
+        };
+
+        Kernel&                          m_kernel;
+        std::string                      m_filename;
+        std::ofstream                    m_file;
+        std::vector<Event>               m_events;    ///< Events since the last flush
+        size_t                           m_handler;   ///< Interval handler in the kernel
+
+        // The batches of events that wait for the writer
+        std::deque<std::vector<Event> >  m_queue;
+        std::mutex                       m_lock;
+        std::condition_variable          m_ready;     ///< Signals the writer
+        std::condition_variable          m_done;      ///< Signals the simulation
+        bool                             m_stop;
+        std::thread                      m_thread;
+        std::atomic<bool>                m_failed;
+        std::exception_ptr               m_error;     ///< Set by the writer when m_failed is set
+
+        // The writer state, only used by the writer thread
+        std::map<std::pair<PID, LFID>, Span> m_families;
+        std::map<std::pair<PID, TID>,  Span> m_threads;
+        std::set<std::pair<PID, unsigned> >  m_named; ///< Tracks that have a name
+        std::string                      m_text;      ///< Formatted events not yet written
+        bool                             m_first;     ///< No event written yet
+        CycleNo                          m_last;      ///< Latest cycle seen
+
+        void Flush();
+        void Drain();
+        void Write(const Event& e);
+        void WriteEvent(const char* ph, const std::string& name, const char* cat, PID pid, unsigned track,
+                        CycleNo cycle, CycleNo dur, const std::string& args);
+        void WriteSpan(const char* cat, PID pid, unsigned track, const Span& span, CycleNo end);
+        void NameTrack(PID pid, unsigned track, const std::string& name);
+        void Output(bool all);
+
+    public:
+        Timeline(Kernel& kernel, const std::vector<DRISC*>& procs, const std::string& filename, CycleNo interval);
+        Timeline(const Timeline&) = delete;
+        Timeline& operator=(const Timeline&) = delete;
+        ~Timeline();
+
+        // Records an event of core pid. This must only be called in the
+        // commit phase.
+        void Record(PID pid, EventType type, LFID fid, TID tid, uint64_t arg)
+        {
+            m_events.push_back(Event{m_kernel.GetCycleNo(), arg, pid, fid, tid, type});
+        }
+
+        // Writes the events that are left and completes the trace file.
+        // This is done by the destructor, but only Close() reports errors.
+        void Close();
+    };
+}
+
+#endif
@@ -16,9 +16,6 @@ using namespace std;
 namespace Simulator
 {
 
-// We allocate per block, this is the size of each block. Must be a power of two
-#define BLOCK_SIZE (1 << 12)
-
 void VirtualMemory::ReportOverlap(MemAddr address, MemSize size) const
 {
     ostringstream os;
@@ -59,23 +56,12 @@ void VirtualMemory::Reserve(MemAddr address, MemSize size, ProcessID pid, int pe
         range.owner       = pid;
         range.permissions = perm;
         m_ranges.insert(p, make_pair(address, range));
+        m_rangeTable.Insert(address, size, pid, perm);
         m_total_reserved += size;
         ++m_number_of_ranges;
     }
 }
 
-VirtualMemory::RangeMap::const_iterator VirtualMemory::GetReservationRange(MemAddr address, MemSize size) const
-{
-    auto p = m_ranges.lower_bound(address);
-    if (p != m_ranges.begin() && (p == m_ranges.end() || p->first > address))
-    {
-        --p;
-    }
-    return (p != m_ranges.end() &&
-            address >= p->first && p->second.size >= size &&
-            address <= p->first + (p->second.size - size)) ? p : m_ranges.end();
-}
-
 void VirtualMemory::Unreserve(MemAddr address, MemSize size)
 {
     auto p = m_ranges.find(address);
@@ -95,6 +81,7 @@ void VirtualMemory::Unreserve(MemAddr address, MemSize size)
     m_total_reserved -= p->second.size;
     --m_number_of_ranges;
     m_ranges.erase(p);
+    m_rangeTable.Remove(address);
 }
 
 void VirtualMemory::UnreserveAll(ProcessID pid)
@@ -107,6 +94,7 @@ void VirtualMemory::UnreserveAll(ProcessID pid)
         {
             m_total_reserved -= p->second.size;
             --m_number_of_ranges;
+            m_rangeTable.Remove(p->first);
             m_ranges.erase(p++); // careful that iterator is invalidated by erase()
         }
         else
@@ -124,8 +112,8 @@ bool VirtualMemory::CheckPermissions(MemAddr address, MemSize size, int access)
     }
 #endif
 
-    auto p = GetReservationRange(address, size);
-    return (p != m_ranges.end() && (p->second.permissions & access) == access);
+    const RangeTable::Range* range = m_rangeTable.Find(address, size);
+    return range != NULL && (range->permissions & access) == access;
 }
 
 void VirtualMemory::Read(MemAddr address, void* _data, MemSize size) const
@@ -142,25 +130,18 @@ void VirtualMemory::Read(MemAddr address, void* _data, MemSize size) const
     size_t  offset = (size_t)(address - base);      // Offset within base block of address
     char*   data   = static_cast<char*>(_data);     // Byte-aligned pointer to destination
 
-    for (auto pos = m_blocks.lower_bound(base); size > 0;)
+    while (size > 0)
     {
-        if (pos == m_blocks.end())
-        {
-            // Rest of address range does not exist, fill with zero
-            fill(data, data + size, 0);
-            break;
-        }
-
-        // Number of bytes to read, initially
-        size_t count = min( (size_t)size, (size_t)BLOCK_SIZE);
+        // Number of bytes to read from this block
+        size_t count = min( (size_t)size, (size_t)BLOCK_SIZE - offset);
 
-        if (pos->first > base) {
+        const Block* block = m_blocks.Find(base);
+        if (block == NULL) {
             // This part of the request does not exist, fill with zero
-            fill(data, data + count, 0);
+            memset(data, 0, count);
         } else {
             // Read data
-            copy(pos->second.data + offset, pos->second.data + offset + count, data);
-            ++pos;
+            memcpy(data, block->data + offset, count);
         }
         size  -= count;
         data  += count;
@@ -169,7 +150,7 @@ void VirtualMemory::Read(MemAddr address, void* _data, MemSize size) const
     }
 }
 
-void VirtualMemory::Write(MemAddr address, const void* _data, const bool* mask, MemSize size)
+void VirtualMemory::Write(MemAddr address, const void* _data, const LineMask* mask, MemSize size)
 {
 #if MEMSIZE_MAX >= SIZE_MAX
     if (size > SIZE_MAX)
@@ -182,16 +163,17 @@ void VirtualMemory::Write(MemAddr address, const void* _data, const bool* mask,
     MemAddr     base   = address & -BLOCK_SIZE;                     // Base address of block containing address
     size_t      offset = (size_t)(address - base);          // Offset within base block of address
     const char* data   = static_cast<const char*>(_data);   // Byte-aligned pointer to destination
+    uint64_t    bits   = (mask != 0) ? mask->bits() : 0;    // Remaining mask bits, if masked
+
+    assert(mask == 0 || size <= MAX_MEMORY_OPERATION_SIZE);
 
     while (size > 0)
     {
-        // Find or insert the block
-        auto ins = m_blocks.insert(make_pair(base, Block()));
-
-        auto& pos = ins.first;
-        if (ins.second) {
-            // A new element was inserted, allocate and clear memory
-            memset(pos->second.data, 0, BLOCK_SIZE);
+        // Find or allocate the block
+        bool   created;
+        Block* block = m_blocks.Allocate(base, created);
+        if (created) {
+            // A new block was allocated, it is already cleared
             m_total_allocated += BLOCK_SIZE;
         }
 
@@ -199,14 +181,14 @@ void VirtualMemory::Write(MemAddr address, const void* _data, const bool* mask,
         size_t count = min( (size_t)size, (size_t)BLOCK_SIZE - offset);
 
         // Write data
-        for (size_t i = 0; i < count; ++i)
-            if (mask == 0 || mask[i])
-                pos->second.data[offset + i] = data[i];
+        if (mask == 0)
+            memcpy(block->data + offset, data, count);
+        else
+            line::blit(block->data + offset, data, LineMask::Bits(bits), count);
 
         size  -= count;
         data  += count;
-        if (mask != 0)
-            mask  += count;
+        bits   = (count < 64) ? bits >> count : 0;
         base  += BLOCK_SIZE;
         offset = 0;
     }
@@ -230,10 +212,11 @@ VirtualMemory::VirtualMemory(const std::string& name, Object& parent)
       InitSampleVariable(total_reserved, SVC_LEVEL),
       InitSampleVariable(total_allocated, SVC_LEVEL),
       InitSampleVariable(number_of_ranges, SVC_LEVEL),
-      m_symtable(0)
+      m_symtable(0),
+      m_rangeTable()
 {
     RegisterStateObject(m_blocks, "blocks");
-    RegisterStateObject(m_ranges, "ranges");
+    RegisterStateObject(*this, "ranges");
 }
 
 VirtualMemory::~VirtualMemory()
@@ -302,7 +285,7 @@ void VirtualMemory::Cmd_Info(ostream& out, const vector<string>& /* arguments */
     out << endl << setfill(' ') << dec;
     out << "Total reserved memory:  " << setw(4) << total << " " << Mods[mod] << endl;
 
-    total = m_blocks.size() * BLOCK_SIZE;
+    total = m_blocks.GetNumPages() * BLOCK_SIZE;
     assert(m_total_allocated == total);
     // Print total memory usage
     for (mod = 0; total >= 1024 && mod < 4; ++mod)
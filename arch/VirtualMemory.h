@@ -8,6 +8,8 @@
 #include <sim/kernel.h>
 #include <sim/sampling.h>
 #include <arch/Memory.h>
+#include <arch/PageTable.h>
+#include <arch/RangeTable.h>
 
 #include <map>
 #include <vector>
@@ -22,13 +24,9 @@ class VirtualMemory : public Object,
 {
 public:
     // We allocate per block, this is the size of each block. Must be a power of two
-    static const int BLOCK_SIZE = (1 << 12);
+    static const int BLOCK_SIZE = PageTable::PAGE_SIZE;
 
-    struct Block
-    {
-        char data[BLOCK_SIZE];
-        SERIALIZE(a) { a & Serialization::binary(data, BLOCK_SIZE); }
-    };
+    typedef PageTable::Page Block;
 
     struct Range
     {
@@ -38,7 +36,7 @@ public:
         SERIALIZE(a) { a & size & owner & permissions; }
     };
 
-    typedef std::map<MemAddr, Block> BlockMap;
+    typedef PageTable                BlockMap;
     typedef std::map<MemAddr, Range> RangeMap;
 
     void Reserve(MemAddr address, MemSize size, ProcessID pid, int perm) override;
@@ -49,7 +47,7 @@ public:
 
     // Mask indicates which bytes of the data to actually write. If mask is set
     // to NULL, then write all bytes.
-    void Write(MemAddr address, const void* data, const bool* mask, MemSize size) override;
+    void Write(MemAddr address, const void* data, const LineMask* mask, MemSize size) override;
 
     bool CheckPermissions(MemAddr address, MemSize size, int access) const override;
 
@@ -58,12 +56,24 @@ public:
     VirtualMemory& operator=(const VirtualMemory&) = delete;
     virtual ~VirtualMemory();
 
+    // Serializes the reservation ranges; registered as the "ranges"
+    // state variable.
+    SERIALIZE(a)
+    {
+        a & m_ranges;
+        if (!a.reading())
+        {
+            m_rangeTable.Clear();
+            for (auto& p : m_ranges)
+                m_rangeTable.Insert(p.first, p.second.size, p.second.owner, p.second.permissions);
+        }
+    }
+
     void Cmd_Info(std::ostream& out, const std::vector<std::string>& arguments) const override;
     void SetSymbolTable(SymbolTable& symtable) override;
     SymbolTable& GetSymbolTable() const override;
 
 private:
-    RangeMap::const_iterator GetReservationRange(MemAddr address, MemSize size) const;
     void ReportOverlap(MemAddr address, MemSize size) const;
 
     DefineStateVariable(BlockMap, blocks);
@@ -73,6 +83,10 @@ private:
     DefineSampleVariable(size_t, total_allocated);
     DefineSampleVariable(size_t, number_of_ranges);
     SymbolTable *m_symtable;
+
+    // Index from page number to the reservation ranges, for
+    // CheckPermissions. It is updated along with m_ranges.
+    RangeTable m_rangeTable;
 };
 
 }
@@ -245,6 +245,7 @@ bool Allocator::KillThread(TID tid)
     }
 
     DebugSimWrite("F%u/T%u(%llu) terminated", (unsigned)thread.family, (unsigned)tid, (unsigned long long)thread.index);
+    GetDRISC().RecordEvent(Timeline::THREAD_TERMINATED, thread.family, tid);
 
     COMMIT
     {
@@ -485,6 +486,7 @@ bool Allocator::AllocateThread(LFID fid, TID tid, bool isNewlyAllocated)
 
     DebugSimWrite("F%u/T%u(%llu) created",
                   (unsigned)fid, (unsigned)tid, (unsigned long long)logical_index);
+    GetDRISC().RecordEvent(Timeline::THREAD_CREATED, fid, tid, logical_index);
     return true;
 }
 
@@ -524,6 +526,7 @@ bool Allocator::DecreaseFamilyDependency(LFID fid, Family& family, FamilyDepende
         {
             COMMIT{ family.state = FST_TERMINATED; }
             DebugSimWrite("F%u terminated", (unsigned)fid);
+            GetDRISC().RecordEvent(Timeline::FAMILY_TERMINATED, fid);
         }
         // Fall through
 
@@ -567,6 +570,7 @@ bool Allocator::DecreaseFamilyDependency(LFID fid, Family& family, FamilyDepende
             }
 
             DebugSimWrite("F%u synchronized", (unsigned)fid);
+            GetDRISC().RecordEvent(Timeline::FAMILY_SYNCHRONIZED, fid);
         }
         // Fall through
 
@@ -590,6 +594,7 @@ bool Allocator::DecreaseFamilyDependency(LFID fid, Family& family, FamilyDepende
             m_familyTable.FreeFamily(fid, context);
 
             DebugSimWrite("F%u cleaned up", (unsigned)fid);
+            GetDRISC().RecordEvent(Timeline::FAMILY_RELEASED, fid);
         }
         break;
     }
@@ -1082,6 +1087,7 @@ void Allocator::ReleaseContext(LFID fid)
     m_familyTable.FreeFamily(fid, CONTEXT_NORMAL);
     m_raunit.UnreserveContext();
     m_threadTable.UnreserveThread();
+    GetDRISC().RecordEvent(Timeline::FAMILY_RELEASED, fid);
 }
 
 LFID Allocator::AllocateContext(ContextType type, LFID prev_fid, PSize placeSize)
@@ -1115,6 +1121,7 @@ LFID Allocator::AllocateContext(ContextType type, LFID prev_fid, PSize placeSize
         // First core? Already synched.
         family.dependencies.prevSynchronized = (prev_fid == INVALID_LFID);
     }
+    GetDRISC().RecordEvent(Timeline::FAMILY_ALLOCATED, lfid, INVALID_TID, placeSize);
 
     return lfid;
 }
@@ -1393,6 +1400,7 @@ bool Allocator::QueueCreate(const LinkMessage& msg)
         DeadlockWrite("F%u unable to activate", (unsigned)msg.create.fid);
         return false;
     }
+    GetDRISC().RecordEvent(Timeline::FAMILY_CREATED, msg.create.fid, INVALID_TID, family.nThreads);
 
     if (family.link != INVALID_LFID)
     {
@@ -1835,6 +1843,7 @@ Result Allocator::DoFamilyCreate()
                 return FAILED;
             }
             DebugSimWrite("F%u activated", (unsigned)info.fid);
+            GetDRISC().RecordEvent(Timeline::FAMILY_CREATED, info.fid, INVALID_TID, family.nThreads);
         }
 
         COMMIT{ m_createState = CREATE_NOTIFY; }
@@ -1878,15 +1887,15 @@ Result Allocator::DoFamilyCreate()
 Result Allocator::DoThreadActivation()
 {
     TID tid;
-    if ((m_prevReadyList == &m_readyThreadsOther || m_readyThreadsOther.Empty()) && !m_readyThreadsPipe.Empty()) {
+    if ((m_prevReadyOther || m_readyThreadsOther.Empty()) && !m_readyThreadsPipe.Empty()) {
         tid = m_readyThreadsPipe.Front();
         m_readyThreadsPipe.Pop();
-        COMMIT{ m_prevReadyList = &m_readyThreadsPipe; }
+        COMMIT{ m_prevReadyOther = false; }
     } else {
         assert(!m_readyThreadsOther.Empty());
         tid = m_readyThreadsOther.Front();
         m_readyThreadsOther.Pop();
-        COMMIT{ m_prevReadyList = &m_readyThreadsOther; }
+        COMMIT{ m_prevReadyOther = true; }
     }
     COMMIT{ --m_numThreadsPerState[TST_READY]; }
 
@@ -1927,6 +1936,7 @@ Result Allocator::DoThreadActivation()
                 DeadlockWrite("Unable to enqueue T%u to the Active Queue", (unsigned)tid);
                 return FAILED;
             }
+            GetDRISC().RecordEvent(Timeline::THREAD_ACTIVATED, thread.family, tid);
         }
         return SUCCESS;
     }
@@ -2005,7 +2015,7 @@ Allocator::Allocator(const string& name, DRISC& parent, Clock& clock)
     InitStateVariable(createLine, 0),
     InitStorage(m_readyThreadsPipe, clock, m_threadTable),
     InitStorage(m_readyThreadsOther, clock, m_threadTable),
-    m_prevReadyList (NULL),
+    InitStateVariable(prevReadyOther, false),
 
     InitBuffer(m_allocRequestsSuspend, clock, "FamilyAllocationSuspendQueueSize"),
     InitBuffer(m_allocRequestsNoSuspend, clock, "FamilyAllocationNoSuspendQueueSize"),
@@ -2097,6 +2107,7 @@ void Allocator::AllocateInitialFamily(MemAddr pc, bool legacy, PSize placeSize,
     }
 
     m_threadTable.ReserveThread();
+    GetDRISC().RecordEvent(Timeline::FAMILY_ALLOCATED, fid, INVALID_TID, placeSize);
 
     m_alloc.Push(fid);
 }
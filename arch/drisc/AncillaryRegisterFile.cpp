@@ -96,6 +96,8 @@ namespace drisc
         {
             WriteRegister(ASR_SYSTEM_VERSION, ASR_SYSTEM_VERSION_VALUE);
         }
+
+        RegisterStateVariable(m_registers, "registers");
     }
 
 }
@@ -19,13 +19,14 @@ namespace drisc
 DCache::DCache(const std::string& name, DRISC& parent, Clock& clock)
 :   Object(name, parent),
     m_memory(NULL),
+    m_memadmin(NULL),
     m_mcid(0),
     m_lines(),
     m_data(),
-    m_valid(0),
 
     m_assoc          (GetConf("Associativity", size_t)),
     m_sets           (GetConf("NumSets", size_t)),
+    m_tags           (m_sets, m_assoc),
     m_lineSize       (GetTopConf("CacheLineSize", size_t)),
     m_selector       (IBankSelector::makeSelector(*this, GetConf("BankSelector", string), m_sets)),
     InitBuffer(m_read_responses, clock, "ReadResponsesBufferSize"),
@@ -33,6 +34,8 @@ DCache::DCache(const std::string& name, DRISC& parent, Clock& clock)
     InitBuffer(m_writebacks, clock, "ReadWritebacksBufferSize"),
     InitBuffer(m_outgoing, clock, "OutgoingBufferSize"),
     m_wbstate(),
+    m_directMemory(false),
+    m_draining(false),
     InitSampleVariable(numRHits, SVC_CUMULATIVE),
     InitSampleVariable(numDelayedReads, SVC_CUMULATIVE),
     InitSampleVariable(numEmptyRMisses, SVC_CUMULATIVE),
@@ -47,6 +50,8 @@ DCache::DCache(const std::string& name, DRISC& parent, Clock& clock)
     InitSampleVariable(numStallingRMisses, SVC_CUMULATIVE),
     InitSampleVariable(numStallingWMisses, SVC_CUMULATIVE),
     InitSampleVariable(numSnoops, SVC_CUMULATIVE),
+    InitSampleVariable(numFastReads, SVC_CUMULATIVE),
+    InitSampleVariable(numFastWrites, SVC_CUMULATIVE),
 
     InitProcess(p_ReadWritebacks, DoReadWritebacks),
     InitProcess(p_ReadResponses, DoReadResponses),
@@ -85,9 +90,7 @@ DCache::DCache(const std::string& name, DRISC& parent, Clock& clock)
 
     m_lines.resize(m_sets * m_assoc);
     m_data.resize(m_lines.size() * m_lineSize);
-    m_valid = new bool[m_lines.size() * m_lineSize];
 
-    RegisterStateArray(m_valid, m_lines.size() * m_lineSize, "valid");
     RegisterStateVariable(m_data, "data");
 
     for (size_t i = 0; i < m_lines.size(); ++i)
@@ -95,31 +98,52 @@ DCache::DCache(const std::string& name, DRISC& parent, Clock& clock)
         auto &line = m_lines[i];
         line.state  = LINE_EMPTY;
         line.data   = &m_data[i * m_lineSize];
-        line.valid  = &m_valid[i * m_lineSize];
         line.create = false;
         RegisterStateObject(line, "line" + to_string(i));
     }
+    RegisterStateObject(m_tags, "tags");
 
     m_wbstate.size   = 0;
     m_wbstate.offset = 0;
     RegisterStateObject(m_wbstate, "wbstate");
 }
 
-void DCache::ConnectMemory(IMemory* memory)
+void DCache::ConnectMemory(IMemory* memory, IMemoryAdmin* admin)
 {
     assert(memory != NULL);
     assert(m_memory == NULL); // can't register two times
 
     m_memory = memory;
+    m_memadmin = admin;
     StorageTraceSet traces;
     m_mcid = m_memory->RegisterClient(*this, p_Outgoing, traces, m_read_responses ^ m_write_responses, true);
     p_Outgoing.SetStorageTraces(traces);
 
 }
 
+void DCache::SetDirectMemory(bool enable)
+{
+    if (m_directMemory && !enable)
+    {
+        // The stores in direct-memory mode, of this core and of the others,
+        // have bypassed the lines. The lines stay warm, but their data is
+        // reloaded from memory. Lines that are still loading deliver their
+        // data to the waiting registers and are cleared afterwards.
+        for (auto& line : m_lines)
+        {
+            if (line.state == LINE_FULL) {
+                const MemAddr address = m_selector->Unmap(line.tag, (&line - &m_lines[0]) / m_assoc) * m_lineSize;
+                m_memadmin->Read(address, line.data, m_lineSize);
+            } else if (line.state == LINE_LOADING) {
+                line.state = LINE_INVALID;
+            }
+        }
+    }
+    m_directMemory = enable;
+}
+
 DCache::~DCache()
 {
-    delete[] m_valid;
     delete m_selector;
 }
 
@@ -131,6 +155,16 @@ Result DCache::FindLine(MemAddr address, Line* &line, bool check_only)
     const size_t  set  = setindex * m_assoc;
 
     // Find the line
+    const size_t way = m_tags.Find(setindex, tag, [this](size_t i) { return m_lines[i].state != LINE_EMPTY; });
+    if (way < m_assoc)
+    {
+        // The wanted line was in the cache
+        line = &m_lines[set + way];
+        assert(line->tag == tag);
+        return SUCCESS;
+    }
+
+    // Look for an empty line or the least recently used one
     Line* empty   = NULL;
     Line* replace = NULL;
     for (size_t i = 0; i < m_assoc; ++i)
@@ -143,11 +177,6 @@ Result DCache::FindLine(MemAddr address, Line* &line, bool check_only)
             // Empty, unused line, remember this one
             empty = line;
         }
-        else if (line->tag == tag)
-        {
-            // The wanted line was in the cache
-            return SUCCESS;
-        }
         else if (line->state == LINE_FULL && (replace == NULL || line->access < replace->access))
         {
             // The line is available to be replaced and has a lower LRU rating,
@@ -175,8 +204,9 @@ Result DCache::FindLine(MemAddr address, Line* &line, bool check_only)
         {
             line->processing = false;
             line->tag        = tag;
+            m_tags[line - &m_lines[0]] = tag;
             line->waiting    = INVALID_REG;
-            std::fill(line->valid, line->valid + m_lineSize, false);
+            line->valid.reset();
         }
     }
 
@@ -210,6 +240,13 @@ Result DCache::Read(MemAddr address, void* data, MemSize size, RegAddr* reg)
                                          (unsigned long long)address, (size_t)size);
     }
 
+    if (m_draining)
+    {
+        DeadlockWrite("Unable to read while the memory system drains (%#016llx, %zd)",
+                      (unsigned long long)address, (size_t)size);
+        return FAILED;
+    }
+
     if (!p_service.Invoke())
     {
         DeadlockWrite("Unable to acquire port for D-Cache read access (%#016llx, %zd)",
@@ -218,6 +255,31 @@ Result DCache::Read(MemAddr address, void* data, MemSize size, RegAddr* reg)
         return FAILED;
     }
 
+    if (m_directMemory)
+    {
+        // Read the memory contents directly, and warm up the cache:
+        // the line is allocated and filled at once, as if the load had
+        // missed and completed in the same cycle.
+        Line* line;
+        const Result result = FindLine(address - offset, line, false);
+        COMMIT
+        {
+            m_memadmin->Read(address, data, size);
+            if (result == DELAYED)
+            {
+                m_memadmin->Read(address - offset, line->data, m_lineSize);
+                line->valid = LineMask::Range(0, m_lineSize);
+                line->state = LINE_FULL;
+            }
+            if (result != FAILED && line->state == LINE_FULL)
+            {
+                line->access = cpu.GetCycleNo();
+            }
+            ++m_numFastReads;
+        }
+        return SUCCESS;
+    }
+
     Line*  line;
     Result result;
     // SUCCESS - A line with the address was found
@@ -343,6 +405,13 @@ Result DCache::Write(MemAddr address, void* data, MemSize size, LFID fid, TID ti
                                          (unsigned long long)address, (size_t)size);
     }
 
+    if (m_draining)
+    {
+        DeadlockWrite("Unable to write while the memory system drains (%#016llx, %zd)",
+                      (unsigned long long)address, (size_t)size);
+        return FAILED;
+    }
+
     if (!p_service.Invoke())
     {
         DeadlockWrite("Unable to acquire port for D-Cache write access (%#016llx, %zd)",
@@ -350,6 +419,18 @@ Result DCache::Write(MemAddr address, void* data, MemSize size, LFID fid, TID ti
         return FAILED;
     }
 
+    if (m_directMemory)
+    {
+        // Write the memory contents directly; there is no completion
+        // to wait for.
+        COMMIT
+        {
+            m_memadmin->Write(address, data, NULL, size);
+            ++m_numFastWrites;
+        }
+        return SUCCESS;
+    }
+
     Line* line = NULL;
     Result result = FindLine(address, line, true);
     if (result == SUCCESS)
@@ -379,7 +460,7 @@ Result DCache::Write(MemAddr address, void* data, MemSize size, LFID fid, TID ti
             assert(line->state == LINE_FULL);
             COMMIT{
                 std::copy((char*)data, (char*)data + size, line->data + offset);
-                std::fill(line->valid + offset, line->valid + offset + size, true);
+                line->valid |= LineMask::Range(offset, size);
 
                 // Statistics
                 ++m_numWHits;
@@ -399,9 +480,7 @@ Result DCache::Write(MemAddr address, void* data, MemSize size, LFID fid, TID ti
 
     COMMIT{
     std::copy((char*)data, ((char*)data)+size, request.data.data+offset);
-    std::fill(request.data.mask, request.data.mask+offset, false);
-    std::fill(request.data.mask+offset, request.data.mask+offset+size, true);
-    std::fill(request.data.mask+offset+size, request.data.mask+m_lineSize, false);
+    request.data.mask = LineMask::Range(offset, size);
     }
 
     if (!m_outgoing.Push(std::move(request)))
@@ -452,7 +531,7 @@ bool DCache::OnMemoryReadCompleted(MemAddr addr, const char* data)
             // Copy the data into the cache line.
             // Mask by valid bytes (don't overwrite already written data).
             line::blitnot(line->data, mdata, line->valid, m_lineSize);
-            line::setifnot(line->valid, true, line->valid, m_lineSize);
+            line->valid = LineMask::Range(0, m_lineSize);
 
             line->processing = true;
         }
@@ -490,7 +569,7 @@ bool DCache::OnMemoryWriteCompleted(WClientID wid)
     return true;
 }
 
-bool DCache::OnMemorySnooped(MemAddr address, const char* data, const bool* mask)
+bool DCache::OnMemorySnooped(MemAddr address, const char* data, const LineMask& mask)
 {
     Line*  line;
 
@@ -520,7 +599,7 @@ bool DCache::OnMemorySnooped(MemAddr address, const char* data, const bool* mask
             // because we don't have to guarantee sequential semantics from other cores.
             // This falls within the non-determinism behavior of the architecture.
             line::blit(line->data, data, mask, m_lineSize);
-            line::setif(line->valid, true, mask, m_lineSize);
+            line->valid |= mask;
 
             // Statistics
             ++m_numSnoops;
@@ -801,7 +880,9 @@ void DCache::Cmd_Info(std::ostream& out, const std::vector<std::string>& /*argum
     out <<
     "The Data Cache stores data from memory that has been used in loads and stores\n"
     "for faster access. Compared to a traditional cache, this D-Cache is extended\n"
-    "with several fields to support the multiple threads and asynchronous operation.\n\n"
+    "with several fields to support the multiple threads and asynchronous operation.\n"
+    "In direct-memory mode, loads and stores access memory directly; loads still\n"
+    "allocate lines, to keep the cache warm.\n\n"
     "Supported operations:\n"
     "- inspect <component>\n"
     "  Display global information such as hit-rate and configuration.\n"
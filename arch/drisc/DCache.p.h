@@ -6,6 +6,7 @@
 #include <sim/inspect.h>
 #include <sim/buffer.h>
 #include <arch/Memory.h>
+#include <arch/TagArray.h>
 #include <arch/drisc/forward.h>
 
 namespace Simulator
@@ -33,7 +34,7 @@ public:
      (state
       (MemAddr     tag)               ///< The address tag.
       (char*       data noserialize)  ///< The data in this line.
-      (bool*       valid noserialize) ///< A bitmap of valid bytes in this line.
+      (LineMask    valid)             ///< A bitmap of valid bytes in this line.
       (CycleNo     access)            ///< Last access time of this line (for LRU).
       (RegAddr     waiting)           ///< First register waiting on this line.
       (LineState   state)             ///< The line state.
@@ -84,12 +85,13 @@ private:
     Result FindLine(MemAddr address, Line* &line, bool check_only);
 
     IMemory*             m_memory;          ///< Memory
+    IMemoryAdmin*        m_memadmin;        ///< Memory contents, for direct-memory mode
     MCID                 m_mcid;            ///< Memory Client ID
     std::vector<Line>    m_lines;           ///< The cache-lines.
     std::vector<char>    m_data;            ///< The data in the cache lines.
-    bool*                m_valid;           ///< The valid bits.
     size_t               m_assoc;           ///< Config: Cache associativity.
     size_t               m_sets;            ///< Config: Number of sets in the cace.
+    TagArray             m_tags;            ///< The tags of the cache-lines.
     size_t               m_lineSize;        ///< Config: Size of a cache line, in bytes.
     IBankSelector*       m_selector;        ///< Mapping of cache line addresses to tags and set indices.
     Buffer<ReadResponse>  m_read_responses; ///< Incoming buffer for read responses from memory bus.
@@ -97,6 +99,8 @@ private:
     Buffer<WritebackRequest> m_writebacks; ///< Incoming buffer for register writebacks after load.
     Buffer<Request>      m_outgoing;        ///< Outgoing buffer to memory bus.
     WritebackState       m_wbstate;         ///< Writeback state
+    bool                 m_directMemory;     ///< Access the memory contents directly?
+    bool                 m_draining;        ///< Stall the loads and stores until direct-memory mode starts?
 
 
     // Statistics
@@ -119,6 +123,9 @@ private:
 
     DefineSampleVariable(uint64_t, numSnoops);
 
+    DefineSampleVariable(uint64_t, numFastReads);
+    DefineSampleVariable(uint64_t, numFastWrites);
+
 
     Result DoReadWritebacks();
     Result DoReadResponses();
@@ -132,7 +139,22 @@ public:
     DCache(const DCache&) = delete;
     DCache& operator=(const DCache&) = delete;
     ~DCache();
-    void ConnectMemory(IMemory* memory);
+    void ConnectMemory(IMemory* memory, IMemoryAdmin* admin);
+
+    /**
+     * @brief Enable or disable direct-memory mode.
+     * In this mode, loads and stores complete immediately on the memory
+     * contents, bypassing the memory system. When the mode ends the
+     * data of the lines is reloaded, since it may be stale.
+     */
+    void SetDirectMemory(bool enable);
+    bool IsDirectMemory() const { return m_directMemory; }
+
+    /**
+     * @brief Stall the loads and stores, so that no new requests are sent
+     * to memory while the requests in flight complete.
+     */
+    void SetDraining(bool enable) { m_draining = enable; }
 
     // Processes
     Process p_ReadWritebacks;
@@ -151,7 +173,7 @@ public:
     // Memory callbacks
     bool OnMemoryReadCompleted(MemAddr addr, const char* data) override;
     bool OnMemoryWriteCompleted(TID tid) override;
-    bool OnMemorySnooped(MemAddr addr, const char* data, const bool* mask) override;
+    bool OnMemorySnooped(MemAddr addr, const char* data, const LineMask& mask) override;
     bool OnMemoryInvalidated(MemAddr addr) override;
 
     Object& GetMemoryPeer() override;
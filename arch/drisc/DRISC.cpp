@@ -26,6 +26,7 @@ DRISC::DRISC(const std::string& name, Object& parent, Clock& clock, PID pid, con
     m_grid(grid),
     m_fpu(NULL),
     m_symtable(NULL),
+    m_timeline(NULL),
     m_pid(pid),
     m_reginits(),
     m_bits(),
@@ -128,8 +129,8 @@ void DRISC::ConnectMemory(IMemory* memory, IMemoryAdmin* admin)
     m_memory = memory;
     m_memadmin = admin;
     m_symtable = &admin->GetSymbolTable(),
-    m_icache.ConnectMemory(memory);
-    m_dcache.ConnectMemory(memory);
+    m_icache.ConnectMemory(memory, admin);
+    m_dcache.ConnectMemory(memory, admin);
     if (m_io_if != NULL)
         m_io_if->ConnectMemory(memory);
 }
@@ -321,13 +322,13 @@ void DRISC::Initialize()
         m_network.m_allocResponse.out ^ m_allocator.m_creates ^ m_network.m_link.out ^ DELEGATE * opt(DELEGATE) );
 
     m_allocator.p_FamilyCreate.SetStorageTraces(
-        /* CREATE_INITIAL */                opt(m_icache.m_outgoing) ^
+        /* CREATE_INITIAL */                opt(m_icache.m_outgoing ^ m_icache.m_incoming) ^
         /* CREATE_BROADCASTING_CREATE */    opt(m_network.m_link.out) ^
         /* CREATE_ACTIVATING_FAMILY */      m_allocator.m_alloc ^
         /* CREATE_NOTIFY */                 opt(DELEGATE) );
 
     m_allocator.p_ThreadActivation.SetStorageTraces(
-        ( m_allocator.m_readyThreadsPipe ^ m_allocator.m_readyThreadsOther ) * opt(m_allocator.m_activeThreads ^ m_icache.m_outgoing) );
+        ( m_allocator.m_readyThreadsPipe ^ m_allocator.m_readyThreadsOther ) * opt(m_allocator.m_activeThreads ^ m_icache.m_outgoing ^ m_icache.m_incoming) );
 
     m_allocator.p_BundleCreate.SetStorageTraces( m_dcache.m_outgoing ^ DELEGATE );
 
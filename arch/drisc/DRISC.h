@@ -8,6 +8,7 @@
 #include <arch/Memory.h>
 #include <arch/BankSelector.h>
 #include <arch/FPU.h>
+#include <arch/Timeline.h>
 #include <arch/drisc/RAUnit.h>
 #include <arch/drisc/IOMatchUnit.h>
 #include <arch/drisc/DebugChannel.h>
@@ -63,6 +64,19 @@ public:
     PSize GetGridSize() const { return m_grid.size(); }
     bool  IsIdle()      const;
 
+    // Direct-memory mode: the core executes without cache and memory timing
+    void SetDirectMemory(bool enable) { m_icache.SetDirectMemory(enable); m_dcache.SetDirectMemory(enable); }
+    bool IsDirectMemory() const { return m_dcache.IsDirectMemory(); }
+    void SetDraining(bool enable) { m_icache.SetDraining(enable); m_dcache.SetDraining(enable); }
+
+    // Lifecycle timeline of the families and threads, optional
+    void SetTimeline(Timeline* timeline) { m_timeline = timeline; }
+    void RecordEvent(Timeline::EventType type, LFID fid, TID tid = INVALID_TID, uint64_t arg = 0)
+    {
+        if (m_timeline != NULL && IsCommitting())
+            m_timeline->Record(m_pid, type, fid, tid, arg);
+    }
+
     float GetRegFileAsyncPortActivity() const {
         return (float)m_registerFile.p_asyncW.GetBusyCycles() / (float)GetCycleNo();
     }
@@ -127,6 +141,7 @@ private:
     const std::vector<DRISC*>&     m_grid;
     FPU*                           m_fpu;
     SymbolTable*                   m_symtable;
+    Timeline*                      m_timeline;
     PID                            m_pid;
     // Register initializers
     std::map<RegAddr, std::string> m_reginits;
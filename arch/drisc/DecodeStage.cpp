@@ -1,4 +1,6 @@
 #include "Pipeline.h"
+#include <sim/log2.h>
+#include <sim/sampling.h>
 #include <cassert>
 #include <sstream>
 #include <iomanip>
@@ -122,7 +124,11 @@ Pipeline::PipeAction Pipeline::DecodeStage::OnCycle()
             m_output.RsSize = sizeof(Integer);
 #endif
 
-            DecodeInstruction(m_input.instr);
+            if (!LoadDecoded())
+            {
+                DecodeInstruction(m_input.instr);
+                COMMIT{ StoreDecoded(); }
+            }
 
             DebugPipeWrite("F%u/T%u(%llu) %s decoded %s %s %s"
 #if defined(TARGET_MTSPARC)
@@ -130,7 +136,7 @@ Pipeline::PipeAction Pipeline::DecodeStage::OnCycle()
 #endif
                            " lit %lu"
                            ,
-                           (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                           (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                            m_output.Ra.str().c_str(),
                            m_output.Rb.str().c_str(),
                            m_output.Rc.str().c_str(),
@@ -165,7 +171,7 @@ Pipeline::PipeAction Pipeline::DecodeStage::OnCycle()
                    " %s"
 #endif
                    ,
-                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                    m_output.Ra.str().c_str(),
                    m_output.Rb.str().c_str(),
                    m_output.Rc.str().c_str()
@@ -176,11 +182,87 @@ Pipeline::PipeAction Pipeline::DecodeStage::OnCycle()
     return PIPE_CONTINUE;
 }
 
-Pipeline::DecodeStage::DecodeStage(Pipeline& parent, const FetchDecodeLatch& input, DecodeReadLatch& output)
+bool Pipeline::DecodeStage::LoadDecoded()
+{
+    if (m_decoded.empty())
+    {
+        return false;
+    }
+
+    const DecodedInstruction& d = m_decoded[GetDecodedIndex(m_input.pc)];
+    if (!d.valid || d.pc != m_input.pc || d.instr != m_input.instr)
+    {
+        COMMIT{ ++m_nDecodeMisses; }
+        return false;
+    }
+
+    (ArchDecodeReadLatch&)m_output = d.arch;
+    m_output.literal      = d.literal;
+    m_output.Ra           = d.Ra;
+    m_output.Rb           = d.Rb;
+    m_output.Rc           = d.Rc;
+    m_output.RaSize       = d.RaSize;
+    m_output.RbSize       = d.RbSize;
+    m_output.RcSize       = d.RcSize;
+    m_output.RaNotPending = d.RaNotPending;
+    m_output.regofs       = d.regofs;
+    COMMIT{ ++m_nDecodeHits; }
+    return true;
+}
+
+void Pipeline::DecodeStage::StoreDecoded()
+{
+    if (m_decoded.empty())
+    {
+        return;
+    }
+
+    DecodedInstruction& d = m_decoded[GetDecodedIndex(m_input.pc)];
+    d.valid        = true;
+    d.pc           = m_input.pc;
+    d.instr        = m_input.instr;
+    d.arch         = m_output;
+    d.literal      = m_output.literal;
+    d.Ra           = m_output.Ra;
+    d.Rb           = m_output.Rb;
+    d.Rc           = m_output.Rc;
+    d.RaSize       = m_output.RaSize;
+    d.RbSize       = m_output.RbSize;
+    d.RcSize       = m_output.RcSize;
+    d.RaNotPending = m_output.RaNotPending;
+    d.regofs       = m_output.regofs;
+}
+
+void Pipeline::DecodeStage::InvalidateDecoded(MemAddr address, MemSize size)
+{
+    if (m_decoded.empty())
+    {
+        return;
+    }
+
+    for (MemAddr pc = address - address % sizeof(Instruction); pc < address + size; pc += sizeof(Instruction))
+    {
+        DecodedInstruction& d = m_decoded[GetDecodedIndex(pc)];
+        if (d.pc == pc)
+        {
+            d.valid = false;
+        }
+    }
+}
+
+Pipeline::DecodeStage::DecodeStage(Pipeline& parent, const FetchDecodeLatch& input, DecodeReadLatch& output,
+                                   size_t decodeCacheSize)
   : Stage("decode", parent),
     m_input(input),
-    m_output(output)
+    m_output(output),
+    m_decoded(decodeCacheSize),
+    InitSampleVariable(nDecodeHits, SVC_CUMULATIVE),
+    InitSampleVariable(nDecodeMisses, SVC_CUMULATIVE)
 {
+    if (decodeCacheSize != 0 && !IsPowerOfTwo(decodeCacheSize))
+    {
+        throw exceptf<InvalidArgumentException>(*this, "DecodeCacheSize = %zd is not a power of two", decodeCacheSize);
+    }
 }
 
 }
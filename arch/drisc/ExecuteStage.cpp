@@ -84,7 +84,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::OnCycle()
         }
 
         DebugPipeWrite("F%u/T%u(%llu) %s suspend on non-full operand %s",
-                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                        m_input.Rc.str().c_str());
 
         return PIPE_FLUSH;
@@ -122,13 +122,13 @@ Pipeline::PipeAction Pipeline::ExecuteStage::OnCycle()
         }
 
         DebugPipeWrite("F%u/T%u(%llu) %s executed Rc %s Rcv %s",
-                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                        m_output.Rc.str().c_str(), m_output.Rcv.str(m_output.Rc.type).c_str());
     }
     else
     {
         DebugPipeWrite("F%u/T%u(%llu) %s stalled",
-                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym);
+                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str());
     }
 
     return action;
@@ -164,7 +164,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecAllocate(PlaceID place, RegInde
         place.capability = 0x1337; // also later: copy the place capability from the parent.
 
         DebugSimWrite("F%u/T%u(%llu) %s adjusted default place -> CPU%u/%u cap 0x%lx",
-                      (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                      (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                       (unsigned)place.pid, (unsigned)place.size, (unsigned long)place.capability);
     }
     else if (place.size == 1 && place.capability == 0)
@@ -175,13 +175,13 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecAllocate(PlaceID place, RegInde
             place.pid  = GetDRISC().GetPID();
 
             DebugSimWrite("F%u/T%u(%llu) %s adjusted local place -> CPU%u/1",
-                          (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                          (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                           (unsigned)place.pid);
         }
         place.capability = 0x1337; // also later: copy the place capability from the parent.
 
         DebugSimWrite("F%u/T%u(%llu) %s adjusted sz 1 cap 0 -> 0x%lx",
-                      (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                      (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                       (unsigned long)place.capability);
     }
 
@@ -201,7 +201,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecAllocate(PlaceID place, RegInde
         type = ALLOCATE_SINGLE;
 
         DebugSimWrite("F%u/T%u(%llu) %s adjusted allocate type exclusive -> exclusive single",
-                      (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym);
+                      (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str());
     }
 
     // Send an allocation request.
@@ -269,7 +269,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecCreate(const FID& fid, MemAddr
     }
 
     DebugFlowWrite("F%u/T%u(%llu) %s create CPU%u/F%u %s",
-                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                    (unsigned)fid.pid, (unsigned) fid.lfid,
                    GetDRISC().GetSymbolTable()[address].c_str());
 
@@ -316,7 +316,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecSync(const FID& fid)
     if (m_input.Rc.index == INVALID_REG_INDEX)
     {
         throw exceptf<InvalidArgumentException>(*this, "F%u/T%u(%llu) %s invalid target register for sync",
-                                                (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym);
+                                                (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str());
     }
 
     if (fid.pid == 0 && fid.lfid == 0 && fid.capability == 0)
@@ -338,7 +338,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecSync(const FID& fid)
             m_output.Rcv = MAKE_PENDING_PIPEVALUE(m_input.RcSize);
         }
         DebugFlowWrite("F%u/T%u(%llu) %s sync CPU%u/F%u",
-                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                        (unsigned)fid.pid, (unsigned)fid.lfid);
     }
 
@@ -360,7 +360,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecDetach(const FID& fid)
             m_output.Rrc.detach.fid = fid;
         }
         DebugFlowWrite("F%u/T%u(%llu) %s detach CPU%u/F%u",
-                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                        (unsigned)fid.pid, (unsigned)fid.lfid);
     }
 
@@ -410,7 +410,7 @@ void Pipeline::ExecuteStage::ExecDebugOutput(Integer value, int command, int fla
     if (outstream == 0)
     {
         DebugProgWrite("F%u/T%u(%llu) %s PRINT: %s",
-                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                        stringout.str().c_str());
     }
 }
@@ -448,7 +448,7 @@ void Pipeline::ExecuteStage::ExecStatusAction(Integer value, int command, int fl
     if (outstream == 0)
     {
         DebugProgWrite("F%u/T%u(%llu) %s STATUS: %s",
-                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                        stringout.str().c_str());
     }
 
@@ -551,7 +551,7 @@ void Pipeline::ExecuteStage::ExecDebug(double value, Integer stream) const
     switch (s) {
     case 0:
       DebugProgWrite("F%u/T%u(%llu) %s PRINT: %0.*lf",
-                     (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                     (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                      prec, value );
       break;
     case 1:
@@ -122,14 +122,6 @@ Pipeline::PipeAction Pipeline::FetchStage::OnCycle()
         m_output.instr        = UnserializeInstruction(&instrs[iInstr]);
 
         m_output.pc_dbg       = pc;
-        if (GetKernel()->GetDebugMode() & Kernel::DEBUG_CPU_MASK)
-        {
-            m_output.pc_sym = GetDRISC().GetSymbolTable()[m_output.pc].c_str();
-        }
-        else
-        {
-            m_output.pc_sym = "(untranslated)";
-        }
 
         // Check for breakpoints
         GetDRISC().GetBreakPointManager().Check(BreakPointManager::FETCH, pc, *this);
@@ -140,7 +132,7 @@ Pipeline::PipeAction Pipeline::FetchStage::OnCycle()
     }
 
     DebugPipeWrite("F%u/T%u(%llu) %s fetched 0x%.*lx (switching: %s)",
-                   (unsigned)m_output.fid, (unsigned)m_output.tid, (unsigned long long)m_output.logical_index, m_output.pc_sym,
+                   (unsigned)m_output.fid, (unsigned)m_output.tid, (unsigned long long)m_output.logical_index, GetPCSymbol(m_output).c_str(),
                    (int)(sizeof(Instruction) * 2), (unsigned long)m_output.instr,
                    m_switched ? "yes" : "no");
 
@@ -175,6 +167,10 @@ Pipeline::FetchStage::FetchStage(Pipeline& parent, FetchDecodeLatch& output)
     }
 
     m_buffer = new char[m_icache.GetLineSize()];
+
+    RegisterStateArray(&m_buffer[0], m_icache.GetLineSize(), "buffer");
+    RegisterStateVariable(m_switched, "switched");
+    RegisterStateVariable(m_pc, "pc");
 }
 
 Pipeline::FetchStage::~FetchStage()
@@ -18,6 +18,7 @@ namespace drisc
 ICache::ICache(const std::string& name, DRISC& parent, Clock& clock)
 :   Object(name, parent),
     m_memory(NULL),
+    m_memadmin(NULL),
     m_selector(IBankSelector::makeSelector(*this, GetConf("BankSelector", string), GetConf("NumSets", size_t))),
     m_mcid(0),
     m_lines(),
@@ -26,6 +27,9 @@ ICache::ICache(const std::string& name, DRISC& parent, Clock& clock)
     InitBuffer(m_incoming, clock, "IncomingBufferSize"),
     m_lineSize(GetTopConf("CacheLineSize", size_t)),
     m_assoc   (GetConf("Associativity", size_t)),
+    m_tags    (m_selector->GetNumBanks(), m_assoc),
+    m_directMemory(false),
+    m_draining(false),
 
     InitSampleVariable(numHits, SVC_CUMULATIVE),
     InitSampleVariable(numDelayedReads, SVC_CUMULATIVE),
@@ -46,6 +50,9 @@ ICache::ICache(const std::string& name, DRISC& parent, Clock& clock)
     m_outgoing.Sensitive( p_Outgoing );
     m_incoming.Sensitive( p_Incoming );
 
+    // A memory queues a read or fails without effect
+    p_Outgoing.SetFailsFirst();
+
     // These things must be powers of two
     if (m_assoc == 0 || !IsPowerOfTwo(m_assoc))
     {
@@ -85,14 +92,16 @@ ICache::ICache(const std::string& name, DRISC& parent, Clock& clock)
         line.creation     = false;
         RegisterStateObject(line, "line" + to_string(i));
     }
+    RegisterStateObject(m_tags, "tags");
 }
 
-void ICache::ConnectMemory(IMemory* memory)
+void ICache::ConnectMemory(IMemory* memory, IMemoryAdmin* admin)
 {
     assert(m_memory == NULL); // can't register two times
     assert(memory != NULL);
 
     m_memory = memory;
+    m_memadmin = admin;
     StorageTraceSet traces;
     m_mcid = m_memory->RegisterClient(*this, p_Outgoing, traces, m_incoming);
     p_Outgoing.SetStorageTraces(traces);
@@ -129,6 +138,16 @@ Result ICache::FindLine(MemAddr address, Line* &line, bool check_only)
     const size_t  set  = setindex * m_assoc;
 
     // Find the line
+    const size_t way = m_tags.Find(setindex, tag, [this](size_t i) { return m_lines[i].state != LINE_EMPTY; });
+    if (way < m_assoc)
+    {
+        // The wanted line was in the cache
+        line = &m_lines[set + way];
+        assert(line->tag == tag);
+        return SUCCESS;
+    }
+
+    // Look for an empty line or the least recently used one
     Line* empty   = NULL;
     Line* replace = NULL;
     for (size_t i = 0; i < m_assoc; ++i)
@@ -140,11 +159,6 @@ Result ICache::FindLine(MemAddr address, Line* &line, bool check_only)
             // Empty line, remember this one
             empty = line;
         }
-        else if (line->tag == tag)
-        {
-            // The wanted line was in the cache
-            return SUCCESS;
-        }
         else if (line->references == 0 && (replace == NULL || line->access < replace->access))
         {
             // The line is available to be replaced and has a lower LRU rating,
@@ -169,6 +183,7 @@ Result ICache::FindLine(MemAddr address, Line* &line, bool check_only)
         {
             // Reset the line
             line->tag = tag;
+            m_tags[line - &m_lines[0]] = tag;
         }
     }
     return DELAYED;
@@ -344,13 +359,29 @@ Result ICache::Fetch(MemAddr address, MemSize size, TID* tid, CID* cid)
     else
     {
         // Cache miss; a line has been allocated, fetch the data
-        if (!m_outgoing.Push(address))
+        if (m_draining)
+        {
+            DeadlockWrite("Unable to fetch I-Cache line while the memory system drains");
+            return FAILED;
+        }
+        if (m_directMemory)
+        {
+            // In direct-memory mode, read the line from memory right away and
+            // complete it as if it came back from the memory system.
+            if (!m_incoming.Push(line - &m_lines[0]))
+            {
+                DeadlockWrite("Unable to buffer I-Cache line read completion");
+                ++m_numStallingMisses;
+                return FAILED;
+            }
+            COMMIT{ m_memadmin->Read(address, line->data, m_lineSize); }
+        }
+        else if (!m_outgoing.Push(address))
         {
             DeadlockWrite("Unable to put request for I-Cache line into outgoing buffer");
             ++m_numStallingMisses;
             return FAILED;
         }
-
         // Data is being fetched
         COMMIT
         {
@@ -417,7 +448,7 @@ bool ICache::OnMemoryWriteCompleted(TID /*tid*/)
     UNREACHABLE;
 }
 
-bool ICache::OnMemorySnooped(MemAddr address, const char * data, const bool * mask)
+bool ICache::OnMemorySnooped(MemAddr address, const char * data, const LineMask& mask)
 {
     Line* line;
     // Cache coherency: check if we have the same address
@@ -426,6 +457,7 @@ bool ICache::OnMemorySnooped(MemAddr address, const char * data, const bool * ma
         // We do, update the data
         COMMIT{
             line::blit(line->data, data, mask, m_lineSize);
+            GetDRISC().GetPipeline().InvalidateDecoded(address, m_lineSize);
         }
     }
     return true;
@@ -438,6 +470,7 @@ bool ICache::OnMemoryInvalidated(MemAddr address)
         Line* line;
         if (FindLine(address, line, true) == SUCCESS)
         {
+            GetDRISC().GetPipeline().InvalidateDecoded(address, m_lineSize);
             if (line->state == LINE_FULL) {
                 // Valid lines without references are invalidated by clearing then. Simple.
                 // Otherwise, we invalidate them.
@@ -6,6 +6,7 @@
 #include "sim/inspect.h"
 #include "sim/buffer.h"
 #include "arch/Memory.h"
+#include "arch/TagArray.h"
 #include "forward.h"
 
 namespace Simulator
@@ -47,6 +48,7 @@ class ICache : public Object, public IMemoryCallback, public Inspect::Interface<
     Result DoIncoming();
 
     IMemory*          m_memory;
+    IMemoryAdmin*     m_memadmin;
     IBankSelector*    m_selector;
     MCID              m_mcid;
     std::vector<Line> m_lines;
@@ -56,6 +58,9 @@ class ICache : public Object, public IMemoryCallback, public Inspect::Interface<
 
     size_t            m_lineSize;
     size_t            m_assoc;
+    TagArray          m_tags;
+    bool              m_directMemory;
+    bool              m_draining;
 
     // Statistics:
     DefineSampleVariable(uint64_t, numHits);
@@ -74,7 +79,16 @@ public:
     ICache(const ICache&) = delete;
     ICache& operator=(const ICache&) = delete;
     ~ICache();
-    void ConnectMemory(IMemory* memory);
+    void ConnectMemory(IMemory* memory, IMemoryAdmin* admin);
+
+    // In direct-memory mode, missing lines are read from the memory contents
+    // directly instead of being requested from the memory system.
+    void SetDirectMemory(bool enable) { m_directMemory = enable; }
+    bool IsDirectMemory() const { return m_directMemory; }
+
+    // While draining, missing lines are not requested from memory, so
+    // that the requests in flight can complete.
+    void SetDraining(bool enable) { m_draining = enable; }
 
     // Processes
     Process p_Outgoing;
@@ -91,7 +105,7 @@ public:
     // IMemoryCallback
     bool   OnMemoryReadCompleted(MemAddr addr, const char* data) override;
     bool   OnMemoryWriteCompleted(TID tid) override;
-    bool   OnMemorySnooped(MemAddr addr, const char* data, const bool* mask) override;
+    bool   OnMemorySnooped(MemAddr addr, const char* data, const LineMask& mask) override;
     bool   OnMemoryInvalidated(MemAddr addr) override ;
     Object& GetMemoryPeer() override;
 
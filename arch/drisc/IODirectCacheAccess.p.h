@@ -87,7 +87,7 @@ public:
 
     bool OnMemoryReadCompleted(MemAddr addr, const char* data) override;
     bool OnMemoryWriteCompleted(TID tid) override;
-    bool OnMemorySnooped(MemAddr /*unused*/, const char* /*data*/, const bool* /*mask*/) override;
+    bool OnMemorySnooped(MemAddr /*unused*/, const char* /*data*/, const LineMask& /*mask*/) override;
     bool OnMemoryInvalidated(MemAddr /*unused*/) override;
 
     Object& GetMemoryPeer() override;
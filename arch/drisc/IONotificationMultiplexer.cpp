@@ -43,6 +43,9 @@ IONotificationMultiplexer::IONotificationMultiplexer(const string& name, IOInter
         }
     }
 
+    RegisterStateObject(m_mask, "mask");
+    RegisterStateVariable(m_lastNotified, "lastNotified");
+
 }
 
 IONotificationMultiplexer::~IONotificationMultiplexer()
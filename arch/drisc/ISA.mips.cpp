@@ -251,7 +251,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
                 case M_ROP_JR:
                     if (Rav != m_input.pc + sizeof(Instruction)) {
                         DebugFlowWrite("F%u/T%u(%llu) %s branch %s",
-                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                        GetDRISC().GetSymbolTable()[Rav].c_str());
                         COMMIT {
                             m_output.pc = Rav;
@@ -270,7 +270,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
                         if (Rav == next)
                             break;
                         DebugFlowWrite("F%u/T%u(%llu) %s branch %s",
-                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                        GetDRISC().GetSymbolTable()[Rav].c_str());
                         COMMIT {
                             m_output.pc = Rav;
@@ -416,7 +416,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
                         MemAddr target = next + m_input.displacement;
                         if (target != next) {
                             DebugFlowWrite("F%u/T%u(%llu) %s branch %s",
-                                           (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                                           (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                            GetDRISC().GetSymbolTable()[target].c_str());
                             COMMIT {
                                 m_output.pc = target;
@@ -446,7 +446,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
                     }
                     if (target != next) {
                         DebugFlowWrite("F%u/T%u(%llu) %s branch %s",
-                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                        GetDRISC().GetSymbolTable()[target].c_str());
                         COMMIT {
                             m_output.swch = true;
@@ -481,7 +481,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
                     MemAddr target = next + m_input.displacement;
                     if (target != next) {
                         DebugFlowWrite("F%u/T%u(%llu) %s branch %s",
-                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                        GetDRISC().GetSymbolTable()[target].c_str());
                         COMMIT {
                             m_output.swch = true;
@@ -122,6 +122,7 @@ struct ArchDecodeReadLatch
           displacement(0)
     {}
     virtual ~ArchDecodeReadLatch() {}
+    SERIALIZE(arch) { arch & format & opcode & function & regimm & shift & immediate & displacement; }
 };
 
 typedef ArchDecodeReadLatch ArchReadExecuteLatch;
@@ -991,7 +991,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
                     COMMIT
                     {
                         DebugFlowWrite("F%u/T%u(%llu) %s branch %s",
-                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                        cpu.GetSymbolTable()[target].c_str());
                         m_output.pc   = target;
                         m_output.swch = true;
@@ -1016,7 +1016,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
             COMMIT
             {
                 DebugFlowWrite("F%u/T%u(%llu) %s branch %s",
-                               (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                               (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                cpu.GetSymbolTable()[target].c_str());
 
                 // Store the address of the next instruction
@@ -1293,7 +1293,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
                     m_input.Rc))
                 {
                     DeadlockWrite("F%u/T%u(%llu) %s unable to queue FP operation %u on %s for %s",
-                                  (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                                  (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                   (unsigned)fpuop, m_fpu->GetName().c_str(), m_input.Rc.str().c_str());
 
                     return PIPE_STALL;
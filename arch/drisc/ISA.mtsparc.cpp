@@ -736,7 +736,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
             m_output.Rcv.m_state   = RST_FULL;
             m_output.Rcv.m_size    = sizeof(Integer);
             DebugFlowWrite("F%u/T%u(%llu) %s call %s",
-                           (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                           (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                            cpu.GetSymbolTable()[m_output.pc].c_str());
         }
         return PIPE_FLUSH;
@@ -772,7 +772,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
                 COMMIT {
                     m_output.pc = m_input.pc + m_input.displacement * sizeof(Instruction);
                     DebugFlowWrite("F%u/T%u(%llu) %s branch %s",
-                                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                    cpu.GetSymbolTable()[m_output.pc].c_str());
                 }
                 return PIPE_FLUSH;
@@ -959,7 +959,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
                     m_input.Rbv.m_float.tofloat(m_input.Rbv.m_size), m_input.Rc))
                 {
                     DeadlockWrite("F%u/T%u(%llu) %s unable to queue FP operation %u on %s for %s",
-                                  (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                                  (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                   (unsigned)fpuop, m_fpu->GetName().c_str(), m_input.Rc.str().c_str());
                     return PIPE_STALL;
                 }
@@ -1093,7 +1093,7 @@ Pipeline::PipeAction Pipeline::ExecuteStage::ExecuteInstruction()
                 m_output.Rcv.m_integer = m_input.pc;
                 m_output.Rcv.m_state   = RST_FULL;
                 DebugFlowWrite("F%u/T%u(%llu) %s branch %s",
-                               (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                               (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                                cpu.GetSymbolTable()[m_output.pc].c_str());
             }
             return PIPE_FLUSH;
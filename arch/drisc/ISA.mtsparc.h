@@ -272,12 +272,14 @@ struct ArchDecodeReadLatch
 
     ArchDecodeReadLatch() : op1(0), op2(0), op3(0), function(0), asi(0), displacement(0), Rs(), RsIsLocal(false),  RsSize(0) {}
     virtual ~ArchDecodeReadLatch() {}
+    SERIALIZE(arch) { arch & op1 & op2 & op3 & function & asi & displacement & Rs & RsIsLocal & RsSize; }
 };
 
 struct ArchReadExecuteLatch : public ArchDecodeReadLatch
 {
     PipeValue Rsv;
     ArchReadExecuteLatch() : ArchDecodeReadLatch(), Rsv() {}
+    SERIALIZE(arch) { ArchDecodeReadLatch::serialize(arch); arch & Rsv; }
 };
 
 
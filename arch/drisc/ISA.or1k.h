@@ -22,6 +22,7 @@ struct ArchDecodeReadLatch
         function(0),
         displacement(0)
     {}
+    SERIALIZE(arch) { arch & function & displacement; }
 };
 
 struct ArchReadExecuteLatch : public ArchDecodeReadLatch
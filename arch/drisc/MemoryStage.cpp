@@ -61,7 +61,7 @@ Pipeline::PipeAction Pipeline::MemoryStage::OnCycle()
                     {
                         DeadlockWrite("F%u/T%u(%llu) %s stall (I/O store *%#.*llx/%zd <- %s)",
                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                      m_input.pc_sym,
+                                      GetPCSymbol(m_input).c_str(),
                                       (int)(sizeof(MemAddr)*2), (unsigned long long)m_input.address, (size_t)m_input.size,
                                       m_input.Rcv.str(m_input.Rc.type).c_str());
 
@@ -76,18 +76,19 @@ Pipeline::PipeAction Pipeline::MemoryStage::OnCycle()
                         // Stall
                         DeadlockWrite("F%u/T%u(%llu) %s stall (L1 store *%#.*llx/%zd <- %s)",
                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                      m_input.pc_sym,
+                                      GetPCSymbol(m_input).c_str(),
                                       (int)(sizeof(MemAddr)*2), (unsigned long long)m_input.address, (size_t)m_input.size,
                                       m_input.Rcv.str(m_input.Rc.type).c_str());
 
                         return PIPE_STALL;
                     }
 
-                    if (!m_allocator.IncreaseThreadDependency(m_input.tid, THREADDEP_OUTSTANDING_WRITES))
+                    // Writes in direct-memory mode complete immediately
+                    if (result == DELAYED && !m_allocator.IncreaseThreadDependency(m_input.tid, THREADDEP_OUTSTANDING_WRITES))
                     {
                         DeadlockWrite("F%u/T%u(%llu) %s unable to increase OUTSTANDING_WRITES",
                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                      m_input.pc_sym);
+                                      GetPCSymbol(m_input).c_str());
                         return PIPE_STALL;
                     }
                 }
@@ -100,7 +101,7 @@ Pipeline::PipeAction Pipeline::MemoryStage::OnCycle()
 
                 DebugMemWrite("F%u/T%u(%llu) %s store *%#.*llx/%zd <- %#llx (%s %s)",
                               (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                              m_input.pc_sym,
+                              GetPCSymbol(m_input).c_str(),
                               (int)(sizeof(MemAddr)*2),
                               (unsigned long long)m_input.address, (size_t)m_input.size,
                               (unsigned long long)(value & ~(((uint64_t)-1) << (8 * m_input.size) )),
@@ -133,7 +134,7 @@ Pipeline::PipeAction Pipeline::MemoryStage::OnCycle()
 
                 DebugMemWrite("F%u/T%u(%llu) %s clear %s",
                               (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                              m_input.pc_sym,
+                              GetPCSymbol(m_input).c_str(),
                               m_input.Rc.str().c_str());
             }
             else
@@ -155,7 +156,7 @@ Pipeline::PipeAction Pipeline::MemoryStage::OnCycle()
                         case FAILED:
                             DeadlockWrite("F%u/T%u(%llu) %s stall (I/O load *%#.*llx/%zu bytes -> %s)",
                                           (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                          m_input.pc_sym,
+                                          GetPCSymbol(m_input).c_str(),
                                           (int)(sizeof(MemAddr)*2), (unsigned long long)m_input.address, (size_t)m_input.size,
                                           m_input.Rc.str().c_str());
 
@@ -177,7 +178,7 @@ Pipeline::PipeAction Pipeline::MemoryStage::OnCycle()
 
                             DebugMemWrite("F%u/T%u(%llu) %s I/O load *%#.*llx/%zu -> delayed %s",
                                           (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                          m_input.pc_sym,
+                                          GetPCSymbol(m_input).c_str(),
                                           (int)(sizeof(MemAddr)*2), (unsigned long long)m_input.address, (size_t)m_input.size,
                                           m_input.Rc.str().c_str());
 
@@ -198,7 +199,7 @@ Pipeline::PipeAction Pipeline::MemoryStage::OnCycle()
                             // Stall
                             DeadlockWrite("F%u/T%u(%llu) %s stall (L1 load *%#.*llx/%zu bytes -> %s)",
                                           (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                          m_input.pc_sym,
+                                          GetPCSymbol(m_input).c_str(),
                                           (int)(sizeof(MemAddr)*2), (unsigned long long)m_input.address, (size_t)m_input.size,
                                           m_input.Rc.str().c_str());
 
@@ -223,7 +224,7 @@ Pipeline::PipeAction Pipeline::MemoryStage::OnCycle()
 
                             DebugMemWrite("F%u/T%u(%llu) %s L1 load *%#.*llx/%zu -> delayed %s",
                                           (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                          m_input.pc_sym,
+                                          GetPCSymbol(m_input).c_str(),
                                           (int)(sizeof(MemAddr)*2), (unsigned long long)m_input.address, (size_t)m_input.size,
                                           m_input.Rc.str().c_str());
 
@@ -260,7 +261,7 @@ Pipeline::PipeAction Pipeline::MemoryStage::OnCycle()
                         // Memory read
                         DebugMemWrite("F%u/T%u(%llu) %s load *%#.*llx/%zu -> %s %s",
                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                      m_input.pc_sym,
+                                      GetPCSymbol(m_input).c_str(),
                                       (int)(sizeof(MemAddr)*2), (unsigned long long)m_input.address, (size_t)m_input.size,
                                       m_input.Rc.str().c_str(), rcv.str(m_input.Rc.type).c_str());
                     }
@@ -419,6 +419,7 @@ bool Network::OnSync(LFID fid, PID completion_pid, RegIndex completion_reg)
         }
         DebugSimWrite("F%u registered sync writeback for CPU%u/R%04x",
                       (unsigned)fid, (unsigned)completion_pid, (unsigned)completion_reg);
+        GetDRISC().RecordEvent(Timeline::FAMILY_SYNC, fid, INVALID_TID, completion_pid);
     }
     else
     {
@@ -433,12 +434,15 @@ bool Network::OnSync(LFID fid, PID completion_pid, RegIndex completion_reg)
         }
         DebugSimWrite("F%u sent sync writeback %u to CPU%u/R%04x",
                       (unsigned)fid, (unsigned)family.broken, (unsigned)completion_pid, (unsigned)completion_reg);
+        GetDRISC().RecordEvent(Timeline::FAMILY_SYNC, fid, INVALID_TID, completion_pid);
     }
     return true;
 }
 
 bool Network::OnDetach(LFID fid)
 {
+    // Recorded first, as the detachment can release the family
+    GetDRISC().RecordEvent(Timeline::FAMILY_DETACHED, fid);
     if (!m_allocator.DecreaseFamilyDependency(fid, FAMDEP_DETACHED))
     {
         DeadlockWrite("Unable to mark family detachment of F%u", (unsigned)fid);
@@ -55,7 +55,7 @@ Pipeline::Pipeline(const std::string&  name,
     m_stages[0].output = &m_fdLatch;
 
     // Create the Decode stage
-    m_stages[1].stage  = new DecodeStage(*this, m_fdLatch, m_drLatch);
+    m_stages[1].stage  = new DecodeStage(*this, m_fdLatch, m_drLatch, GetConfOpt("DecodeCacheSize", size_t, 256));
     m_stages[1].input  = &m_fdLatch;
     m_stages[1].output = &m_drLatch;
 
@@ -103,6 +103,19 @@ Pipeline::Pipeline(const std::string&  name,
     bypasses.push_back(BypassInfo(m_mwBypass.empty, m_mwBypass.Rc, m_mwBypass.Rcv));
 
     m_stages[2].stage = new ReadStage(*this, m_drLatch, m_reLatch, bypasses);
+
+    RegisterStateObject(*this, "latches");
+}
+
+template<typename A>
+void Pipeline::serialize(A& arch)
+{
+    arch & "[latches" & m_fdLatch & m_drLatch & m_reLatch & m_emLatch & m_mwLatch & m_dummyLatches & m_mwBypass & "]";
+}
+
+SymbolName Pipeline::Stage::GetPCSymbol(const CommonData& data) const
+{
+    return GetDRISC().GetSymbolTable()[data.pc_dbg];
 }
 
 void Pipeline::ConnectFPU(FPU* fpu)
@@ -124,6 +137,38 @@ Pipeline::~Pipeline()
     }
 }
 
+bool Pipeline::GetSamplePC(MemAddr& pc, bool& stalled) const
+{
+    for (auto& s : m_stages)
+    {
+        if (s.status == FAILED && s.input != NULL && !s.input->empty)
+        {
+            pc      = s.input->pc_dbg;
+            stalled = true;
+            return true;
+        }
+    }
+
+    if (!m_emLatch.empty)
+    {
+        pc      = m_emLatch.pc_dbg;
+        stalled = false;
+        return true;
+    }
+
+    const Latch* latches[] = { &m_reLatch, &m_drLatch, &m_fdLatch };
+    for (const Latch* latch : latches)
+    {
+        if (!latch->empty)
+        {
+            pc      = latch->pc_dbg;
+            stalled = true;
+            return true;
+        }
+    }
+    return false;
+}
+
 Result Pipeline::DoPipeline()
 {
     m_running = true;
@@ -5,6 +5,7 @@
 #include <sim/kernel.h>
 #include <sim/inspect.h>
 #include <arch/simtypes.h>
+#include <arch/symtable.h>
 #include <arch/drisc/forward.h>
 #include <arch/drisc/FamilyTable.h>
 #include <arch/drisc/ThreadTable.h>
@@ -38,6 +39,7 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
         };
         PipeValue() : m_state(RST_INVALID), m_size(0) {}
         std::string str(RegType type) const;
+        SERIALIZE(arch) { arch & Serialization::binary(this, sizeof *this); }
     };
 
 #if defined(TARGET_MTALPHA)
@@ -95,6 +97,8 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
             Family::RegInfo family;
             Thread::RegInfo thread;
         } types[NUM_REG_TYPES];
+
+        SERIALIZE(arch) { arch & Serialization::binary(types, sizeof types); }
     };
 
     //
@@ -120,13 +124,14 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
 
         // Admin (debugging, traces)
         MemAddr      pc_dbg;        // Original, unmodified PC for debugging (execute can change the pc)
-        const char*  pc_sym;        // Symbolic name for PC
         uint64_t     logical_index; // Thread logical index
 
-        CommonData() : pc(0), tid(0), fid(0), swch(false), kill(false), pc_dbg(0), pc_sym(NULL), logical_index(0) {}
+        CommonData() : pc(0), tid(0), fid(0), swch(false), kill(false), pc_dbg(0), logical_index(0) {}
         CommonData(const CommonData&) = default;
         CommonData& operator=(const CommonData&) = default;
         virtual ~CommonData() {}
+
+        SERIALIZE(arch) { arch & pc & tid & fid & swch & kill & pc_dbg & logical_index; }
     };
 
     struct Latch : public CommonData
@@ -134,6 +139,7 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
         bool empty;
 
         Latch() : empty(true) {}
+        SERIALIZE(arch) { CommonData::serialize(arch); arch & empty; }
     };
 
     struct FetchDecodeLatch : public Latch
@@ -144,6 +150,7 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
         bool        legacy;
 
         FetchDecodeLatch() : instr(0), regs(), placeSize(0), legacy(false) {}
+        SERIALIZE(arch) { Latch::serialize(arch); arch & instr & regs & placeSize & legacy; }
     };
 
     struct DecodeReadLatch : public Latch, public ArchDecodeReadLatch
@@ -174,6 +181,15 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
             RaNotPending(false),
             regofs(0),
             legacy(false) {}
+
+        SERIALIZE(arch)
+        {
+            Latch::serialize(arch);
+            ArchDecodeReadLatch::serialize(arch);
+            arch & literal & regs & placeSize
+                 & Ra & Rb & Rc & RaSize & RbSize & RcSize
+                 & RaIsLocal & RbIsLocal & RaNotPending & regofs & legacy;
+        }
     };
 
     struct ReadExecuteLatch : public Latch, public ArchReadExecuteLatch
@@ -203,6 +219,13 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
             legacy(false),
             Ra(), Rb()
         {}
+
+        SERIALIZE(arch)
+        {
+            Latch::serialize(arch);
+            ArchReadExecuteLatch::serialize(arch);
+            arch & placeSize & regs & Rc & Rav & Rbv & RcSize & regofs & legacy & Ra & Rb;
+        }
     };
 
     struct ExecuteMemoryLatch : public Latch
@@ -231,6 +254,12 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
             Rcv(), Rc(),
             placeSize(0),
             Rrc(), Ra() {}
+
+        SERIALIZE(arch)
+        {
+            Latch::serialize(arch);
+            arch & suspend & address & size & sign_extend & Rcv & Rc & placeSize & Rrc & Ra;
+        }
     };
 
     struct MemoryWritebackLatch : public Latch
@@ -242,6 +271,7 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
         RemoteMessage Rrc;
 
         MemoryWritebackLatch() : suspend(SUSPEND_NONE), Rc(), Rcv(), Rrc() {}
+        SERIALIZE(arch) { Latch::serialize(arch); arch & suspend & Rc & Rcv & Rrc; }
     };
 
     //
@@ -257,6 +287,9 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
         Stage(const std::string& name, Object& parent)
             : Object(name, parent) {}
         Object& GetDRISCParent()  const { return *GetParent()->GetParent(); }
+
+        // Symbolic name of the PC in a latch, for traces.
+        SymbolName GetPCSymbol(const CommonData& data) const;
     };
 
     class FetchStage : public Stage
@@ -282,19 +315,50 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
 
     class DecodeStage : public Stage
     {
-        const FetchDecodeLatch& m_input;
-        DecodeReadLatch&        m_output;
+        // The outputs of DecodeInstruction() for an instruction. They
+        // only depend on the instruction word, which is checked on a hit,
+        // so that an entry can never be stale.
+        struct DecodedInstruction
+        {
+            bool                valid;
+            MemAddr             pc;
+            Instruction         instr;
+            ArchDecodeReadLatch arch;
+            uint32_t            literal;
+            RegAddr             Ra, Rb, Rc;
+            unsigned int        RaSize, RbSize, RcSize;
+            bool                RaNotPending;
+            unsigned char       regofs;
+
+            DecodedInstruction()
+                : valid(false), pc(0), instr(0), arch(), literal(0),
+                  Ra(), Rb(), Rc(), RaSize(0), RbSize(0), RcSize(0),
+                  RaNotPending(false), regofs(0) {}
+        };
+
+        const FetchDecodeLatch&         m_input;
+        DecodeReadLatch&                m_output;
+        std::vector<DecodedInstruction> m_decoded;  ///< Decoded instructions, indexed by PC; empty if disabled.
+        DefineSampleVariable(uint64_t, nDecodeHits);
+        DefineSampleVariable(uint64_t, nDecodeMisses);
 
         PipeAction OnCycle();
         RegAddr TranslateRegister(uint8_t reg, RegType type, unsigned int size, bool *islocal) const;
         void    DecodeInstruction(const Instruction& instr);
+        size_t  GetDecodedIndex(MemAddr pc) const { return (size_t)(pc / sizeof(Instruction)) & (m_decoded.size() - 1); }
+        bool    LoadDecoded();
+        void    StoreDecoded();
 
 #if defined(TARGET_MTALPHA) || defined(TARGET_MIPS32) || defined(TARGET_MIPS32EL)
         static InstrFormat GetInstrFormat(uint8_t opcode);
 #endif
     public:
         DecodeStage(Pipeline& parent,
-                    const FetchDecodeLatch& input, DecodeReadLatch& output);
+                    const FetchDecodeLatch& input, DecodeReadLatch& output,
+                    size_t decodeCacheSize);
+
+        // Forget the decoded instructions in [address, address + size).
+        void InvalidateDecoded(MemAddr address, MemSize size);
     };
 
     class ReadStage : public Stage
@@ -313,6 +377,9 @@ class Pipeline : public Object, public Inspect::Interface<Inspect::Read>
             PipeValue          value_reg; ///< Value as read from the register file
 
             OperandInfo() : port(0), addr(), value(), offset(0), islocal(false), addr_reg(), value_reg() {}
+
+            // The port is fixed at construction and is not serialized.
+            SERIALIZE(arch) { arch & addr & value & offset & islocal & addr_reg & value_reg; }
         };
 
         bool ReadRegister(OperandInfo& operand, uint32_t literal);
@@ -491,11 +558,25 @@ public:
     void     CollectMemOpStatistics(uint64_t& nr, uint64_t& nw, uint64_t& nrb, uint64_t& nwb) const
     { return dynamic_cast<MemoryStage&>(*m_stages[4].stage).addMemStatistics(nr, nw, nrb, nwb); }
 
+    // Called by the I-Cache when the code in a line changes or is invalidated.
+    void InvalidateDecoded(MemAddr address, MemSize size)
+    { dynamic_cast<DecodeStage&>(*m_stages[1].stage).InvalidateDecoded(address, size); }
+
     void Cmd_Info(std::ostream& out, const std::vector<std::string>& arguments) const;
     void Cmd_Read(std::ostream& out, const std::vector<std::string>& arguments) const;
 
     bool IsPipelineProcessActive() const { return m_running; }
 
+    // The PC a profiler attributes the last cycle to: the instruction
+    // held up by a stalled stage, or else the one that was executed.
+    // If no instruction was executed but some are on their way, the
+    // oldest of those counts as stalled. Returns false if the pipeline
+    // is empty.
+    bool GetSamplePC(MemAddr& pc, bool& stalled) const;
+
+    // Serializes the latches; registered as the "latches" state variable.
+    SERIALIZE(arch);
+
     // Processes
     Process p_Pipeline;
 private:
@@ -59,6 +59,10 @@ RAUnit::RAUnit(const string& name, Object& parent, const array<RegSize, NUM_REG_
         type.free[CONTEXT_EXCLUSIVE] = 1;
 
         type.list.resize(free_blocks, List::value_type(0, INVALID_LFID));
+
+        static constexpr std::array<const char*, NUM_REG_TYPES> var_names = { {"int", "flt"} };
+        RegisterStateVariable(type.list, std::string(var_names[i]) + "_blocks");
+        RegisterStateArray(&type.free[0], NUM_CONTEXT_TYPES, std::string(var_names[i]) + "_free");
     }
 }
 
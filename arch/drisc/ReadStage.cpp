@@ -469,7 +469,7 @@ Pipeline::PipeAction Pipeline::ReadStage::OnCycle()
                        " %s"
 #endif
                        ,
-                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                       m_output.Rav.str(m_input.Ra.type).c_str(),
                       m_output.Rbv.str(m_input.Rb.type).c_str()
 #if defined(TARGET_MTSPARC)
@@ -510,6 +510,14 @@ Pipeline::ReadStage::ReadStage(Pipeline& parent,
     m_operand1.port = &m_regFile.p_pipelineR1;
     m_operand2.port = &m_regFile.p_pipelineR2;
     Clear(input.tid);
+
+    RegisterStateObject(m_operand1, "operand1");
+    RegisterStateObject(m_operand2, "operand2");
+    RegisterStateVariable(m_RaNotPending, "RaNotPending");
+#if defined(TARGET_MTSPARC)
+    RegisterStateVariable(m_isMemoryOp, "isMemoryOp");
+    RegisterStateObject(m_rsv, "rsv");
+#endif
 }
 
 }
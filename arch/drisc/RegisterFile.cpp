@@ -42,6 +42,8 @@ RegisterFile::RegisterFile(const std::string& name, DRISC& parent, Clock& clock)
         {
             m_files[i][j] = MAKE_EMPTY_REG();
         }
+        static constexpr std::array<const char*, NUM_REG_TYPES> var_names = { {"intregs", "fltregs"} };
+        RegisterStateArray(&m_files[i][0], m_sizes[i], var_names[i]);
     }
     // Set write port priorities (from ReadWriteStructure); first port has highest priority
     AddPort(p_pipelineW);
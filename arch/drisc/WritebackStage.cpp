@@ -28,7 +28,7 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
     if (m_input.Rrc.type != RemoteMessage::MSG_NONE)
     {
         DebugPipeWrite("F%u/T%u(%llu) %s sent network message %s",
-                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, m_input.pc_sym,
+                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index, GetPCSymbol(m_input).c_str(),
                        m_input.Rrc.str().c_str());
         // Network activity
         if (!m_network.SendMessage(m_input.Rrc))
@@ -100,7 +100,7 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
                 {
                     DeadlockWrite("F%u/T%u(%llu) %s unable to acquire write port on RF",
                                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                  m_input.pc_sym);
+                                  GetPCSymbol(m_input).c_str());
 
                     return PIPE_STALL;
                 }
@@ -111,7 +111,7 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
                 {
                     DeadlockWrite("F%u/T%u(%llu) %s unable to read prev %s",
                                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                  m_input.pc_sym,
+                                  GetPCSymbol(m_input).c_str(),
                                   addr.str().c_str());
 
                     return PIPE_STALL;
@@ -130,7 +130,7 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
 
                         DebugPipeWrite("F%u/T%u(%llu) %s data arrived in %s since read, rescheduling",
                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                       m_input.pc_sym,
+                                       GetPCSymbol(m_input).c_str(),
                                        addr.str().c_str());
                     }
                     else
@@ -171,7 +171,7 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
 
                     DebugPipeWrite("F%u/T%u(%llu) %s combining pending and waiting -> %s",
                                    (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                   m_input.pc_sym,
+                                   GetPCSymbol(m_input).c_str(),
                                    value.str(addr.type).c_str());
 
                 }
@@ -187,7 +187,7 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
 
                         DebugPipeWrite("F%u/T%u(%llu) %s target busy %s %s, retrying",
                                        (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                       m_input.pc_sym,
+                                       GetPCSymbol(m_input).c_str(),
                                        addr.str().c_str(), old_value.str(addr.type).c_str());
 
                         return PIPE_DELAY;
@@ -209,14 +209,14 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
                     {
                         DeadlockWrite("F%u/T%u(%llu) %s unable to write %s <- %s",
                                       (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                      m_input.pc_sym,
+                                      GetPCSymbol(m_input).c_str(),
                                       addr.str().c_str(), value.str(addr.type).c_str());
                         return PIPE_STALL;
                     }
 
                     DebugPipeWrite("F%u/T%u(%llu) %s writeback %s <- %s",
                                    (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                   m_input.pc_sym,
+                                   GetPCSymbol(m_input).c_str(),
                                    addr.str().c_str(), value.str(addr.type).c_str());
                 }
             }
@@ -237,7 +237,7 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
 
         DebugPipeWrite("F%u/T%u(%llu) %s memory barrier, suspend: %s",
                        (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                       m_input.pc_sym,
+                       GetPCSymbol(m_input).c_str(),
                        suspend ? "yes" : "no");
 
     }
@@ -258,7 +258,7 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
                 {
                     DeadlockWrite("F%u/T%u(%llu) %s unable to terminate thread",
                                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                  m_input.pc_sym);
+                                  GetPCSymbol(m_input).c_str());
                     return PIPE_STALL;
                 }
             }
@@ -270,7 +270,7 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
                 {
                     DeadlockWrite("F%u/T%u(%llu) %s unable to suspend thread",
                                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                  m_input.pc_sym);
+                                  GetPCSymbol(m_input).c_str());
                     return PIPE_STALL;
                 }
             }
@@ -285,7 +285,7 @@ Pipeline::PipeAction Pipeline::WritebackStage::OnCycle()
                     // We cannot reschedule, stall pipeline
                     DeadlockWrite("F%u/T%u(%llu) %s unable to reschedule thread",
                                   (unsigned)m_input.fid, (unsigned)m_input.tid, (unsigned long long)m_input.logical_index,
-                                  m_input.pc_sym);
+                                  GetPCSymbol(m_input).c_str());
                     return PIPE_STALL;
                 }
             }
@@ -321,6 +321,8 @@ Pipeline::WritebackStage::WritebackStage(Pipeline& parent,
     m_network(GetDRISC().GetNetwork()),
     m_writebackOffset(-1)
 {
+    RegisterStateVariable(m_stall, "stall");
+    RegisterStateVariable(m_writebackOffset, "writebackOffset");
 }
 
 }
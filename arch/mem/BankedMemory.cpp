@@ -33,7 +33,8 @@ class BankedMemory::Bank : public Object
 
     bool AddRequest(Buffer<Request>& queue, Request& request, bool data)
     {
-        COMMIT
+        // The arrival time is computed in every phase, so that a request
+        // that does not fit in the queue leaves no trace.
         {
             const std::pair<CycleNo, CycleNo> delay = m_memory.GetMessageDelay(data ? request.size : 0);
             const CycleNo                     now   = GetKernel()->GetActiveClock()->GetCycleNo();
@@ -84,6 +85,11 @@ class BankedMemory::Bank : public Object
 
             m_incoming.Pop();
         }
+        else
+        {
+            // Wait for the request to arrive
+            COMMIT{ GetKernel()->GetActiveClock()->SleepProcess(p_Incoming, request.done); }
+        }
         return SUCCESS;
     }
 
@@ -114,6 +120,11 @@ class BankedMemory::Bank : public Object
 
             m_outgoing.Pop();
         }
+        else
+        {
+            // Wait for the response to arrive
+            COMMIT{ GetKernel()->GetActiveClock()->SleepProcess(p_Outgoing, request.done); }
+        }
         return SUCCESS;
     }
 
@@ -125,7 +136,7 @@ class BankedMemory::Bank : public Object
         {
             // This bank is done serving the request
             if (m_request.write) {
-                static_cast<VirtualMemory&>(m_memory).Write(m_request.address, m_request.data.data, m_request.data.mask, m_request.size);
+                static_cast<VirtualMemory&>(m_memory).Write(m_request.address, m_request.data.data, &m_request.data.mask, m_request.size);
             } else {
                 static_cast<VirtualMemory&>(m_memory).Read(m_request.address, m_request.data.data, m_request.size);
             }
@@ -141,6 +152,11 @@ class BankedMemory::Bank : public Object
                 return FAILED;
             }
         }
+        else
+        {
+            // Wait for the bank to finish
+            COMMIT{ GetKernel()->GetActiveClock()->SleepProcess(p_Bank, m_request.done); }
+        }
         return SUCCESS;
     }
 
@@ -250,7 +266,7 @@ public:
         RegisterStateVariable(m_request.address, "request.address");
         RegisterStateVariable(m_request.size, "request.size");
         RegisterStateArray(m_request.data.data, sizeof(m_request.data.data)/sizeof(m_request.data.data[0]), "request.data");
-        RegisterStateArray(m_request.data.mask, sizeof(m_request.data.mask)/sizeof(m_request.data.mask[0]), "request.mask");
+        RegisterStateObject(m_request.data.mask, "request.mask");
         RegisterStateVariable(m_request.wid, "request.wid");
         RegisterStateVariable(m_request.done, "request.done");
 
@@ -260,6 +276,8 @@ public:
 
         p_Incoming.SetStorageTraces(opt(m_busy));
         p_Bank.SetStorageTraces(opt(m_outgoing * m_busy));
+
+        p_Incoming.SetFailsFirst();
     }
 };
 
@@ -360,7 +378,7 @@ bool BankedMemory::Write(MCID id, MemAddr address, const MemData& data, WClientI
     request.write     = true;
     COMMIT{
     std::copy(data.data, data.data+m_lineSize, request.data.data);
-    std::copy(data.mask, data.mask+m_lineSize, request.data.mask);
+    request.data.mask = data.mask;
     }
 
     // Broadcast the snoop data
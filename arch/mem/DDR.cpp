@@ -74,6 +74,7 @@ Result DDRChannel::DoRequest()
     if (now < m_next_command)
     {
         // Can't continue yet
+        COMMIT{ GetKernel()->GetActiveClock()->SleepProcess(p_Request, m_next_command); }
         return SUCCESS;
     }
 
@@ -176,6 +177,17 @@ Result DDRChannel::DoPipeline()
     assert(!m_pipeline.Empty());
     const CycleNo  now     = GetKernel()->GetActiveClock()->GetCycleNo();
     const Request& request = m_pipeline.Front();
+    if (m_sleep_cycle != INFINITE_CYCLES)
+    {
+        // We were busy in the cycles we slept through
+        const CycleNo slept = now - m_sleep_cycle - 1;
+        COMMIT
+        {
+            m_busyCycles += slept;
+            m_sleep_cycle = INFINITE_CYCLES;
+        }
+    }
+
     if (now >= request.done)
     {
         // The last burst has completed, send the assembled data back
@@ -186,6 +198,14 @@ Result DDRChannel::DoPipeline()
         }
         m_pipeline.Pop();
     }
+    else
+    {
+        // Nothing to do until the read completes
+        COMMIT{
+            GetKernel()->GetActiveClock()->SleepProcess(p_Pipeline, request.done);
+            m_sleep_cycle = now;
+        }
+    }
     COMMIT{ m_busyCycles++; }
     return SUCCESS;
 }
@@ -238,6 +258,7 @@ DDRChannel::DDRChannel(const std::string& name, Object& parent, Clock& clock)
       InitStorage(m_busy, clock, false),
       InitStateVariable(next_command, 0),
       InitStateVariable(next_precharge, 0),
+      InitStateVariable(sleep_cycle, INFINITE_CYCLES),
       m_traces(),
 
       InitProcess(p_Request, DoRequest),
@@ -251,7 +272,7 @@ DDRChannel::DDRChannel(const std::string& name, Object& parent, Clock& clock)
     RegisterStateVariable(m_request.size, "request.size");
     RegisterStateVariable(m_request.offset, "request.offset");
     RegisterStateArray(m_request.data.data, sizeof(m_request.data.data)/sizeof(m_request.data.data[0]), "request.data");
-    RegisterStateArray(m_request.data.mask, sizeof(m_request.data.mask)/sizeof(m_request.data.mask[0]), "request.mask");
+    RegisterStateObject(m_request.data.mask, "request.mask");
     RegisterStateVariable(m_request.done, "request.done");
 
     m_busy.Sensitive(p_Request);
@@ -148,6 +148,7 @@ private:
     Flag                       m_busy;           ///< Trigger for process
     DefineStateVariable(CycleNo, next_command);  ///< Minimum time for next command
     DefineStateVariable(CycleNo, next_precharge);///< Minimum time for next Row Precharge
+    DefineStateVariable(CycleNo, sleep_cycle);   ///< Cycle at which p_Pipeline went to sleep, INFINITE_CYCLES if awake
     TraceMap                   m_traces;         ///< Active traces
 
     // Processes
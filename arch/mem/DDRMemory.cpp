@@ -117,7 +117,7 @@ public:
             }
 
             COMMIT {
-                m_memory.Write(req.address, req.data.data, req.data.mask, m_lineSize);
+                m_memory.Write(req.address, req.data.data, &req.data.mask, m_lineSize);
 
                 ++m_nwrites;
             }
@@ -257,6 +257,8 @@ public:
 
         m_ddr->SetClient(*this, m_ddrStorageTraces, m_responses);
 
+        RegisterStateObject(m_activeRequests, "activeRequests");
+
         //p_Requests.SetStorageTraces(m_requests);
         //p_Responses.SetStorageTraces(sts);
     }
@@ -339,7 +341,7 @@ bool DDRMemory::Write(MCID id, MemAddr address, const MemData& data, WClientID w
     request.write     = true;
     COMMIT{
     std::copy(data.data, data.data + m_lineSize, request.data.data);
-    std::copy(data.mask, data.mask + m_lineSize, request.data.mask);
+    request.data.mask = data.mask;
     }
 
     // Broadcast the snoop data
@@ -42,6 +42,7 @@ class DDRMemory : public IMemory, public VirtualMemory
     using VirtualMemory::Write;
     bool Read (MCID id, MemAddr address) override;
     bool Write(MCID id, MemAddr address, const MemData& data, WClientID wid) override;
+    bool HasTimingState() const override { return true; }
 
     void GetMemoryStatistics(uint64_t& nreads, uint64_t& nwrites,
                              uint64_t& nread_bytes, uint64_t& nwrite_bytes,
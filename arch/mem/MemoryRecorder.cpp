@@ -0,0 +1,251 @@
+#include "MemoryRecorder.h"
+#include <sim/config.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+namespace Simulator
+{
+
+MemoryRecorder::MemoryRecorder(const string& name, Object& parent, IMemory& memory, const string& filename)
+    : Object(name, parent),
+      m_memory(memory),
+      m_filename(filename),
+      m_writer(filename),
+      m_clients(),
+      m_lineSize(GetTopConf("CacheLineSize", size_t)),
+      m_ring(),
+      m_ringMask(0),
+      m_head(0),
+      m_tail(0),
+      m_tailCache(0),
+      m_thread(),
+      m_stop(false),
+      m_failed(false),
+      m_error(),
+      InitSampleVariable(nrecords, SVC_CUMULATIVE),
+      InitSampleVariable(nstalls, SVC_CUMULATIVE)
+{
+    // Round the ring up to a power of two, so that positions can be
+    // masked instead of divided.
+    size_t size = max<size_t>(GetConf("BufferSize", size_t), 2);
+    size_t ringSize = 1;
+    while (ringSize < size)
+        ringSize <<= 1;
+    m_ring.resize(ringSize);
+    m_ringMask = ringSize - 1;
+
+    m_thread = thread(&MemoryRecorder::Drain, this);
+}
+
+MemoryRecorder::~MemoryRecorder()
+{
+    try
+    {
+        Close();
+    }
+    catch (const exception& e)
+    {
+        cerr << "Warning: memory trace " << m_filename << " is incomplete: " << e.what() << endl;
+    }
+}
+
+void MemoryRecorder::Close()
+{
+    if (!m_thread.joinable())
+        return;
+
+    m_stop.store(true, memory_order_release);
+    m_thread.join();
+    if (m_failed.load(memory_order_acquire))
+    {
+        rethrow_exception(m_error);
+    }
+
+    // The clients are only written at the end of the trace, so they
+    // can be declared now that the encoder is done.
+    for (size_t i = 0; i < m_clients.size(); ++i)
+    {
+        m_writer.RegisterClient(i, m_clients[i].grouped);
+    }
+    m_writer.Close();
+}
+
+// Runs on its own host thread: encodes the records between the tail
+// and the head of the ring, until Close() stops it.
+void MemoryRecorder::Drain()
+{
+    // Return records to the producer at least this often
+    const uint64_t batch = max<uint64_t>(m_ring.size() / 4, 1);
+    try
+    {
+        for (;;)
+        {
+            uint64_t tail = m_tail.load(memory_order_relaxed);
+            uint64_t head = m_head.load(memory_order_acquire);
+            if (tail == head)
+            {
+                if (m_stop.load(memory_order_acquire))
+                {
+                    // The last records may have been published just
+                    // before the stop
+                    if (m_head.load(memory_order_acquire) == tail)
+                        break;
+                    continue;
+                }
+                this_thread::sleep_for(chrono::microseconds(200));
+                continue;
+            }
+
+            head = min(head, tail + batch);
+            for (; tail != head; ++tail)
+            {
+                m_writer.Append(m_ring[tail & m_ringMask]);
+            }
+            m_tail.store(tail, memory_order_release);
+        }
+    }
+    catch (...)
+    {
+        m_error = current_exception();
+        m_failed.store(true, memory_order_release);
+    }
+}
+
+// Returns the ring slot for the next record, waiting for the encoder
+// if the ring is full.
+MemoryTraceRecord& MemoryRecorder::Reserve()
+{
+    const uint64_t head = m_head.load(memory_order_relaxed);
+    if (head - m_tailCache == m_ring.size())
+    {
+        m_tailCache = m_tail.load(memory_order_acquire);
+        if (head - m_tailCache == m_ring.size())
+        {
+            ++m_nstalls;
+            do
+            {
+                if (m_failed.load(memory_order_acquire))
+                {
+                    rethrow_exception(m_error);
+                }
+                this_thread::yield();
+                m_tailCache = m_tail.load(memory_order_acquire);
+            } while (head - m_tailCache == m_ring.size());
+        }
+    }
+    return m_ring[head & m_ringMask];
+}
+
+void MemoryRecorder::Publish()
+{
+    m_head.store(m_head.load(memory_order_relaxed) + 1, memory_order_release);
+    ++m_nrecords;
+}
+
+MCID MemoryRecorder::RegisterClient(IMemoryCallback& callback, Process& process, StorageTraceSet& traces, const StorageTraceSet& storages, bool grouped)
+{
+    // The clients are numbered in the trace in the order in which they
+    // register, which is the order in which players register them
+    // again on replay.
+    Client client;
+    client.id      = m_memory.RegisterClient(callback, process, traces, storages, grouped);
+    client.grouped = grouped;
+    m_clients.push_back(client);
+    return m_clients.size() - 1;
+}
+
+void MemoryRecorder::UnregisterClient(MCID id)
+{
+    assert(id < m_clients.size());
+    m_memory.UnregisterClient(m_clients[id].id);
+}
+
+bool MemoryRecorder::Read(MCID id, MemAddr address)
+{
+    if (!m_memory.Read(m_clients[id].id, address))
+    {
+        return false;
+    }
+
+    COMMIT
+    {
+        MemoryTraceRecord& rec = Reserve();
+        rec.cycle   = GetKernel()->GetCycleNo();
+        rec.client  = id;
+        rec.write   = false;
+        rec.address = address;
+        rec.size    = m_lineSize;
+        rec.mask    = LineMask::Range(0, m_lineSize);
+        Publish();
+    }
+    return true;
+}
+
+bool MemoryRecorder::Write(MCID id, MemAddr address, const MemData& data, WClientID wid)
+{
+    if (!m_memory.Write(m_clients[id].id, address, data, wid))
+    {
+        return false;
+    }
+
+    COMMIT
+    {
+        MemoryTraceRecord& rec = Reserve();
+        rec.cycle   = GetKernel()->GetCycleNo();
+        rec.client  = id;
+        rec.write   = true;
+        rec.address = address;
+        rec.size    = m_lineSize;
+        rec.mask    = data.mask;
+        Publish();
+    }
+    return true;
+}
+
+void MemoryRecorder::Initialize()
+{
+    m_memory.Initialize();
+}
+
+bool MemoryRecorder::HasCurrentContents() const
+{
+    return m_memory.HasCurrentContents();
+}
+
+bool MemoryRecorder::HasTimingState() const
+{
+    return m_memory.HasTimingState();
+}
+
+void MemoryRecorder::GetMemoryStatistics(uint64_t& nreads, uint64_t& nwrites,
+                                         uint64_t& nread_bytes, uint64_t& nwrite_bytes,
+                                         uint64_t& nreads_ext, uint64_t& nwrites_ext) const
+{
+    m_memory.GetMemoryStatistics(nreads, nwrites, nread_bytes, nwrite_bytes, nreads_ext, nwrites_ext);
+}
+
+void MemoryRecorder::Cmd_Info(ostream& out, const vector<string>& /*arguments*/) const
+{
+    out <<
+    "The recorder writes the requests of the memory clients to a memory\n"
+    "trace, which trace players can replay.\n\n"
+    "Supported operations:\n"
+    "- inspect <component>\n"
+    "  Shows the trace file and the number of records.\n";
+}
+
+void MemoryRecorder::Cmd_Read(ostream& out, const vector<string>& /*arguments*/) const
+{
+    const uint64_t head = m_head.load(memory_order_relaxed);
+    const uint64_t tail = m_tail.load(memory_order_relaxed);
+    out << "Trace file:       " << m_filename << endl
+        << "Clients:          " << m_clients.size() << endl
+        << "Records:          " << m_nrecords << endl
+        << "Waiting in ring:  " << (head - tail) << " of " << m_ring.size() << endl
+        << "Stalls:           " << m_nstalls << endl;
+}
+
+}
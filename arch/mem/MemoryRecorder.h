@@ -0,0 +1,93 @@
+// -*- c++ -*-
+#ifndef MEMORYRECORDER_H
+#define MEMORYRECORDER_H
+
+#include "MemoryTrace.h"
+
+#include <arch/Memory.h>
+#include <sim/kernel.h>
+#include <sim/inspect.h>
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace Simulator
+{
+
+// Records the requests that the memory clients (D-caches, I-caches and
+// DCAs) send to the memory into a memory trace, which a TracePlayer
+// can replay. The recorder sits between the clients and the memory:
+// it forwards every call and, when a request is accepted, adds a
+// record to a ring buffer. A host thread takes the records from the
+// ring and encodes them into the trace file, so that the simulation
+// only pays for copying the record.
+//
+// The ring has a single producer and a single consumer. The producer
+// is the simulation thread, which runs the processes one at a time.
+// If the ring is full, the producer waits for the consumer; this is
+// counted as a stall.
+class MemoryRecorder : public Object, public IMemory, public Inspect::Interface<Inspect::Info|Inspect::Read>
+{
+    struct Client
+    {
+        MCID id;        ///< ID of the client at the memory
+        bool grouped;
+    };
+
+    IMemory&                       m_memory;
+    std::string                    m_filename;
+    MemoryTraceWriter              m_writer;
+    std::vector<Client>            m_clients;
+    size_t                         m_lineSize;
+
+    // The ring buffer. m_head is only written by the producer and
+    // m_tail only by the consumer; both only ever increase.
+    std::vector<MemoryTraceRecord> m_ring;
+    size_t                         m_ringMask;
+    std::atomic<uint64_t>          m_head;      ///< Next record to write
+    std::atomic<uint64_t>          m_tail;      ///< Next record to encode
+    uint64_t                       m_tailCache; ///< Producer's copy of m_tail
+
+    std::thread                    m_thread;
+    std::atomic<bool>              m_stop;
+    std::atomic<bool>              m_failed;
+    std::exception_ptr             m_error;     ///< Set by the consumer when m_failed is set
+
+    DefineSampleVariable(uint64_t, nrecords);
+    DefineSampleVariable(uint64_t, nstalls);    ///< Records that waited for room in the ring
+
+    MemoryTraceRecord& Reserve();
+    void Publish();
+    void Drain();
+
+public:
+    MemoryRecorder(const std::string& name, Object& parent, IMemory& memory, const std::string& filename);
+    MemoryRecorder(const MemoryRecorder&) = delete;
+    MemoryRecorder& operator=(const MemoryRecorder&) = delete;
+    ~MemoryRecorder();
+
+    // Encodes the records that are left and completes the trace file.
+    // This is done by the destructor, but only Close() reports errors.
+    void Close();
+
+    // IMemory
+    MCID RegisterClient(IMemoryCallback& callback, Process& process, StorageTraceSet& traces, const StorageTraceSet& storages, bool grouped) override;
+    void UnregisterClient(MCID id) override;
+    bool Read (MCID id, MemAddr address) override;
+    bool Write(MCID id, MemAddr address, const MemData& data, WClientID wid) override;
+    void Initialize() override;
+    bool HasCurrentContents() const override;
+    bool HasTimingState() const override;
+    void GetMemoryStatistics(uint64_t& nreads, uint64_t& nwrites,
+                             uint64_t& nread_bytes, uint64_t& nwrite_bytes,
+                             uint64_t& nreads_ext, uint64_t& nwrites_ext) const override;
+
+    // Admin
+    void Cmd_Info(std::ostream& out, const std::vector<std::string>& arguments) const override;
+    void Cmd_Read(std::ostream& out, const std::vector<std::string>& arguments) const override;
+};
+
+}
+
+#endif
@@ -0,0 +1,458 @@
+#include "MemoryTrace.h"
+#include <sim/except.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+namespace Simulator
+{
+
+static const char     FILE_MAGIC[8]  = {'M','G','S','T','R','A','C','E'};
+static const char     END_MAGIC[8]   = {'M','G','S','T','R','E','N','D'};
+static const uint32_t FORMAT_VERSION = 1;
+static const uint32_t BLOCK_MAGIC    = 0x4b4c4254; // "TBLK"
+
+static const size_t FILE_HEADER_SIZE  = 16;
+static const size_t BLOCK_HEADER_SIZE = 24;
+static const size_t INDEX_ENTRY_SIZE  = 24;
+static const size_t TRAILER_SIZE      = 24;
+
+// Flags in the first field of a record
+static const unsigned REC_WRITE = 1;  ///< The record is a write
+static const unsigned REC_SIZE  = 2;  ///< The size differs from the previous record
+static const unsigned REC_MASK  = 4;  ///< The mask does not cover the whole line
+
+//
+// Encoding helpers
+//
+static void PutFixed(vector<char>& buf, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i, value >>= 8)
+        buf.push_back((char)(value & 0xff));
+}
+
+static uint64_t GetFixed(const char* p, size_t bytes)
+{
+    uint64_t value = 0;
+    for (size_t i = bytes; i > 0; --i)
+        value = (value << 8) | (unsigned char)p[i - 1];
+    return value;
+}
+
+static void PutVarint(vector<char>& buf, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buf.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    buf.push_back((char)value);
+}
+
+static uint64_t ZigZag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t UnZigZag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+//
+// MemoryTraceWriter
+//
+MemoryTraceWriter::MemoryTraceWriter(const string& filename, size_t blockRecords)
+    : m_filename(filename),
+      m_file(filename.c_str(), ios::out | ios::binary | ios::trunc),
+      m_blockRecords(blockRecords),
+      m_block(),
+      m_count(0),
+      m_first(0),
+      m_cycle(0),
+      m_size(0),
+      m_addresses(),
+      m_index(),
+      m_clients(),
+      m_offset(0)
+{
+    if (!m_file)
+    {
+        throw exceptf<IOException>("Unable to create memory trace %s: %s", filename.c_str(), strerror(errno));
+    }
+    assert(blockRecords > 0);
+
+    vector<char> header(FILE_MAGIC, FILE_MAGIC + sizeof FILE_MAGIC);
+    PutFixed(header, FORMAT_VERSION, 4);
+    PutFixed(header, 0, 4);
+    m_file.write(header.data(), header.size());
+    m_offset = header.size();
+}
+
+MemoryTraceWriter::~MemoryTraceWriter()
+{
+    try
+    {
+        Close();
+    }
+    catch (const IOException&)
+    {
+        // Nowhere to report this to
+    }
+}
+
+void MemoryTraceWriter::RegisterClient(MCID client, bool grouped)
+{
+    if (client >= m_clients.size())
+        m_clients.resize(client + 1, 0);
+    m_clients[client] = grouped ? TRACE_CLIENT_GROUPED : 0;
+}
+
+void MemoryTraceWriter::Append(const MemoryTraceRecord& rec)
+{
+    assert(m_file.is_open());
+
+    if (m_count == 0)
+    {
+        // Start a new block
+        m_first = m_cycle = rec.cycle;
+        m_size  = 0;
+        fill(m_addresses.begin(), m_addresses.end(), 0);
+    }
+    else if (rec.cycle < m_cycle)
+    {
+        throw exceptf<InvalidArgumentException>("Memory trace records out of order: cycle %llu after %llu",
+                                                (unsigned long long)rec.cycle, (unsigned long long)m_cycle);
+    }
+
+    if (rec.client >= m_addresses.size())
+        m_addresses.resize(rec.client + 1, 0);
+    if (rec.client >= m_clients.size())
+        m_clients.resize(rec.client + 1, 0);
+
+    unsigned flags = 0;
+    if (rec.write)
+    {
+        flags |= REC_WRITE;
+        if (rec.mask != LineMask::Range(0, rec.size))
+            flags |= REC_MASK;
+    }
+    if (rec.size != m_size)
+        flags |= REC_SIZE;
+
+    PutVarint(m_block, rec.cycle - m_cycle);
+    PutVarint(m_block, ((uint64_t)rec.client << 3) | flags);
+    if (flags & REC_SIZE)
+        PutVarint(m_block, rec.size);
+    PutVarint(m_block, ZigZag((int64_t)(rec.address - m_addresses[rec.client])));
+    if (flags & REC_MASK)
+        PutFixed(m_block, rec.mask.bits(), 8);
+
+    m_cycle = rec.cycle;
+    m_size  = rec.size;
+    m_addresses[rec.client] = rec.address;
+
+    if (++m_count == m_blockRecords)
+        FlushBlock();
+}
+
+void MemoryTraceWriter::FlushBlock()
+{
+    if (m_count == 0)
+        return;
+
+    vector<char> header;
+    PutFixed(header, BLOCK_MAGIC, 4);
+    PutFixed(header, m_count, 4);
+    PutFixed(header, m_block.size(), 4);
+    PutFixed(header, 0, 4);
+    PutFixed(header, m_first, 8);
+    m_file.write(header.data(), header.size());
+    m_file.write(m_block.data(), m_block.size());
+
+    m_index.push_back(BlockInfo{m_first, m_offset, m_count});
+    m_offset += header.size() + m_block.size();
+    m_block.clear();
+    m_count = 0;
+}
+
+void MemoryTraceWriter::Close()
+{
+    if (!m_file.is_open())
+        return;
+
+    FlushBlock();
+
+    vector<char> index;
+    for (const BlockInfo& b : m_index)
+    {
+        PutFixed(index, b.first, 8);
+        PutFixed(index, b.offset, 8);
+        PutFixed(index, b.count, 8);
+    }
+    PutFixed(index, m_clients.size(), 4);
+    index.insert(index.end(), m_clients.begin(), m_clients.end());
+
+    PutFixed(index, m_offset, 8);
+    PutFixed(index, m_index.size(), 8);
+    index.insert(index.end(), END_MAGIC, END_MAGIC + sizeof END_MAGIC);
+    m_file.write(index.data(), index.size());
+
+    m_file.close();
+    if (!m_file)
+    {
+        throw exceptf<IOException>("Unable to write memory trace %s", m_filename.c_str());
+    }
+}
+
+//
+// MemoryTraceReader
+//
+MemoryTraceReader::MemoryTraceReader(const string& filename)
+    : m_filename(filename),
+      m_file(filename.c_str(), ios::in | ios::binary),
+      m_index(),
+      m_clients(),
+      m_records(0),
+      m_next(0),
+      m_block(),
+      m_pos(0),
+      m_left(0),
+      m_cycle(0),
+      m_size(0),
+      m_addresses(),
+      m_peek(),
+      m_peeked(false)
+{
+    if (!m_file)
+    {
+        throw exceptf<FileNotFoundException>("Unable to open memory trace %s: %s", filename.c_str(), strerror(errno));
+    }
+
+    m_file.seekg(0, ios::end);
+    uint64_t fileSize = m_file.tellg();
+    m_file.seekg(0);
+
+    char header[FILE_HEADER_SIZE];
+    if (fileSize < FILE_HEADER_SIZE || !m_file.read(header, sizeof header) ||
+        memcmp(header, FILE_MAGIC, sizeof FILE_MAGIC) != 0)
+    {
+        throw exceptf<IOException>("%s is not a memory trace", filename.c_str());
+    }
+    if (GetFixed(header + 8, 4) != FORMAT_VERSION)
+    {
+        throw exceptf<IOException>("Memory trace %s has unsupported version %u",
+                                   filename.c_str(), (unsigned)GetFixed(header + 8, 4));
+    }
+
+    if (!ReadIndex(fileSize))
+    {
+        ScanBlocks(fileSize);
+    }
+
+    for (const BlockInfo& b : m_index)
+        m_records += b.count;
+}
+
+// Reads the index at the end of the file. Returns false if the file
+// has no valid trailer.
+bool MemoryTraceReader::ReadIndex(uint64_t fileSize)
+{
+    char trailer[TRAILER_SIZE];
+    if (fileSize < FILE_HEADER_SIZE + TRAILER_SIZE)
+        return false;
+    m_file.seekg(fileSize - TRAILER_SIZE);
+    if (!m_file.read(trailer, sizeof trailer) || memcmp(trailer + 16, END_MAGIC, sizeof END_MAGIC) != 0)
+    {
+        m_file.clear();
+        return false;
+    }
+
+    uint64_t offset = GetFixed(trailer, 8);
+    uint64_t blocks = GetFixed(trailer + 8, 8);
+    if (offset > fileSize - TRAILER_SIZE || blocks > (fileSize - TRAILER_SIZE - offset) / INDEX_ENTRY_SIZE)
+        return false;
+
+    vector<char> index(fileSize - TRAILER_SIZE - offset);
+    m_file.seekg(offset);
+    m_file.read(index.data(), index.size());
+    if (!m_file || index.size() < blocks * INDEX_ENTRY_SIZE + 4)
+    {
+        m_file.clear();
+        return false;
+    }
+
+    m_index.resize(blocks);
+    const char* p = index.data();
+    for (BlockInfo& b : m_index)
+    {
+        b.first  = GetFixed(p, 8);
+        b.offset = GetFixed(p + 8, 8);
+        b.count  = GetFixed(p + 16, 8);
+        p += INDEX_ENTRY_SIZE;
+    }
+
+    size_t clients = GetFixed(p, 4);
+    p += 4;
+    if ((size_t)(index.data() + index.size() - p) != clients)
+    {
+        m_index.clear();
+        return false;
+    }
+    m_clients.assign(p, p + clients);
+    return true;
+}
+
+// Builds the index by walking over the blocks, for a trace that was
+// not closed. The clients are found by decoding the records.
+void MemoryTraceReader::ScanBlocks(uint64_t fileSize)
+{
+    uint64_t offset = FILE_HEADER_SIZE;
+    while (offset + BLOCK_HEADER_SIZE <= fileSize)
+    {
+        char header[BLOCK_HEADER_SIZE];
+        m_file.seekg(offset);
+        if (!m_file.read(header, sizeof header) || GetFixed(header, 4) != BLOCK_MAGIC)
+            break;
+
+        uint64_t size = GetFixed(header + 8, 4);
+        if (offset + BLOCK_HEADER_SIZE + size > fileSize)
+            break;
+
+        m_index.push_back(BlockInfo{GetFixed(header + 16, 8), offset, GetFixed(header + 4, 4)});
+        offset += BLOCK_HEADER_SIZE + size;
+    }
+    m_file.clear();
+
+    MemoryTraceRecord rec;
+    while (Next(rec))
+    {
+        if (rec.client >= m_clients.size())
+            m_clients.resize(rec.client + 1, 0);
+    }
+    Seek(0);
+}
+
+bool MemoryTraceReader::LoadBlock(size_t index)
+{
+    if (index >= m_index.size())
+        return false;
+
+    const BlockInfo& b = m_index[index];
+    char header[BLOCK_HEADER_SIZE];
+    m_file.seekg(b.offset);
+    if (!m_file.read(header, sizeof header) || GetFixed(header, 4) != BLOCK_MAGIC || GetFixed(header + 4, 4) != b.count)
+    {
+        throw exceptf<IOException>("Corrupt block %zu in memory trace %s", index, m_filename.c_str());
+    }
+
+    m_block.resize(GetFixed(header + 8, 4));
+    if (!m_file.read(m_block.data(), m_block.size()))
+    {
+        throw exceptf<IOException>("Truncated block %zu in memory trace %s", index, m_filename.c_str());
+    }
+
+    m_next  = index + 1;
+    m_pos   = 0;
+    m_left  = b.count;
+    m_cycle = b.first;
+    m_size  = 0;
+    fill(m_addresses.begin(), m_addresses.end(), 0);
+    return true;
+}
+
+void MemoryTraceReader::Decode(MemoryTraceRecord& rec)
+{
+    const char* const end = m_block.data() + m_block.size();
+    const char*       p   = m_block.data() + m_pos;
+
+    auto varint = [&]() -> uint64_t {
+        uint64_t value = 0;
+        for (unsigned shift = 0; ; shift += 7)
+        {
+            if (p == end || shift > 63)
+            {
+                throw exceptf<IOException>("Corrupt record in block %zu of memory trace %s", m_next - 1, m_filename.c_str());
+            }
+            unsigned char c = *p++;
+            value |= (uint64_t)(c & 0x7f) << shift;
+            if (!(c & 0x80))
+                return value;
+        }
+    };
+
+    m_cycle += varint();
+    uint64_t first = varint();
+    unsigned flags = first & 7;
+    MCID client    = first >> 3;
+    if (flags & REC_SIZE)
+        m_size = varint();
+
+    if (client >= m_addresses.size())
+        m_addresses.resize(client + 1, 0);
+    m_addresses[client] += (MemAddr)UnZigZag(varint());
+
+    rec.cycle   = m_cycle;
+    rec.client  = client;
+    rec.write   = flags & REC_WRITE;
+    rec.address = m_addresses[client];
+    rec.size    = m_size;
+    rec.mask    = LineMask::Range(0, m_size);
+    if (flags & REC_MASK)
+    {
+        if (end - p < 8)
+        {
+            throw exceptf<IOException>("Corrupt record in block %zu of memory trace %s", m_next - 1, m_filename.c_str());
+        }
+        rec.mask = LineMask::Bits(GetFixed(p, 8));
+        p += 8;
+    }
+    m_pos = p - m_block.data();
+}
+
+bool MemoryTraceReader::Next(MemoryTraceRecord& rec)
+{
+    if (m_peeked)
+    {
+        rec = m_peek;
+        m_peeked = false;
+        return true;
+    }
+    while (m_left == 0)
+    {
+        if (!LoadBlock(m_next))
+            return false;
+    }
+    Decode(rec);
+    --m_left;
+    return true;
+}
+
+void MemoryTraceReader::Seek(CycleNo cycle)
+{
+    // Start at the last block that begins before the cycle; the
+    // records of the cycle may start at the end of that block.
+    auto it = lower_bound(m_index.begin(), m_index.end(), cycle,
+                          [](const BlockInfo& b, CycleNo c) { return b.first < c; });
+    m_next   = (it == m_index.begin()) ? 0 : (it - m_index.begin()) - 1;
+    m_left   = 0;
+    m_peeked = false;
+    if (cycle == 0)
+        return;
+
+    // Skip the records before the cycle, and keep the first one after
+    while (Next(m_peek))
+    {
+        if (m_peek.cycle >= cycle)
+        {
+            m_peeked = true;
+            break;
+        }
+    }
+}
+
+}
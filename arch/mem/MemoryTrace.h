@@ -0,0 +1,142 @@
+// -*- c++ -*-
+#ifndef MEMORYTRACE_H
+#define MEMORYTRACE_H
+
+#include <arch/Memory.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Simulator
+{
+
+// One request from a memory client to the memory system.
+struct MemoryTraceRecord
+{
+    CycleNo  cycle;    ///< Master cycle at which the request was issued
+    MCID     client;   ///< Client that issued the request
+    bool     write;    ///< Write or read
+    MemAddr  address;  ///< Address of the line
+    uint32_t size;     ///< Size of the line
+    LineMask mask;     ///< Bytes written, for writes
+};
+
+// A memory trace file holds records in cycle order. They are grouped
+// in blocks of a few thousand records; the fields of a record are
+// stored as variable-length differences from the previous record in
+// the block (the cycle) or the previous record of the same client in
+// the block (the address), which takes two to four bytes for most
+// records. Every block can be decoded on its own. An index at the end
+// of the file gives the first cycle and offset of every block, so
+// that a reader can start at any cycle, and the clients that were
+// registered with the memory.
+//
+// Layout, all integers little-endian:
+//   file header:   "MGSTRACE", u32 version, u32 0
+//   block:         u32 block magic, u32 records, u32 payload size,
+//                  u32 0, u64 first cycle, payload
+//   index:         per block: u64 first cycle, u64 offset, u64 records;
+//                  u32 clients; per client: u8 flags
+//   trailer:       u64 index offset, u64 blocks, "MGSTREND"
+//
+// A file without trailer, such as one left behind by a simulation
+// that did not finish, can still be read up to its last whole block.
+
+// The flags of a client in the index
+static const uint8_t TRACE_CLIENT_GROUPED = 1;  ///< Registered with grouped = true
+
+class MemoryTraceWriter
+{
+    struct BlockInfo
+    {
+        CycleNo  first;
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    std::string            m_filename;
+    std::ofstream          m_file;
+    const size_t           m_blockRecords;  ///< Records per block
+    std::vector<char>      m_block;         ///< Payload of the current block
+    size_t                 m_count;         ///< Records in the current block
+    CycleNo                m_first;         ///< First cycle of the current block
+    CycleNo                m_cycle;         ///< Cycle of the last record
+    uint32_t               m_size;          ///< Size of the last record in the block
+    std::vector<MemAddr>   m_addresses;     ///< Last address of every client in the block
+    std::vector<BlockInfo> m_index;
+    std::vector<uint8_t>   m_clients;       ///< Flags of every client
+    uint64_t               m_offset;        ///< Current file offset
+
+    void FlushBlock();
+
+public:
+    // Declares a client of the traced memory. Clients that do not
+    // appear here but in records are not grouped.
+    void RegisterClient(MCID client, bool grouped);
+
+    // Adds a record. Records must be added in cycle order.
+    void Append(const MemoryTraceRecord& rec);
+
+    // Writes the last block and the index. This is done by the
+    // destructor, but only Close() reports errors.
+    void Close();
+
+    MemoryTraceWriter(const std::string& filename, size_t blockRecords = 4096);
+    MemoryTraceWriter(const MemoryTraceWriter&) = delete;
+    MemoryTraceWriter& operator=(const MemoryTraceWriter&) = delete;
+    ~MemoryTraceWriter();
+};
+
+class MemoryTraceReader
+{
+    struct BlockInfo
+    {
+        CycleNo  first;
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    std::string            m_filename;
+    std::ifstream          m_file;
+    std::vector<BlockInfo> m_index;
+    std::vector<uint8_t>   m_clients;    ///< Flags of every client
+    uint64_t               m_records;    ///< Number of records in the file
+
+    // Decoding state
+    size_t                 m_next;       ///< Next block to load
+    std::vector<char>      m_block;      ///< Payload of the current block
+    size_t                 m_pos;        ///< Position in m_block
+    size_t                 m_left;       ///< Records left in the current block
+    CycleNo                m_cycle;
+    uint32_t               m_size;
+    std::vector<MemAddr>   m_addresses;
+    MemoryTraceRecord      m_peek;       ///< Record read ahead by Seek()
+    bool                   m_peeked;     ///< Whether m_peek is valid
+
+    bool ReadIndex(uint64_t fileSize);
+    void ScanBlocks(uint64_t fileSize);
+    bool LoadBlock(size_t index);
+    void Decode(MemoryTraceRecord& rec);
+
+public:
+    // Reads the next record. Returns false at the end of the trace.
+    bool Next(MemoryTraceRecord& rec);
+
+    // Continues reading at the first record at or after the cycle.
+    void Seek(CycleNo cycle);
+
+    size_t   GetNumClients()  const { return m_clients.size(); }
+    bool     IsGrouped(MCID client) const { return m_clients[client] & TRACE_CLIENT_GROUPED; }
+    uint64_t GetNumRecords()  const { return m_records; }
+    size_t   GetNumBlocks()   const { return m_index.size(); }
+    CycleNo  GetFirstCycle()  const { return m_index.empty() ? 0 : m_index.front().first; }
+
+    MemoryTraceReader(const std::string& filename);
+    MemoryTraceReader(const MemoryTraceReader&) = delete;
+    MemoryTraceReader& operator=(const MemoryTraceReader&) = delete;
+};
+
+}
+
+#endif
@@ -41,7 +41,7 @@ class ParallelMemory::Port : public Object
             // The current request has completed
             if (request.write)
             {
-                static_cast<VirtualMemory&>(m_memory).Write(request.address, request.data.data, request.data.mask, m_lineSize);
+                static_cast<VirtualMemory&>(m_memory).Write(request.address, request.data.data, &request.data.mask, m_lineSize);
 
                 if (!m_callback.OnMemoryWriteCompleted(request.wid))
                 {
@@ -121,7 +121,7 @@ public:
         return m_requests.Push(std::move(request));
     }
 
-    bool OnMemorySnooped(MemAddr address, const char * data, const bool * mask)
+    bool OnMemorySnooped(MemAddr address, const char * data, const LineMask& mask)
     {
         return m_callback.OnMemorySnooped(address, data, mask);
     }
@@ -206,7 +206,7 @@ bool ParallelMemory::Write(MCID id, MemAddr address, const MemData& data, WClien
     request.write     = true;
     COMMIT{
     std::copy(data.data, data.data + m_lineSize, request.data.data);
-    std::copy(data.mask, data.mask + m_lineSize, request.data.mask);
+    request.data.mask = data.mask;
     }
 
     // Broadcast the snoop data
@@ -75,7 +75,7 @@ bool SerialMemory::Write(MCID id, MemAddr address, const MemData& data, WClientI
     request.write     = true;
     COMMIT{
     std::copy(data.data, data.data + m_lineSize, request.data.data);
-    std::copy(data.mask, data.mask + m_lineSize, request.data.mask);
+    request.data.mask = data.mask;
     }
 
     if (!m_requests.Push(std::move(request)))
@@ -110,7 +110,7 @@ Result SerialMemory::DoRequests()
             // The current request has completed
             if (request.write) {
 
-                VirtualMemory::Write(request.address, request.data.data, request.data.mask, m_lineSize);
+                VirtualMemory::Write(request.address, request.data.data, &request.data.mask, m_lineSize);
 
                 if (!m_clients[request.client]->OnMemoryWriteCompleted(request.wid))
                 {
@@ -0,0 +1,375 @@
+#include "TracePlayer.h"
+#include <sim/config.h>
+
+#include <algorithm>
+#include <iomanip>
+
+using namespace std;
+
+namespace Simulator
+{
+
+//
+// TraceFeed
+//
+TraceFeed::TraceFeed(const string& filename, CycleNo start)
+    : m_reader(filename),
+      m_queues(m_reader.GetNumClients()),
+      m_start(start)
+{
+    m_reader.Seek(start);
+}
+
+const MemoryTraceRecord* TraceFeed::Peek(MCID client)
+{
+    if (client >= m_queues.size())
+        m_queues.resize(client + 1);
+
+    MemoryTraceRecord rec;
+    while (m_queues[client].empty() && m_reader.Next(rec))
+    {
+        if (rec.client >= m_queues.size())
+            m_queues.resize(rec.client + 1);
+        m_queues[rec.client].push_back(rec);
+    }
+    return m_queues[client].empty() ? NULL : &m_queues[client].front();
+}
+
+void TraceFeed::Pop(MCID client)
+{
+    assert(client < m_queues.size() && !m_queues[client].empty());
+    m_queues[client].pop_front();
+}
+
+//
+// TracePlayer
+//
+TracePlayer::TracePlayer(const string& name, Object& parent, Clock& clock, TraceFeed& feed, MCID client)
+    : Object(name, parent),
+      m_clock(clock),
+      m_memory(NULL),
+      m_mcid(0),
+      m_feed(feed),
+      m_client(client),
+      m_lineSize(GetTopConf("CacheLineSize", size_t)),
+      m_maxOutstanding(GetConf("MaxOutstanding", size_t)),
+      m_timed(GetConf("Timed", bool)),
+      m_outstanding(0),
+      m_nextWid(0),
+      m_lastIssue(0),
+      m_lastRecorded(0),
+      m_reads(),
+      m_writes(),
+      InitStorage(m_ready, clock, true),
+      InitBuffer(m_responses, clock, "ResponseBufferSize"),
+      InitProcess(p_Requests, DoRequests),
+      InitProcess(p_Responses, DoResponses),
+      InitSampleVariable(nreads, SVC_CUMULATIVE),
+      InitSampleVariable(nread_bytes, SVC_CUMULATIVE),
+      InitSampleVariable(nwrites, SVC_CUMULATIVE),
+      InitSampleVariable(nwrite_bytes, SVC_CUMULATIVE),
+      InitSampleVariable(read_latency, SVC_CUMULATIVE),
+      InitSampleVariable(write_latency, SVC_CUMULATIVE),
+      InitSampleVariable(max_read_latency, SVC_WATERMARK),
+      InitSampleVariable(max_write_latency, SVC_WATERMARK),
+      InitSampleVariable(first_cycle, SVC_LEVEL),
+      InitSampleVariable(last_cycle, SVC_LEVEL)
+{
+    if (m_maxOutstanding == 0)
+    {
+        throw exceptf<InvalidArgumentException>(*this, "MaxOutstanding must be at least 1");
+    }
+
+    m_ready    .Sensitive(p_Requests);
+    m_responses.Sensitive(p_Responses);
+    p_Responses.SetStorageTraces(opt(m_ready));
+
+    m_reads.reserve(m_maxOutstanding);
+    m_writes.reserve(m_maxOutstanding);
+
+    RegisterModelObject(*this, "player");
+}
+
+void TracePlayer::ConnectMemory(IMemory* memory)
+{
+    assert(m_memory == NULL);
+    assert(memory != NULL);
+
+    m_memory = memory;
+    StorageTraceSet traces;
+    m_mcid = m_memory->RegisterClient(*this, p_Requests, traces, opt(m_responses), m_feed.IsGrouped(m_client));
+    p_Requests.SetStorageTraces(opt(traces ^ m_ready));
+}
+
+TracePlayer::~TracePlayer()
+{
+    if (m_memory != NULL)
+        m_memory->UnregisterClient(m_mcid);
+}
+
+bool TracePlayer::OnMemoryReadCompleted(MemAddr addr, const char* /*data*/)
+{
+    // Some memories send read completions to all clients that share
+    // a cache; ignore the lines that we are not reading.
+    if (m_reads.count(addr) == 0)
+    {
+        return true;
+    }
+
+    Response response;
+    response.write   = false;
+    response.address = addr;
+    response.wid     = 0;
+    if (!m_responses.Push(response))
+    {
+        DeadlockWrite("Unable to buffer read completion for %#016llx", (unsigned long long)addr);
+        return false;
+    }
+    return true;
+}
+
+bool TracePlayer::OnMemoryWriteCompleted(WClientID wid)
+{
+    Response response;
+    response.write   = true;
+    response.address = 0;
+    response.wid     = wid;
+    if (!m_responses.Push(response))
+    {
+        DeadlockWrite("Unable to buffer write completion for %u", (unsigned)wid);
+        return false;
+    }
+    return true;
+}
+
+bool TracePlayer::OnMemoryInvalidated(MemAddr /*addr*/)
+{
+    return true;
+}
+
+Object& TracePlayer::GetMemoryPeer()
+{
+    return *this;
+}
+
+// Accounts for the requests completed by a response, and returns
+// their number.
+size_t TracePlayer::Complete(const Response& response)
+{
+    const CycleNo now = m_clock.GetCycleNo();
+
+    if (response.write)
+    {
+        auto p = m_writes.find(response.wid);
+        if (p == m_writes.end())
+        {
+            return 0;
+        }
+
+        COMMIT {
+            CycleNo latency = now - p->second;
+            m_write_latency += latency;
+            m_max_write_latency = max(m_max_write_latency, latency);
+            m_last_cycle = now;
+            m_writes.erase(response.wid);
+        }
+        return 1;
+    }
+
+    auto p = m_reads.find(response.address);
+    if (p == m_reads.end())
+    {
+        // Completed by an earlier response to the same line
+        return 0;
+    }
+
+    size_t count = p->second.count;
+    COMMIT {
+        m_read_latency += count * now - p->second.total;
+        m_max_read_latency = max(m_max_read_latency, now - p->second.first);
+        m_last_cycle = now;
+        m_reads.erase(response.address);
+    }
+    return count;
+}
+
+Result TracePlayer::DoResponses()
+{
+    assert(!m_responses.Empty());
+
+    size_t count = Complete(m_responses.Front());
+    m_responses.Pop();
+
+    // Requests can be issued again, unless we are done
+    if (count > 0 && m_feed.Peek(m_client) != NULL && !m_ready.Set())
+    {
+        return FAILED;
+    }
+
+    COMMIT { m_outstanding -= count; }
+    return SUCCESS;
+}
+
+Result TracePlayer::DoRequests()
+{
+    const MemoryTraceRecord* rec = m_feed.Peek(m_client);
+    if (rec == NULL || m_outstanding >= m_maxOutstanding)
+    {
+        // Nothing to issue until a request completes
+        if (!m_ready.Clear())
+        {
+            return FAILED;
+        }
+        return SUCCESS;
+    }
+
+    const CycleNo now = GetKernel()->GetCycleNo();
+    if (m_timed)
+    {
+        const CycleNo start = m_feed.GetStartCycle();
+        const CycleNo due   = (m_nwrites + m_nreads == 0)
+            ? (rec->cycle > start ? rec->cycle - start : 0)
+            : m_lastIssue + (rec->cycle - m_lastRecorded);
+        if (now < due)
+        {
+            COMMIT {
+                const CycleNo period = GetKernel()->GetMasterFrequency() / m_clock.GetFrequency();
+                GetKernel()->GetActiveClock()->SleepProcess(p_Requests, (due + period - 1) / period);
+            }
+            return SUCCESS;
+        }
+    }
+
+    if (rec->size != m_lineSize || rec->address % m_lineSize != 0)
+    {
+        throw exceptf<InvalidArgumentException>(*this, "Request of %u bytes at %#016llx does not match the cache line size of %zu bytes",
+                                                (unsigned)rec->size, (unsigned long long)rec->address, m_lineSize);
+    }
+
+    const CycleNo cycle = m_clock.GetCycleNo();
+    if (rec->write)
+    {
+        // The trace does not record the data, so zeroes are written.
+        // The request is built in every phase, since the memory may
+        // look at it before it accepts it.
+        MemData data = MemData();
+        data.mask = rec->mask;
+        if (!m_memory->Write(m_mcid, rec->address, data, m_nextWid))
+        {
+            DeadlockWrite("Unable to send write to %#016llx to memory", (unsigned long long)rec->address);
+            return FAILED;
+        }
+
+        COMMIT {
+            m_writes[m_nextWid++] = cycle;
+            ++m_nwrites;
+            m_nwrite_bytes += rec->mask.count();
+        }
+    }
+    else
+    {
+        if (!m_memory->Read(m_mcid, rec->address))
+        {
+            DeadlockWrite("Unable to send read from %#016llx to memory", (unsigned long long)rec->address);
+            return FAILED;
+        }
+
+        COMMIT {
+            PendingRead& pending = m_reads[rec->address];
+            if (pending.count == 0)
+                pending.first = cycle;
+            pending.total += cycle;
+            pending.count++;
+            ++m_nreads;
+            m_nread_bytes += rec->size;
+        }
+    }
+
+    COMMIT {
+        if (m_nreads + m_nwrites == 1)
+            m_first_cycle = cycle;
+        ++m_outstanding;
+        m_lastIssue    = now;
+        m_lastRecorded = rec->cycle;
+        m_feed.Pop(m_client);
+    }
+    return SUCCESS;
+}
+
+bool TracePlayer::IsDone() const
+{
+    return m_outstanding == 0 && m_responses.Empty() && !m_ready.IsSet();
+}
+
+void TracePlayer::GetStatistics(uint64_t& nreads, uint64_t& nwrites, uint64_t& nbytes,
+                                uint64_t& latency, CycleNo& max_latency,
+                                CycleNo& first, CycleNo& last) const
+{
+    nreads      = m_nreads;
+    nwrites     = m_nwrites;
+    nbytes      = m_nread_bytes + m_nwrite_bytes;
+    latency     = m_read_latency + m_write_latency;
+    max_latency = max(m_max_read_latency, m_max_write_latency);
+    first       = m_first_cycle;
+    last        = m_last_cycle;
+}
+
+void TracePlayer::Cmd_Info(ostream& out, const vector<string>& /*arguments*/) const
+{
+    out <<
+    "The trace player replays the memory requests of one client from a\n"
+    "memory trace, and measures their latency.\n\n"
+    "Supported operations:\n"
+    "- inspect <component>\n"
+    "  Shows the settings, the requests in flight and the statistics.\n";
+}
+
+void TracePlayer::Cmd_Read(ostream& out, const vector<string>& /*arguments*/) const
+{
+    out << "Trace client:    " << m_client << endl
+        << "Memory client:   " << m_mcid << endl
+        << "Timed:           " << (m_timed ? "yes" : "no") << endl
+        << "Max outstanding: " << m_maxOutstanding << endl
+        << "Outstanding:     " << m_outstanding << endl
+        << endl;
+
+    if (!m_reads.empty())
+    {
+        // Show the lines in order
+        vector<pair<MemAddr, PendingRead> > reads(m_reads.begin(), m_reads.end());
+        sort(reads.begin(), reads.end(), [](const pair<MemAddr, PendingRead>& a, const pair<MemAddr, PendingRead>& b) { return a.first < b.first; });
+
+        out << "Reads in flight:" << endl;
+        for (auto& r : reads)
+        {
+            out << "  " << hex << setfill('0') << setw(16) << r.first << dec << setfill(' ')
+                << " x" << r.second.count << ", since cycle " << r.second.first << endl;
+        }
+        out << endl;
+    }
+
+    if (!m_writes.empty())
+    {
+        vector<pair<WClientID, CycleNo> > writes(m_writes.begin(), m_writes.end());
+        sort(writes.begin(), writes.end());
+
+        out << "Writes in flight:" << endl;
+        for (auto& w : writes)
+        {
+            out << "  wid " << w.first << ", since cycle " << w.second << endl;
+        }
+        out << endl;
+    }
+
+    const CycleNo span = m_last_cycle > m_first_cycle ? m_last_cycle - m_first_cycle : 0;
+    out << "Reads:  " << m_nreads << " (" << m_nread_bytes << " bytes), average latency "
+        << fixed << setprecision(2) << (m_nreads ? (double)m_read_latency / m_nreads : 0.)
+        << ", max " << m_max_read_latency << endl
+        << "Writes: " << m_nwrites << " (" << m_nwrite_bytes << " bytes), average latency "
+        << (m_nwrites ? (double)m_write_latency / m_nwrites : 0.)
+        << ", max " << m_max_write_latency << endl
+        << "Bandwidth: " << (span ? (double)(m_nread_bytes + m_nwrite_bytes) / span : 0.)
+        << " bytes/cycle over cycles " << m_first_cycle << "-" << m_last_cycle << endl;
+}
+
+}
@@ -0,0 +1,143 @@
+// -*- c++ -*-
+#ifndef TRACEPLAYER_H
+#define TRACEPLAYER_H
+
+#include "MemoryTrace.h"
+
+#include <arch/Memory.h>
+#include <sim/kernel.h>
+#include <sim/inspect.h>
+#include <sim/buffer.h>
+#include <sim/flag.h>
+#include <sim/flatmap.h>
+
+#include <deque>
+
+namespace Simulator
+{
+
+// Reads a memory trace for a set of players and gives every player
+// the records of its client, in order. Records are read ahead until
+// the requested client has one, so players that are far behind the
+// others keep the records in between in memory.
+class TraceFeed
+{
+    MemoryTraceReader                           m_reader;
+    std::vector<std::deque<MemoryTraceRecord> > m_queues;  ///< Records read ahead, per client
+    CycleNo                                     m_start;   ///< First cycle that is replayed
+
+public:
+    // Returns the next record of the client, or NULL at the end.
+    const MemoryTraceRecord* Peek(MCID client);
+    void Pop(MCID client);
+
+    size_t  GetNumClients() const { return m_queues.size(); }
+    // The first client cannot be grouped, since there is no client
+    // before it to group it with.
+    bool    IsGrouped(MCID client) const { return client > 0 && client < m_reader.GetNumClients() && m_reader.IsGrouped(client); }
+    CycleNo GetStartCycle() const { return m_start; }
+    const MemoryTraceReader& GetReader() const { return m_reader; }
+
+    // Opens the trace and skips the records before the start cycle.
+    TraceFeed(const std::string& filename, CycleNo start);
+    TraceFeed(const TraceFeed&) = delete;
+    TraceFeed& operator=(const TraceFeed&) = delete;
+};
+
+// Replays the requests of one client from a memory trace into a memory
+// system, in place of the component that made them, and measures the
+// latency of the requests.
+//
+// With Timed set, a request is issued no earlier than the recorded
+// time since the previous request of the client, so a player that
+// does not stall reproduces the recorded timing. Otherwise requests
+// are issued as fast as the memory accepts them. At most
+// MaxOutstanding requests are in flight; with 1, every request waits
+// for the previous one, like a chain of dependent loads.
+class TracePlayer : public Object, public IMemoryCallback, public Inspect::Interface<Inspect::Info|Inspect::Read>
+{
+    struct Response
+    {
+        bool      write;
+        MemAddr   address;  ///< Line, for reads
+        WClientID wid;      ///< Write, for writes
+        SERIALIZE(a) { a & write & address & wid; }
+    };
+
+    // Reads in flight to a line. The memory completes them together.
+    struct PendingRead
+    {
+        CycleNo  first;     ///< Issue cycle of the oldest read
+        CycleNo  total;     ///< Sum of the issue cycles
+        unsigned count;     ///< Number of reads
+    };
+
+    Clock&                          m_clock;
+    IMemory*                        m_memory;
+    MCID                            m_mcid;
+    TraceFeed&                      m_feed;
+    MCID                            m_client;          ///< Client in the trace
+    size_t                          m_lineSize;
+    size_t                          m_maxOutstanding;
+    bool                            m_timed;
+
+    size_t                          m_outstanding;     ///< Requests in flight
+    WClientID                       m_nextWid;
+    CycleNo                         m_lastIssue;       ///< Master cycle of the last request
+    CycleNo                         m_lastRecorded;    ///< Recorded cycle of the last request
+    FlatMap<MemAddr, PendingRead>   m_reads;
+    FlatMap<WClientID, CycleNo>     m_writes;          ///< Issue cycles of the writes in flight
+
+    Flag                            m_ready;           ///< Set while requests can be issued
+    Buffer<Response>                m_responses;
+
+    Process                         p_Requests;
+    Process                         p_Responses;
+
+    // Statistics, in cycles of the player's clock
+    DefineSampleVariable(uint64_t, nreads);
+    DefineSampleVariable(uint64_t, nread_bytes);
+    DefineSampleVariable(uint64_t, nwrites);
+    DefineSampleVariable(uint64_t, nwrite_bytes);
+    DefineSampleVariable(uint64_t, read_latency);      ///< Sum of the read latencies
+    DefineSampleVariable(uint64_t, write_latency);     ///< Sum of the write latencies
+    DefineSampleVariable(CycleNo,  max_read_latency);
+    DefineSampleVariable(CycleNo,  max_write_latency);
+    DefineSampleVariable(CycleNo,  first_cycle);       ///< First request
+    DefineSampleVariable(CycleNo,  last_cycle);        ///< Last completion
+
+    size_t Complete(const Response& response);
+
+    Result DoRequests();
+    Result DoResponses();
+
+public:
+    TracePlayer(const std::string& name, Object& parent, Clock& clock, TraceFeed& feed, MCID client);
+    TracePlayer(const TracePlayer&) = delete;
+    TracePlayer& operator=(const TracePlayer&) = delete;
+    ~TracePlayer();
+
+    void ConnectMemory(IMemory* memory);
+
+    // Whether all requests have been issued and completed
+    bool IsDone() const;
+
+    // Totals of the statistics, for the reports
+    void GetStatistics(uint64_t& nreads, uint64_t& nwrites, uint64_t& nbytes,
+                       uint64_t& latency, CycleNo& max_latency,
+                       CycleNo& first, CycleNo& last) const;
+
+    // IMemoryCallback
+    bool OnMemoryReadCompleted(MemAddr addr, const char* data) override;
+    bool OnMemoryWriteCompleted(WClientID wid) override;
+    bool OnMemoryInvalidated(MemAddr addr) override;
+    Object& GetMemoryPeer() override;
+
+    // Admin
+    void Cmd_Info(std::ostream& out, const std::vector<std::string>& arguments) const override;
+    void Cmd_Read(std::ostream& out, const std::vector<std::string>& arguments) const override;
+};
+
+}
+
+#endif
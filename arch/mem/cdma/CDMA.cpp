@@ -102,24 +102,34 @@ void CDMA::UnregisterClient(MCID id)
 
 bool CDMA::Read(MCID id, MemAddr address)
 {
+    // Forward the read to the cache associated with the callback
+    if (!m_clientMap[id].first->Read(m_clientMap[id].second, address))
+    {
+        return false;
+    }
+
     COMMIT
     {
         m_nreads++;
         m_nread_bytes += m_lineSize;
     }
-    // Forward the read to the cache associated with the callback
-    return m_clientMap[id].first->Read(m_clientMap[id].second, address);
+    return true;
 }
 
 bool CDMA::Write(MCID id, MemAddr address, const MemData& data, WClientID wid)
 {
+    // Forward the write to the cache associated with the callback
+    if (!m_clientMap[id].first->Write(m_clientMap[id].second, address, data, wid))
+    {
+        return false;
+    }
+
     COMMIT
     {
         m_nwrites++;
         m_nwrite_bytes += m_lineSize;
     }
-    // Forward the write to the cache associated with the callback
-    return m_clientMap[id].first->Write(m_clientMap[id].second, address, data, wid);
+    return true;
 }
 
 // Note that the CDMA class is just a container for caches and directories.
@@ -137,6 +147,7 @@ CDMA::CDMA(const std::string& name, Simulator::Object& parent, Clock& clock)
     m_traces(),
     m_ddr("ddr", *this, GetConf("NumRootDirectories", size_t)),
     m_clientMap(),
+    m_pool(new MessagePool),
     InitSampleVariable(nreads, SVC_CUMULATIVE), InitSampleVariable(nwrites, SVC_CUMULATIVE), InitSampleVariable(nread_bytes, SVC_CUMULATIVE), InitSampleVariable(nwrite_bytes, SVC_CUMULATIVE)
 {
 
@@ -287,6 +298,8 @@ CDMA::~CDMA()
 
     for (auto r : m_roots)
         delete r;
+
+    delete m_pool;
 }
 
 void CDMA::GetMemoryStatistics(uint64_t& nreads, uint64_t& nwrites, uint64_t& nread_bytes, uint64_t& nwrite_bytes, uint64_t& nreads_ext, uint64_t& nwrites_ext) const
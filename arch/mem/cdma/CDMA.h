@@ -25,6 +25,7 @@ public:
     class Directory;
     class RootDirectory;
     class Cache;
+    struct MessagePool;
 
     // A simple base class for all CDMA objects. It keeps track of what
     // CDMA memory it's in.
@@ -55,6 +56,7 @@ protected:
     DDRChannelRegistry          m_ddr;                ///< List of DDR channels
 
     std::vector<std::pair<Cache*,MCID> > m_clientMap; ///< Mapping of MCID to caches
+    MessagePool*                m_pool;               ///< Arenas for the messages on the rings
 
     DefineSampleVariable(uint64_t, nreads);
     DefineSampleVariable(uint64_t, nwrites);
@@ -92,6 +94,8 @@ public:
     using VirtualMemory::Write;
     bool Read (MCID id, MemAddr address) override;
     bool Write(MCID id, MemAddr address, const MemData& data, WClientID wid) override;
+    bool HasCurrentContents() const override { return false; }
+    bool HasTimingState() const override { return true; }
 
     void GetMemoryStatistics(uint64_t& nreads, uint64_t& nwrites,
                              uint64_t& nread_bytes, uint64_t& nwrite_bytes,
@@ -97,7 +97,7 @@ bool CDMA::Cache::Write(MCID id, MemAddr address, const MemData& data, WClientID
     req.wid     = wid;
     COMMIT{
     std::copy(data.data, data.data + m_lineSize, req.mdata.data);
-    std::copy(data.mask, data.mask + m_lineSize, req.mdata.mask);
+    req.mdata.mask = data.mask;
     }
 
     // Client should have been registered
@@ -136,14 +136,12 @@ CDMA::Cache::Line* CDMA::Cache::FindLine(MemAddr address)
     const size_t  set  = setindex * m_assoc;
 
     // Find the line
-    for (size_t i = 0; i < m_assoc; ++i)
+    const size_t way = m_tags.Find(setindex, tag, [this](size_t i) { return m_lines[i].state != LINE_EMPTY; });
+    if (way < m_assoc)
     {
-        Line& line = m_lines[set + i];
-        if (line.state != LINE_EMPTY && line.tag == tag)
-        {
-            // The wanted line was in the cache
-            return &line;
-        }
+        // The wanted line was in the cache
+        assert(m_lines[set + way].tag == tag);
+        return &m_lines[set + way];
     }
     return NULL;
 }
@@ -205,14 +203,13 @@ bool CDMA::Cache::EvictLine(Line* line, const Request& req)
     Message* msg = NULL;
     COMMIT
     {
-        msg = new Message;
-        msg->type      = Message::EVICTION;
+        msg = NewMessage(Message::EVICTION);
         msg->address   = address;
         msg->ignore    = false;
         msg->sender    = GetNodeID();
         msg->tokens    = line->tokens;
         msg->dirty     = line->dirty;
-        std::copy(line->data, line->data + m_lineSize, msg->data.data);
+        std::copy(line->data, line->data + m_lineSize, msg->data->data);
     }
 
     if (!SendMessage(msg, MINSPACE_INSERTION))
@@ -290,7 +287,8 @@ bool CDMA::Cache::OnMessageReceived(Message* msg)
                     msg->type   = Message::REQUEST_DATA_TOKEN;
                     msg->tokens = 1;
                     msg->dirty  = line->dirty;
-                    std::copy(line->data, line->data + m_lineSize, msg->data.data);
+                    AttachData(msg);
+                    std::copy(line->data, line->data + m_lineSize, msg->data->data);
 
                     line->tokens -= msg->tokens;
 
@@ -307,7 +305,8 @@ bool CDMA::Cache::OnMessageReceived(Message* msg)
                 {
                     msg->type  = Message::REQUEST_DATA;
                     msg->dirty = line->dirty;
-                    std::copy(line->data, line->data + m_lineSize, msg->data.data);
+                    AttachData(msg);
+                    std::copy(line->data, line->data + m_lineSize, msg->data->data);
                 }
             }
 
@@ -342,11 +341,11 @@ bool CDMA::Cache::OnMessageReceived(Message* msg)
             // Update the message. This will ensure the response
             // gets the latest value, and other processors too
             // (which is fine, according to non-determinism).
-            line::blit(msg->data.data, line->data, line->valid, m_lineSize);
+            line::blit(msg->data->data, line->data, line->valid, m_lineSize);
 
             // Store the data, masked by the already-valid bitmask
-            line::blitnot(line->data, msg->data.data, line->valid, m_lineSize);
-            line::setifnot(line->valid, true, line->valid, m_lineSize);
+            line::blitnot(line->data, msg->data->data, line->valid, m_lineSize);
+            line->valid = LineMask::Range(0, m_lineSize);
 
             line->state  = LINE_FULL;
             line->tokens = msg->tokens;
@@ -364,7 +363,7 @@ bool CDMA::Cache::OnMessageReceived(Message* msg)
 
         COMMIT
         {
-            std::copy(msg->data.data, msg->data.data + m_lineSize, data);
+            std::copy(msg->data->data, msg->data->data + m_lineSize, data);
 
             for (auto& p : m_requests)
             {
@@ -386,7 +385,7 @@ bool CDMA::Cache::OnMessageReceived(Message* msg)
         // Statistics
         COMMIT{ ++m_numRCompletions; }
 
-        COMMIT{ delete msg; }
+        COMMIT{ FreeMessage(msg); }
         break;
     }
 
@@ -407,7 +406,7 @@ bool CDMA::Cache::OnMessageReceived(Message* msg)
                     // Combine the dirty flags
                     line->dirty = line->dirty || msg->dirty;
 
-                    delete msg;
+                    FreeMessage(msg);
 
                     // Statistics
                     ++m_numMergedEvictions;
@@ -428,14 +427,15 @@ bool CDMA::Cache::OnMessageReceived(Message* msg)
                 {
                     line->state    = LINE_FULL;
                     line->tag      = tag;
+                    m_tags[line - &m_lines[0]] = tag;
                     line->tokens   = msg->tokens;
                     line->dirty    = msg->dirty;
                     line->updating = 0;
                     line->access   = GetKernel()->GetCycleNo();
-                    std::fill(line->valid, line->valid + m_lineSize, true);
-                    std::copy(msg->data.data, msg->data.data + m_lineSize, line->data);
+                    line->valid    = LineMask::Range(0, m_lineSize);
+                    std::copy(msg->data->data, msg->data->data + m_lineSize, line->data);
 
-                    delete msg;
+                    FreeMessage(msg);
 
                     // Statistics
                     ++m_numInjectedEvictions;
@@ -472,7 +472,7 @@ bool CDMA::Cache::OnMessageReceived(Message* msg)
             COMMIT
             {
                 line->updating--;
-                delete msg;
+                FreeMessage(msg);
 
                 // Statistics
                 ++m_numWCompletions;
@@ -485,8 +485,8 @@ bool CDMA::Cache::OnMessageReceived(Message* msg)
             {
                 COMMIT
                 {
-                    line::blit(line->data, msg->data.data, msg->data.mask, m_lineSize);
-                    line::setif(line->valid, true, msg->data.mask, m_lineSize);
+                    line::blit(line->data, msg->data->data, msg->data->mask, m_lineSize);
+                    line->valid |= msg->data->mask;
 
                     // Statistics
                     ++m_numNetworkWHits;
@@ -497,7 +497,7 @@ bool CDMA::Cache::OnMessageReceived(Message* msg)
                 {
                     if (m_clients[i] != NULL)
                     {
-                        if (!m_clients[i]->OnMemorySnooped(msg->address, msg->data.data, msg->data.mask))
+                        if (!m_clients[i]->OnMemorySnooped(msg->address, msg->data->data, msg->data->mask))
                         {
                             DeadlockWrite("Unable to snoop update to cache clients");
                             ++m_numStallingWSnoops;
@@ -596,18 +596,18 @@ Result CDMA::Cache::OnWriteRequest(const Request& req)
         {
             line->state    = LINE_LOADING;
             line->tag      = tag;
+            m_tags[line - &m_lines[0]] = tag;
             line->tokens   = 0;
             line->dirty    = false;
             line->updating = 0;
-            std::fill(line->valid, line->valid + m_lineSize, false);
+            line->valid.reset();
         }
 
         // Send a request out for the cache-line
         Message* msg = NULL;
         COMMIT
         {
-            msg = new Message;
-            msg->type      = Message::REQUEST;
+            msg = NewMessage(Message::REQUEST);
             msg->address   = req.address;
             msg->ignore    = false;
             msg->tokens    = 0;
@@ -654,15 +654,14 @@ Result CDMA::Cache::OnWriteRequest(const Request& req)
         Message* msg = NULL;
         COMMIT
         {
-            msg = new Message;
+            msg = NewMessage(Message::UPDATE);
             msg->address   = req.address;
-            msg->type      = Message::UPDATE;
             msg->sender    = GetNodeID();
             msg->ignore    = false;
             msg->client    = req.client;
             msg->wid       = req.wid;
-            std::copy(req.mdata.data, req.mdata.data + m_lineSize, msg->data.data);
-            std::copy(req.mdata.mask, req.mdata.mask + m_lineSize, msg->data.mask);
+            std::copy(req.mdata.data, req.mdata.data + m_lineSize, msg->data->data);
+            msg->data->mask = req.mdata.mask;
 
             // Lock the line to prevent eviction
             line->updating++;
@@ -689,7 +688,7 @@ Result CDMA::Cache::OnWriteRequest(const Request& req)
     COMMIT
     {
         line::blit(line->data, req.mdata.data, req.mdata.mask, m_lineSize);
-        line::setif(line->valid, true, req.mdata.mask, m_lineSize);
+        line->valid |= req.mdata.mask;
 
         // The line is now dirty
         line->dirty = true;
@@ -750,19 +749,19 @@ Result CDMA::Cache::OnReadRequest(const Request& req)
         {
             line->state    = LINE_LOADING;
             line->tag      = tag;
+            m_tags[line - &m_lines[0]] = tag;
             line->tokens   = 0;
             line->dirty    = false;
             line->updating = 0;
             line->access   = GetKernel()->GetCycleNo();
-            std::fill(line->valid, line->valid + m_lineSize, false);
+            line->valid.reset();
         }
 
         // Send a request out
         Message* msg = NULL;
         COMMIT
         {
-            msg = new Message;
-            msg->type      = Message::REQUEST;
+            msg = NewMessage(Message::REQUEST);
             msg->address   = req.address;
             msg->ignore    = false;
             msg->tokens    = 0;
@@ -875,6 +874,7 @@ CDMA::Cache::Cache(const std::string& name, CDMA& parent, Clock& clock, NodeID i
     m_storages (),
     p_lines    (clock, GetName() + ".p_lines"),
     m_lines    (m_assoc * m_sets),
+    m_tags     (m_sets, m_assoc),
     m_data     (m_lines.size() * m_lineSize),
 
     InitSampleVariable(numRAccesses, SVC_CUMULATIVE),
@@ -931,8 +931,9 @@ CDMA::Cache::Cache(const std::string& name, CDMA& parent, Clock& clock, NodeID i
         RegisterStateVariable(line.tokens, ln + ".tokens");
         RegisterStateVariable(line.dirty, ln + ".dirty");
         RegisterStateVariable(line.updating, ln + ".updating");
-        RegisterStateArray(line.valid, sizeof(line.valid)/sizeof(line.valid[0]), ln + ".valid");
+        RegisterStateObject(line.valid, ln + ".valid");
     }
+    RegisterStateObject(m_tags, "tags");
 
     m_requests.Sensitive(p_Requests);
     m_incoming.Sensitive(p_In);
@@ -5,6 +5,7 @@
 #include <arch/mem/cdma/Node.h>
 #include <sim/inspect.h>
 #include <arch/BankSelector.h>
+#include <arch/TagArray.h>
 
 #include <queue>
 #include <set>
@@ -33,7 +34,7 @@ public:
         unsigned int tokens;    ///< Number of tokens in this line
         bool         dirty;     ///< Dirty: line has been written to
         unsigned int updating;  ///< Number of REQUEST_UPDATEs pending on this line
-        bool         valid[MAX_MEMORY_OPERATION_SIZE]; ///< Validity bitmask
+        LineMask     valid;     ///< Validity bitmask
     };
 
 private:
@@ -58,6 +59,7 @@ private:
     StorageTraceSet               m_storages;
     ArbitratedService<>           p_lines;
     std::vector<Line>             m_lines;
+    TagArray                      m_tags;
     std::vector<char>             m_data;
 
     // Statistics
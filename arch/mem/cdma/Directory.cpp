@@ -5,6 +5,7 @@
 #include <cstring>
 #include <cstdio>
 #include <iomanip>
+#include <map>
 using namespace std;
 
 namespace Simulator
@@ -254,6 +255,8 @@ CDMA::Directory::Directory(const std::string& name, CDMA& parent, Clock& clock)
     RegisterModelProperty(m_bottom, "freq", clock.GetFrequency());
 
     RegisterModelBidiRelation(m_bottom, m_top, "dir");
+
+    RegisterStateObject(m_dir, "dir");
 }
 
 void CDMA::Directory::ConnectRing(Node* first, Node* last)
@@ -279,6 +282,9 @@ void CDMA::Directory::Initialize()
         assert(p->GetPrevNode() == &m_bottom || p->GetPrevNode()->GetNodeID() == p->GetNodeID() + 1);
         m_maxNumLines += p->GetNumLines();
     }
+
+    // Size the table once, so it never grows during simulation
+    m_dir.reserve(m_maxNumLines);
 }
 
 void CDMA::Directory::Cmd_Info(std::ostream& out, const std::vector<std::string>& /*args*/) const
@@ -323,13 +329,15 @@ void CDMA::Directory::Cmd_Read(std::ostream& out, const std::vector<std::string>
     for (size_t i = 0; i < width; ++i) separator += "--------------------+--------+";
     out << separator << endl;
 
-    auto p = m_dir.begin();
-    for (size_t i = 0; i < m_dir.size(); i += width)
+    // Show the lines in address order
+    const std::map<MemAddr, size_t> lines(m_dir.begin(), m_dir.end());
+    auto p = lines.begin();
+    for (size_t i = 0; i < lines.size(); i += width)
     {
         out << setw(6) << setfill(' ') << dec << right << i << " | ";
         for (size_t j = i; j < i + width; ++j)
         {
-            if (p != m_dir.end())
+            if (p != lines.end())
             {
                 out << hex << "0x" << setw(16) << setfill('0') << p->first << " | "
                     << dec << setfill(' ') << setw(6) << p->second;
@@ -4,9 +4,9 @@
 
 #include "Node.h"
 #include <sim/inspect.h>
+#include <sim/flatmap.h>
 
 #include <vector>
-#include <map>
 
 class Config;
 
@@ -48,7 +48,7 @@ private:
 
     ArbitratedService<CyclicArbitratedPort> p_lines;      ///< Arbitrator for access to the lines
 
-    std::map<MemAddr, size_t> m_dir;  ///< The directory: tag -> tokens
+    FlatMap<MemAddr, size_t> m_dir;  ///< The directory: tag -> tokens
 
     size_t              m_maxNumLines; ///< Maximum number of lines to store
     NodeID              m_firstNode;  ///< ID of first node in the subring
@@ -10,51 +10,42 @@ using namespace std;
 namespace Simulator
 {
 
-// Memory management data
-/*static*/ unsigned long                   CDMA::Node::g_References   = 0;
-/*static*/ CDMA::Node::Message*            CDMA::Node::g_FreeMessages = NULL;
-/*static*/ std::list<CDMA::Node::Message*> CDMA::Node::g_Messages;
-
-/*static*/ void* CDMA::Node::Message::operator new(size_t size)
+CDMA::Node::Message* CDMA::Node::NewMessage(Message::Type type)
 {
-    // We allocate this many messages at once
-    constexpr size_t ALLOCATE_SIZE = 1024;
-
-    assert(size == sizeof(Message));
-    if (g_FreeMessages == NULL)
+    Message* msg = m_messageCache.Allocate();
+    msg->type = type;
+    msg->pool = m_parent.m_pool;
+    if (Message::CarriesData(type))
     {
-        // Allocate more messages
-        Message* msg = new Message[ALLOCATE_SIZE];
-        g_Messages.push_back(msg);
-
-        // Link the new messages into the free list
-        for (size_t i = 0; i < ALLOCATE_SIZE; ++i, ++msg)
-        {
-            msg->next = g_FreeMessages;
-            g_FreeMessages = msg;
-        }
+        msg->data = m_dataCache.Allocate();
     }
-    assert(g_FreeMessages != NULL);
-
-    // Grab a message off the free list
-    Message* msg = g_FreeMessages;
-    g_FreeMessages = msg->next;
     return msg;
 }
 
-/*static*/ void CDMA::Node::Message::operator delete(void *p, size_t size)
+void CDMA::Node::AttachData(Message* msg)
 {
-    assert(size == sizeof(Message));
-    Message* msg = static_cast<Message*>(p);
+    if (msg->data == NULL)
+    {
+        msg->data = (msg->pool != NULL) ? m_dataCache.Allocate() : new MemData;
+    }
+}
 
-#ifndef NDEBUG
-    // Fill the message with garbage
-    memset(msg, 0xFE, sizeof(Message));
-#endif
+void CDMA::Node::FreeMessage(Message* msg)
+{
+    if (msg->pool == NULL)
+    {
+        // Restored from a checkpoint
+        delete msg->data;
+        delete msg;
+        return;
+    }
 
-    // Append the message to the free list
-    msg->next = g_FreeMessages;
-    g_FreeMessages = msg;
+    assert(msg->pool == m_parent.m_pool);
+    if (msg->data != NULL)
+    {
+        m_dataCache.Free(msg->data);
+    }
+    m_messageCache.Free(msg);
 }
 
 string CDMA::Node::Message::str() const
@@ -131,13 +122,13 @@ Result CDMA::Node::DoForward()
     assert(!m_outgoing.Empty());
     assert(m_next != NULL);
 
-    TraceWrite(m_outgoing.Front()->address, "Sending %s to %s", m_outgoing.Front()->str().c_str(), m_next->GetName().c_str());
-
     if (!m_next->m_incoming.Push( m_outgoing.Front() ))
     {
         DeadlockWrite("Unable to send request to next node (%s)", m_next->GetName().c_str());
         return FAILED;
     }
+
+    TraceWrite(m_outgoing.Front()->address, "Sending %s to %s", m_outgoing.Front()->str().c_str(), m_next->GetName().c_str());
     m_outgoing.Pop();
     return SUCCESS;
 }
@@ -156,6 +147,8 @@ bool CDMA::Node::SendMessage(Message* message, size_t min_space)
 CDMA::Node::Node(const std::string& name, CDMA& parent, Clock& clock, NodeID id)
     : Simulator::Object(name, parent),
       CDMA::Object(name, parent),
+      m_messageCache(parent.m_pool->messages),
+      m_dataCache(parent.m_pool->data),
       m_id(id),
       m_prev(NULL),
       m_next(NULL),
@@ -163,23 +156,12 @@ CDMA::Node::Node(const std::string& name, CDMA& parent, Clock& clock, NodeID id)
       InitBuffer(m_outgoing, clock, "NodeBufferSize"),
       InitProcess(p_Forward, DoForward)
 {
-    g_References++;
-
     m_outgoing.Sensitive(p_Forward);
+    p_Forward.SetFailsFirst();
 }
 
 CDMA::Node::~Node()
 {
-    assert(g_References > 0);
-    if (--g_References == 0)
-    {
-        // Clean up the allocated messages
-        for (std::list<Message*>::const_iterator p = g_Messages.begin(); p != g_Messages.end(); ++p)
-        {
-            delete[] *p;
-        }
-        g_Messages.clear();
-    }
 }
 
 }
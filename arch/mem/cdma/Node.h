@@ -3,6 +3,7 @@
 #define CDMA_NODE_H
 
 #include "CDMA.h"
+#include <sim/arena.h>
 
 namespace Simulator
 {
@@ -34,10 +35,11 @@ class CDMA::Node : public CDMA::Object
 protected:
     friend class CDMA::Directory;
     friend class CDMA::RootDirectory;
+    friend struct CDMA::MessagePool;
     template<typename T> friend struct Serialization::serialize_trait;
 
     /// This is the message that gets sent around
-    union Message
+    struct Message
     {
         enum Type {
             REQUEST,            ///< Read request (RR)
@@ -48,39 +50,37 @@ protected:
         };
 
         /// The actual message contents that's simulated
-        struct
-        {
-            Type         type;          ///< Type of message
-            bool         dirty;         ///< Is the data dirty? (EV, RD, RDT)
-            bool         ignore;        ///< Just pass this message through to the top level
-            MemAddr      address;       ///< The address of the cache-line
-            MemData      data;          ///< The data (RD, RDT, EV, UP)
-            NodeID       sender;        ///< ID of the sender of the message
-            size_t       client;        ///< Sending client (UP)
-            WClientID    wid;           ///< Sending entity on client (family/thread) (UP)
-            unsigned int tokens;        ///< Number of tokens in this message (RDT, EV)
-            // (See also serializer below!!)
-        };
-
-        /// For memory management
-        Message* next;
-
-        // Overload allocation for efficiency
-        static void * operator new (size_t size);
-        static void operator delete (void *p, size_t size);
+        Type         type;          ///< Type of message
+        bool         dirty;         ///< Is the data dirty? (EV, RD, RDT)
+        bool         ignore;        ///< Just pass this message through to the top level
+        MemAddr      address;       ///< The address of the cache-line
+        MemData*     data;          ///< The data (RD, RDT, EV, UP), NULL for RR
+        NodeID       sender;        ///< ID of the sender of the message
+        size_t       client;        ///< Sending client (UP)
+        WClientID    wid;           ///< Sending entity on client (family/thread) (UP)
+        unsigned int tokens;        ///< Number of tokens in this message (RDT, EV)
+        // (See also serializer below!!)
+
+        /// The pool the message came from, or NULL if it was
+        /// restored from a checkpoint and lives on the heap.
+        MessagePool* pool;
+
+        /// Does a message of this type carry data?
+        static bool CarriesData(Type type) { return type != REQUEST; }
 
         std::string str() const;
 
-        Message() {}
-    private:
-        Message(const Message&) {} // No copying
+        Message()
+            : type(REQUEST), dirty(false), ignore(false), address(0), data(NULL),
+              sender(0), client(0), wid(0), tokens(0), pool(NULL)
+        {}
+        Message(const Message&) = delete; // No copying
+        Message& operator=(const Message&) = delete;
     };
 
 private:
-    // Message management
-    static Message*            g_FreeMessages;
-    static std::list<Message*> g_Messages;
-    static unsigned long       g_References;
+    Arena<Message>::Cache m_messageCache;   ///< Free messages of this node
+    Arena<MemData>::Cache m_dataCache;      ///< Free message data of this node
 
     NodeID            m_id;             ///< Node identifier in the memory network
     Node*             m_prev;           ///< Prev node in the ring
@@ -99,6 +99,17 @@ protected:
         return m_outgoing;
     }
 
+    /// Allocate a message of the given type. Messages of types that
+    /// carry data get a data block.
+    Message* NewMessage(Message::Type type);
+
+    /// Give a message a data block, if it has none. Used when a
+    /// request has data attached to it.
+    void AttachData(Message* msg);
+
+    /// Release a message and its data
+    void FreeMessage(Message* msg);
+
     /// Send the message to the next node
     bool SendMessage(Message* message, size_t min_space);
 
@@ -124,6 +135,19 @@ public:
     virtual size_t GetNumLines() const;
 };
 
+/**
+ * The arenas that the messages of a CDMA memory and their data blocks
+ * are allocated from. Every CDMA instance has its own; the nodes
+ * allocate through caches in front of it.
+ */
+struct CDMA::MessagePool
+{
+    Arena<Node::Message> messages;
+    Arena<MemData>       data;
+
+    MessagePool() : messages(), data() {}
+};
+
 namespace Serialization
 {
     template<>
@@ -139,7 +163,12 @@ namespace Serialization
             arch & p->dirty;
             arch & p->ignore;
             arch & p->address;
-            arch & p->data;
+            if (CDMA::Node::Message::CarriesData(p->type))
+            {
+                if (p->data == NULL)
+                    p->data = (p->pool != NULL) ? p->pool->data.Allocate() : new MemData;
+                arch & *p->data;
+            }
             arch & p->sender;
             arch & p->client;
             arch & p->wid;
@@ -3,6 +3,7 @@
 #include <sim/config.h>
 
 #include <iomanip>
+#include <map>
 using namespace std;
 
 namespace Simulator
@@ -48,8 +49,9 @@ bool CDMA::RootDirectory::OnReadCompleted()
     {
         msg->type = Message::REQUEST_DATA_TOKEN;
         msg->dirty = false;
+        AttachData(msg);
 
-        static_cast<VirtualMemory&>(m_parent).Read(msg->address, msg->data.data, m_lineSize);
+        static_cast<VirtualMemory&>(m_parent).Read(msg->address, msg->data->data, m_lineSize);
 
         m_active.pop();
     }
@@ -181,7 +183,7 @@ bool CDMA::RootDirectory::OnMessageReceived(Message* msg)
                 COMMIT
                 {
                     line->tokens = tokens;
-                    delete msg;
+                    FreeMessage(msg);
                 }
             }
             else
@@ -201,7 +203,7 @@ bool CDMA::RootDirectory::OnMessageReceived(Message* msg)
                 else
                 {
                     TraceWrite(msg_addr, "Received Evict Request; All tokens; Clearing line from system");
-                    COMMIT{ delete msg; }
+                    COMMIT{ FreeMessage(msg); }
                 }
                 COMMIT{
                     m_dir.erase(msg_addr);
@@ -289,8 +291,9 @@ Result CDMA::RootDirectory::DoRequests()
 
                 msg->type = Message::REQUEST_DATA_TOKEN;
                 msg->dirty = false;
+                AttachData(msg);
 
-                m_parent.Read(msg_addr, msg->data.data, m_lineSize);
+                m_parent.Read(msg_addr, msg->data->data, m_lineSize);
             }
 
             if (!m_responses.Push(msg))
@@ -314,10 +317,10 @@ Result CDMA::RootDirectory::DoRequests()
 #endif
             COMMIT {
 
-                static_cast<VirtualMemory&>(m_parent).Write(msg_addr, msg->data.data, 0, m_lineSize);
+                static_cast<VirtualMemory&>(m_parent).Write(msg_addr, msg->data->data, 0, m_lineSize);
 
                 ++m_nwrites;
-                delete msg;
+                FreeMessage(msg);
             }
         }
     }
@@ -386,6 +389,10 @@ void CDMA::RootDirectory::Initialize()
         if (dynamic_cast<RootDirectory*>(p) != NULL)
             ++m_numRoots;
     }
+
+    // Lines are interleaved over the root directories, so expect
+    // our share of them; the table grows if the share is uneven.
+    m_dir.reserve(m_maxNumLines / m_numRoots);
 }
 
 CDMA::RootDirectory::RootDirectory(const std::string& name, CDMA& parent, Clock& clock, size_t id, const DDRChannelRegistry& ddr) :
@@ -432,6 +439,9 @@ CDMA::RootDirectory::RootDirectory(const std::string& name, CDMA& parent, Clock&
     p_Requests.SetStorageTraces(sts ^ m_responses);
     p_Incoming.SetStorageTraces((GetOutgoingTrace() * opt(m_requests)) ^ opt(m_requests));
     p_Responses.SetStorageTraces(GetOutgoingTrace());
+
+    RegisterStateObject(m_dir, "dir");
+    RegisterStateObject(m_active, "active");
 }
 
 void CDMA::RootDirectory::Cmd_Info(std::ostream& out, const std::vector<std::string>& /*args*/) const
@@ -474,13 +484,15 @@ void CDMA::RootDirectory::Cmd_Read(std::ostream& out, const std::vector<std::str
     for (size_t i = 0; i < width; ++i) separator += "--------------------+-------------+";
     out << separator << endl;
 
-    auto p = m_dir.begin();
-    for (size_t i = 0; i < m_dir.size(); i += width)
+    // Show the lines in address order
+    const std::map<MemAddr, Line> lines(m_dir.begin(), m_dir.end());
+    auto p = lines.begin();
+    for (size_t i = 0; i < lines.size(); i += width)
     {
         out << setw(6) << dec << right << i << " | ";
         for (size_t j = i; j < i + width; ++j)
         {
-            if (p != m_dir.end())
+            if (p != lines.end())
             {
                 out << hex << "0x" << setfill('0') << setw(16) << p->first << " | "
                     << dec << setfill(' ') << right;
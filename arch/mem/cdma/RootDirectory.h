@@ -31,10 +31,12 @@ public:
         LineState    state;    ///< State of the line
         unsigned int tokens;   ///< Full: tokens stored here by evictions
         NodeID       sender;   ///< Loading: ID of the cache that requested the loading line
+
+        SERIALIZE(arch) { arch & "rl" & state & tokens & sender; }
     };
 
 private:
-    std::map<MemAddr, Line> m_dir;///< The cache lines
+    FlatMap<MemAddr, Line> m_dir; ///< The cache lines
     size_t            m_maxNumLines;///< Maximum number of lines in this directory
     size_t            m_lineSize;   ///< The size of a cache-line
     size_t            m_id;         ///< Which root directory we are (0 <= m_id < m_numRoots)
@@ -70,24 +70,34 @@ void ZLCDMA::UnregisterClient(MCID id)
 
 bool ZLCDMA::Read(MCID id, MemAddr address)
 {
+    // Forward the read to the cache associated with the callback
+    if (!m_clientMap[id].first->Read(m_clientMap[id].second, address))
+    {
+        return false;
+    }
+
     COMMIT
     {
         m_nreads++;
         m_nread_bytes += m_lineSize;
     }
-    // Forward the read to the cache associated with the callback
-    return m_clientMap[id].first->Read(m_clientMap[id].second, address);
+    return true;
 }
 
 bool ZLCDMA::Write(MCID id, MemAddr address, const MemData& data, WClientID wid)
 {
+    // Forward the write to the cache associated with the callback
+    if (!m_clientMap[id].first->Write(m_clientMap[id].second, address, data, wid))
+    {
+        return false;
+    }
+
     COMMIT
     {
         m_nwrites++;
         m_nwrite_bytes += m_lineSize;
     }
-    // Forward the write to the cache associated with the callback
-    return m_clientMap[id].first->Write(m_clientMap[id].second, address, data, wid);
+    return true;
 }
 
 // Note that the CDMA class is just a container for caches and directories.
@@ -108,6 +118,7 @@ ZLCDMA::ZLCDMA(const std::string& name, Simulator::Object& parent, Clock& clock)
     m_traces(),
     m_ddr("ddr", *this, GetConf("NumRootDirectories", size_t)),
     m_clientMap(),
+    m_pool(new MessagePool),
     InitSampleVariable(nreads, SVC_CUMULATIVE), InitSampleVariable(nwrites, SVC_CUMULATIVE), InitSampleVariable(nread_bytes, SVC_CUMULATIVE), InitSampleVariable(nwrite_bytes, SVC_CUMULATIVE)
 {
 
@@ -202,6 +213,7 @@ ZLCDMA::~ZLCDMA()
     for (auto r : m_roots)
         delete r;
 
+    delete m_pool;
     delete m_selector;
 }
 
@@ -93,7 +93,7 @@ bool ZLCDMA::Cache::Write(MCID id, MemAddr address, const MemData& data, WClient
     req.wid     = wid;
     COMMIT{
     std::copy(data.data, data.data + m_lineSize, req.mdata.data);
-    std::copy(data.mask, data.mask + m_lineSize, req.mdata.mask);
+    req.mdata.mask = data.mask;
     }
 
     // Client should have been registered
@@ -131,14 +131,12 @@ ZLCDMA::Cache::Line* ZLCDMA::Cache::FindLine(MemAddr address)
     const size_t  set  = setindex * m_assoc;
 
     // Find the line
-    for (size_t i = 0; i < m_assoc; ++i)
+    const size_t way = m_tags.Find(setindex, tag, [this](size_t i) { return m_lines[i].valid; });
+    if (way < m_assoc)
     {
-        Line& line = m_lines[set + i];
-        if (line.valid && line.tag == tag)
-        {
-            // The wanted line was in the cache
-            return &line;
-        }
+        // The wanted line was in the cache
+        assert(m_lines[set + way].tag == tag);
+        return &m_lines[set + way];
     }
     return NULL;
 }
@@ -151,14 +149,12 @@ const ZLCDMA::Cache::Line* ZLCDMA::Cache::FindLine(MemAddr address) const
     const size_t  set  = setindex * m_assoc;
 
     // Find the line
-    for (size_t i = 0; i < m_assoc; ++i)
+    const size_t way = m_tags.Lookup(setindex, tag, [this](size_t i) { return m_lines[i].valid; });
+    if (way < m_assoc)
     {
-        const Line& line = m_lines[set + i];
-        if (line.valid && line.tag == tag)
-        {
-            // The wanted line was in the cache
-            return &line;
-        }
+        // The wanted line was in the cache
+        assert(m_lines[set + way].tag == tag);
+        return &m_lines[set + way];
     }
     return NULL;
 }
@@ -298,11 +294,11 @@ bool ZLCDMA::Cache::EvictLine(Line* line, const Request& req)
     size_t  set     = (line - &m_lines[0]) / m_assoc;
     MemAddr address = m_selector.Unmap(line->tag, set) * m_lineSize;
 
-    Message* msg = new Message();
+    Message* msg = NULL;
     COMMIT
     {
+        msg = NewMessage(Message::EVICTION);
         msg->transient = false;
-        msg->type      = Message::EVICTION;
         msg->address   = address;
         msg->ignore    = false;
         msg->source    = m_id;
@@ -310,7 +306,7 @@ bool ZLCDMA::Cache::EvictLine(Line* line, const Request& req)
         msg->dirty     = line->dirty;
         msg->tokens    = line->tokens;
         std::copy(line->data,    line->data    + m_lineSize, msg->data);
-        std::copy(line->bitmask, line->bitmask + m_lineSize, msg->bitmask);
+        msg->bitmask = line->bitmask;
     }
 
     TraceWrite(address, "Evicting with %u tokens due to miss for 0x%llx", line->tokens, (unsigned long long)req.address);
@@ -374,6 +370,7 @@ Result ZLCDMA::Cache::OnReadRequest(const Request& req)
         COMMIT
         {
             line->tag           = tag;
+            m_tags[line - &m_lines[0]] = tag;
             line->time          = GetKernel()->GetActiveClock()->GetCycleNo();
             line->valid         = true;
             line->dirty         = false;
@@ -382,10 +379,10 @@ Result ZLCDMA::Cache::OnReadRequest(const Request& req)
             line->priority      = false;
             line->pending_read  = false;
             line->pending_write = false;
-            std::fill(line->bitmask, line->bitmask + m_lineSize, false);
+            line->bitmask.reset();
         }
     }
-    else if (!contains(line->bitmask, line->bitmask + m_lineSize, false))
+    else if (line->bitmask.all(m_lineSize))
     {
         // We have all data in the line; return it to the memory clients
         // Note that this can happen before a read or write request has
@@ -431,15 +428,14 @@ Result ZLCDMA::Cache::OnReadRequest(const Request& req)
     Message* msg = NULL;
     COMMIT
     {
-        msg = new Message();
-        msg->type      = Message::READ;
+        msg = NewMessage(Message::READ);
         msg->address   = req.address;
         msg->ignore    = false;
         msg->source    = m_id;
         msg->tokens    = 0;
         msg->priority  = false;
         msg->transient = false;
-        std::fill(msg->bitmask, msg->bitmask + m_lineSize, false);
+        msg->bitmask.reset();
 
         line->pending_read = true;
 
@@ -497,6 +493,7 @@ Result ZLCDMA::Cache::OnWriteRequest(const Request& req)
         COMMIT
         {
             line->tag           = tag;
+            m_tags[line - &m_lines[0]] = tag;
             line->valid         = true;
             line->dirty         = false;
             line->tokens        = 0;
@@ -504,7 +501,7 @@ Result ZLCDMA::Cache::OnWriteRequest(const Request& req)
             line->priority      = false;
             line->pending_read  = false;
             line->pending_write = false;
-            std::fill(line->bitmask, line->bitmask + m_lineSize, false);
+            line->bitmask.reset();
         }
 
         newline = true;
@@ -517,7 +514,7 @@ Result ZLCDMA::Cache::OnWriteRequest(const Request& req)
         line->dirty = true;
 
         line::blit(line->data, req.mdata.data, req.mdata.mask, m_lineSize);
-        line::setif(line->bitmask, true, req.mdata.mask, m_lineSize);
+        line->bitmask |= req.mdata.mask;
     }
 
     if (!newline && !line->transient && line->tokens == m_parent.GetTotalTokens())
@@ -556,8 +553,7 @@ Result ZLCDMA::Cache::OnWriteRequest(const Request& req)
     Message* msg = NULL;
     COMMIT
     {
-        msg = new Message();
-        msg->type      = Message::ACQUIRE_TOKENS;
+        msg = NewMessage(Message::ACQUIRE_TOKENS);
         msg->address   = req.address;
         msg->ignore    = false;
         msg->source    = m_id;
@@ -567,7 +563,7 @@ Result ZLCDMA::Cache::OnWriteRequest(const Request& req)
 
         // Send our current (updated) data with the message
         std::copy(line->data,    line->data    + m_lineSize, msg->data);
-        std::copy(line->bitmask, line->bitmask + m_lineSize, msg->bitmask);
+        msg->bitmask = line->bitmask;
 
         if (line->priority)
         {
@@ -615,19 +611,12 @@ Result ZLCDMA::Cache::OnAcquireTokensRem(Message* req)
     // See if the request has data that we don't, and vica versa
     COMMIT
     {
-        for (unsigned int i = 0; i < m_lineSize; i++)
-        {
-            if (!req->bitmask[i] && line->bitmask[i])
-            {
-                req->data[i] = line->data[i];
-                req->bitmask[i] = true;
-            }
-            else if (req->bitmask[i] && !line->bitmask[i])
-            {
-                line->data[i] = req->data[i];
-                line->bitmask[i] = true;
-            }
-        }
+        const LineMask to_req  = line->bitmask & ~req->bitmask;
+        const LineMask to_line = req->bitmask & ~line->bitmask;
+        line::blit(req->data, line->data, to_req, m_lineSize);
+        line::blit(line->data, req->data, to_line, m_lineSize);
+        req->bitmask  |= to_req;
+        line->bitmask |= to_line;
     }
 
     if (line->pending_read)
@@ -706,8 +695,7 @@ Result ZLCDMA::Cache::OnAcquireTokensRem(Message* req)
             Message *reqnotify = NULL;
             COMMIT
             {
-                reqnotify = new Message();
-                reqnotify->type    = Message::LOCALDIR_NOTIFICATION;
+                reqnotify = NewMessage(Message::LOCALDIR_NOTIFICATION);
                 reqnotify->address = req->address;
                 reqnotify->ignore  = false;
                 reqnotify->source  = m_id;
@@ -763,14 +751,8 @@ Result ZLCDMA::Cache::OnAcquireTokensRet(Message* req)
     // Update the cache-line with data from the request
     COMMIT
     {
-        for (unsigned int i = 0 ; i < m_lineSize; ++i)
-        {
-            if (req->bitmask[i] && !line->bitmask[i])
-            {
-                line->bitmask[i] = true;
-                line->data[i] = req->data[i];
-            }
-        }
+        line::blit(line->data, req->data, req->bitmask & ~line->bitmask, m_lineSize);
+        line->bitmask |= req->bitmask;
     }
 
     unsigned int tokens = line->tokens;
@@ -799,8 +781,7 @@ Result ZLCDMA::Cache::OnAcquireTokensRet(Message* req)
             Message *reqnotify = NULL;
             COMMIT
             {
-                reqnotify = new Message();
-                reqnotify->type    = Message::LOCALDIR_NOTIFICATION;
+                reqnotify = NewMessage(Message::LOCALDIR_NOTIFICATION);
                 reqnotify->address = req->address;
                 reqnotify->ignore  = false;
                 reqnotify->source  = m_id;
@@ -845,7 +826,7 @@ Result ZLCDMA::Cache::OnAcquireTokensRet(Message* req)
         COMMIT
         {
             line->pending_write = false;
-            delete req;
+            FreeMessage(req);
         }
     }
 
@@ -877,19 +858,10 @@ Result ZLCDMA::Cache::OnReadRem(Message* req)
     }
 
     // Exchange data between line and request
-    for (unsigned int i = 0; i < m_lineSize; i++)
-    {
-        if (line->bitmask[i])
-        {
-            req->data[i] = line->data[i];
-            req->bitmask[i] = true;
-        }
-        else if (req->bitmask[i])
-        {
-            line->data[i] = req->data[i];
-            line->bitmask[i] = true;
-        }
-    }
+    line::blit(req->data, line->data, line->bitmask, m_lineSize);
+    line::blit(line->data, req->data, req->bitmask & ~line->bitmask, m_lineSize);
+    line->bitmask |= req->bitmask;
+    req->bitmask   = line->bitmask;
 
     if (line->pending_write)
     {
@@ -949,14 +921,7 @@ Result ZLCDMA::Cache::OnReadRet(Message* req)
     assert(line->pending_read);
 
     // See if the line will be full
-    unsigned int missing_bytes = 0;
-    for (unsigned int i = 0; i < m_lineSize; i++)
-    {
-        if (!line->bitmask[i] && !req->bitmask[i])
-        {
-            missing_bytes++;
-        }
-    }
+    unsigned int missing_bytes = m_lineSize - ((line->bitmask | req->bitmask) & LineMask::Range(0, m_lineSize)).count();
 
     if (missing_bytes > 0)
         TraceWrite(req->address, "Received Read Response with %u tokens; Sending request for remaining %u bytes", req->tokens, missing_bytes);
@@ -966,14 +931,8 @@ Result ZLCDMA::Cache::OnReadRet(Message* req)
     COMMIT
     {
         // Update the line with the request's data
-        for (unsigned int i = 0; i < m_lineSize; i++)
-        {
-            if (!line->bitmask[i] && req->bitmask[i])
-            {
-                line->data[i] = req->data[i];
-                line->bitmask[i] = true;
-            }
-        }
+        line::blit(line->data, req->data, req->bitmask & ~line->bitmask, m_lineSize);
+        line->bitmask |= req->bitmask;
 
         // Give tokens to the line
         line->tokens += req->tokens;
@@ -1010,7 +969,7 @@ Result ZLCDMA::Cache::OnReadRet(Message* req)
             return FAILED;
         }
 
-        COMMIT{ delete req; }
+        COMMIT{ FreeMessage(req); }
     }
     return SUCCESS;
 }
@@ -1054,7 +1013,9 @@ Result ZLCDMA::Cache::OnEviction(Message* req)
         // Store evicted line in the allocated line
         COMMIT
         {
+            line->valid         = true;
             line->tag           = tag;
+            m_tags[line - &m_lines[0]] = tag;
             line->time          = GetKernel()->GetActiveClock()->GetCycleNo();
             line->dirty         = req->dirty;
             line->tokens        = req->tokens;
@@ -1064,9 +1025,9 @@ Result ZLCDMA::Cache::OnEviction(Message* req)
             line->priority      = req->priority;
 
             std::copy(req->data, req->data + m_lineSize, line->data);
-            std::fill(line->bitmask, line->bitmask + m_lineSize, true);
+            line->bitmask = LineMask::Range(0, m_lineSize);
 
-            delete req;
+            FreeMessage(req);
         }
     }
     // We have the line
@@ -1084,12 +1045,12 @@ Result ZLCDMA::Cache::OnEviction(Message* req)
         COMMIT
         {
             line::blitnot(line->data, req->data, line->bitmask, m_lineSize);
-            line::blitnot(line->bitmask, req->bitmask, line->bitmask, m_lineSize);
+            line->bitmask |= req->bitmask;
 
             line->tokens += req->tokens;
             line->priority = line->priority || req->priority;
             line->dirty = line->dirty || req->dirty;
-            delete req;
+            FreeMessage(req);
         }
     }
     return SUCCESS;
@@ -1168,6 +1129,7 @@ ZLCDMA::Cache::Cache(const std::string& name, ZLCDMA& parent, Clock& clock, Cach
     m_storages (),
     p_lines    (clock, GetName() + ".p_lines"),
     m_lines    (m_assoc * m_sets),
+    m_tags     (m_sets, m_assoc),
     InitSampleVariable(numHits, SVC_CUMULATIVE),
     InitSampleVariable(numMisses, SVC_CUMULATIVE),
     InitSampleVariable(numConflicts, SVC_CUMULATIVE),
@@ -1184,6 +1146,8 @@ ZLCDMA::Cache::Cache(const std::string& name, ZLCDMA& parent, Clock& clock, Cach
     {
         m_lines[i].valid = false;
     }
+    RegisterStateObject(m_lines, "lines");
+    RegisterStateObject(m_tags, "tags");
 
     m_requests.Sensitive(p_Requests);
     m_incoming.Sensitive(p_In);
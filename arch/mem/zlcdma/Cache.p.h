@@ -5,6 +5,7 @@
 #include <arch/mem/zlcdma/Node.h>
 #include <sim/inspect.h>
 #include <arch/BankSelector.h>
+#include <arch/TagArray.h>
 
 #include <queue>
 #include <set>
@@ -27,7 +28,7 @@ public:
         // The bitmask indicates the valid sections of the line,
         // when writes are stored by replies come back with the
         // whole cache line.
-        bool bitmask[MAX_MEMORY_OPERATION_SIZE];
+        LineMask bitmask;
 
         // Tokens held by this line
         unsigned int tokens;
@@ -49,10 +50,19 @@ public:
         std::vector<WriteAck> ack_queue;
 
         Line()
-        : valid(false), tag(0), time(0), tokens(0), priority(false),
+        : valid(false), tag(0), time(0), bitmask(), tokens(0), priority(false),
             pending_read(false), pending_write(false), dirty(false),
             transient(false), ack_queue()
         {}
+
+        SERIALIZE(arch)
+        {
+            arch & "cl" & valid & tag & time
+                 & Serialization::binary(data, sizeof data)
+                 & bitmask
+                 & tokens & priority & pending_read & pending_write
+                 & dirty & transient & ack_queue;
+        }
     };
 
 private:
@@ -78,6 +88,7 @@ private:
     StorageTraceSet               m_storages;
     ArbitratedService<>           p_lines;
     std::vector<Line>             m_lines;
+    TagArray                      m_tags;
 
     // Statistics
     DefineSampleVariable(uint64_t, numHits);
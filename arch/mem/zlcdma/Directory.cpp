@@ -127,7 +127,7 @@ bool ZLCDMA::Directory::OnMessageReceivedBottom(Message* req)
             COMMIT
             {
                 line->tokens += req->tokens;
-                delete req;
+                m_bottom.FreeMessage(req);
             }
             return true;
 
@@ -292,6 +292,8 @@ Result ZLCDMA::Directory::DoInTop()
     RegisterModelProperty(m_bottom, "freq", clock.GetFrequency());
 
     RegisterModelBidiRelation(m_bottom, m_top, "dir");
+
+    RegisterStateVariable(m_lines, "lines");
 }
 
 void ZLCDMA::Directory::Cmd_Info(std::ostream& out, const std::vector<std::string>& /*args*/) const
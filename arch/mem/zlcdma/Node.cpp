@@ -8,51 +8,35 @@ using namespace std;
 namespace Simulator
 {
 
-// Memory management data
-/*static*/ unsigned long                     ZLCDMA::Node::g_References   = 0;
-/*static*/ ZLCDMA::Node::Message*            ZLCDMA::Node::g_FreeMessages = NULL;
-/*static*/ std::list<ZLCDMA::Node::Message*> ZLCDMA::Node::g_Messages;
-
-/*static*/ void* ZLCDMA::Node::Message::operator new(size_t size)
+ZLCDMA::Node::Message* ZLCDMA::Node::NewMessage(Message::Type type)
 {
-    // We allocate this many messages at once
-    static const size_t ALLOCATE_SIZE = 1024;
-
-    assert(size == sizeof(Message));
-    if (g_FreeMessages == NULL)
+    Message* msg = m_messageCache.Allocate();
+    msg->type = type;
+    msg->pool = m_parent.m_pool;
+    if (Message::CarriesData(type))
     {
-        // Allocate more messages
-        Message* msg = new Message[ALLOCATE_SIZE];
-        g_Messages.push_back(msg);
-
-        // Link the new messages into the free list
-        for (size_t i = 0; i < ALLOCATE_SIZE; ++i, ++msg)
-        {
-            msg->next = g_FreeMessages;
-            g_FreeMessages = msg;
-        }
+        msg->data = m_dataCache.Allocate()->bytes;
     }
-    assert(g_FreeMessages != NULL);
-
-    // Grab a message off the free list
-    Message* msg = g_FreeMessages;
-    g_FreeMessages = msg->next;
     return msg;
 }
 
-/*static*/ void ZLCDMA::Node::Message::operator delete(void *p, size_t size)
+void ZLCDMA::Node::FreeMessage(Message* msg)
 {
-    assert(size == sizeof(Message));
-    Message* msg = static_cast<Message*>(p);
-
-#ifndef NDEBUG
-    // Fill the message with garbage
-    memset(msg, 0xFE, sizeof(Message));
-#endif
+    MessageData* data = reinterpret_cast<MessageData*>(msg->data);
+    if (msg->pool == NULL)
+    {
+        // Restored from a checkpoint
+        delete data;
+        delete msg;
+        return;
+    }
 
-    // Append the message to the free list
-    msg->next = g_FreeMessages;
-    g_FreeMessages = msg;
+    assert(msg->pool == m_parent.m_pool);
+    if (data != NULL)
+    {
+        m_dataCache.Free(data);
+    }
+    m_messageCache.Free(msg);
 }
 
 /*static*/ void ZLCDMA::Node::PrintMessage(std::ostream& out, const Message& msg)
@@ -135,29 +119,20 @@ bool ZLCDMA::Node::SendMessage(Message* message, size_t min_space)
 ZLCDMA::Node::Node(const std::string& name, ZLCDMA& parent, Clock& clock)
     : Simulator::Object(name, parent),
       ZLCDMA::Object(name, parent),
+      m_messageCache(parent.m_pool->messages),
+      m_dataCache(parent.m_pool->data),
       m_prev(NULL),
       m_next(NULL),
       InitStorage(m_incoming, clock, 2),
       InitStorage(m_outgoing, clock, 2),
       InitProcess(p_Forward, DoForward)
 {
-    g_References++;
-
     m_outgoing.Sensitive(p_Forward);
+    p_Forward.SetFailsFirst();
 }
 
 ZLCDMA::Node::~Node()
 {
-    assert(g_References > 0);
-    if (--g_References == 0)
-    {
-        // Clean up the allocated messages
-        for (std::list<Message*>::const_iterator p = g_Messages.begin(); p != g_Messages.end(); ++p)
-        {
-            delete[] *p;
-        }
-        g_Messages.clear();
-    }
 }
 
 }
@@ -3,6 +3,7 @@
 #define ZLCDMA_NODE_H
 
 #include "CDMA.h"
+#include <sim/arena.h>
 
 namespace Simulator
 {
@@ -36,10 +37,17 @@ class ZLCDMA::Node : public ZLCDMA::Object
 {
 protected:
     friend class ZLCDMA::Directory;
+    friend struct ZLCDMA::MessagePool;
     template<typename T> friend struct Serialization::serialize_trait;
 
+    /// The data block of a message
+    struct MessageData
+    {
+        char bytes[MAX_MEMORY_OPERATION_SIZE];
+    };
+
     /// This is the message that gets sent around
-    union Message
+    struct Message
     {
         enum Type
         {
@@ -50,34 +58,36 @@ protected:
         };
 
         /// The actual message contents that's simulated
-        struct
-        {
-            Type            type;       // Type of the message
-            MemAddr         address;    // Address of the concerned cache-line
-            CacheID         source;     // ID of the originating cache
-            bool            dirty;      // Is the data in this message 'dirty'?
+        Type            type;       // Type of the message
+        MemAddr         address;    // Address of the concerned cache-line
+        CacheID         source;     // ID of the originating cache
+        bool            dirty;      // Is the data in this message 'dirty'?
 
-            // Message data and validity bitmask
-            char            data   [MAX_MEMORY_OPERATION_SIZE];
-            bool            bitmask[MAX_MEMORY_OPERATION_SIZE];
+        // Message data and validity bitmask.
+        // Notifications carry no data; their data is NULL.
+        char*           data;
+        LineMask        bitmask;
 
-            // To avoid deadlock, messages sometimes have to be routed the long way.
-            // This flag, when set, causes all relevant clients to ignore the message in such a case.
-            bool ignore;
+        // To avoid deadlock, messages sometimes have to be routed the long way.
+        // This flag, when set, causes all relevant clients to ignore the message in such a case.
+        bool ignore;
 
-            // Does the request have the priority token?
-            bool priority;
+        // Does the request have the priority token?
+        bool priority;
 
-            // If set, this request has transient tokens.
-            // This can only ever be true for ACQUIRE_TOKENS messages.
-            // If priority is true, transient cannot be.
-            bool transient;
+        // If set, this request has transient tokens.
+        // This can only ever be true for ACQUIRE_TOKENS messages.
+        // If priority is true, transient cannot be.
+        bool transient;
 
-            // Number of tokens held by this request
-            unsigned int tokens;
+        // Number of tokens held by this request
+        unsigned int tokens;
 
-            // (See also serializer below!)
-        };
+        // (See also serializer below!)
+
+        // The pool the message came from, or NULL if it was restored
+        // from a checkpoint and lives on the heap.
+        MessagePool* pool;
 
         // transient tokens cannot be grabbed by anybody, but can be transformed into permanent token by priority token
         // permanent tokens can be stored and grabed by the lines.
@@ -86,23 +96,20 @@ protected:
             return transient ? 0 : tokens;
         }
 
-        /// For memory management
-        Message* next;
+        // Does a message of this type carry data?
+        static bool CarriesData(Type type) { return type != LOCALDIR_NOTIFICATION; }
 
-        // Overload allocation for efficiency
-        static void * operator new (size_t size);
-        static void operator delete (void *p, size_t size);
-
-        Message() {};
-    private:
-        Message(const Message&) {} // No copying
+        Message()
+            : type(READ), address(0), source(0), dirty(false), data(NULL), bitmask(),
+              ignore(false), priority(false), transient(false), tokens(0), pool(NULL)
+        {}
+        Message(const Message&) = delete; // No copying
+        Message& operator=(const Message&) = delete;
     };
 
 private:
-    // Message management
-    static Message*            g_FreeMessages;
-    static std::list<Message*> g_Messages;
-    static unsigned long       g_References;
+    Arena<Message>::Cache     m_messageCache;  ///< Free messages of this node
+    Arena<MessageData>::Cache m_dataCache;     ///< Free message data of this node
 
     static void PrintMessage(std::ostream& out, const Message& msg);
 
@@ -122,6 +129,13 @@ protected:
         return m_outgoing;
     }
 
+    /// Allocate a message of the given type. Messages of types that
+    /// carry data get a data block.
+    Message* NewMessage(Message::Type type);
+
+    /// Release a message and its data
+    void FreeMessage(Message* msg);
+
     /// Send the message to the next node
     bool SendMessage(Message* message, size_t min_space);
 
@@ -141,6 +155,19 @@ public:
     void Initialize(Node* next, Node* prev);
 };
 
+/**
+ * The arenas that the messages of a ZLCDMA memory and their data
+ * blocks are allocated from. Every ZLCDMA instance has its own; the
+ * nodes allocate through caches in front of it.
+ */
+struct ZLCDMA::MessagePool
+{
+    Arena<Node::Message>     messages;
+    Arena<Node::MessageData> data;
+
+    MessagePool() : messages(), data() {}
+};
+
 namespace Serialization
 {
     template<>
@@ -159,9 +186,14 @@ namespace Serialization
                 & p->ignore
                 & p->priority
                 & p->transient
-                & p->tokens
-                & Serialization::binary(p->data, MAX_MEMORY_OPERATION_SIZE);
-            for (auto &b : p->bitmask) arch & b;
+                & p->tokens;
+            if (ZLCDMA::Node::Message::CarriesData(p->type))
+            {
+                if (p->data == NULL)
+                    p->data = (p->pool != NULL) ? p->pool->data.Allocate()->bytes : (new ZLCDMA::Node::MessageData)->bytes;
+                arch & Serialization::binary(p->data, MAX_MEMORY_OPERATION_SIZE)
+                     & p->bitmask;
+            }
             arch & "]";
         }
     };
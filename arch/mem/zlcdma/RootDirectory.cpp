@@ -82,7 +82,7 @@ bool ZLCDMA::RootDirectory::OnReadCompleted()
         static_cast<VirtualMemory&>(m_parent).Read(msg->address, data, m_lineSize);
 
         line::blitnot(msg->data, data, msg->bitmask, m_lineSize);
-        std::fill(msg->bitmask, msg->bitmask + m_lineSize, true);
+        msg->bitmask = LineMask::Range(0, m_lineSize);
 
         msg->dirty = false;
 
@@ -160,7 +160,7 @@ bool ZLCDMA::RootDirectory::OnMessageReceived(Message* req)
                 break;
             }
 
-            if (!contains(req->bitmask, req->bitmask + m_lineSize, false))
+            if (req->bitmask.all(m_lineSize))
             {
                 // The message itself contains all data, which means it already exists in the system
                 // without going through the root directory (i.e., writes).
@@ -298,7 +298,7 @@ bool ZLCDMA::RootDirectory::OnMessageReceived(Message* req)
             if (!req->dirty)
             {
                 // Non-dirty data; we don't have to write back
-                COMMIT{ delete req; }
+                COMMIT{ FreeMessage(req); }
             }
             // Dirty data; write back the data to memory
             else if (!m_requests.Push(req))
@@ -385,7 +385,7 @@ Result ZLCDMA::RootDirectory::DoRequests()
                 static_cast<VirtualMemory&>(m_parent).Write(msg->address, msg->data, 0, m_lineSize);
 
                 ++m_nwrites;
-                delete msg;
+                FreeMessage(msg);
             }
         }
     }
@@ -494,6 +494,11 @@ ZLCDMA::RootDirectory::RootDirectory(const std::string& name, ZLCDMA& parent, Cl
     p_Requests.SetStorageTraces(sts ^ m_responses);
     p_Incoming.SetStorageTraces((GetOutgoingTrace() * opt(m_requests)) ^ opt(m_requests));
     p_Responses.SetStorageTraces(GetOutgoingTrace());
+
+    RegisterStateObject(m_lines, "lines");
+    RegisterStateObject(m_active, "active");
+    RegisterSampleVariableInObject(m_nreads, SVC_CUMULATIVE);
+    RegisterSampleVariableInObject(m_nwrites, SVC_CUMULATIVE);
 }
 
 void ZLCDMA::RootDirectory::Cmd_Info(std::ostream& out, const std::vector<std::string>& /*args*/) const
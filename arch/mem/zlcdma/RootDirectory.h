@@ -29,6 +29,8 @@ public:
         Line()
         : valid(false), tag(0), loading(false), data(false), tokens(0), priority(false), requests()
         {}
+
+        SERIALIZE(arch) { arch & "rl" & valid & tag & loading & data & tokens & priority & requests; }
     };
 
 private:
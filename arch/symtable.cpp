@@ -1,6 +1,7 @@
 #include "symtable.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <sstream>
 #include <fnmatch.h>
 
@@ -11,10 +12,56 @@ using namespace Simulator;
 #define entry_sz(E) (E).second.first
 #define entry_sym(E) (E).second.second
 
-const string SymbolTable::Resolve(MemAddr addr) const
+namespace {
+
+// An entry of the per-thread name cache.
+struct CachedName
+{
+    uint64_t                     id;    ///< Table contents it was resolved for; 0 if unused
+    MemAddr                      addr;
+    shared_ptr<const string>     name;
+};
+
+// Every table, and every change to its contents, gets a new ID, so that
+// the cached names of a table are never taken for those of another.
+atomic<uint64_t> g_nextId(1);
+
+}
+
+SymbolTable::SymbolTable()
+    : m_entries(),
+      m_names(),
+      m_sorted(true),
+      m_sortLock(),
+      m_id(g_nextId.fetch_add(1, memory_order_relaxed))
+{
+}
+
+void SymbolTable::Sort() const
+{
+    if (m_sorted.load(memory_order_acquire))
+        return;
+
+    lock_guard<mutex> lock(m_sortLock);
+    if (m_sorted.load(memory_order_relaxed))
+        return;
+
+    sort(m_entries.begin(), m_entries.end());
+
+    m_names.resize(m_entries.size());
+    for (size_t i = 0; i < m_names.size(); ++i)
+        m_names[i] = i;
+    // For equal names, the lowest address comes first
+    stable_sort(m_names.begin(), m_names.end(), [this](size_t a, size_t b) {
+        return entry_sym(m_entries[a]) < entry_sym(m_entries[b]);
+    });
+
+    m_sorted.store(true, memory_order_release);
+}
+
+string SymbolTable::Resolve(MemAddr addr) const
 {
     ostringstream o;
-    // cerr << "searching for: " << hex << addr << endl;
     o << '<' << hex;
 
     /* if no entries in table, nothing to resolve */
@@ -24,37 +71,23 @@ const string SymbolTable::Resolve(MemAddr addr) const
     }
     else
     {
-        /* first, search */
-        size_t len = m_entries.size();
-        size_t cursor = 0;
-        size_t half, middle;
-
-        while (len > 0)
-        {
-            half = len / 2;
-            middle = cursor + half;
-            if (entry_addr(m_entries[middle]) < addr)
-            {
-                cursor = middle + 1;
-                len = len - half - 1;
-            }
-            else
-                len = half;
-        }
+        /* first entry at or above the address */
+        const size_t cursor = lower_bound(m_entries.begin(), m_entries.end(), addr,
+                                          [](const entry_t& e, MemAddr a) { return entry_addr(e) < a; })
+                              - m_entries.begin();
 
         if (cursor >= m_entries.size())
         {
-            // cerr << "found after last" << endl;
             // addr greater than all addresses
             // take last entry as reference
-            const entry_t & last = m_entries[m_entries.size()-1];
+            const entry_t & last = m_entries.back();
 
             // is it within last entry?
             if (addr < (entry_addr(last) + entry_sz(last)))
-                o << entry_sym(last) << "+0x" << entry_addr(last) + entry_sz(last) - addr;
+                o << entry_sym(last) << "+0x" << (addr - entry_addr(last));
             else
                 // nothing to resolve
-                o << addr;
+                o << "0x" << addr;
         }
         else
         {
@@ -66,7 +99,7 @@ const string SymbolTable::Resolve(MemAddr addr) const
             {
                 // yes, collate all equivalent symbols
                 o << entry_sym(found);
-                for (size_t more = cursor+1; entry_addr(m_entries[more]) == addr; ++more)
+                for (size_t more = cursor+1; more < m_entries.size() && entry_addr(m_entries[more]) == addr; ++more)
                     o << ',' << entry_sym(m_entries[more]);
             }
             else
@@ -82,11 +115,6 @@ const string SymbolTable::Resolve(MemAddr addr) const
                 if (cursor > 0)
                     below = m_entries[cursor-1];
 
-                /*
-                cerr << "bracket: " << hex << entry_addr(below) << ':' << entry_sym(below)
-                     << " < " << addr << " < " << entry_addr(above) << ':' << entry_sym(above) << endl;
-                */
-
                 // are we within the lower object?
                 if (addr < (entry_addr(below) + entry_sz(below)))
                     // yes, then prefer that always
@@ -115,28 +143,58 @@ const string SymbolTable::Resolve(MemAddr addr) const
     return o.str();
 }
 
-const string SymbolTable::operator[](MemAddr addr) const
+SymbolName SymbolTable::operator[](MemAddr addr) const
 {
-    /* if already in cache, get it from there */
-    cache_t::const_iterator i = m_cache.find(addr);
-    if (i != m_cache.end())
-        return i->second;
-    /* can't use cache, so simply resolve */
-    return Resolve(addr);
+    static thread_local vector<CachedName> cache(NAME_CACHE_SIZE);
+
+    Sort();
+    const uint64_t id = m_id.load(memory_order_acquire);
+    CachedName& c = cache[(addr / sizeof(Instruction)) % NAME_CACHE_SIZE];
+    if (c.id != id || c.addr != addr)
+    {
+        c.id   = id;
+        c.addr = addr;
+        c.name = make_shared<const string>(Resolve(addr));
+    }
+    return SymbolName(c.name);
 }
 
-const string& SymbolTable::operator[](MemAddr addr)
+bool SymbolTable::FindSymbol(MemAddr addr, MemAddr& start, string& name) const
 {
-    /* if already in cache, get it from there */
-    cache_t::const_iterator i = m_cache.find(addr);
-    if (i != m_cache.end())
-        return i->second;
-    /* cache result before return */
-    return m_cache[addr] = Resolve(addr);
+    Sort();
+
+    /* first entry above the address */
+    size_t cursor = upper_bound(m_entries.begin(), m_entries.end(), addr,
+                                [](MemAddr a, const entry_t& e) { return a < entry_addr(e); })
+                    - m_entries.begin();
+    if (cursor == 0)
+        return false;
+
+    // The entries at the same address are sorted on size, so the
+    // largest one comes last; it is used if it contains the address,
+    // or else one without size.
+    const MemAddr base = entry_addr(m_entries[cursor - 1]);
+    const entry_t* found = NULL;
+    for (; cursor > 0 && entry_addr(m_entries[cursor - 1]) == base; --cursor)
+    {
+        const entry_t& e = m_entries[cursor - 1];
+        if (entry_sz(e) == 0 || addr < base + entry_sz(e))
+        {
+            found = &e;
+            break;
+        }
+    }
+    if (found == NULL)
+        return false;
+
+    start = base;
+    name  = entry_sym(*found);
+    return true;
 }
 
 void SymbolTable::Write(ostream& o, const string& pat) const
 {
+    Sort();
     for (auto& i : m_entries)
     {
         if (FNM_NOMATCH != fnmatch(pat.c_str(), entry_sym(i).c_str(), 0))
@@ -151,28 +209,68 @@ void SymbolTable::Write(ostream& o, const string& pat) const
 
 bool SymbolTable::LookUp(const string& sym, MemAddr &addr, bool recurse) const
 {
-    for (auto& i : m_entries)
-        if (entry_sym(i) == sym)
-        {
-            addr = entry_addr(i);
-            return true;
-        }
+    Sort();
 
-    for (auto& i : m_cache)
-        if (i.second == sym)
+    auto i = lower_bound(m_names.begin(), m_names.end(), sym,
+                         [this](size_t e, const string& s) { return entry_sym(m_entries[e]) < s; });
+    if (i != m_names.end() && entry_sym(m_entries[*i]) == sym)
+    {
+        addr = entry_addr(m_entries[*i]);
+        return true;
+    }
+
+    if (!recurse)
+        return false;
+
+    // Parse the names made by Resolve(): "<sym>", "<sym+0xN>",
+    // "<sym-0xN>", "<sym+size+0xN>" and "<0xN>".
+    string name = sym;
+    if (name.size() >= 2 && name.front() == '<' && name.back() == '>')
+        name = name.substr(1, name.size() - 2);
+    if (name.empty())
+        return false;
+
+    if (name.compare(0, 2, "0x") == 0)
+    {
+        char* end;
+        addr = strtoull(name.c_str() + 2, &end, 16);
+        return *end == '\0' && name.size() > 2;
+    }
+
+    const size_t pos = name.find_last_of("+-");
+    if (pos == string::npos || pos == 0 || name.compare(pos + 1, 2, "0x") != 0)
+        return name != sym && LookUp(name, addr, false);
+
+    char* end;
+    const MemAddr ofs = strtoull(name.c_str() + pos + 3, &end, 16);
+    if (*end != '\0' || name.size() == pos + 3)
+        return false;
+
+    string base = name.substr(0, pos);
+    MemAddr skip = 0;
+    if (name[pos] == '+')
+    {
+        // The size of the object may precede the offset
+        const size_t szpos = base.find_last_of('+');
+        if (szpos != string::npos && szpos > 0 && base.find_first_not_of("0123456789", szpos + 1) == string::npos && szpos + 1 < base.size())
         {
-            addr = i.first;
-            return true;
+            skip = strtoull(base.c_str() + szpos + 1, NULL, 10);
+            base = base.substr(0, szpos);
         }
+    }
 
-    if (recurse)
-        return LookUp('<' + sym + '>', addr, false);
-    return false;
+    if (!LookUp(base, addr, false))
+        return false;
+    addr = (name[pos] == '+') ? addr + skip + ofs : addr - ofs;
+    return true;
 }
 
 void SymbolTable::AddSymbol(MemAddr addr, const string& name, size_t sz)
 {
+    // Sorting is left to the next lookup, so that loading a program
+    // does not sort the table once for every symbol.
+    lock_guard<mutex> lock(m_sortLock);
     m_entries.push_back(make_pair(addr, make_pair(sz, name)));
-    sort(m_entries.begin(), m_entries.end());
-    m_cache.clear();
+    m_sorted.store(false, memory_order_release);
+    m_id.store(g_nextId.fetch_add(1, memory_order_relaxed), memory_order_release);
 }
@@ -7,36 +7,76 @@
 #include <vector>
 #include <utility>
 #include <string>
-#include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
 #include <iostream>
 
 namespace Simulator {
 
+// A name returned by SymbolTable::operator[]. It shares the string with
+// the name cache, so it remains valid after the cache has dropped it.
+class SymbolName
+{
+    std::shared_ptr<const std::string> m_name;
+
+public:
+    explicit SymbolName(std::shared_ptr<const std::string> name) : m_name(std::move(name)) {}
+
+    const std::string& str() const { return *m_name; }
+    const char* c_str() const { return m_name->c_str(); }
+    operator const std::string&() const { return *m_name; }
+};
+
+inline std::ostream& operator<<(std::ostream& o, const SymbolName& name)
+{
+    return o << name.str();
+}
+
 class SymbolTable
 {
 public:
     typedef std::pair<size_t, std::string> sym_t;
     typedef std::pair<MemAddr, sym_t> entry_t;
 
-    SymbolTable() : m_entries(), m_cache() {}
-    SymbolTable(const SymbolTable&) = default;
+    SymbolTable();
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
 
     void AddSymbol(MemAddr addr, const std::string& name, size_t sz = 0);
 
     void Write(std::ostream& o, const std::string& pat = "*") const;
 
+    // Finds the address of a symbol. With recurse, this also accepts
+    // the names returned by operator[], e.g. "main+0x10".
     bool LookUp(const std::string& sym, MemAddr &addr, bool recurse = true) const;
 
-    const std::string& operator[](MemAddr addr);
-    const std::string operator[](MemAddr addr) const;
+    // Returns the symbolic name of an address, e.g. "<main+0x10>".
+    // The last names resolved are cached per host thread, in a table
+    // of NAME_CACHE_SIZE entries indexed by address, so that repeated
+    // lookups take no lock and do not format the name again.
+    SymbolName operator[](MemAddr addr) const;
+
+    static const size_t NAME_CACHE_SIZE = 1024;
+
+    // Finds the symbol that an address belongs to: the one at the
+    // highest address at or below it, if the address is within its
+    // size or it has none. Returns false if there is no such symbol.
+    bool FindSymbol(MemAddr addr, MemAddr& start, std::string& name) const;
 
 protected:
-    const std::string Resolve(MemAddr addr) const;
+    std::string Resolve(MemAddr addr) const;
+    void Sort() const;
 
     typedef std::vector<entry_t> table_t;
-    table_t m_entries;
-    typedef std::map<MemAddr, std::string> cache_t;
-    cache_t m_cache;
+
+    // The entries are sorted on address, and the name index on name,
+    // by the first lookup after symbols were added.
+    mutable table_t             m_entries;
+    mutable std::vector<size_t> m_names;    ///< Indices in m_entries, in name order
+    mutable std::atomic<bool>   m_sorted;
+    mutable std::mutex          m_sortLock;
+    std::atomic<uint64_t>       m_id;       ///< Identifies the table and its contents in the name caches
 };
 
 }
@@ -1,7 +1,10 @@
 #include "commands.h"
 #include <sim/sampling.h>
+#include <arch/GuestProfiler.h>
 #include <arch/dev/IODeviceDatabase.h>
 
+#include <fstream>
+
 using namespace Simulator;
 using namespace std;
 
@@ -56,3 +59,120 @@ bool cmd_show_devdb(const vector<string>& /*command*/, vector<string>& /*args*/,
     return false;
 }
 
+
+bool cmd_show_profile(const vector<string>& /*command*/, vector<string>& args, cli_context& ctx)
+{
+    string pat = "*";
+    if (!args.empty())
+        pat = args[0];
+
+    size_t depth = 0;
+    if (args.size() > 1)
+        depth = strtoul(args[1].c_str(), 0, 0);
+
+    const Kernel& kernel = *ctx.sys.GetKernel();
+    const Profile profile = kernel.GetProfile();
+    if (!kernel.GetProfiling() && profile.total == 0)
+    {
+        cout << "No profile; use 'profile on' to start profiling." << endl;
+        return false;
+    }
+    profile.Print(cout, pat, depth);
+    return false;
+}
+
+bool cmd_profile(const vector<string>& /*command*/, vector<string>& args, cli_context& ctx)
+{
+    Kernel& kernel = *ctx.sys.GetKernel();
+    if (!args.empty())
+    {
+        if      (args[0] == "on")    kernel.SetProfiling(true);
+        else if (args[0] == "off")   kernel.SetProfiling(false);
+        else if (args[0] == "reset") kernel.ResetProfile();
+        else if (args[0] == "save")
+        {
+            if (args.size() < 2)
+            {
+                cout << "Usage: profile save FILE" << endl;
+                return false;
+            }
+            ofstream of(args[1].c_str(), ios::out);
+            kernel.GetProfile().WriteFolded(of);
+            if (!of)
+                cout << "Unable to write " << args[1] << endl;
+            return false;
+        }
+        else
+        {
+            cout << "Unknown profile command: " << args[0] << endl;
+            return false;
+        }
+    }
+    cout << "Profiling is " << (kernel.GetProfiling() ? "enabled" : "disabled") << "." << endl;
+    return false;
+}
+
+bool cmd_show_gprofile(const vector<string>& /*command*/, vector<string>& args, cli_context& ctx)
+{
+    string pat = "*";
+    if (!args.empty())
+        pat = args[0];
+
+    size_t count = 20;
+    if (args.size() > 1)
+        count = strtoul(args[1].c_str(), 0, 0);
+
+    const GuestProfiler& profiler = ctx.sys.GetGuestProfiler();
+    if (profiler.GetInterval() == 0 && !profiler.HasSamples())
+    {
+        cout << "No guest profile; use 'gprofile on' to start sampling." << endl;
+        return false;
+    }
+    profiler.Print(cout, pat, count);
+    return false;
+}
+
+bool cmd_gprofile(const vector<string>& /*command*/, vector<string>& args, cli_context& ctx)
+{
+    GuestProfiler& profiler = ctx.sys.GetGuestProfiler();
+    if (!args.empty())
+    {
+        if (args[0] == "on")
+        {
+            CycleNo interval = 1000;
+            if (args.size() > 1)
+                interval = strtoull(args[1].c_str(), 0, 0);
+            if (interval == 0)
+            {
+                cout << "Usage: gprofile on [N], with N > 0" << endl;
+                return false;
+            }
+            profiler.SetInterval(interval);
+        }
+        else if (args[0] == "off")   profiler.SetInterval(0);
+        else if (args[0] == "reset") profiler.Reset();
+        else if (args[0] == "save")
+        {
+            if (args.size() < 2)
+            {
+                cout << "Usage: gprofile save FILE" << endl;
+                return false;
+            }
+            ofstream of(args[1].c_str(), ios::out);
+            profiler.WriteFolded(of);
+            if (!of)
+                cout << "Unable to write " << args[1] << endl;
+            return false;
+        }
+        else
+        {
+            cout << "Unknown gprofile command: " << args[0] << endl;
+            return false;
+        }
+    }
+    if (profiler.GetInterval() == 0)
+        cout << "Guest PC sampling is disabled." << endl;
+    else
+        cout << "Guest PC sampling is enabled, every " << profiler.GetInterval() << " cycles." << endl;
+    return false;
+}
@@ -32,6 +32,83 @@ bool cmd_run(const vector<string>& command, vector<string>& args, cli_context& c
     return false;
 }
 
+bool cmd_directmem(const vector<string>& /*command*/, vector<string>& args, cli_context& ctx)
+{
+    try
+    {
+        ctx.sys.SetDirectMemory(true);
+    }
+    catch (const exception& e)
+    {
+        PrintException(&ctx.sys, cerr, e);
+        return false;
+    }
+    if (args.empty())
+    {
+        cout << "Direct-memory mode enabled; use 'switch' to resume simulating the memory system." << endl;
+        return false;
+    }
+
+    // Run the specified number of cycles this way, then switch back
+    const CycleNo nCycles = max(1UL, strtoul(args[0].c_str(), 0, 0));
+    ctx.clr.CheckPointHistory();
+
+    ctx.mon.start();
+    try
+    {
+        StepSystem(ctx.sys, nCycles);
+    }
+    catch (const exception& e)
+    {
+        PrintException(&ctx.sys, cerr, e);
+    }
+    ctx.mon.stop();
+
+    ctx.sys.SetDirectMemory(false);
+    cout << "Direct-memory mode ended at cycle " << ctx.sys.GetKernel()->GetCycleNo() << "; the memory system is simulated again." << endl;
+    return false;
+}
+
+bool cmd_switch(const vector<string>& /*command*/, vector<string>& /*args*/, cli_context& ctx)
+{
+    if (!ctx.sys.IsDirectMemory())
+    {
+        cout << "Not in direct-memory mode." << endl;
+        return false;
+    }
+    ctx.sys.SetDirectMemory(false);
+    cout << "The memory system is simulated again from cycle " << ctx.sys.GetKernel()->GetCycleNo() << "." << endl;
+    return false;
+}
+
+bool cmd_checkpoint_save(const vector<string>& /*command*/, vector<string>& args, cli_context& ctx)
+{
+    try
+    {
+        ctx.sys.SaveCheckpoint(args[0]);
+        cout << "Checkpoint saved at cycle " << ctx.sys.GetKernel()->GetCycleNo() << "." << endl;
+    }
+    catch (const exception& e)
+    {
+        PrintException(&ctx.sys, cerr, e);
+    }
+    return false;
+}
+
+bool cmd_checkpoint_load(const vector<string>& /*command*/, vector<string>& args, cli_context& ctx)
+{
+    try
+    {
+        ctx.sys.LoadCheckpoint(args[0]);
+        cout << "Checkpoint restored at cycle " << ctx.sys.GetKernel()->GetCycleNo() << "." << endl;
+    }
+    catch (const exception& e)
+    {
+        PrintException(&ctx.sys, cerr, e);
+    }
+    return false;
+}
+
 bool cmd_state(const vector<string>& /*command*/, vector<string>& args, cli_context& ctx)
 {
     ctx.sys.PrintState(args);
@@ -33,8 +33,11 @@ extern command_handler
     cmd_bp_off,
     cmd_bp_on,
     cmd_bp_state,
+    cmd_checkpoint_load,
+    cmd_checkpoint_save,
     cmd_disas,
     cmd_dump,
+    cmd_directmem,
     cmd_help,
     cmd_info,
     cmd_line,
@@ -48,8 +51,13 @@ extern command_handler
     cmd_show_components,
     cmd_show_processes,
     cmd_show_devdb,
+    cmd_show_profile,
+    cmd_profile,
+    cmd_show_gprofile,
+    cmd_gprofile,
     cmd_state,
     cmd_stats,
+    cmd_switch,
     cmd_run,
     cmd_trace_show,
     cmd_trace_debug,
@@ -5,12 +5,15 @@
 #include "simreadline.h"
 #include "commands.h"
 #include <arch/MGSystem.h>
+#include <arch/GuestProfiler.h>
 #include <sim/config.h>
 #include <sim/configparser.h>
 #include <sim/readfile.h>
 #include <sim/rusage.h>
 #include <sim/sampling.h>
 #include <sim/monitor.h>
+#include <sim/sampledsim.h>
+#include <sim/statsdump.h>
 
 #include <sstream>
 #include <iostream>
@@ -38,6 +41,10 @@ struct ProgramConfig
     bool                             m_quiet;
     bool                             m_dumpvars;
     vector<string>                   m_printvars;
+    string                           m_profileFile;
+    CycleNo                          m_directMemory;
+    bool                             m_sample;
+    string                           m_restoreFile;
     bool                             m_earlyquit;
     ConfigMap                        m_overrides;
     vector<string>                   m_extradevs;
@@ -58,6 +65,10 @@ struct ProgramConfig
           m_quiet(false),
           m_dumpvars(false),
           m_printvars(),
+          m_profileFile(),
+          m_directMemory(0),
+          m_sample(false),
+          m_restoreFile(),
           m_earlyquit(false),
           m_overrides(),
           m_extradevs(),
@@ -122,6 +133,9 @@ static const struct argp_option mgsim_options[] =
     { "do-nothing", 'n', 0, 0, "Exit before the program starts, but after the system is configured.", 3 },
     { "quiet", 'q', 0, 0, "Do not print simulation statistics after execution.", 3 },
     { "terminate", 't', 0, 0, "Terminate the simulator upon an exception, instead of dropping to the interactive prompt.", 3 },
+    { "directmem", 14, "N", 0, "Run the first N cycles with the loads, stores and fetches accessing the memory contents directly, without cache and memory timing. The pipelines are still simulated cycle by cycle.", 3 },
+    { "sample", 15, 0, 0, "Simulate the memory system in detail only in periodic windows, and estimate the statistics of the whole program (configure with -o Sampling...). Only the L1 caches are warmed between windows; the pipelines still run cycle by cycle, and memory systems with L2 caches or directories are not supported.", 3 },
+    { "restore", 16, "FILE", 0, "Restore the state of the simulation from the checkpoint FILE before it starts. The configuration and program must be the same as when the checkpoint was saved.", 3 },
 
 #ifdef ENABLE_CACTI
     { "area", 'a', "VAL", 0, "Dump area information prior to program startup using CACTI. Assume technology is VAL nanometers.", 4 },
@@ -129,6 +143,7 @@ static const struct argp_option mgsim_options[] =
 
     { "list-mvars", 'l', 0, 0, "Dump list of monitor variables prior to program startup.", 5 },
     { "print-final-mvars", 'p', "PATTERN", 0, "Print the value of all monitoring variables matching PATTERN. Can be specified multiple times.", 5 },
+    { "profile", 13, "FILE", 0, "Measure the host time spent per component and write it to FILE as folded stacks at the end of the simulation.", 5 },
 
     { "dump-topology", 'T', "FILE", 0, "Dump the grid topology to FILE prior to program startup.", 6 },
     { "no-node-properties", 11, 0, 0, "Do not print component properties in the topology dump.", 6 },
@@ -173,6 +188,10 @@ static error_t mgsim_parse_opt(int key, char *arg, struct argp_state *state)
     case 'T': config.m_dumptopo = true; config.m_topofile = arg; break;
     case 11 : config.m_dumpnodeprops = false; break;
     case 12 : config.m_dumpedgeprops = false; break;
+    case 13 : config.m_profileFile = arg; break;
+    case 14 : config.m_directMemory = strtoull(arg, 0, 0); break;
+    case 15 : config.m_sample = true; break;
+    case 16 : config.m_restoreFile = arg; break;
     case 'n': config.m_earlyquit = true; break;
     case 'o':
     {
@@ -263,15 +282,42 @@ void PrintFinalVariables(const Kernel& kernel, const ProgramConfig& cfg)
 }
 
 static
-void AtEnd(const MGSystem& sys, const ProgramConfig& cfg)
+void AtEnd(const MGSystem& sys, const ProgramConfig& cfg, const SampledSimulation* sampler)
 {
     if (!cfg.m_quiet)
     {
         clog << "### begin end-of-simulation statistics" << endl;
         sys.PrintAllStatistics(clog);
         clog << "### end end-of-simulation statistics" << endl;
+        if (sampler != NULL)
+        {
+            clog << "### begin sampled simulation estimates" << endl;
+            sampler->PrintStatistics(clog);
+            clog << "### end sampled simulation estimates" << endl;
+        }
+        if (sys.GetGuestProfiler().HasSamples())
+        {
+            clog << "### begin guest profile" << endl;
+            sys.GetGuestProfiler().Print(clog);
+            clog << "### end guest profile" << endl;
+        }
     }
     PrintFinalVariables(*sys.GetKernel(), cfg);
+
+    if (!cfg.m_profileFile.empty())
+    {
+        ofstream of(cfg.m_profileFile.c_str(), ios::out);
+        sys.GetKernel()->GetProfile().WriteFolded(of);
+        of.close();
+    }
+
+    string gprofileFile = sys.GetKernel()->GetConfig()->getValueOrDefault<string>("GuestProfileFile", "");
+    if (!gprofileFile.empty() && sys.GetGuestProfiler().HasSamples())
+    {
+        ofstream of(gprofileFile.c_str(), ios::out);
+        sys.GetGuestProfiler().WriteFolded(of);
+        of.close();
+    }
 }
 
 static
@@ -297,6 +343,8 @@ int main(int argc, char** argv)
     UNIQUE_PTR<Config> config;
     UNIQUE_PTR<MGSystem> sys;
     UNIQUE_PTR<Monitor> mo;
+    UNIQUE_PTR<SampledSimulation> sampler;
+    UNIQUE_PTR<StatsDumper> stats;
 
     ////
     // Early initialization.
@@ -470,6 +518,22 @@ int main(int argc, char** argv)
 
     // Otherwise, the simulation should start.
 
+    if (!flags.m_restoreFile.empty())
+    {
+        // Continue from a checkpoint instead of the initial state.
+        try
+        {
+            sys->LoadCheckpoint(flags.m_restoreFile);
+        }
+        catch (const exception& e)
+        {
+            PrintException(sys.get(), cerr, e);
+            return 1;
+        }
+        clog << "### restored checkpoint " << flags.m_restoreFile
+             << " at cycle " << sys->GetKernel()->GetCycleNo() << endl;
+    }
+
     ////
     // Start the simulation.
 
@@ -479,6 +543,38 @@ int main(int argc, char** argv)
     mo.reset(new Monitor(*sys, flags.m_enableMonitor,
                          mo_mdfile, flags.m_earlyquit ? "" : mo_tfile, !flags.m_interactive));
 
+    // Then the statistics dump, if enabled.
+    if (config->getValueOrDefault<CycleNo>("StatsDumpInterval", 0) > 0)
+    {
+        try
+        {
+            stats.reset(new StatsDumper(*sys, config->getValueOrDefault<string>("StatsDumpFile", "mgstats.out")));
+        }
+        catch (const exception& e)
+        {
+            PrintException(sys.get(), cerr, e);
+            return 1;
+        }
+    }
+
+    if (!flags.m_profileFile.empty())
+    {
+        sys->GetKernel()->SetProfiling(true);
+    }
+
+    if (flags.m_sample && !flags.m_interactive)
+    {
+        try
+        {
+            sampler.reset(new SampledSimulation(*sys));
+        }
+        catch (const exception& e)
+        {
+            PrintException(sys.get(), cerr, e);
+            return 1;
+        }
+    }
+
     // Simulation proper.
     // Rules:
     // - if interactive, then do not automatically start the simulation.
@@ -497,6 +593,16 @@ int main(int argc, char** argv)
             try
             {
                 mo->start();
+                if (flags.m_directMemory > 0)
+                {
+                    sys->SetDirectMemory(true);
+                    StepSystem(*sys, flags.m_directMemory);
+                    sys->SetDirectMemory(false);
+                }
+                if (sampler)
+                {
+                    sampler->Run([&](CycleNo cycles) { StepSystem(*sys, cycles); });
+                }
                 StepSystem(*sys, INFINITE_CYCLES);
                 mo->stop();
 
@@ -537,8 +643,11 @@ int main(int argc, char** argv)
             PrintException(sys.get(), cerr, e);
 
         // Print statistics & final variables.
-        AtEnd(*sys, flags);
+        AtEnd(*sys, flags, sampler.get());
 
+        // The monitor and statistics dump detach from the kernel.
+        mo.reset(nullptr);
+        stats.reset(nullptr);
         sys.reset(nullptr);
         if (ex != NULL)
         {
@@ -554,8 +663,11 @@ int main(int argc, char** argv)
     }
 
     // Print statistics & final variables.
-    AtEnd(*sys, flags);
+    AtEnd(*sys, flags, sampler.get());
 
+    // The monitor and statistics dump detach from the kernel.
+    mo.reset(nullptr);
+    stats.reset(nullptr);
     sys.reset(nullptr);
     return 0;
 }
@@ -13,12 +13,17 @@ command_descriptor command_table[] =
     { { "breakpoint", "off", 0  },    0, 0,  cmd_bp_off,     "breakpoint off",    "Disable breakpoint detection." },
     { { "breakpoint", "on", 0  },     0, 0,  cmd_bp_on,      "breakpoint on",     "Enable breakpoint detection." },
     { { "breakpoint", "state", 0  },  0, 0,  cmd_bp_state,   "breakpoint state",  "Report which breakpoints have been reached." },
+    { { "checkpoint", "load", 0 },    1, 1,  cmd_checkpoint_load, "checkpoint load FILE", "Restore the state of the simulation from FILE." },
+    { { "checkpoint", "save", 0 },    1, 1,  cmd_checkpoint_save, "checkpoint save FILE", "Save the state of the simulation to FILE." },
+    { { "directmem", 0 },             0, 1,  cmd_directmem,  "directmem [N]",    "Let loads, stores and fetches access the memory contents directly, without cache and memory timing, for N cycles or until 'switch'." },
     { { "disassemble", 0 },           1, 2,  cmd_disas,      "disassemble ADDR [SZ]", "Disassemble the program from address ADDR." },
     { { "dump", 0 },                  1, 1,  cmd_dump   ,    "dump PAT",          "Dump variables with names matching PAT" },
+    { { "gprofile", 0 },              0, 2,  cmd_gprofile,   "gprofile [on [N]|off|reset|save FILE]", "Control sampling of the guest PCs every N cycles (default 1000), or save the samples to FILE as folded stacks." },
     { { "help", 0 },                  0, 1,  cmd_help,       "help [COMMAND]",    "Print the help text for COMMAND, or this text if no command is specified." },
     { { "info", 0 },                  1, -1, cmd_info,       "info COMPONENT [ARGS...]",    "Show help/configuration/layout for COMPONENT." },
     { { "line", 0 },                  2, 2,  cmd_line,       "line COMPONENT ADDR", "Lookup the memory line at address ADDR in the memory system COMPONENT." },
     { { "lookup", 0 },                1, 1,  cmd_lookup,     "lookup ADDR",       "Look up the program symbol closest to address ADDR." },
+    { { "profile", 0 },               0, 2,  cmd_profile,    "profile [on|off|reset|save FILE]", "Control host time profiling, or save the profile to FILE as folded stacks." },
     { { "quit", 0 },                  0, 0,  cmd_quit,       "quit",              "Exit the simulation." },
     { { "inspect", 0 },               1, -1, cmd_inspect,    "inspect NAME [ARGS...]", "Inspect NAME. See 'info NAME' for details." },
     { { "run", 0 },                   0, 0,  cmd_run,        "run",               "Run the system until it is idle or deadlocks. Livelocks will not be reported." },
@@ -28,9 +33,12 @@ command_descriptor command_table[] =
     { { "show", "components", 0 },    0, 2,  cmd_show_components, "show components [PAT] [LEVEL]",   "List components matching PAT (at most LEVELs)." },
     { { "show", "processes", 0 },     0, 1,  cmd_show_processes, "show processes [PAT]",   "List processes matching PAT." },
     { { "show", "devicedb", 0 },      0, 0,  cmd_show_devdb, "show devicedb",     "List the I/O device identifier database." },
+    { { "show", "profile", 0 },       0, 2,  cmd_show_profile, "show profile [PAT] [DEPTH]", "List host time per process, storage and arbitrator matching PAT, or per component up to DEPTH levels." },
+    { { "show", "gprofile", 0 },      0, 2,  cmd_show_gprofile, "show gprofile [PAT] [COUNT]", "List the guest PC samples of the cores matching PAT, and the COUNT functions and instructions with the most samples." },
     { { "state", 0 },                 0, 0,  cmd_state,       "state",            "Show the state of the system. Idle components are left out." },
     { { "statistics", 0 },            0, 0,  cmd_stats,       "statistics",       "Print the current simulation statistics." },
     { { "step", 0 },                  0, 1,  cmd_run,         "step [N]",         "Advance the system by N clock cycles (default 1)." },
+    { { "switch", 0 },                0, 0,  cmd_switch,      "switch",           "Leave direct-memory mode and resume simulating the memory system." },
     { { "trace", "line", 0 },         2, 3,  cmd_trace_line,   "trace line COMPONENT ADDR [clear]",  "Enable/Disable tracing of the cache line at address ADDR by memory COMPONENT." },
     { { "trace", 0 },                 0, -1, cmd_trace_debug,  "trace [FLAGS...]", "Show current traces / toggle tracing of FLAGS." },
     { { "write", 0 },                 1, -1, cmd_write,        "write NAME [ARGS...]", "Write property of object NAME." },
@@ -51,6 +59,7 @@ command_alias alias_table[] =
     { "d"       , { "disassemble", 0 } },
     { "debug"   , { "trace", 0 } },
     { "dis"     , { "disassemble", 0 } },
+    { "dm"      , { "directmem", 0 } },
     { "exit"    , { "quit", 0 } },
     { "h"       , { "help", 0 } },
     { "i"       , { "info", 0 } },
@@ -0,0 +1,68 @@
+#include "demo/bufferbench.h"
+#include "sim/delegate.h"
+
+#include <algorithm>
+
+ExamplePipeStage::ExamplePipeStage(const std::string& name, Simulator::Object& parent, Simulator::Clock& clock,
+                                   size_t sz, ExamplePipeStage* next)
+    : Simulator::Object(name, parent),
+      m_packets(0),
+      m_next(next),
+      m_input("b_input", *this, clock, sz),
+      p_Forward(*this, "forward", Simulator::delegate::create<ExamplePipeStage, &ExamplePipeStage::DoForward>(*this))
+{
+    m_input.Sensitive(p_Forward);
+    if (next != NULL)
+        p_Forward.SetStorageTraces(next->m_input);
+    else
+        p_Forward.SetStorageTraces(Simulator::StorageTraceSet(Simulator::StorageTrace()));
+}
+
+Simulator::Result
+ExamplePipeStage::DoForward()
+{
+    assert(!m_input.Empty());
+    const ExamplePacket& p = m_input.Front();
+
+    if (m_next != NULL && !m_next->m_input.Push(p))
+    {
+        return Simulator::FAILED;
+    }
+    m_input.Pop();
+
+    COMMIT {
+        ++m_packets;
+    }
+    return Simulator::SUCCESS;
+}
+
+ExamplePipeSource::ExamplePipeSource(const std::string& name, Simulator::Object& parent, Simulator::Clock& clock,
+                                     ExamplePipeStage& first)
+    : Simulator::Object(name, parent),
+      m_counter(0),
+      m_first(first),
+      p_Produce(*this, "produce", Simulator::delegate::create<ExamplePipeSource, &ExamplePipeSource::DoProduce>(*this)),
+      m_enabled("f_enabled", *this, clock, true)
+{
+    m_enabled.Sensitive(p_Produce);
+    p_Produce.SetStorageTraces(first.m_input);
+}
+
+Simulator::Result
+ExamplePipeSource::DoProduce()
+{
+    ExamplePacket p;
+    p.id      = m_counter;
+    p.address = m_counter * sizeof p.data;
+    std::fill(p.data, p.data + sizeof p.data, (char)m_counter);
+    std::fill(p.mask, p.mask + sizeof p.mask, true);
+
+    if (!m_first.m_input.Push(std::move(p)))
+    {
+        return Simulator::FAILED;
+    }
+    COMMIT {
+        ++m_counter;
+    }
+    return Simulator::SUCCESS;
+}
@@ -0,0 +1,55 @@
+// -*- c++ -*-
+#ifndef BUFFERBENCH_H
+#define BUFFERBENCH_H
+
+#include "sim/kernel.h"
+#include "sim/buffer.h"
+#include "sim/flag.h"
+
+// A payload about the size of a memory request.
+struct ExamplePacket
+{
+    uint64_t id;
+    uint64_t address;
+    char     data[64];
+    bool     mask[64];
+    SERIALIZE(a) {
+        a & id & address
+          & Simulator::Serialization::binary(data, sizeof data)
+          & Simulator::Serialization::bitvec(mask, sizeof mask);
+    }
+};
+
+// A pipeline stage that forwards every packet from its input buffer
+// to the next stage, or drops it at the end of the pipeline.
+// Long pipelines of these measure the cost of Buffer operations.
+class ExamplePipeStage : public Simulator::Object
+{
+public:
+    ExamplePipeStage(const std::string& name, Simulator::Object& parent, Simulator::Clock& clock,
+                     size_t sz, ExamplePipeStage* next);
+
+    Simulator::Result DoForward();
+
+    uint64_t                         m_packets;
+    ExamplePipeStage*                m_next;
+    Simulator::Buffer<ExamplePacket> m_input;
+    Simulator::Process               p_Forward;
+};
+
+// Feeds a new packet into the first stage of a pipeline every cycle.
+class ExamplePipeSource : public Simulator::Object
+{
+public:
+    ExamplePipeSource(const std::string& name, Simulator::Object& parent, Simulator::Clock& clock,
+                      ExamplePipeStage& first);
+
+    Simulator::Result DoProduce();
+
+    uint64_t            m_counter;
+    ExamplePipeStage&   m_first;
+    Simulator::Process  p_Produce;
+    Simulator::Flag     m_enabled;
+};
+
+#endif
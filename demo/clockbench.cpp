@@ -0,0 +1,20 @@
+#include "demo/clockbench.h"
+#include "sim/delegate.h"
+
+ExampleTicker::ExampleTicker(const std::string& name, Simulator::Object& parent, Simulator::Clock& clock)
+    : Simulator::Object(name, parent),
+      m_ticks(0),
+      p_Tick(*this, "tick", Simulator::delegate::create<ExampleTicker, &ExampleTicker::DoTick>(*this)),
+      m_enabled("f_enabled", *this, clock, true)
+{
+    m_enabled.Sensitive(p_Tick);
+}
+
+Simulator::Result
+ExampleTicker::DoTick()
+{
+    COMMIT {
+        ++m_ticks;
+    }
+    return Simulator::SUCCESS;
+}
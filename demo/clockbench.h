@@ -0,0 +1,22 @@
+// -*- c++ -*-
+#ifndef CLOCKBENCH_H
+#define CLOCKBENCH_H
+
+#include "sim/kernel.h"
+#include "sim/flag.h"
+
+// A component that does nothing but run on every tick of its clock.
+// Many of these on different clocks stress the kernel's clock scheduling.
+class ExampleTicker : public Simulator::Object
+{
+public:
+    ExampleTicker(const std::string& name, Simulator::Object& parent, Simulator::Clock& clock);
+
+    Simulator::Result DoTick();
+
+    uint64_t           m_ticks;
+    Simulator::Process p_Tick;
+    Simulator::Flag    m_enabled;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "demo/dirbench.h"
+
+#include "sim/flatmap.h"
+#include "arch/simtypes.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace Simulator;
+
+namespace {
+
+// One access to the directory. A hit updates the token count of a
+// line that is present; a miss evicts the oldest line if the
+// directory is full and inserts a new one.
+struct Access
+{
+    MemAddr address;
+    MemAddr victim;
+    bool    miss;
+    bool    evict;
+};
+
+// Builds a trace in which most accesses hit lines that are present,
+// biased towards the recently inserted ones, and the misses walk
+// sequential lines with an occasional jump to another region, like
+// the line fills of streaming kernels.
+std::vector<Access> MakeTrace(size_t numOps, size_t numLines, double missRate)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> coin(0, 1);
+    std::geometric_distribution<size_t> age(4.0 / numLines);
+
+    std::vector<MemAddr> resident(numLines);  // Ring of present lines, oldest first
+    size_t  head = 0, count = 0;
+    MemAddr next = 0;
+
+    std::vector<Access> trace(numOps);
+    for (auto& a : trace)
+    {
+        if (count == 0 || coin(rng) < missRate)
+        {
+            if (coin(rng) < 1.0 / 64)
+                next = (rng() & 0xffffffffff) * 64;
+            a.address = next;
+            a.miss    = true;
+            a.evict   = (count == numLines);
+            next += 64;
+            if (a.evict)
+            {
+                a.victim = resident[head];
+                resident[head] = a.address;
+                head = (head + 1) % numLines;
+            }
+            else
+            {
+                resident[(head + count++) % numLines] = a.address;
+            }
+        }
+        else
+        {
+            size_t back = std::min(age(rng), count - 1);
+            a.address = resident[(head + count - 1 - back) % numLines];
+            a.miss    = false;
+            a.evict   = false;
+        }
+    }
+    return trace;
+}
+
+// Replays the trace on a directory, and returns the number of
+// nanoseconds per access.
+template<typename Map>
+double Replay(Map& dir, const std::vector<Access>& trace, size_t& sum)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (auto& a : trace)
+    {
+        if (a.miss)
+        {
+            if (a.evict)
+                dir.erase(a.victim);
+            dir.insert(std::make_pair(a.address, (size_t)1));
+        }
+        else
+        {
+            auto p = dir.find(a.address);
+            sum += ++p->second;
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() * 1e9 / trace.size();
+}
+
+}
+
+void RunDirectoryBenchmark(size_t numOps, size_t numLines)
+{
+    if (numLines == 0)
+        numLines = 1;
+
+    std::cout << numOps << " accesses to a directory of " << numLines << " lines:" << std::endl
+              << "miss rate    std::map (ns/op)  FlatMap (ns/op)" << std::endl;
+
+    size_t sum = 0;
+    for (double missRate : { 0.05, 0.25, 0.5 })
+    {
+        auto trace = MakeTrace(numOps, numLines, missRate);
+
+        std::map<MemAddr, size_t> map;
+        FlatMap<MemAddr, size_t>  flat;
+        flat.reserve(numLines);
+
+        double m = Replay(map, trace, sum);
+        double f = Replay(flat, trace, sum);
+        if (map.size() != flat.size())
+            std::cout << "size mismatch: " << map.size() << " != " << flat.size() << std::endl;
+
+        std::cout << std::left << std::setw(12) << missRate << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(17) << m
+                  << std::setw(17) << f << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+
+    // Keep the results from being optimized away.
+    if (sum == (size_t)-1)
+        std::cout << sum << std::endl;
+}
@@ -0,0 +1,12 @@
+// -*- c++ -*-
+#ifndef DIRBENCH_H
+#define DIRBENCH_H
+
+#include <cstddef>
+
+// Replay a trace of directory accesses on a CDMA-style directory of
+// numLines lines, stored in a std::map as the directories did before
+// and in a FlatMap, and print the time per access for both.
+void RunDirectoryBenchmark(size_t numOps, size_t numLines);
+
+#endif
@@ -2,9 +2,18 @@
 #include "demo/memclient.h"
 #include "demo/prodcons.h"
 #include "demo/prodcons2.h"
+#include "demo/clockbench.h"
+#include "demo/vmembench.h"
+#include "demo/linebench.h"
+#include "demo/dirbench.h"
+#include "demo/bufferbench.h"
+#include "demo/tracebench.h"
+#include "demo/portbench.h"
+#include "demo/varbench.h"
 
 #include "arch/mem/SerialMemory.h"
 
+#include <chrono>
 #include <cstdlib>
 
 
@@ -18,11 +27,31 @@ int main(int argc, char *argv[])
                   << "Supported demos:" << std::endl
                   << "   memory          Demo of the memory subsystem with a serial memory." << std::endl
                   << "   prodcons N M S  Demo a producer-consumer with a buffer of size S" << std::endl
-                  << "                   and frequency ratio N/M." << std::endl;
+                  << "                   and frequency ratio N/M." << std::endl
+                  << "   clocks N C      Time C cycles of N components in separate" << std::endl
+                  << "                   clock domains." << std::endl
+                  << "   vmem N P        Time N line reads/writes to P pages of" << std::endl
+                  << "                   VirtualMemory against a std::map." << std::endl
+                  << "   lines N L       Time N masked merges of L-byte lines with" << std::endl
+                  << "                   LineMask against bool arrays." << std::endl
+                  << "   buffers N S C   Time C cycles of a pipeline of N stages" << std::endl
+                  << "                   connected by buffers of size S." << std::endl
+                  << "   dirs N L        Time N accesses to a directory of L lines" << std::endl
+                  << "                   with FlatMap against a std::map." << std::endl
+                  << "   trace F N C     Write a synthetic memory trace of N requests" << std::endl
+                  << "                   from C clients to file F, and time reading it." << std::endl
+                  << "   ports N I C     Time C cycles of N clients that compete for" << std::endl
+                  << "                   shared ports and write to I shared indices." << std::endl
+                  << "   vars N          Time pattern lookups among the variables" << std::endl
+                  << "                   of N cores against fnmatch." << std::endl;
 	return 0;
     }
     MGSim env(argv[1]);
     std::string demo = argv[2];
+    Simulator::CycleNo cycles = 100000;
+    std::vector<ExampleTicker*> tickers;
+    std::vector<ExamplePipeStage*> stages;
+    std::vector<ExampleArbiterClient*> clients;
 
     // To show the configuration found so far: env.cfg->dumpConfiguration(std::cerr, argv[1]);
 
@@ -90,6 +119,123 @@ int main(int argc, char *argv[])
 	// Initialize the memory -- after all clients have been registered
 	mem->Initialize();
     }
+    else if (demo == "clocks")
+    {
+	size_t n = 16;
+	if (argc > 3)
+            n = atoi(argv[3]);
+	if (argc > 4)
+            cycles = strtoull(argv[4], NULL, 0);
+
+	// Give each component a clock whose period is a different divisor
+	// of 720720, so that the master frequency stays at 720720 MHz.
+	static const unsigned long base = 720720;
+	auto root = new Simulator::Object("", *env.k);
+	for (unsigned long period = 2; tickers.size() < n && period <= base; ++period)
+	{
+            if (base % period == 0)
+            {
+                auto& clock = env.k->CreateClock(base / period);
+                tickers.push_back(new ExampleTicker("tick" + std::to_string(tickers.size()), *root, clock));
+            }
+	}
+    }
+    else if (demo == "vmem")
+    {
+	size_t n = 10000000, p = 4096;
+	if (argc > 3)
+            n = strtoull(argv[3], NULL, 0);
+	if (argc > 4)
+            p = strtoull(argv[4], NULL, 0);
+
+	auto root = new Simulator::Object("", *env.k);
+	auto vmem = new Simulator::VirtualMemory("vmem", *root);
+	RunMemoryBenchmark(*vmem, n, p);
+	return 0;
+    }
+    else if (demo == "buffers")
+    {
+	size_t n = 64, sz = 4;
+	if (argc > 3)
+            n = atoi(argv[3]);
+	if (argc > 4)
+            sz = atoi(argv[4]);
+	if (argc > 5)
+            cycles = strtoull(argv[5], NULL, 0);
+
+	// Build the pipeline back to front, so each stage knows its successor.
+	auto& clock = env.k->CreateClock(1);
+	auto root = new Simulator::Object("", *env.k);
+	ExamplePipeStage* next = NULL;
+	for (size_t i = n; i > 0; --i)
+	{
+            next = new ExamplePipeStage("stage" + std::to_string(i - 1), *root, clock, sz, next);
+            stages.push_back(next);
+	}
+	new ExamplePipeSource("source", *root, clock, *next);
+    }
+    else if (demo == "lines")
+    {
+	size_t n = 10000000, l = 64;
+	if (argc > 3)
+            n = strtoull(argv[3], NULL, 0);
+	if (argc > 4)
+            l = strtoull(argv[4], NULL, 0);
+
+	RunLineBenchmark(n, l);
+	return 0;
+    }
+    else if (demo == "dirs")
+    {
+	size_t n = 10000000, l = 65536;
+	if (argc > 3)
+            n = strtoull(argv[3], NULL, 0);
+	if (argc > 4)
+            l = strtoull(argv[4], NULL, 0);
+
+	RunDirectoryBenchmark(n, l);
+	return 0;
+    }
+    else if (demo == "trace")
+    {
+	std::string f = "mem.trace";
+	size_t n = 10000000, c = 256;
+	if (argc > 3)
+            f = argv[3];
+	if (argc > 4)
+            n = strtoull(argv[4], NULL, 0);
+	if (argc > 5)
+            c = strtoull(argv[5], NULL, 0);
+
+	RunTraceBenchmark(f, n, c);
+	return 0;
+    }
+    else if (demo == "ports")
+    {
+	size_t n = 8, ni = 2;
+	if (argc > 3)
+            n = atoi(argv[3]);
+	if (argc > 4)
+            ni = atoi(argv[4]);
+	if (argc > 5)
+            cycles = strtoull(argv[5], NULL, 0);
+
+	auto& clock = env.k->CreateClock(1);
+	auto root = new Simulator::Object("", *env.k);
+	auto service = new Simulator::ArbitratedService<Simulator::CyclicArbitratedPort>(clock, "service");
+	auto regs = new ExampleRegisters("regs", *root, clock);
+	for (size_t i = 0; i < n; ++i)
+            clients.push_back(new ExampleArbiterClient("client" + std::to_string(i), *root, clock, *service, *regs, i, std::max<size_t>(ni, 1)));
+    }
+    else if (demo == "vars")
+    {
+	size_t n = 128;
+	if (argc > 3)
+            n = strtoull(argv[3], NULL, 0);
+
+	RunVariableBenchmark(n);
+	return 0;
+    }
     else
     {
 	std::cerr << "Unknown demo mode, using empty simulation." << std::endl;
@@ -97,10 +243,42 @@ int main(int argc, char *argv[])
 
     std::cout << "Initialization done, starting simulation..." << std::endl;
 
-    // Global simulation loop: simulate 100 cycles
+    // Global simulation loop
     try {
-        env.DoSteps(100000);
+        auto start = std::chrono::steady_clock::now();
+        env.DoSteps(cycles);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
 	std::cout << "Simulation completed, " << env.k->GetCycleNo() << " cycles elapsed." << std::endl;
+
+	if (!stages.empty())
+	{
+            uint64_t packets = 0;
+            for (auto s : stages)
+                packets += s->m_packets;
+            std::cout << stages.size() << " stages, " << packets << " packets forwarded in "
+                      << elapsed.count() << " s, "
+                      << elapsed.count() * 1e9 / env.k->GetCycleNo() << " ns per cycle, "
+                      << elapsed.count() * 1e9 / packets << " ns per packet." << std::endl;
+	}
+	if (!clients.empty())
+	{
+            uint64_t grants = 0;
+            for (auto c : clients)
+                grants += c->m_grants;
+            std::cout << clients.size() << " clients, " << grants << " grants in "
+                      << elapsed.count() << " s, "
+                      << elapsed.count() * 1e9 / env.k->GetCycleNo() << " ns per cycle, "
+                      << elapsed.count() * 1e9 / env.k->GetCycleNo() / clients.size() << " ns per client per cycle." << std::endl;
+	}
+	if (!tickers.empty())
+	{
+            uint64_t ticks = 0;
+            for (auto t : tickers)
+                ticks += t->m_ticks;
+            std::cout << tickers.size() << " clocks, " << ticks << " ticks in "
+                      << elapsed.count() << " s, "
+                      << elapsed.count() * 1e9 / ticks << " ns per tick." << std::endl;
+	}
     }
     catch (const std::exception& e) {
         // Standard exception message
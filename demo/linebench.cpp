@@ -0,0 +1,110 @@
+#include "demo/linebench.h"
+
+#include "arch/Memory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Simulator;
+
+namespace {
+
+// A line with its mask in both representations.
+struct TestLine
+{
+    char     data[MAX_MEMORY_OPERATION_SIZE];
+    bool     bytes[MAX_MEMORY_OPERATION_SIZE];
+    LineMask mask;
+};
+
+// The per-byte comparison that the caches used for bool arrays.
+bool EqualBytes(const char* a, const char* b, const bool* mask, size_t sz)
+{
+    for (size_t i = 0; i < sz; ++i)
+        if (mask[i] && a[i] != b[i])
+            return false;
+    return true;
+}
+
+size_t CountBytes(const bool* mask, size_t sz)
+{
+    return std::count(mask, mask + sz, true);
+}
+
+// Run f over all the test lines, numOps times in total, and return
+// the number of nanoseconds per operation.
+template<typename F>
+double Time(const std::vector<TestLine>& lines, size_t numOps, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numOps; ++i)
+        f(lines[i % lines.size()]);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() * 1e9 / numOps;
+}
+
+}
+
+void RunLineBenchmark(size_t numOps, size_t lineSize)
+{
+    lineSize = std::min(lineSize, (size_t)MAX_MEMORY_OPERATION_SIZE);
+
+    // A mix of full, empty, contiguous and random masks, as seen for
+    // line fills, word stores and merged snoops.
+    std::mt19937_64 rng(42);
+    std::vector<TestLine> lines(1024);
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        TestLine& l = lines[i];
+        uint64_t bits;
+        switch (i % 4)
+        {
+        case 0:  bits = LineMask::Range(0, lineSize).bits(); break;
+        case 1:  bits = 0; break;
+        case 2:  { size_t sz = 1 << (rng() % 4), off = (rng() % lineSize) & -sz;
+                   bits = LineMask::Range(off, sz).bits(); break; }
+        default: bits = rng() & LineMask::Range(0, lineSize).bits(); break;
+        }
+        l.mask = LineMask::Bits(bits);
+        for (size_t j = 0; j < MAX_MEMORY_OPERATION_SIZE; ++j)
+        {
+            l.data[j]  = (char)rng();
+            l.bytes[j] = l.mask[j];
+        }
+    }
+
+    char   dst[MAX_MEMORY_OPERATION_SIZE] = {};
+    size_t sum = 0;
+
+    struct Result { const char* name; double bytes, mask; } results[] = {
+        { "blit",
+          Time(lines, numOps, [&](const TestLine& l) { line::blit(dst, l.data, l.bytes, lineSize); }),
+          Time(lines, numOps, [&](const TestLine& l) { line::blit(dst, l.data, l.mask, lineSize); }) },
+        { "blitnot",
+          Time(lines, numOps, [&](const TestLine& l) { line::blitnot(dst, l.data, l.bytes, lineSize); }),
+          Time(lines, numOps, [&](const TestLine& l) { line::blitnot(dst, l.data, l.mask, lineSize); }) },
+        { "equal",
+          Time(lines, numOps, [&](const TestLine& l) { sum += EqualBytes(dst, l.data, l.bytes, lineSize); }),
+          Time(lines, numOps, [&](const TestLine& l) { sum += line::equal(dst, l.data, l.mask, lineSize); }) },
+        { "count",
+          Time(lines, numOps, [&](const TestLine& l) { sum += CountBytes(l.bytes, lineSize); }),
+          Time(lines, numOps, [&](const TestLine& l) { sum += l.mask.count(); }) },
+    };
+
+    // Keep the results from being optimized away.
+    if (sum == (size_t)-1 || dst[0] == 1)
+        std::cout << sum << std::endl;
+
+    std::cout << numOps << " operations on " << lineSize << "-byte lines:" << std::endl
+              << "operation    bool[] (ns/op)  LineMask (ns/op)" << std::endl;
+    for (auto& r : results)
+    {
+        std::cout << std::left << std::setw(12) << r.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(15) << r.bytes
+                  << std::setw(18) << r.mask << std::endl;
+    }
+}
@@ -0,0 +1,12 @@
+// -*- c++ -*-
+#ifndef LINEBENCH_H
+#define LINEBENCH_H
+
+#include <cstddef>
+
+// Time the line merge operations (blit, blitnot, equal and counting
+// mask bits) on packed LineMasks against the per-byte loops over
+// arrays of bool that were used before, and print the results.
+void RunLineBenchmark(size_t numOps, size_t lineSize);
+
+#endif
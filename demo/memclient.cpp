@@ -58,7 +58,7 @@ ExampleMemClient::DoMemoryOutgoing()
             // only populate the data if the store
             // is known to go through successfully
             for (auto &c : data.data) { c = 42; }
-            for (auto &b : data.mask) { b = true; }
+            data.mask = LineMask::Range(0, MAX_MEMORY_OPERATION_SIZE);
         }
 
         if (!memory->Write(mcid, addr, data, (WClientID)-1))
@@ -104,7 +104,7 @@ ExampleMemClient::OnMemoryInvalidated(Simulator::MemAddr /*unused*/)
 }
 
 bool
-ExampleMemClient::OnMemorySnooped(Simulator::MemAddr /*unused*/, const char* /*data*/, const bool* /*mask*/)
+ExampleMemClient::OnMemorySnooped(Simulator::MemAddr /*unused*/, const char* /*data*/, const Simulator::LineMask& /*mask*/)
 {
     return true;
 }
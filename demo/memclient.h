@@ -27,7 +27,7 @@ public:
     // Interface: memory -> component
     bool OnMemoryReadCompleted(Simulator::MemAddr addr, const char* data) override;
     bool OnMemoryWriteCompleted(Simulator::WClientID wid) override;
-    bool OnMemorySnooped(Simulator::MemAddr /*unused*/, const char* /*data*/, const bool* /*mask*/) override;
+    bool OnMemorySnooped(Simulator::MemAddr /*unused*/, const char* /*data*/, const Simulator::LineMask& /*mask*/) override;
     bool OnMemoryInvalidated(Simulator::MemAddr /*unused*/) override;
     virtual Simulator::Object& GetMemoryPeer() override;
 
@@ -0,0 +1,53 @@
+#include "demo/portbench.h"
+#include "sim/delegate.h"
+
+ExampleRegisters::ExampleRegisters(const std::string& name, Simulator::Object& parent, Simulator::Clock& clock)
+    : Simulator::Object(name, parent),
+      Simulator::ReadWriteStructure<size_t>(name, parent, clock),
+      p_sharedW(*this, GetName() + ".p_sharedW")
+{
+    // The shared port has the highest priority; the dedicated ports
+    // of the clients follow in the order in which they are created.
+    AddPort(p_sharedW);
+}
+
+ExampleArbiterClient::ExampleArbiterClient(const std::string& name, Simulator::Object& parent, Simulator::Clock& clock,
+                                           Simulator::ArbitratedService<Simulator::CyclicArbitratedPort>& service,
+                                           ExampleRegisters& regs, size_t id, size_t nindices)
+    : Simulator::Object(name, parent),
+      m_grants(0),
+      m_id(id),
+      m_nindices(nindices),
+      m_service(service),
+      m_regs(regs),
+      p_ownW(regs),
+      p_Access(*this, "access", Simulator::delegate::create<ExampleArbiterClient, &ExampleArbiterClient::DoAccess>(*this)),
+      m_enabled("f_enabled", *this, clock, true)
+{
+    m_enabled.Sensitive(p_Access);
+    p_Access.SetStorageTraces(Simulator::StorageTraceSet(Simulator::StorageTrace()));
+
+    m_service.AddProcess(p_Access);
+    m_regs.p_sharedW.AddProcess(p_Access);
+    p_ownW.SetProcess(p_Access);
+    m_regs.AddPort(p_ownW);
+}
+
+Simulator::Result
+ExampleArbiterClient::DoAccess()
+{
+    // The clients write to a few indices in turn, so that several
+    // dedicated ports write to the same index in every cycle.
+    const size_t index = (GetKernel()->GetCycleNo() + m_id) % m_nindices;
+
+    // Every request is made in every cycle, and a denied request is
+    // simply not counted, so that the clients never stall.
+    const bool service = m_service.Invoke();
+    const bool shared  = m_regs.p_sharedW.Write(index);
+    const bool own     = p_ownW.Write(index);
+
+    COMMIT {
+        m_grants += service + shared + own;
+    }
+    return Simulator::SUCCESS;
+}
@@ -0,0 +1,42 @@
+// -*- c++ -*-
+#ifndef PORTBENCH_H
+#define PORTBENCH_H
+
+#include "sim/kernel.h"
+#include "sim/ports.h"
+#include "sim/flag.h"
+
+// A structure with write ports, like a register file, whose writes
+// to the same index are arbitrated every cycle.
+class ExampleRegisters : public Simulator::ReadWriteStructure<size_t>
+{
+public:
+    ExampleRegisters(const std::string& name, Simulator::Object& parent, Simulator::Clock& clock);
+
+    Simulator::ArbitratedWritePort<size_t> p_sharedW;
+};
+
+// A client that, every cycle, competes for a round-robin service and
+// for the shared write port of a structure, and writes to an index
+// of the structure that other clients also write to through its own
+// dedicated port. Many of these measure the cost of arbitration.
+class ExampleArbiterClient : public Simulator::Object
+{
+public:
+    ExampleArbiterClient(const std::string& name, Simulator::Object& parent, Simulator::Clock& clock,
+                         Simulator::ArbitratedService<Simulator::CyclicArbitratedPort>& service,
+                         ExampleRegisters& regs, size_t id, size_t nindices);
+
+    Simulator::Result DoAccess();
+
+    uint64_t                                 m_grants;
+    size_t                                   m_id;
+    size_t                                   m_nindices;
+    Simulator::ArbitratedService<Simulator::CyclicArbitratedPort>& m_service;
+    ExampleRegisters&                        m_regs;
+    Simulator::DedicatedWritePort<size_t>    p_ownW;
+    Simulator::Process                       p_Access;
+    Simulator::Flag                          m_enabled;
+};
+
+#endif
@@ -19,6 +19,7 @@ MGSim::MGSim(const char* conf)
     parser(read_file(conf));
     cfg = new Config(defaults, ConfigMap(), std::vector<std::string>());
     k->AttachConfig(*cfg);
+    k->SetNumThreads(cfg->getValueOrDefault<size_t>("KernelThreads", 1));
 }
 
 void MGSim::DoSteps(Simulator::CycleNo nCycles)
@@ -52,7 +53,7 @@ void MGSim::DoSteps(Simulator::CycleNo nCycles)
         // either there are no processes at all, or they are all
         // stalled. Deadlock only exists in the latter case, so
         // we only check for the existence of an active process.
-        for (const Clock* clock = k->GetActiveClocks(); clock != NULL; clock = clock->GetNext())
+        for (const Clock* clock : k->GetActiveClocks())
         {
             if (clock->GetActiveProcesses() != NULL)
             {
@@ -79,7 +80,7 @@ void MGSim::DoSteps(Simulator::CycleNo nCycles)
         // See how many processes are in each of the states
         unsigned int num_stalled = 0, num_running = 0;
 
-        for (const Clock* clock = k->GetActiveClocks(); clock != NULL; clock = clock->GetNext())
+        for (const Clock* clock : k->GetActiveClocks())
         {
             for (const Process* process = clock->GetActiveProcesses(); process != NULL; process = process->GetNext())
             {
@@ -0,0 +1,118 @@
+#include "demo/tracebench.h"
+
+#include "arch/mem/MemoryTrace.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Simulator;
+
+namespace {
+
+static const size_t LINE_SIZE = 64;
+
+// Builds requests like those of L1 caches running streaming kernels:
+// every client walks through a few arrays, reading most lines and
+// writing some of them, and now and then jumps to another line. A
+// client makes a request every 20 cycles on average.
+// Every pair of clients is an instruction and a data cache, so the
+// odd clients are grouped with the one before them.
+std::vector<MemoryTraceRecord> MakeTrace(size_t numRecords, size_t numClients)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> coin(0, 1);
+    std::exponential_distribution<double> gap(numClients / 20.0);
+
+    std::vector<MemAddr> next(numClients);
+    for (size_t i = 0; i < numClients; ++i)
+        next[i] = ((MemAddr)i << 24);
+
+    std::vector<MemoryTraceRecord> trace(numRecords);
+    double time = 0;
+    for (auto& r : trace)
+    {
+        time += gap(rng);
+        r.cycle   = (CycleNo)time;
+        r.client  = rng() % numClients;
+        r.size    = LINE_SIZE;
+        r.write   = (r.client % 2 == 1) && coin(rng) < 0.3;
+        r.mask    = LineMask::Range(0, LINE_SIZE);
+        if (r.write && coin(rng) < 0.5)
+            r.mask = LineMask::Range(8 * (rng() % 8), 8);
+
+        if (coin(rng) < 1.0 / 32)
+            next[r.client] = (rng() & 0xffffffff) * LINE_SIZE;
+        r.address = next[r.client];
+        next[r.client] += LINE_SIZE;
+    }
+    return trace;
+}
+
+bool Same(const MemoryTraceRecord& a, const MemoryTraceRecord& b)
+{
+    return a.cycle == b.cycle && a.client == b.client && a.write == b.write &&
+        a.address == b.address && a.size == b.size && (!a.write || a.mask == b.mask);
+}
+
+}
+
+void RunTraceBenchmark(const std::string& filename, size_t numRecords, size_t numClients)
+{
+    typedef std::chrono::steady_clock clock;
+    std::vector<MemoryTraceRecord> trace = MakeTrace(numRecords, numClients);
+
+    auto start = clock::now();
+    {
+        MemoryTraceWriter writer(filename);
+        for (size_t i = 0; i < numClients; ++i)
+            writer.RegisterClient(i, i % 2 == 1);
+        for (auto& r : trace)
+            writer.Append(r);
+        writer.Close();
+    }
+    std::chrono::duration<double> wtime = clock::now() - start;
+
+    start = clock::now();
+    MemoryTraceReader reader(filename);
+    MemoryTraceRecord rec;
+    size_t n = 0, bad = 0;
+    while (reader.Next(rec))
+    {
+        if (n >= trace.size() || !Same(rec, trace[n]))
+            ++bad;
+        ++n;
+    }
+    std::chrono::duration<double> rtime = clock::now() - start;
+
+    // Seek to random cycles and check that we land on the first
+    // record at or after them.
+    std::mt19937_64 rng(7);
+    const size_t numSeeks = 1000;
+    start = clock::now();
+    for (size_t i = 0; i < numSeeks && !trace.empty(); ++i)
+    {
+        size_t target = rng() % trace.size();
+        while (target > 0 && trace[target - 1].cycle == trace[target].cycle)
+            --target;
+        reader.Seek(trace[target].cycle);
+        if (!reader.Next(rec) || !Same(rec, trace[target]))
+            ++bad;
+    }
+    std::chrono::duration<double> stime = clock::now() - start;
+
+    std::ifstream f(filename.c_str(), std::ios::binary | std::ios::ate);
+    const double size = f.tellg();
+
+    std::cout << std::fixed << std::setprecision(2)
+              << numRecords << " records from " << numClients << " clients, "
+              << reader.GetNumBlocks() << " blocks, "
+              << size / numRecords << " bytes per record" << std::endl
+              << "write: " << wtime.count() * 1e9 / numRecords << " ns per record" << std::endl
+              << "read:  " << rtime.count() * 1e9 / numRecords << " ns per record" << std::endl
+              << "seek:  " << stime.count() * 1e6 / numSeeks << " us per seek" << std::endl
+              << (n == numRecords && bad == 0 ? "trace verified" : "TRACE MISMATCH") << std::endl;
+}
@@ -0,0 +1,14 @@
+// -*- c++ -*-
+#ifndef TRACEBENCH_H
+#define TRACEBENCH_H
+
+#include <cstddef>
+#include <string>
+
+// Write a synthetic memory trace of numRecords requests from
+// numClients clients to a file, read it back and check it, and print
+// the size per record and the time to write, read and seek. The file
+// can be replayed with TraceFile in mgsim.
+void RunTraceBenchmark(const std::string& filename, size_t numRecords, size_t numClients);
+
+#endif
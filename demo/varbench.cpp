@@ -0,0 +1,105 @@
+#include "demo/varbench.h"
+
+#include "sim/binarysampler.h"
+#include "sim/sampling.h"
+
+#include <chrono>
+#include <fnmatch.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Simulator;
+
+namespace {
+
+// The components of a synthetic core and the number of variables of
+// each, roughly as a DRISC core registers them.
+const struct { const char* name; size_t vars; } components[] = {
+    { "pipeline.fetch", 20 }, { "pipeline.decode", 20 }, { "pipeline.read", 40 },
+    { "pipeline.execute", 40 }, { "pipeline.memory", 30 }, { "pipeline.writeback", 20 },
+    { "dcache", 60 }, { "icache", 40 }, { "families", 40 }, { "threads", 60 },
+    { "registers", 80 }, { "allocator", 60 }, { "network", 50 },
+};
+
+const char* patterns[] = {
+    "cpu5.pipeline.*",
+    "cpu*.pipeline.execute:v3",
+    "*.dcache:v7",
+    "cpu1?.icache:*",
+    "cpu77.*",
+    "cpu[0-3].threads:v1*",
+    "kernel.cycle",
+};
+
+}
+
+void RunVariableBenchmark(size_t numCores)
+{
+    VariableRegistry registry;
+    std::vector<std::string> names;
+
+    size_t perCore = 0;
+    for (auto& c : components)
+        perCore += c.vars;
+    std::vector<uint64_t> storage(numCores * perCore + 1);
+    size_t k = 0;
+
+    registry.RegisterVariable(storage[k++], "kernel.cycle", SVC_CUMULATIVE);
+    names.push_back("kernel.cycle");
+    for (size_t i = 0; i < numCores; ++i)
+        for (auto& c : components)
+            for (size_t v = 0; v < c.vars; ++v)
+            {
+                std::string name = "cpu" + std::to_string(i) + "." + c.name + ":v" + std::to_string(v);
+                registry.RegisterVariable(storage[k++], name, SVC_CUMULATIVE);
+                names.push_back(name);
+            }
+
+    // The first lookup with a wildcard builds the index.
+    BinarySampler sampler(registry);
+    auto start = std::chrono::steady_clock::now();
+    sampler.SelectVariables(std::vector<std::string>(1, "none*"));
+    std::chrono::duration<double> build = std::chrono::steady_clock::now() - start;
+
+    std::cout << names.size() << " variables, index built in " << build.count() * 1e6 << " us:" << std::endl
+              << "pattern                     matches  fnmatch (us)  first (us)  again (us)" << std::endl;
+
+    size_t sum = 0;
+    for (auto p : patterns)
+    {
+        std::vector<std::string> pats(1, p);
+
+        start = std::chrono::steady_clock::now();
+        size_t matches = 0;
+        for (auto& n : names)
+            if (fnmatch(p, n.c_str(), 0) != FNM_NOMATCH)
+                ++matches;
+        std::chrono::duration<double> linear = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        sampler.SelectVariables(pats);
+        std::chrono::duration<double> first = std::chrono::steady_clock::now() - start;
+        sum += sampler.GetNumVariables();
+
+        start = std::chrono::steady_clock::now();
+        sampler.SelectVariables(pats);
+        std::chrono::duration<double> again = std::chrono::steady_clock::now() - start;
+        sum += sampler.GetNumVariables();
+
+        if (sampler.GetNumVariables() != matches)
+            std::cout << "match mismatch for " << p << ": " << sampler.GetNumVariables() << " != " << matches << std::endl;
+
+        std::cout << std::left << std::setw(28) << p << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(7) << matches
+                  << std::setw(14) << linear.count() * 1e6
+                  << std::setw(12) << first.count() * 1e6
+                  << std::setw(12) << again.count() * 1e6 << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+
+    // Keep the results from being optimized away.
+    if (sum == (size_t)-1)
+        std::cout << sum << std::endl;
+}
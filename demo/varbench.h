@@ -0,0 +1,12 @@
+// -*- c++ -*-
+#ifndef VARBENCH_H
+#define VARBENCH_H
+
+#include <cstddef>
+
+// Register the variables of numCores synthetic cores, time the
+// selection of typical patterns through the VariableRegistry against
+// fnmatch() over every name as was done before, and print the results.
+void RunVariableBenchmark(size_t numCores);
+
+#endif
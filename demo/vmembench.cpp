@@ -0,0 +1,129 @@
+#include "demo/vmembench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Simulator;
+
+void ExampleMapMemory::Read(MemAddr address, void* _data, MemSize size) const
+{
+    MemAddr base   = address & -BLOCK_SIZE;
+    size_t  offset = (size_t)(address - base);
+    char*   data   = static_cast<char*>(_data);
+
+    for (auto pos = m_blocks.lower_bound(base); size > 0;)
+    {
+        size_t count = std::min((size_t)size, (size_t)BLOCK_SIZE - offset);
+        if (pos == m_blocks.end() || pos->first > base) {
+            std::fill(data, data + count, 0);
+        } else {
+            std::copy(pos->second.data + offset, pos->second.data + offset + count, data);
+            ++pos;
+        }
+        size  -= count;
+        data  += count;
+        base  += BLOCK_SIZE;
+        offset = 0;
+    }
+}
+
+void ExampleMapMemory::Write(MemAddr address, const void* _data, const bool* mask, MemSize size)
+{
+    MemAddr     base   = address & -BLOCK_SIZE;
+    size_t      offset = (size_t)(address - base);
+    const char* data   = static_cast<const char*>(_data);
+
+    while (size > 0)
+    {
+        auto ins = m_blocks.insert(std::make_pair(base, Block()));
+        auto& pos = ins.first;
+        if (ins.second)
+            memset(pos->second.data, 0, BLOCK_SIZE);
+
+        size_t count = std::min((size_t)size, (size_t)BLOCK_SIZE - offset);
+        for (size_t i = 0; i < count; ++i)
+            if (mask == 0 || mask[i])
+                pos->second.data[offset + i] = data[i];
+
+        size  -= count;
+        data  += count;
+        if (mask != 0)
+            mask  += count;
+        base  += BLOCK_SIZE;
+        offset = 0;
+    }
+}
+
+// Run the same sequence of accesses on a memory and return the
+// number of seconds it took. Every other access is a write.
+template<typename M>
+static double TimeAccesses(M& mem, const std::vector<MemAddr>& addrs, size_t lineSize)
+{
+    std::vector<char> line(lineSize, 1);
+    unsigned long long sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < addrs.size(); ++i)
+    {
+        if (i & 1)
+            mem.Write(addrs[i], line.data(), NULL, lineSize);
+        else
+        {
+            mem.Read(addrs[i], line.data(), lineSize);
+            sum += line[0];
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Keep the reads from being optimized away.
+    if (sum == (unsigned long long)-1)
+        std::cout << sum;
+    return elapsed.count();
+}
+
+void RunMemoryBenchmark(VirtualMemory& vmem, size_t numOps, size_t numPages)
+{
+    static const size_t LINE_SIZE = 64;
+
+    // The pages are scattered over the whole address space, in groups
+    // of 16 consecutive pages.
+    std::mt19937_64 rng(42);
+    std::vector<MemAddr> pages(numPages);
+    for (size_t i = 0; i < numPages; i += 16)
+    {
+        MemAddr base = (MemAddr)rng() & ~(MemAddr)0xffff;
+        for (size_t j = i; j < std::min(numPages, i + 16); ++j)
+            pages[j] = base + (j - i) * VirtualMemory::BLOCK_SIZE;
+    }
+
+    std::vector<MemAddr> seq(numOps), rnd(numOps);
+    const size_t linesPerPage = VirtualMemory::BLOCK_SIZE / LINE_SIZE;
+    for (size_t i = 0; i < numOps; ++i)
+    {
+        size_t line = i % (numPages * linesPerPage);
+        seq[i] = pages[line / linesPerPage] + (line % linesPerPage) * LINE_SIZE;
+        rnd[i] = pages[rng() % numPages] + (rng() % linesPerPage) * LINE_SIZE;
+    }
+
+    ExampleMapMemory map;
+    struct { const char* name; const std::vector<MemAddr>* addrs; } patterns[] = {
+        { "sequential", &seq },
+        { "random",     &rnd },
+    };
+
+    std::cout << numOps << " accesses of " << LINE_SIZE << " bytes over " << numPages << " pages:" << std::endl
+              << "pattern      std::map (ns/op)  page table (ns/op)" << std::endl;
+    for (auto& p : patterns)
+    {
+        double tm = TimeAccesses(map,  *p.addrs, LINE_SIZE);
+        double tv = TimeAccesses(vmem, *p.addrs, LINE_SIZE);
+        std::cout << std::left << std::setw(12) << p.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(17) << tm * 1e9 / numOps
+                  << std::setw(20) << tv * 1e9 / numOps << std::endl;
+    }
+}
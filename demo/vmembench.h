@@ -0,0 +1,29 @@
+// -*- c++ -*-
+#ifndef VMEMBENCH_H
+#define VMEMBENCH_H
+
+#include "arch/VirtualMemory.h"
+
+#include <map>
+
+// A sparse memory stored in a std::map of blocks, the way
+// VirtualMemory did before it used a page table. This is the
+// reference for the "vmem" benchmark.
+class ExampleMapMemory
+{
+public:
+    static const int BLOCK_SIZE = Simulator::VirtualMemory::BLOCK_SIZE;
+
+    void Read (Simulator::MemAddr address, void* data, Simulator::MemSize size) const;
+    void Write(Simulator::MemAddr address, const void* data, const bool* mask, Simulator::MemSize size);
+
+private:
+    struct Block { char data[BLOCK_SIZE]; };
+    std::map<Simulator::MemAddr, Block> m_blocks;
+};
+
+// Time random and sequential line-sized reads and writes on a
+// VirtualMemory and on the reference map, and print the results.
+void RunMemoryBenchmark(Simulator::VirtualMemory& vmem, size_t numOps, size_t numPages);
+
+#endif
@@ -11,6 +11,8 @@ namespace Simulator
     /// Base class for all objects that arbitrate
     class Arbitrator
     {
+        friend class Kernel;
+
         ///< Next pointer in the list of arbitrators that require arbitration
         Arbitrator* m_next;
 
@@ -20,6 +22,9 @@ namespace Simulator
         ///< Has the arbitrator already been activated this cycle?
         bool        m_activated;
 
+        ///< Host time spent in OnArbitrate(), when profiling
+        ProfileCounter m_profile;
+
     protected:
         // Request arbitration: register this arbitrator to its clock, so
         // that it is woken up during the cycle arbitration phase (calling
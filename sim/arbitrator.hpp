@@ -11,6 +11,13 @@ namespace Simulator
     void Arbitrator::RequestArbitration()
     {
         if (!m_activated) {
+            Kernel& kernel = m_clock.GetKernel();
+            if (kernel.m_parallel) {
+                // The kernel activates the arbitrator after the acquire
+                // phase, in the order of a serial run.
+                kernel.DeferArbitration(*this);
+                return;
+            }
             m_next = m_clock.ActivateArbitrator(*this);
             m_activated = true;
         }
@@ -0,0 +1,178 @@
+// -*- c++ -*-
+#ifndef SIM_ARENA_H
+#define SIM_ARENA_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace Simulator
+{
+    /// A pool of objects of type T. Objects are allocated in chunks
+    /// and recycled through a free list, so steady-state allocation
+    /// never goes to the host allocator. All objects are released
+    /// when the arena is destroyed.
+    ///
+    /// The arena is thread-safe. Clients that allocate and free often
+    /// should put a Cache in front of it, which moves objects to and
+    /// from the arena in batches and needs no locking.
+    template <typename T>
+    class Arena
+    {
+        union Slot
+        {
+            Slot* next;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        };
+
+        std::mutex         m_lock;
+        Slot*              m_free;      ///< Free list
+        std::vector<Slot*> m_chunks;    ///< The allocated chunks
+        const size_t       m_chunkSize; ///< Number of objects per chunk
+
+        // Takes up to n slots off the free list, allocating a new chunk
+        // if it is empty. Returns them as a list of count slots.
+        Slot* Take(size_t n, size_t& count)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_free == NULL)
+            {
+                Slot* chunk = new Slot[m_chunkSize];
+                m_chunks.push_back(chunk);
+                for (size_t i = 0; i < m_chunkSize; ++i)
+                {
+                    chunk[i].next = (i + 1 < m_chunkSize) ? &chunk[i + 1] : NULL;
+                }
+                m_free = chunk;
+            }
+
+            Slot* first = m_free;
+            Slot* last  = first;
+            for (count = 1; count < n && last->next != NULL; ++count)
+            {
+                last = last->next;
+            }
+            m_free = last->next;
+            last->next = NULL;
+            return first;
+        }
+
+        // Puts a list of slots back on the free list
+        void Give(Slot* first, Slot* last)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            last->next = m_free;
+            m_free = first;
+        }
+
+        static T* Construct(Slot* s)
+        {
+            return new (&s->storage) T();
+        }
+
+        static Slot* Destroy(T* p)
+        {
+            p->~T();
+#ifndef NDEBUG
+            // Fill the object with garbage
+            memset((void*)p, 0xFE, sizeof(T));
+#endif
+            return reinterpret_cast<Slot*>(p);
+        }
+
+    public:
+        /// A private front-end to an arena for a single worker.
+        class Cache
+        {
+            Arena&       m_arena;
+            Slot*        m_free;   ///< Local free list
+            size_t       m_count;  ///< Number of slots on the local free list
+            const size_t m_batch;  ///< Number of slots moved at once
+
+        public:
+            T* Allocate()
+            {
+                if (m_free == NULL)
+                {
+                    m_free = m_arena.Take(m_batch, m_count);
+                }
+                Slot* s = m_free;
+                m_free = s->next;
+                --m_count;
+                return Construct(s);
+            }
+
+            void Free(T* p)
+            {
+                Slot* s = Destroy(p);
+                s->next = m_free;
+                m_free  = s;
+                if (++m_count >= 2 * m_batch)
+                {
+                    // Return a batch to the arena, so that objects
+                    // freed here can be reused by other workers.
+                    Slot* last = m_free;
+                    for (size_t i = 1; i < m_batch; ++i)
+                        last = last->next;
+                    Slot* first = m_free;
+                    m_free   = last->next;
+                    m_count -= m_batch;
+                    m_arena.Give(first, last);
+                }
+            }
+
+            explicit Cache(Arena& arena, size_t batch = 64)
+                : m_arena(arena), m_free(NULL), m_count(0), m_batch(batch)
+            {
+                assert(batch > 0);
+            }
+
+            ~Cache()
+            {
+                if (m_free != NULL)
+                {
+                    Slot* last = m_free;
+                    while (last->next != NULL)
+                        last = last->next;
+                    m_arena.Give(m_free, last);
+                }
+            }
+
+            Cache(const Cache&) = delete;
+            Cache& operator=(const Cache&) = delete;
+        };
+
+        T* Allocate()
+        {
+            size_t count;
+            return Construct(Take(1, count));
+        }
+
+        void Free(T* p)
+        {
+            Slot* s = Destroy(p);
+            Give(s, s);
+        }
+
+        explicit Arena(size_t chunkSize = 1024)
+            : m_lock(), m_free(NULL), m_chunks(), m_chunkSize(chunkSize)
+        {
+            assert(chunkSize > 0);
+        }
+
+        ~Arena()
+        {
+            for (auto c : m_chunks)
+                delete[] c;
+        }
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+    };
+}
+
+#endif
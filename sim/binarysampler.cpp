@@ -1,8 +1,9 @@
 #include <sys_config.h>
 #include <algorithm> // sort
-#include <fnmatch.h> // fnmatch
 #include <ctime>     // time, gmtime, asctime
 #include <unistd.h>  // gethostname
+#include <cstring>   // memcpy
+#include <cstdint>
 #include <sim/binarysampler.h>
 #include <sim/sampling.h>
 #include <sim/config.h>
@@ -11,30 +12,26 @@ using namespace std;
 namespace Simulator
 {
     BinarySampler::BinarySampler(const VariableRegistry& registry)
-        : m_datasize(0), m_vars(), m_registry(registry)
+        : m_datasize(0), m_vars(), m_info(), m_offsets(), m_registry(registry)
     {}
 
-    void BinarySampler::SelectVariables(ostream& os, const Config& config,
-                                        const vector<string>& pats)
+    void BinarySampler::SelectVariables(const vector<string>& pats, unsigned categories)
     {
-        typedef pair<const string*,
-                     const VariableRegistry::VarInfo*> varsel_t;
-        typedef vector<varsel_t> varvec_t;
-        varvec_t vars;
+        vector<varsel_t> vars;
 
         //
         // Select variables to sample
         //
         for (auto& i : pats)
-            for (auto& j : m_registry.GetRegistry())
+            for (auto j : m_registry.Match(i))
             {
-                if (FNM_NOMATCH == fnmatch(i.c_str(), j.first.c_str(), 0))
+                if (!(categories & (1u << j->second.cat)))
                     continue;
 
-                if (j.second.type == Serialization::SV_OTHER)
-                    throw exceptf<>("Cannot monitor the non-scalar variable %s (selected by %s)", j.first.c_str(), i.c_str());
+                if (j->second.type == Serialization::SV_OTHER)
+                    throw exceptf<>("Cannot monitor the non-scalar variable %s (selected by %s)", j->first.c_str(), i.c_str());
 
-                vars.push_back(make_pair(&j.first, &j.second));
+                vars.push_back(make_pair(&j->first, &j->second));
             }
 
         if (vars.size() >= 2)
@@ -48,6 +45,23 @@ namespace Simulator
                  [](const varsel_t& left, const varsel_t& right) -> bool
                  { return left.second->var < right.second->var; });
 
+        m_datasize = 0;
+        m_vars.clear();
+        m_offsets.clear();
+        for (auto& i : vars)
+        {
+            m_offsets.push_back(m_datasize);
+            m_datasize += i.second->width;
+            m_vars.push_back(make_pair((const char*)i.second->var, i.second->width));
+        }
+        m_info.swap(vars);
+    }
+
+    void BinarySampler::SelectVariables(ostream& os, const Config& config,
+                                        const vector<string>& pats)
+    {
+        SelectVariables(pats);
+
         //
         // Generate header for output file
         //
@@ -66,16 +80,62 @@ namespace Simulator
         for (auto& i : rawconf)
             os << i.first << " = " << i.second << endl;
 
-        m_datasize = 0;
-        m_vars.clear();
-        os << "# varinfo: " << vars.size() << endl;
-        for (auto& i : vars)
-        {
-            m_datasize += i.second->width;
-            m_vars.push_back(make_pair((const char*)i.second->var, i.second->width));
+        os << "# varinfo: " << m_info.size() << endl;
+        for (auto& i : m_info)
             m_registry.ListVariables_onevar(os, *i.first, *i.second);
-        }
         os << "# recwidth: " << m_datasize << endl;
     }
 
+    double BinarySampler::GetValue(const char *buf, size_t i) const
+    {
+        const VariableRegistry::VarInfo& info = *m_info[i].second;
+        const char* p = buf + m_offsets[i];
+        switch (info.type)
+        {
+        case Serialization::SV_BOOL:
+            return *p ? 1 : 0;
+        case Serialization::SV_FLOAT:
+            if (info.width == sizeof(float)) {
+                float f; memcpy(&f, p, sizeof f); return f;
+            } else {
+                double d; memcpy(&d, p, sizeof d); return d;
+            }
+        case Serialization::SV_INTEGER:
+            switch (info.width)
+            {
+            case 1: { uint8_t  v; memcpy(&v, p, sizeof v); return v; }
+            case 2: { uint16_t v; memcpy(&v, p, sizeof v); return v; }
+            case 4: { uint32_t v; memcpy(&v, p, sizeof v); return v; }
+            case 8: { uint64_t v; memcpy(&v, p, sizeof v); return (double)v; }
+            }
+            break;
+        default:
+            break;
+        }
+        throw exceptf<>("Cannot read the value of variable %s", m_info[i].first->c_str());
+    }
+
+    uint64_t BinarySampler::GetIntegerValue(const char *buf, size_t i) const
+    {
+        const VariableRegistry::VarInfo& info = *m_info[i].second;
+        const char* p = buf + m_offsets[i];
+        switch (info.type)
+        {
+        case Serialization::SV_BOOL:
+            return *p ? 1 : 0;
+        case Serialization::SV_INTEGER:
+            switch (info.width)
+            {
+            case 1: { uint8_t  v; memcpy(&v, p, sizeof v); return v; }
+            case 2: { uint16_t v; memcpy(&v, p, sizeof v); return v; }
+            case 4: { uint32_t v; memcpy(&v, p, sizeof v); return v; }
+            case 8: { uint64_t v; memcpy(&v, p, sizeof v); return v; }
+            }
+            break;
+        default:
+            break;
+        }
+        throw exceptf<>("Cannot read the integer value of variable %s", m_info[i].first->c_str());
+    }
+
 }
@@ -7,12 +7,14 @@
 #include <vector>
 #include <utility>
 #include <cstddef>
+#include <cstdint>
+
+#include <sim/sampling.h>
 
 class Config;
 
 namespace Simulator
 {
-    class VariableRegistry;
 
     // BinarySampler: used by Monitor to quickly serialize scalar
     // variables to a binary format.
@@ -20,9 +22,13 @@ namespace Simulator
     {
     private:
         typedef std::vector<std::pair<const char*, size_t> > vars_t;
+        typedef std::pair<const std::string*,
+                          const VariableRegistry::VarInfo*> varsel_t;
 
         size_t   m_datasize;          ///< The record size in bytes
         vars_t   m_vars;              ///< The variables to sample
+        std::vector<varsel_t> m_info; ///< The names and types of the variables
+        std::vector<size_t>   m_offsets; ///< The offset of each variable in a record
 
         const VariableRegistry& m_registry; ///< The related registry
 
@@ -31,6 +37,13 @@ namespace Simulator
         // Create a binary sampler
         BinarySampler(const VariableRegistry& registry);
 
+        // Select a set of variables. Only the variables whose
+        // category is in the mask (1 << VariableCategory) are
+        // selected.
+        static const unsigned ALL_CATEGORIES = ~0u;
+        void SelectVariables(const std::vector<std::string>& pats,
+                             unsigned categories = ALL_CATEGORIES);
+
         // Select a set of variables and dump a serialization
         // header.
         void SelectVariables(std::ostream& os, const Config& config,
@@ -46,6 +59,14 @@ namespace Simulator
 
         size_t GetBufferSize() const { return m_datasize; }
 
+        // Inspect the selected variables and the samples
+        size_t GetNumVariables() const { return m_info.size(); }
+        const std::string& GetName(size_t i) const { return *m_info[i].first; }
+        VariableCategory GetCategory(size_t i) const { return m_info[i].second->cat; }
+        bool IsFloat(size_t i) const { return m_info[i].second->type == Serialization::SV_FLOAT; }
+        double GetValue(const char *buf, size_t i) const;
+        uint64_t GetIntegerValue(const char *buf, size_t i) const;
+
     };
 
 
@@ -0,0 +1,54 @@
+#include <sim/binaryserializer.h>
+#include <sim/except.h>
+#include <cstring>
+#include <string>
+
+using namespace std;
+namespace Simulator
+{
+    BinarySerializer::BinarySerializer(vector<char>& out)
+        : m_reading(true), m_out(&out), m_in(NULL), m_size(0), m_pos(0)
+    {
+    }
+
+    BinarySerializer::BinarySerializer(const char* data, size_t size)
+        : m_reading(false), m_out(NULL), m_in(data), m_size(size), m_pos(0)
+    {
+    }
+
+    BinarySerializer& BinarySerializer::operator&(const char *tag)
+    {
+        const size_t len = strlen(tag);
+        if (m_reading)
+            m_out->insert(m_out->end(), tag, tag + len);
+        else
+        {
+            if (m_pos + len > m_size || memcmp(m_in + m_pos, tag, len) != 0)
+                throw exceptf<>("Invalid serialized data: expected tag %s at offset %zu",
+                                tag, m_pos);
+            m_pos += len;
+        }
+        return *this;
+    }
+
+    void BinarySerializer::serialize_raw(Serialization::SerializationValueType /*dt*/,
+                                         void* var, size_t sz)
+    {
+        // All value types, including the bool arrays (SV_BITS), are
+        // stored as their bytes in memory.
+        if (m_reading)
+        {
+            const char* p = static_cast<const char*>(var);
+            m_out->insert(m_out->end(), p, p + sz);
+        }
+        else
+        {
+            if (m_pos + sz > m_size)
+                throw exceptf<>("Invalid serialized data: %zu bytes expected at offset %zu, %zu available",
+                                sz, m_pos, m_size - m_pos);
+            memcpy(var, m_in + m_pos, sz);
+            m_pos += sz;
+        }
+    }
+
+}
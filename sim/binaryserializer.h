@@ -0,0 +1,65 @@
+// -*- c++ -*-
+#ifndef SIM_BINARY_SERIALIZER_H
+#define SIM_BINARY_SERIALIZER_H
+
+#include <vector>
+#include <cstddef>
+#include <sim/serialization.h>
+
+namespace Simulator
+{
+
+    // BinarySerializer: bi-directional serialization archiver
+    // using the raw byte representation of the values.
+    // This is used for checkpoints, where the data is only ever
+    // loaded back into the same simulator.
+    class BinarySerializer
+    {
+    public:
+        // Indicate the direction of serialization.
+        // true = from variable to buffer
+        // false = from buffer to variable
+        bool reading() const { return m_reading; }
+
+        // Low level serializer/deserializer.
+        // This is called by specializations of serialize_trait<>.
+        void serialize_raw(Serialization::SerializationValueType dt,
+                           void *d, size_t sz);
+
+        // Serialization tagging: when reading, store the tag; when
+        // writing, check the tag.
+        BinarySerializer& operator&(const char* str);
+
+        // Generalized forward to serialize_trait::serialize().
+        template<typename T>
+        BinarySerializer& operator&(T& var)
+        {
+            Serialization::serialize_trait<T>::serialize(*this, var);
+            return *this;
+        }
+
+        // Number of bytes read from the input
+        size_t GetPosition() const { return m_pos; }
+
+        BinarySerializer(std::vector<char>& out);
+        BinarySerializer(const char* data, size_t size);
+
+    private:
+        bool               m_reading; ///< Direction of reading
+        std::vector<char>* m_out;     ///< Buffer to append to when reading
+        const char*        m_in;      ///< Data to load from when writing
+        size_t             m_size;    ///< Size of the data to load from
+        size_t             m_pos;     ///< Position in the data to load from
+    };
+
+    // Bit masks are stored packed, instead of one byte per bit.
+    inline
+    BinarySerializer& operator&(BinarySerializer& s, const Serialization::bitmask& bs)
+    {
+        s.serialize_raw(Serialization::SV_INTEGER, bs.p, sizeof(*bs.p));
+        return s;
+    }
+
+}
+
+#endif
@@ -3,12 +3,17 @@
 #include <cstdlib>
 #include <cerrno>
 #include <iomanip>
+#include <mutex>
 
 using namespace std;
 
 namespace Simulator
 {
 
+// Processes on several host threads can reach breakpoints at once,
+// cf Kernel::SetNumThreads().
+static mutex g_breakLock;
+
 void BreakPointManager::CheckEnabled()
 {
     bool someenabled = false;
@@ -219,6 +224,7 @@ void BreakPointManager::CheckMore(int type, MemAddr addr, Object& obj)
         else
         {
             ActiveBreak ab(addr, obj, i->second.type & type);
+            lock_guard<mutex> lock(g_breakLock);
             m_activebreaks.insert(ab);
             GetKernel()->Stop();
         }
@@ -2,7 +2,7 @@
 #ifndef SIM_BUFFER_H
 #define SIM_BUFFER_H
 
-#include <deque>
+#include "sim/ringbuffer.h"
 #include "sim/storage.h"
 #include "sim/sampling.h"
 
@@ -19,9 +19,14 @@ namespace Simulator
         // In hardware it can be possible to support multiple pushes
         static const size_t MAX_PUSHES = 4;
 
+        // Finite buffers reserve their whole size up front, so that
+        // pushes and pops never allocate. Infinite or very large ones
+        // grow on demand.
+        static const BufferSize MAX_PREALLOCATED = 4096;
+
         const size_t  m_maxSize;             ///< Maximum size of this buffer
         const size_t  m_maxPushes;           ///< Maximum number of pushes at a cycle
-        std::deque<T> m_data;                ///< The actual buffer storage
+        RingBuffer<T> m_data;                ///< The actual buffer storage
         size_t        m_pushes;              ///< Number of items Push()'d this cycle
         T             m_new[MAX_PUSHES];     ///< The items being pushed (when m_pushes > 0)
         DefineStateVariable(bool, popped);   ///< Has a Pop() been done?
@@ -64,8 +69,8 @@ namespace Simulator
         static constexpr const char* NAME_PREFIX = "b_";
 
         // We define an iterator for debugging the contents only
-        typedef typename std::deque<T>::const_iterator         const_iterator;
-        typedef typename std::deque<T>::const_reverse_iterator const_reverse_iterator;
+        typedef typename RingBuffer<T>::const_iterator         const_iterator;
+        typedef typename RingBuffer<T>::const_reverse_iterator const_reverse_iterator;
         const_iterator         begin()  const { return m_data.begin(); }
         const_iterator         end()    const { return m_data.end();   }
         const_reverse_iterator rbegin() const { return m_data.rbegin(); }
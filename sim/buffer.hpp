@@ -4,6 +4,8 @@
 #include "sim/buffer.h"
 #include "sim/sampling.h"
 
+#include <algorithm>
+
 namespace Simulator
 {
     template<typename T>
@@ -114,9 +116,10 @@ namespace Simulator
 
         // Accumulate for statistics. We don't want
         // to register multiple stalls so only test during acquire.
+        // Processes on several host threads can stall on the same storage.
         if (IsAcquiring())
         {
-            ++m_stalls;
+            __atomic_add_fetch(&m_stalls, 1, __ATOMIC_RELAXED);
         }
 
         return false;
@@ -148,7 +151,7 @@ namespace Simulator
           SensitiveStorage(name, parent, clock),
           m_maxSize(maxSize),
           m_maxPushes(maxPushes),
-          m_data(),
+          m_data(maxSize == INFINITE ? 16 : std::min(maxSize, (BufferSize)MAX_PREALLOCATED)),
           m_pushes(0),
           InitStateVariable(popped, false),
           InitSampleVariable(stalls, SVC_CUMULATIVE),
@@ -158,6 +161,7 @@ namespace Simulator
           InitSampleVariable(cursize, SVC_LEVEL)
     {
         RegisterStateObject(m_data, "data");
+        RegisterStateObject(*this, "new");
         assert(maxPushes <= MAX_PUSHES);
     }
 
@@ -0,0 +1,215 @@
+#include <sim/checkpoint.h>
+#include <sim/except.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace Simulator
+{
+    const char Checkpoint::MAGIC[8] = { 'M', 'G', 'S', 'I', 'M', 'C', 'K', 'P' };
+
+    static const uint32_t ENDIAN_MARKER = 0x01020304;
+
+    // Values are aligned to this many bytes in the file
+    static const size_t ALIGNMENT = 8;
+
+    static void Align(vector<char>& buf)
+    {
+        buf.resize((buf.size() + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+    }
+
+    void Checkpoint::Save(const VariableRegistry& registry, const string& filename)
+    {
+        const VariableRegistry::var_registry_t& vars = registry.GetRegistry();
+
+        vector<Entry> index;
+        vector<char>  names;
+        vector<char>  data;
+
+        index.reserve(vars.size());
+        for (auto& i : vars)
+        {
+            const VariableRegistry::VarInfo& vinfo = i.second;
+
+            Entry e;
+            memset(&e, 0, sizeof e);
+            e.nameOffset = names.size();
+            e.nameLength = i.first.size();
+            e.type       = vinfo.type;
+            e.category   = vinfo.cat;
+            names.insert(names.end(), i.first.begin(), i.first.end());
+            names.push_back('\0');
+
+            Align(data);
+            e.dataOffset = data.size();
+            if (vinfo.type == Serialization::SV_OTHER)
+            {
+                if (vinfo.bser == NULL)
+                    throw exceptf<>("Cannot checkpoint variable %s: it has no binary serialization", i.first.c_str());
+                BinarySerializer s(data);
+                vinfo.bser(s, vinfo.var);
+            }
+            else
+            {
+                const char* p = static_cast<const char*>(vinfo.var);
+                data.insert(data.end(), p, p + vinfo.width);
+            }
+            e.dataSize = data.size() - e.dataOffset;
+            index.push_back(e);
+        }
+
+        Header h;
+        memset(&h, 0, sizeof h);
+        memcpy(h.magic, MAGIC, sizeof h.magic);
+        h.version     = FORMAT_VERSION;
+        h.endian      = ENDIAN_MARKER;
+        h.numEntries  = index.size();
+        h.namesOffset = sizeof(Header) + index.size() * sizeof(Entry);
+        h.dataOffset  = (h.namesOffset + names.size() + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        h.fileSize    = h.dataOffset + data.size();
+
+        Align(names);
+        for (auto& e : index)
+            e.dataOffset += h.dataOffset;
+
+        ofstream of(filename.c_str(), ios::out | ios::binary | ios::trunc);
+        of.write((const char*)&h, sizeof h);
+        of.write((const char*)index.data(), index.size() * sizeof(Entry));
+        of.write(names.data(), names.size());
+        of.write(data.data(), data.size());
+        of.close();
+        if (!of)
+            throw exceptf<IOException>("Unable to write checkpoint %s", filename.c_str());
+    }
+
+    // Read-only mapping of a file, unmapped on destruction
+    class MappedFile
+    {
+        void*  m_data;
+        size_t m_size;
+    public:
+        MappedFile(const string& filename)
+            : m_data(NULL), m_size(0)
+        {
+            int fd = open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw exceptf<IOException>("Unable to open checkpoint %s: %s", filename.c_str(), strerror(errno));
+
+            struct stat st;
+            if (fstat(fd, &st) < 0)
+            {
+                int err = errno;
+                close(fd);
+                throw exceptf<IOException>("Unable to stat checkpoint %s: %s", filename.c_str(), strerror(err));
+            }
+
+            m_size = st.st_size;
+            if (m_size > 0)
+            {
+                m_data = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (m_data == MAP_FAILED)
+                {
+                    int err = errno;
+                    close(fd);
+                    throw exceptf<IOException>("Unable to map checkpoint %s: %s", filename.c_str(), strerror(err));
+                }
+            }
+            close(fd);
+        }
+
+        ~MappedFile()
+        {
+            if (m_data != NULL)
+                munmap(m_data, m_size);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* GetData() const { return static_cast<const char*>(m_data); }
+        size_t      GetSize() const { return m_size; }
+    };
+
+    void Checkpoint::Load(const VariableRegistry& registry, const string& filename)
+    {
+        const VariableRegistry::var_registry_t& vars = registry.GetRegistry();
+        const char* fn = filename.c_str();
+
+        MappedFile file(filename);
+        const char*  base = file.GetData();
+        const size_t size = file.GetSize();
+
+        // Check the header
+        if (size < sizeof(Header))
+            throw exceptf<IOException>("Invalid checkpoint %s: file too small", fn);
+
+        Header h;
+        memcpy(&h, base, sizeof h);
+        if (memcmp(h.magic, MAGIC, sizeof h.magic) != 0)
+            throw exceptf<IOException>("Invalid checkpoint %s: not a checkpoint file", fn);
+        if (h.version != FORMAT_VERSION)
+            throw exceptf<IOException>("Invalid checkpoint %s: unsupported version %u", fn, (unsigned)h.version);
+        if (h.endian != ENDIAN_MARKER)
+            throw exceptf<IOException>("Invalid checkpoint %s: saved on a host with a different byte order", fn);
+        if (h.fileSize != size || h.namesOffset > size || h.dataOffset > size ||
+            h.numEntries > (h.namesOffset - sizeof(Header)) / sizeof(Entry))
+            throw exceptf<IOException>("Invalid checkpoint %s: file is truncated or corrupt", fn);
+        if (h.numEntries != vars.size())
+            throw exceptf<>("Checkpoint %s has %zu variables, the simulation has %zu; was it saved with a different configuration?",
+                            fn, (size_t)h.numEntries, vars.size());
+
+        const Entry* index = reinterpret_cast<const Entry*>(base + sizeof(Header));
+
+        // Match the variables first, so that a mismatch leaves the
+        // simulation untouched.
+        size_t n = 0;
+        for (auto& i : vars)
+        {
+            const Entry& e = index[n++];
+            const VariableRegistry::VarInfo& vinfo = i.second;
+            if (e.nameOffset + e.nameLength >= h.dataOffset - h.namesOffset ||
+                e.dataOffset < h.dataOffset || e.dataOffset > size || e.dataSize > size - e.dataOffset)
+                throw exceptf<IOException>("Invalid checkpoint %s: file is truncated or corrupt", fn);
+
+            const char* name = base + h.namesOffset + e.nameOffset;
+            if (i.first.compare(0, string::npos, name, e.nameLength) != 0)
+                throw exceptf<>("Checkpoint %s contains variable %.*s where the simulation has %s; was it saved with a different configuration?",
+                                fn, (int)e.nameLength, name, i.first.c_str());
+            if (e.type != vinfo.type || (vinfo.type != Serialization::SV_OTHER && e.dataSize != vinfo.width))
+                throw exceptf<>("Variable %s in checkpoint %s has a different type or size than in the simulation",
+                                i.first.c_str(), fn);
+            if (vinfo.type == Serialization::SV_OTHER && vinfo.bser == NULL)
+                throw exceptf<>("Cannot restore variable %s: it has no binary serialization", i.first.c_str());
+        }
+
+        // Load the values
+        n = 0;
+        for (auto& i : vars)
+        {
+            const Entry& e = index[n++];
+            const VariableRegistry::VarInfo& vinfo = i.second;
+            const char* p = base + e.dataOffset;
+            if (vinfo.type == Serialization::SV_OTHER)
+            {
+                BinarySerializer s(p, e.dataSize);
+                vinfo.bser(s, vinfo.var);
+                if (s.GetPosition() != e.dataSize)
+                    throw exceptf<>("Invalid serialized data for variable %s in checkpoint %s", i.first.c_str(), fn);
+            }
+            else
+            {
+                memcpy(vinfo.var, p, vinfo.width);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,64 @@
+// -*- c++ -*-
+#ifndef SIM_CHECKPOINT_H
+#define SIM_CHECKPOINT_H
+
+#include <string>
+#include <cstdint>
+#include <sim/sampling.h>
+
+namespace Simulator
+{
+
+    /*
+     * Checkpoint: saves and restores the values of all the variables
+     * in a registry, in a compact binary file.
+     *
+     * The file starts with a header and an index of the variables, in
+     * the order of their names, followed by the names and the data.
+     * Each value is aligned to 8 bytes and stored in its in-memory
+     * representation, so that a mapped checkpoint can be inspected in
+     * place. Scalars and arrays are copied directly; other variables
+     * use their serialize() method with a BinarySerializer.
+     *
+     * A checkpoint can only be loaded into the simulator that saved it,
+     * with the same configuration: every variable must be present with
+     * the same size.
+     */
+    class Checkpoint
+    {
+    public:
+        static const char     MAGIC[8];
+        static const uint32_t FORMAT_VERSION = 1;
+
+        struct Header
+        {
+            char     magic[8];    ///< MAGIC
+            uint32_t version;     ///< FORMAT_VERSION
+            uint32_t endian;      ///< 0x01020304 in the byte order of the host
+            uint64_t numEntries;  ///< Number of variables
+            uint64_t namesOffset; ///< File offset of the names
+            uint64_t dataOffset;  ///< File offset of the first value
+            uint64_t fileSize;    ///< Size of the whole file
+        };
+
+        struct Entry
+        {
+            uint64_t nameOffset;  ///< Offset of the name from namesOffset
+            uint32_t nameLength;  ///< Length of the name, without terminator
+            uint8_t  type;        ///< Serialization::SerializationValueType
+            uint8_t  category;    ///< VariableCategory
+            uint16_t reserved;
+            uint64_t dataOffset;  ///< File offset of the value
+            uint64_t dataSize;    ///< Size of the value in bytes
+        };
+
+        // Save all the variables in the registry to a file.
+        static void Save(const VariableRegistry& registry, const std::string& filename);
+
+        // Load all the variables in the registry from a file.
+        static void Load(const VariableRegistry& registry, const std::string& filename);
+    };
+
+}
+
+#endif
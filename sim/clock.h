@@ -36,6 +36,7 @@ namespace Simulator
     class Clock
     {
         friend class Kernel;
+        friend class ClockQueue;
 
     public:
         typedef unsigned long Frequency;
@@ -47,7 +48,7 @@ namespace Simulator
 #endif
         Frequency     m_frequency;   ///< Frequency of this clock, in MHz
         Period        m_period;      ///< No. master-cycles per tick of this clock.
-        Clock*        m_next;        ///< Next clock to run
+        Clock*        m_next;        ///< Next clock in the clock queue or in the current cycle
         CycleNo       m_cycle;       ///< Next cycle this clock needs to run
 
         Process*      m_activeProcesses;   ///< List of processes that need to be run.
@@ -76,9 +77,6 @@ namespace Simulator
 	const Kernel& GetKernel() const { return m_kernel; }
 #endif
 
-        /// Used for iterating through active clocks
-        const Clock* GetNext() const { return m_next; }
-
         const Process* GetActiveProcesses() const { return m_activeProcesses; }
         const Storage* GetActiveStorages() const { return m_activeStorages; }
         const Arbitrator* GetActiveArbitrators() const { return m_activeArbitrators; }
@@ -110,6 +108,17 @@ namespace Simulator
          * @param process The process to schedule
          */
         void ActivateProcess(Process& process);
+
+        /**
+         * @brief Suspend the running process until the specified cycle of this clock.
+         * The process is not run until that cycle, or until a storage it is
+         * sensitive to activates it again, whichever comes first. If nothing
+         * else is active, the kernel skips the cycles in between. Must be
+         * called by the process itself, in the commit phase.
+         * @param process The process to suspend
+         * @param cycle The cycle of this clock at which the process runs again
+         */
+        void SleepProcess(Process& process, CycleNo cycle);
     };
 
 
@@ -55,6 +55,17 @@ namespace Simulator
 
             GetKernel().ActivateClock(*this);
         }
+        else if (process.m_wakeup != 0)
+        {
+            // The process is sleeping; it has new work now
+            GetKernel().Resume(process);
+        }
+    }
+
+    inline
+    void Clock::SleepProcess(Process& process, CycleNo cycle)
+    {
+        GetKernel().SleepProcess(process, *this, cycle * m_period);
     }
 
 }
@@ -0,0 +1,161 @@
+#include "sim/kernel.h"
+#include "sim/ctz.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Simulator
+{
+    ClockQueue::ClockQueue()
+        : m_buckets(MIN_BUCKETS, NULL),
+          m_occupied(MIN_BUCKETS / 32, 0),
+          m_size(0),
+          m_next(0),
+          m_nextValid(false)
+    {
+    }
+
+    // Returns the first non-empty bucket at or after the specified one,
+    // or the number of buckets if there is none.
+    size_t ClockQueue::FindBucket(size_t start) const
+    {
+        if (start >= m_buckets.size())
+            return m_buckets.size();
+
+        size_t   word = start / 32;
+        uint32_t bits = m_occupied[word] & (~0U << (start % 32));
+        while (bits == 0)
+        {
+            if (++word == m_occupied.size())
+                return m_buckets.size();
+            bits = m_occupied[word];
+        }
+        return word * 32 + ctz(bits);
+    }
+
+    void ClockQueue::Resize(CycleNo period)
+    {
+        size_t size = MIN_BUCKETS;
+        while (size <= period && size < MAX_BUCKETS)
+            size *= 2;
+
+        if (size == m_buckets.size())
+            return;
+
+        // Push the clocks back in reverse order, since each clock goes in
+        // front of the clocks that tick in the same cycle.
+        std::vector<const Clock*> clocks = GetSorted();
+        m_buckets.assign(size, NULL);
+        m_occupied.assign(size / 32, 0);
+        m_size = 0;
+        m_nextValid = false;
+        for (auto c = clocks.rbegin(); c != clocks.rend(); ++c)
+        {
+            Push(const_cast<Clock&>(**c));
+        }
+    }
+
+    void ClockQueue::Push(Clock& clock)
+    {
+        const size_t bucket = GetBucket(clock.m_cycle);
+
+        Clock** pos = &m_buckets[bucket];
+        while (*pos != NULL && (*pos)->m_cycle < clock.m_cycle)
+            pos = &(*pos)->m_next;
+        clock.m_next = *pos;
+        *pos = &clock;
+        m_occupied[bucket / 32] |= 1U << (bucket % 32);
+
+        if (m_size++ == 0) {
+            m_next      = clock.m_cycle;
+            m_nextValid = true;
+        } else if (m_nextValid && clock.m_cycle < m_next) {
+            m_next = clock.m_cycle;
+        }
+    }
+
+    void ClockQueue::Clear()
+    {
+        std::fill(m_buckets.begin(), m_buckets.end(), (Clock*)NULL);
+        std::fill(m_occupied.begin(), m_occupied.end(), 0);
+        m_size      = 0;
+        m_nextValid = false;
+    }
+
+    CycleNo ClockQueue::GetNextCycle(CycleNo now)
+    {
+        assert(m_size > 0);
+        if (m_nextValid) {
+            return m_next;
+        }
+
+        // Go through the non-empty buckets in the order of time, starting
+        // at the current cycle. The first bucket whose earliest clock ticks
+        // within one turn of the calendar holds the next tick. If there is
+        // none, the next tick is the earliest of all buckets.
+        const size_t size  = m_buckets.size();
+        const size_t start = GetBucket(now);
+        CycleNo next = INFINITE_CYCLES;
+        for (size_t pass = 0; pass < 2; ++pass)
+        {
+            const size_t end = (pass == 0) ? size : start;
+            for (size_t b = FindBucket(pass == 0 ? start : 0); b < end; b = FindBucket(b + 1))
+            {
+                const CycleNo cycle = m_buckets[b]->m_cycle;
+                assert(cycle >= now);
+                if (cycle == now + ((b - start) & (size - 1)))
+                {
+                    m_next      = cycle;
+                    m_nextValid = true;
+                    return m_next;
+                }
+                next = std::min(next, cycle);
+            }
+        }
+
+        m_next      = next;
+        m_nextValid = true;
+        return m_next;
+    }
+
+    Clock* ClockQueue::Pop(CycleNo cycle)
+    {
+        const size_t bucket = GetBucket(cycle);
+        Clock*       first  = m_buckets[bucket];
+        assert(first != NULL && first->m_cycle == cycle);
+
+        // The clocks that tick in this cycle are at the front of the bucket
+        Clock* last = first;
+        --m_size;
+        while (last->m_next != NULL && last->m_next->m_cycle == cycle)
+        {
+            last = last->m_next;
+            --m_size;
+        }
+
+        m_buckets[bucket] = last->m_next;
+        last->m_next = NULL;
+        if (m_buckets[bucket] == NULL) {
+            m_occupied[bucket / 32] &= ~(1U << (bucket % 32));
+        }
+
+        m_nextValid = false;
+        return first;
+    }
+
+    std::vector<const Clock*> ClockQueue::GetSorted() const
+    {
+        // The clocks that tick in the same cycle share a bucket, in the
+        // order in which they run.
+        std::vector<const Clock*> clocks;
+        for (const Clock* bucket : m_buckets)
+        {
+            for (const Clock* clock = bucket; clock != NULL; clock = clock->m_next)
+                clocks.push_back(clock);
+        }
+        std::stable_sort(clocks.begin(), clocks.end(),
+                         [](const Clock* a, const Clock* b) { return a->m_cycle < b->m_cycle; });
+        return clocks;
+    }
+
+}
@@ -0,0 +1,88 @@
+// -*- c++ -*-
+#ifndef SIM_CLOCKQUEUE_H
+#define SIM_CLOCKQUEUE_H
+
+#ifndef KERNEL_H
+#error This file should be included in kernel.h
+#endif
+
+#include <vector>
+#include <cstdint>
+
+namespace Simulator
+{
+    class Clock;
+
+    /*
+     * A calendar queue holding the activated clocks, ordered by their
+     * next tick.
+     *
+     * The queue has a bucket per master cycle, modulo the number of
+     * buckets. Since a clock is always scheduled less than its period
+     * ahead, all clocks in a bucket usually tick in the same cycle, and
+     * scheduling a clock is a matter of prepending it to its bucket. A
+     * bit mask of non-empty buckets leads to the next tick. Clocks with
+     * periods longer than the calendar share buckets with earlier clocks
+     * and are kept in order in their bucket.
+     *
+     * Clocks that tick in the same cycle run in the reverse order of
+     * their activation: a clock that is activated runs before the clocks
+     * that were already scheduled for the same cycle.
+     *
+     * The clocks are linked into the buckets through their m_next field.
+     */
+    class ClockQueue
+    {
+        static const size_t MIN_BUCKETS = 64;
+        static const size_t MAX_BUCKETS = 1 << 16;
+
+        std::vector<Clock*>   m_buckets;    ///< Sorted lists of clocks per bucket.
+        std::vector<uint32_t> m_occupied;   ///< Bit mask of non-empty buckets.
+        size_t                m_size;       ///< Number of clocks in the queue.
+        CycleNo               m_next;       ///< Earliest tick, if m_nextValid.
+        bool                  m_nextValid;  ///< Is m_next up to date?
+
+        size_t GetBucket(CycleNo cycle) const { return cycle & (m_buckets.size() - 1); }
+        size_t FindBucket(size_t start) const;
+
+    public:
+        ClockQueue();
+        ClockQueue(const ClockQueue&) = delete;
+        ClockQueue& operator=(const ClockQueue&) = delete;
+
+        bool   Empty() const { return m_size == 0; }
+        size_t GetSize() const { return m_size; }
+
+        /**
+         * @brief Set the number of buckets for the longest clock period.
+         * Clocks that are already queued keep their order.
+         */
+        void Resize(CycleNo period);
+
+        /// Add a clock; its m_cycle must be later than the current cycle.
+        void Push(Clock& clock);
+
+        /// Remove all clocks.
+        void Clear();
+
+        /**
+         * @brief Returns the earliest tick. The queue must not be empty.
+         * @param now the current cycle; no clock ticks before it.
+         */
+        CycleNo GetNextCycle(CycleNo now);
+
+        /**
+         * @brief Remove the clocks that tick in the specified cycle.
+         * No clock may tick before that cycle.
+         * @return the clocks, linked through their m_next fields in the
+         * order in which they run.
+         */
+        Clock* Pop(CycleNo cycle);
+
+        /// Returns all queued clocks in the order in which they will run.
+        std::vector<const Clock*> GetSorted() const;
+    };
+
+}
+
+#endif
@@ -24,9 +24,10 @@ namespace Simulator
         }
         // Accumulate for statistics. We don't want
         // to register multiple stalls so only test during acquire.
+        // Processes on several host threads can stall on the same storage.
         if (IsAcquiring())
         {
-            ++m_stalls;
+            __atomic_add_fetch(&m_stalls, 1, __ATOMIC_RELAXED);
         }
         return false;
     }
@@ -44,9 +45,10 @@ namespace Simulator
         }
         // Accumulate for statistics. We don't want
         // to register multiple stalls so only test during acquire.
+        // Processes on several host threads can stall on the same storage.
         if (IsAcquiring())
         {
-            ++m_stalls;
+            __atomic_add_fetch(&m_stalls, 1, __ATOMIC_RELAXED);
         }
         return false;
     }
@@ -0,0 +1,221 @@
+// -*- c++ -*-
+#ifndef SIM_FLATMAP_H
+#define SIM_FLATMAP_H
+
+#include "sim/serialization.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Simulator
+{
+    /// An associative container from integer keys to values, stored
+    /// in a single array with open addressing and linear probing.
+    /// Lookups touch one or two cache lines and insertions do not
+    /// allocate until the table grows. Erasing shifts the following
+    /// entries back, so the table never fills up with tombstones.
+    ///
+    /// The interface is a subset of std::map, except that iteration
+    /// is in no particular order and that insertions and erasures
+    /// invalidate all iterators and references into the map.
+    template <typename K, typename V>
+    class FlatMap
+    {
+        static_assert(std::is_integral<K>::value, "FlatMap keys must be integers");
+
+    public:
+        typedef K                 key_type;
+        typedef V                 mapped_type;
+        typedef std::pair<K, V>   value_type;
+
+    private:
+        struct Slot
+        {
+            bool       used;
+            value_type kv;
+        };
+
+        std::vector<Slot> m_slots;  ///< The table, a power of two in size
+        size_t            m_size;   ///< Number of used slots
+        unsigned int      m_shift;  ///< 64 - log2(m_slots.size())
+
+        // Fibonacci hashing; this spreads keys with many zero low bits,
+        // such as line addresses, over the whole table.
+        size_t home(K key) const
+        {
+            return (size_t)(((uint64_t)key * 0x9E3779B97F4A7C15ULL) >> m_shift);
+        }
+
+        size_t mask() const { return m_slots.size() - 1; }
+
+        // Returns the slot holding key, or the empty slot where it belongs.
+        size_t probe(K key) const
+        {
+            size_t i = home(key);
+            while (m_slots[i].used && m_slots[i].kv.first != key)
+                i = (i + 1) & mask();
+            return i;
+        }
+
+        void rehash(size_t capacity)
+        {
+            unsigned int bits = 1;
+            while (((size_t)1 << bits) < capacity)
+                ++bits;
+
+            std::vector<Slot> old(((size_t)1 << bits), Slot{false, value_type()});
+            old.swap(m_slots);
+            m_shift = 64 - bits;
+            for (auto& s : old)
+            {
+                if (s.used)
+                {
+                    Slot& d = m_slots[probe(s.kv.first)];
+                    d.used = true;
+                    d.kv   = std::move(s.kv);
+                }
+            }
+        }
+
+        template <typename S, typename T>
+        class basic_iterator
+        {
+            friend class FlatMap;
+            S* m_slot;
+            S* m_end;
+            basic_iterator(S* slot, S* end) : m_slot(slot), m_end(end) { skip(); }
+            void skip() { while (m_slot != m_end && !m_slot->used) ++m_slot; }
+        public:
+            typedef std::forward_iterator_tag            iterator_category;
+            typedef typename std::remove_const<T>::type  value_type;
+            typedef ptrdiff_t                            difference_type;
+            typedef T*                                   pointer;
+            typedef T&                                   reference;
+
+            basic_iterator() : m_slot(NULL), m_end(NULL) {}
+            // Allow conversion from iterator to const_iterator
+            template <typename S2, typename T2>
+            basic_iterator(const basic_iterator<S2, T2>& o) : m_slot(o.m_slot), m_end(o.m_end) {}
+
+            T& operator*()  const { return m_slot->kv; }
+            T* operator->() const { return &m_slot->kv; }
+
+            basic_iterator& operator++() { ++m_slot; skip(); return *this; }
+            basic_iterator  operator++(int) { basic_iterator t(*this); ++*this; return t; }
+
+            bool operator==(const basic_iterator& o) const { return m_slot == o.m_slot; }
+            bool operator!=(const basic_iterator& o) const { return m_slot != o.m_slot; }
+
+            template <typename S2, typename T2> friend class basic_iterator;
+        };
+
+    public:
+        typedef basic_iterator<Slot, value_type>             iterator;
+        typedef basic_iterator<const Slot, const value_type> const_iterator;
+
+        bool   empty()    const { return m_size == 0; }
+        size_t size()     const { return m_size; }
+        size_t capacity() const { return m_slots.size(); }
+
+        iterator       begin()       { return iterator(m_slots.data(), m_slots.data() + m_slots.size()); }
+        iterator       end()         { return iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()); }
+        const_iterator begin() const { return const_iterator(m_slots.data(), m_slots.data() + m_slots.size()); }
+        const_iterator end()   const { return const_iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()); }
+
+        iterator find(K key)
+        {
+            size_t i = probe(key);
+            return m_slots[i].used ? iterator(&m_slots[i], m_slots.data() + m_slots.size()) : end();
+        }
+
+        const_iterator find(K key) const
+        {
+            size_t i = probe(key);
+            return m_slots[i].used ? const_iterator(&m_slots[i], m_slots.data() + m_slots.size()) : end();
+        }
+
+        size_t count(K key) const { return m_slots[probe(key)].used ? 1 : 0; }
+
+        std::pair<iterator, bool> insert(const value_type& kv)
+        {
+            size_t i = probe(kv.first);
+            if (!m_slots[i].used)
+            {
+                // Keep the load factor under 3/4
+                if (4 * (m_size + 1) > 3 * m_slots.size())
+                {
+                    rehash(2 * m_slots.size());
+                    i = probe(kv.first);
+                }
+                m_slots[i].used = true;
+                m_slots[i].kv   = kv;
+                ++m_size;
+                return std::make_pair(iterator(&m_slots[i], m_slots.data() + m_slots.size()), true);
+            }
+            return std::make_pair(iterator(&m_slots[i], m_slots.data() + m_slots.size()), false);
+        }
+
+        V& operator[](K key)
+        {
+            return insert(value_type(key, V())).first->second;
+        }
+
+        size_t erase(K key)
+        {
+            size_t i = probe(key);
+            if (!m_slots[i].used)
+                return 0;
+
+            // Move back the entries after the hole that would not be
+            // found any more, until the end of the probe sequence.
+            for (size_t j = (i + 1) & mask(); m_slots[j].used; j = (j + 1) & mask())
+            {
+                size_t h = home(m_slots[j].kv.first);
+                if (((j - h) & mask()) >= ((j - i) & mask()))
+                {
+                    m_slots[i].kv = std::move(m_slots[j].kv);
+                    i = j;
+                }
+            }
+            m_slots[i].used = false;
+            m_slots[i].kv   = value_type();
+            --m_size;
+            return 1;
+        }
+
+        void clear()
+        {
+            for (auto& s : m_slots)
+                s = Slot{false, value_type()};
+            m_size = 0;
+        }
+
+        // Makes room for at least n entries without growing the table.
+        void reserve(size_t n)
+        {
+            if (4 * n > 3 * m_slots.size())
+                rehash((4 * n + 2) / 3);
+        }
+
+        explicit FlatMap(size_t n = 16)
+            : m_slots(), m_size(0), m_shift(64)
+        {
+            rehash((4 * n + 2) / 3);
+        }
+    };
+
+    namespace Serialization
+    {
+        // A FlatMap is serialized like a std::map.
+        template<typename K, typename V>
+        struct serialize_trait<FlatMap<K, V> >
+            : public map_serializer<FlatMap<K, V> > {};
+    }
+}
+
+#endif
@@ -0,0 +1,191 @@
+#include "sim/glob.h"
+
+#include <bitset>
+#include <fnmatch.h>
+
+using namespace std;
+
+namespace Simulator
+{
+    GlobPattern::GlobPattern(const string& pattern)
+        : m_pattern(pattern),
+          m_text(),
+          m_literal(false),
+          m_compiled(false),
+          m_match(),
+          m_stars(0),
+          m_start(0),
+          m_accept(0),
+          m_tail(0)
+    {
+        m_compiled = Compile();
+    }
+
+    // Parses a bracket expression that starts at pattern[i], and adds
+    // the characters it matches to set. Returns true and moves i past
+    // the expression if it is supported. Expressions with a character
+    // class or a collating element, and brackets without a closing ']',
+    // whose meaning for fnmatch() depends on the rest of the pattern,
+    // are not.
+    static bool ParseSet(const string& pattern, size_t& i, bitset<256>& set)
+    {
+        size_t j = i + 1;
+        bool negate = false;
+        if (j < pattern.size() && (pattern[j] == '!' || pattern[j] == '^'))
+        {
+            negate = true;
+            ++j;
+        }
+
+        set.reset();
+        for (bool first = true; ; first = false)
+        {
+            if (j >= pattern.size())
+                return false;
+
+            unsigned char lo = pattern[j];
+            if (lo == ']' && !first)
+                break;
+            if (lo == '[' && j + 1 < pattern.size() &&
+                (pattern[j + 1] == ':' || pattern[j + 1] == '=' || pattern[j + 1] == '.'))
+                return false;
+            if (lo == '\\')
+            {
+                if (++j >= pattern.size())
+                    return false;
+                lo = pattern[j];
+            }
+            ++j;
+
+            unsigned char hi = lo;
+            if (j + 1 < pattern.size() && pattern[j] == '-' && pattern[j + 1] != ']')
+            {
+                hi = pattern[j + 1];
+                j += 2;
+                if (hi == '\\')
+                {
+                    if (j >= pattern.size())
+                        return false;
+                    hi = pattern[j++];
+                }
+                else if (hi == '[' && j < pattern.size() &&
+                         (pattern[j] == ':' || pattern[j] == '=' || pattern[j] == '.'))
+                    return false;
+            }
+            for (unsigned c = lo; c <= hi; ++c)
+                set.set(c);
+        }
+
+        if (negate)
+            set.flip();
+        i = j + 1;
+        return true;
+    }
+
+    bool GlobPattern::Compile()
+    {
+        // Translate the pattern to a list of tokens: the characters a
+        // token matches, or a '*' which matches any sequence.
+        vector<bitset<256> > tokens;
+        vector<bool>         stars;
+        m_literal = true;
+        for (size_t i = 0; i < m_pattern.size(); )
+        {
+            bitset<256> set;
+            const char c = m_pattern[i];
+            if (c == '*')
+            {
+                m_literal = false;
+                ++i;
+                if (!stars.empty() && stars.back())
+                    // '**' is the same as '*'
+                    continue;
+                tokens.push_back(set);
+                stars.push_back(true);
+                continue;
+            }
+
+            if (c == '?')
+            {
+                m_literal = false;
+                set.set();
+                ++i;
+            }
+            else if (c == '[')
+            {
+                m_literal = false;
+                if (!ParseSet(m_pattern, i, set))
+                    return false;
+            }
+            else if (c == '\\')
+            {
+                if (i + 1 == m_pattern.size())
+                {
+                    // fnmatch() treats a trailing backslash specially
+                    m_literal = false;
+                    return false;
+                }
+                set.set((unsigned char)m_pattern[i + 1]);
+                m_text += m_pattern[i + 1];
+                i += 2;
+            }
+            else
+            {
+                set.set((unsigned char)c);
+                m_text += c;
+                ++i;
+            }
+            tokens.push_back(set);
+            stars.push_back(false);
+        }
+
+        if (!m_literal)
+            m_text.clear();
+
+        const size_t n = tokens.size();
+        if (n >= sizeof(State) * 8)
+            return false;
+
+        // Shift-and automaton: bit i of a state means that the
+        // characters so far can be followed by token i. A character
+        // moves bit i to i + 1 if token i matches it; a '*' keeps its
+        // bit and also allows the token after it.
+        m_match.assign(256, 0);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (stars[i])
+                m_stars |= (State)1 << i;
+            else
+                for (unsigned c = 0; c < 256; ++c)
+                    if (tokens[i][c])
+                        m_match[c] |= (State)1 << i;
+        }
+
+        m_accept = (State)1 << n;
+        m_tail   = (n > 0 && stars[n - 1]) ? (State)1 << (n - 1) : 0;
+        m_start  = Close(1);
+        return true;
+    }
+
+    GlobPattern::State GlobPattern::Close(State s) const
+    {
+        // No two '*' follow each other, so one step suffices
+        return s | ((s & m_stars) << 1);
+    }
+
+    GlobPattern::State GlobPattern::Advance(State s, const char* p, size_t n) const
+    {
+        for (size_t i = 0; i < n && s != 0; ++i)
+            s = Close(((s & m_match[(unsigned char)p[i]]) << 1) | (s & m_stars));
+        return s;
+    }
+
+    bool GlobPattern::Match(const string& name) const
+    {
+        if (!m_compiled)
+            return fnmatch(m_pattern.c_str(), name.c_str(), 0) != FNM_NOMATCH;
+        if (m_literal)
+            return name == m_text;
+        return Accepts(Advance(m_start, name));
+    }
+}
@@ -0,0 +1,71 @@
+// -*- c++ -*-
+#ifndef SIM_GLOB_H
+#define SIM_GLOB_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Simulator
+{
+    /// A shell wildcard pattern compiled to a small automaton, which
+    /// matches names like fnmatch(3) without flags. The automaton can
+    /// be advanced over a name piece by piece, so that a pattern can
+    /// be matched against a tree of names and whole subtrees can be
+    /// skipped as soon as no name in them can match.
+    ///
+    /// The state of a match is a bit set of the positions in the
+    /// pattern that the characters seen so far can lead to. Patterns
+    /// that do not fit in the state, or that use character classes or
+    /// collating elements, are not compiled; Match() then falls back
+    /// to fnmatch(3) and IsCompiled() returns false.
+    class GlobPattern
+    {
+    public:
+        typedef uint64_t State;
+
+        explicit GlobPattern(const std::string& pattern);
+
+        const std::string& GetPattern() const { return m_pattern; }
+
+        // Whether the pattern has no wildcards, in which case it
+        // only matches GetLiteral().
+        bool IsLiteral() const { return m_literal; }
+        const std::string& GetLiteral() const { return m_text; }
+
+        bool IsCompiled() const { return m_compiled; }
+
+        // The state before any character.
+        State Start() const { return m_start; }
+
+        // The state after the characters in [p, p+n). Returns 0 if
+        // no name that starts with them can match.
+        State Advance(State s, const char* p, size_t n) const;
+        State Advance(State s, const std::string& str) const { return Advance(s, str.data(), str.size()); }
+
+        // Whether the name seen so far matches.
+        bool Accepts(State s) const { return (s & m_accept) != 0; }
+
+        // Whether every name that starts with the characters seen so
+        // far matches, i.e. the rest of the pattern is only '*'.
+        bool AcceptsAll(State s) const { return (s & m_tail) != 0; }
+
+        bool Match(const std::string& name) const;
+
+    private:
+        std::string        m_pattern;
+        std::string        m_text;     ///< The unescaped pattern, if literal
+        bool               m_literal;
+        bool               m_compiled;
+        std::vector<State> m_match;    ///< Per character, the positions whose token matches it
+        State              m_stars;    ///< Positions of '*'
+        State              m_start;
+        State              m_accept;   ///< The position after the last token
+        State              m_tail;     ///< Positions from which only '*' follow
+
+        bool Compile();
+        State Close(State s) const;
+    };
+}
+
+#endif
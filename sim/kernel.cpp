@@ -1,6 +1,7 @@
 #include "kernel.h"
 #include "storage.h"
 #include "sampling.h"
+#include "workerpool.h"
 #include <arch/dev/Display.h>
 #include <arch/dev/SDLInputManager.h>
 
@@ -9,6 +10,7 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
 
 using namespace std;
 
@@ -19,6 +21,10 @@ namespace Simulator
     Kernel* Kernel::g_kernel = 0;
 #endif
 
+    thread_local Process*               Kernel::t_process = NULL;
+    thread_local Clock*                 Kernel::t_clock   = NULL;
+    thread_local Kernel::AcquireWorker* Kernel::t_worker  = NULL;
+
     void Kernel::Abort()
     {
         m_aborted = true;
@@ -100,11 +106,51 @@ namespace Simulator
         assert(m_master_freq % frequency == 0);
 
         m_clocks.push_back(new Clock(*this, frequency, m_master_freq / frequency));
+
+        // Clocks are scheduled at most one period ahead
+        Clock::Period max_period = 0;
+        for (auto c : m_clocks)
+        {
+            max_period = std::max(max_period, c->m_period);
+        }
+        m_clockQueue.Resize(max_period);
+
         return *m_clocks.back();
     }
 
+    // Returns whether the clock has processes to run that are not sleeping.
+    static bool HasAwakeProcesses(const Clock& clock)
+    {
+        for (const Process* process = clock.GetActiveProcesses(); process != NULL; process = process->GetNext())
+        {
+            if (!process->IsSleeping())
+                return true;
+        }
+        return false;
+    }
+
+    // Returns whether the clock only has sleeping processes to run.
+    static bool IsIdleClock(const Clock& clock)
+    {
+        return clock.GetActiveStorages() == NULL && clock.GetActiveArbitrators() == NULL && !HasAwakeProcesses(clock);
+    }
+
+    // Adds the host time of a call to Kernel::Step to the profile.
+    struct StepTimer
+    {
+        uint64_t* total;
+        uint64_t  start;
+
+        StepTimer(bool profiling, uint64_t& t)
+            : total(profiling ? &t : NULL), start(profiling ? ReadHostTicks() : 0) {}
+        StepTimer(const StepTimer&) = delete;
+        StepTimer& operator=(const StepTimer&) = delete;
+        ~StepTimer() { if (total != NULL) *total += ReadHostTicks() - start; }
+    };
+
     RunState Kernel::Step(CycleNo cycles)
     {
+        StepTimer timer(m_profiling, m_profTotal);
         try
         {
             // Time to simulate until
@@ -118,14 +164,15 @@ namespace Simulator
                 UpdateStorages();
             }
 
+            m_aborted = m_suspended = false;
+
             // Advance time to the first clock to run.
-            if (m_activeClocks != NULL)
+            if (m_runningClocks == NULL)
             {
-                assert(m_activeClocks->m_cycle >= m_cycle);
-                m_cycle = m_activeClocks->m_cycle;
+                AdvanceClocks();
             }
+            SkipIdleCycles(endcycle);
 
-            m_aborted = m_suspended = false;
             bool idle = false;
             while (!m_aborted && (!m_suspended || (m_lastsuspend == m_cycle)) && !idle && (endcycle == INFINITE_CYCLES || m_cycle < endcycle))
             {
@@ -136,28 +183,28 @@ namespace Simulator
                 // Acquire phase
                 //
                 m_phase = PHASE_ACQUIRE;
-                for (Clock* clock = m_activeClocks; clock != NULL && m_cycle == clock->m_cycle; clock = clock->m_next)
+
+                // The deadlock messages of the acquire phase would be out
+                // of order if the processes ran in parallel.
+                if (m_workers != NULL && (m_debugMode & DEBUG_DEADLOCK) == 0)
                 {
-                    m_clock = clock;
-                    for (Process* process = clock->m_activeProcesses; process != NULL; process = process->m_next)
+                    AcquireParallel();
+                }
+                else
+                {
+                    for (Clock* clock = m_runningClocks; clock != NULL; clock = clock->m_next)
                     {
-                        m_process   = process;
-
-                        // This process begins the cycle
-                        // This is a purely administrative function and has no simulation effect.
-                        process->OnBeginCycle();
-
-                        // If we fail in the acquire stage, don't bother with the check and commit stages
-                        Result result = process->m_delegate();
-                        if (result == SUCCESS)
+                        m_clock = clock;
+                        for (Process* process = clock->m_activeProcesses; process != NULL; process = process->m_next)
                         {
-                            process->m_state = STATE_RUNNING;
-                        }
-                        else
-                        {
-                            assert(result == FAILED);
-                            process->m_state = STATE_DEADLOCK;
-                            ++process->m_stalls;
+                            if (process->m_wakeup != 0)
+                            {
+                                // This process is sleeping
+                                continue;
+                            }
+
+                            m_process   = process;
+                            AcquireProcess(*process);
                         }
                     }
                 }
@@ -165,12 +212,12 @@ namespace Simulator
                 //
                 // Arbitrate phase
                 //
-                for (Clock* clock = m_activeClocks; clock != NULL && m_cycle == clock->m_cycle; clock = clock->m_next)
+                for (Clock* clock = m_runningClocks; clock != NULL; clock = clock->m_next)
                 {
                     m_clock = clock;
                     for (Arbitrator* arbitrator = clock->m_activeArbitrators; arbitrator != NULL; arbitrator = arbitrator->GetNext())
                     {
-                        arbitrator->OnArbitrate();
+                        Arbitrate(*arbitrator);
                         arbitrator->Deactivate();
                     }
                     clock->m_activeArbitrators = NULL;
@@ -179,30 +226,54 @@ namespace Simulator
                 //
                 // Commit phase
                 //
-                for (Clock* clock = m_activeClocks; clock != NULL && m_cycle == clock->m_cycle; clock = clock->m_next)
+                for (Clock* clock = m_runningClocks; clock != NULL; clock = clock->m_next)
                 {
                     m_clock = clock;
                     for (Process* process = clock->m_activeProcesses; process != NULL; process = process->m_next)
                     {
-                        if (process->m_state != STATE_DEADLOCK)
+                        if (process->m_state != STATE_DEADLOCK && process->m_wakeup == 0)
                         {
                             m_process   = process;
-                            m_phase     = PHASE_CHECK;
 
-                            Result result = process->m_delegate();
-                            if (result == SUCCESS)
+                            Result result;
+                            if (process->m_failsFirst)
                             {
-                                // This process is done this cycle.
-                                // This is a purely administrative function and has no simulation effect.
-                                // We call this before the COMMIT phase, so that if this produces an error,
-                                // we can still inspect the state that caused it.
-                                process->OnEndCycle();
-
+                                // The process has not changed anything if
+                                // it fails, so it can commit without the
+                                // check, cf Process::SetFailsFirst().
                                 m_phase = PHASE_COMMIT;
-                                result = process->m_delegate();
+#ifndef NDEBUG
+                                m_committed = false;
+#endif
+                                result = RunProcess(*process);
+                                assert(result == SUCCESS || !m_committed);
+                                if (result == SUCCESS)
+                                {
+                                    process->OnEndCycle();
+                                }
+                            }
+                            else
+                            {
+                                m_phase = PHASE_CHECK;
+                                result = RunProcess(*process);
+                                if (result == SUCCESS)
+                                {
+                                    // This process is done this cycle.
+                                    // This is a purely administrative function and has no simulation effect.
+                                    // We call this before the COMMIT phase, so that if this produces an error,
+                                    // we can still inspect the state that caused it.
+                                    process->OnEndCycle();
 
-                                // If the CHECK succeeded, the COMMIT cannot fail
-                                assert(result == SUCCESS);
+                                    m_phase = PHASE_COMMIT;
+                                    result = RunProcess(*process);
+
+                                    // If the CHECK succeeded, the COMMIT cannot fail
+                                    assert(result == SUCCESS);
+                                }
+                            }
+
+                            if (result == SUCCESS)
+                            {
                                 process->m_state = STATE_RUNNING;
 
                                 // We've done something -- we're not idle
@@ -232,47 +303,43 @@ namespace Simulator
                 {
                     // We haven't done anything this cycle. Check if there are clocks scheduled
                     // for cycles in the future. If so, we want to still advance the simulation.
-                    for (Clock* clock = m_activeClocks; clock != NULL; clock = clock->m_next)
+                    if (!m_clockQueue.Empty())
                     {
-                        if (clock->m_cycle > m_cycle)
-                        {
-                            idle = false;
-                            break;
-                        }
+                        idle = false;
+                    }
+
+                    if (!m_wheel.Empty())
+                    {
+                        // Sleeping processes will wake up in the future.
+                        idle = false;
                     }
                 }
 
                 auto dm = SDLInputManager::GetManager();
                 if (dm) dm->OnCycle(m_cycle);
 
+                if (m_snapshotRequested.load(std::memory_order_relaxed))
+                {
+                    m_snapshotRequested.store(false, std::memory_order_relaxed);
+                    if (m_snapshotHandler)
+                        m_snapshotHandler();
+                }
+
+                if (m_cycle >= m_nextInterval)
+                {
+                    RunIntervalHandlers();
+                }
+
                 if (!idle)
                 {
                     // Advance the simulation
 
                     // Update the clocks
-                    for (Clock *next, *clock = m_activeClocks; clock != NULL && m_cycle == clock->m_cycle; clock = next)
-                    {
-                        next = clock->m_next;
-
-                        // We ran this clock, remove it from the queue
-                        m_activeClocks = clock->m_next;
-                        clock->m_activated = false;
-
-                        assert(clock->m_activeArbitrators == NULL);
-
-                        if (clock->m_activeProcesses != NULL || clock->m_activeStorages != NULL)
-                        {
-                            // This clock still has active components, reschedule it
-                            ActivateClock(*clock);
-                        }
-                    }
+                    UpdateClocks();
 
                     // Advance time to first clock to run
-                    if (m_activeClocks != NULL)
-                    {
-                        assert(m_activeClocks->m_cycle > m_cycle);
-                        m_cycle = m_activeClocks->m_cycle;
-                    }
+                    AdvanceClocks();
+                    SkipIdleCycles(endcycle);
                 }
             }
 
@@ -306,27 +373,274 @@ namespace Simulator
             // Calculate new activation time for clock
             clock.m_cycle = (m_cycle / clock.m_period) * clock.m_period + clock.m_period;
 
-            // Insert clock into list based on activation time (earliest in front)
-            Clock **before = &m_activeClocks, *after = m_activeClocks;
-            while (after != NULL && after->m_cycle < clock.m_cycle)
+            // Queue the clock; its activation time lies in the future,
+            // so it is never one of the running clocks.
+            m_clockQueue.Push(clock);
+            clock.m_activated = true;
+        }
+    }
+
+    void Kernel::UpdateClocks()
+    {
+        for (Clock *next, *clock = m_runningClocks; clock != NULL; clock = next)
+        {
+            next = clock->m_next;
+
+            // We ran this clock, remove it from the list
+            m_runningClocks = next;
+            clock->m_next = NULL;
+            clock->m_activated = false;
+
+            assert(clock->m_activeArbitrators == NULL);
+
+            if (clock->m_activeProcesses != NULL || clock->m_activeStorages != NULL)
             {
-                before = &after->m_next;
-                after  = after->m_next;
+                // This clock still has active components, reschedule it
+                ActivateClock(*clock);
             }
-            *before = &clock;
-            clock.m_next = after;
-            clock.m_activated = true;
         }
     }
 
+    void Kernel::AdvanceClocks()
+    {
+        assert(m_runningClocks == NULL);
+        if (m_clockQueue.Empty())
+        {
+            return;
+        }
+
+        // Advance time to the first clock to run, and take all clocks
+        // that run in that cycle from the queue.
+        const CycleNo next = m_clockQueue.GetNextCycle(m_cycle);
+        assert(next > m_cycle);
+        m_cycle = next;
+        m_runningClocks = m_clockQueue.Pop(m_cycle);
+    }
+
+    std::vector<const Clock*> Kernel::GetActiveClocks() const
+    {
+        std::vector<const Clock*> clocks;
+        for (const Clock* clock = m_runningClocks; clock != NULL; clock = clock->m_next)
+        {
+            clocks.push_back(clock);
+        }
+        const std::vector<const Clock*> queued = m_clockQueue.GetSorted();
+        clocks.insert(clocks.end(), queued.begin(), queued.end());
+        return clocks;
+    }
+
+    void Kernel::SleepProcess(Process& process, Clock& clock, CycleNo wakeup)
+    {
+        // Processes can only suspend themselves, since the other processes
+        // still have to run this cycle.
+        assert(GetCyclePhase() == PHASE_COMMIT);
+        assert(GetActiveProcess() == &process);
+        assert(GetActiveClock() == &clock);
+
+        if (wakeup <= m_cycle + clock.m_period)
+        {
+            // The process runs on the next tick anyway
+            return;
+        }
+
+        Suspend(process, clock, wakeup);
+    }
+
+    void Kernel::Suspend(Process& process, Clock& clock, CycleNo wakeup)
+    {
+        assert(process.m_activations > 0);
+        assert(process.m_wakeup == 0);
+
+        // The process stays on the run queue of its clock, so it keeps its
+        // place in the order in which processes run. The kernel skips it
+        // until it wakes up.
+        process.m_wakeup = wakeup;
+        process.m_clock  = &clock;
+        m_wheel.Insert(process);
+    }
+
+    void Kernel::Resume(Process& process)
+    {
+        // The clock of the process is still running, since the process
+        // is on its run queue. It runs again on the next tick.
+        m_wheel.Remove(process);
+        process.m_wakeup = 0;
+    }
+
+    void Kernel::CancelSleep(Process& process)
+    {
+        m_wheel.Remove(process);
+        process.m_wakeup = 0;
+    }
+
+    void Kernel::WakeProcesses()
+    {
+        if (m_wheel.Empty() || m_wheel.GetNextEvent() > m_cycle)
+            return;
+
+        // Wakeup cycles are ticks of the clocks of the processes, and those
+        // clocks tick for as long as the processes are on their run queues.
+        // So we always arrive exactly at a wakeup cycle.
+        assert(m_wheel.GetNextEvent() == m_cycle);
+        for (Process *next, *process = m_wheel.Advance(m_cycle); process != NULL; process = next)
+        {
+            next = process->m_wheelNext;
+            process->m_wakeup = 0;
+            assert(process->m_clock->m_activated && process->m_clock->m_cycle == m_cycle);
+        }
+    }
+
+    bool Kernel::IsIdleCycle() const
+    {
+        for (const Clock* clock = m_runningClocks; clock != NULL; clock = clock->m_next)
+        {
+            if (!IsIdleClock(*clock))
+                return false;
+        }
+        return true;
+    }
+
+    void Kernel::SkipIdleCycles(CycleNo endcycle)
+    {
+        WakeProcesses();
+
+        if (m_wheel.Empty() || m_aborted || m_suspended ||
+            (endcycle != INFINITE_CYCLES && m_cycle >= endcycle) ||
+            !IsIdleCycle())
+        {
+            return;
+        }
+
+        // Only sleeping processes are scheduled in this cycle. Nothing
+        // happens until the first of them wakes up, or until a queued clock
+        // ticks with other work to do, so time moves to that cycle at once.
+        // The idle clocks would have ticked every period until then. They
+        // are taken off the schedule, and put back at their first tick from
+        // that cycle on, in the order in which they would have been
+        // rescheduled on every tick.
+        std::vector<IdleClock> idle;
+        for (Clock *next, *clock = m_runningClocks; clock != NULL; clock = next)
+        {
+            // The running clocks are rescheduled in reverse order
+            next = clock->m_next;
+            idle.push_back(IdleClock{clock, m_cycle + clock->m_period, -(long)idle.size() - 1});
+        }
+        m_runningClocks = NULL;
+
+        // Stop at the first tick at or after the end, or at or after the
+        // next call of the interval handlers, so that every interval is
+        // seen by the handlers, e.g. by the samples of the profiler.
+        const CycleNo stop = std::min(endcycle, std::max(m_nextInterval, m_cycle + 1));
+
+        CycleNo target = m_wheel.GetNextEvent();
+        Clock*  running = NULL;
+        long    queued = 0;
+        for (;;)
+        {
+            if (stop != INFINITE_CYCLES)
+            {
+                for (const IdleClock& c : idle)
+                {
+                    const CycleNo period = c.clock->m_period;
+                    target = std::min(target, (stop + period - 1) / period * period);
+                }
+            }
+
+            if (m_clockQueue.Empty() || m_clockQueue.GetNextCycle(m_cycle) >= target)
+            {
+                break;
+            }
+
+            const CycleNo cycle = m_clockQueue.GetNextCycle(m_cycle);
+            Clock* clocks = m_clockQueue.Pop(cycle);
+            bool busy = false;
+            for (const Clock* clock = clocks; clock != NULL; clock = clock->m_next)
+            {
+                busy = busy || !IsIdleClock(*clock);
+            }
+
+            if (busy)
+            {
+                target  = cycle;
+                running = clocks;
+                break;
+            }
+
+            // The clocks keep their order, behind those that were running
+            for (Clock *next, *clock = clocks; clock != NULL; clock = next)
+            {
+                next = clock->m_next;
+                idle.push_back(IdleClock{clock, cycle, queued++});
+            }
+        }
+
+        if (running == NULL && !m_clockQueue.Empty() && m_clockQueue.GetNextCycle(m_cycle) == target)
+        {
+            running = m_clockQueue.Pop(target);
+        }
+
+        for (IdleClock& c : idle)
+        {
+            c.clock->m_next = NULL;
+            if (c.clock->m_activeProcesses == NULL && c.clock->m_activeStorages == NULL)
+            {
+                // Nothing left on this clock; it would not be rescheduled
+                c.clock->m_activated = false;
+                c.rank = 0;
+                continue;
+            }
+
+            const CycleNo period = c.clock->m_period;
+            c.clock->m_cycle = (target + period - 1) / period * period;
+
+            // Clocks that tick in the same cycle run in the reverse order of
+            // their rescheduling. Clocks with shorter periods are rescheduled
+            // later. Clocks with the same period tick together and swap their
+            // order on every tick.
+            if ((c.clock->m_cycle - c.first) / period % 2 != 0)
+            {
+                c.rank = -c.rank;
+            }
+        }
+
+        std::stable_sort(idle.begin(), idle.end(), [](const IdleClock& a, const IdleClock& b) {
+            return a.clock->m_period != b.clock->m_period ? a.clock->m_period < b.clock->m_period : a.rank < b.rank;
+        });
+
+        // Put the clocks back, last first, since the clock queue runs the
+        // latest clock of a cycle first.
+        for (auto c = idle.rbegin(); c != idle.rend(); ++c)
+        {
+            Clock& clock = *c->clock;
+            if (!clock.m_activated)
+            {
+                continue;
+            }
+
+            if (clock.m_cycle == target)
+            {
+                clock.m_next = running;
+                running = &clock;
+            }
+            else
+            {
+                m_clockQueue.Push(clock);
+            }
+        }
+
+        m_cycle = target;
+        m_runningClocks = running;
+        WakeProcesses();
+    }
+
     bool Kernel::UpdateStorages()
     {
         bool updated = false;
-        for (Clock* clock = m_activeClocks; clock != NULL && m_cycle == clock->m_cycle; clock = clock->m_next)
+        for (Clock* clock = m_runningClocks; clock != NULL; clock = clock->m_next)
         {
             for (Storage *s = clock->m_activeStorages; s != NULL; s = s->GetNext())
             {
-                s->Update();
+                UpdateStorage(*s);
                 s->Deactivate();
                 updated = true;
             }
@@ -335,6 +649,336 @@ namespace Simulator
         return updated;
     }
 
+    inline void Kernel::AcquireProcess(Process& process)
+    {
+        // This process begins the cycle
+        // This is a purely administrative function and has no simulation effect.
+        process.OnBeginCycle();
+
+        // If we fail in the acquire stage, don't bother with the check and commit stages
+        Result result = RunProcess(process);
+        if (result == SUCCESS)
+        {
+            process.m_state = STATE_RUNNING;
+        }
+        else
+        {
+            assert(result == FAILED);
+            process.m_state = STATE_DEADLOCK;
+            ++process.m_stalls;
+        }
+    }
+
+    void Kernel::RunAcquireWorker(AcquireWorker& worker)
+    {
+        t_worker = &worker;
+        for (size_t i = 0; i < worker.jobs.size(); ++i)
+        {
+            const AcquireJob& job = worker.jobs[i];
+            t_process    = job.process;
+            t_clock      = job.clock;
+            worker.order = job.order;
+            try
+            {
+                AcquireProcess(*job.process);
+            }
+            catch (...)
+            {
+                // Passed on to the simulation thread
+                worker.error    = std::current_exception();
+                worker.errorJob = i;
+                break;
+            }
+        }
+        t_worker  = NULL;
+        t_process = NULL;
+        t_clock   = NULL;
+    }
+
+    void Kernel::AcquireParallel()
+    {
+        // Hand out the processes in their serial order. The processes
+        // of a top-level component share state outside the storages,
+        // so they go to the same thread.
+        const size_t nthreads = m_acquireWorkers.size();
+        for (AcquireWorker& worker : m_acquireWorkers)
+        {
+            worker.jobs.clear();
+        }
+
+        size_t order = 0;
+        for (Clock* clock = m_runningClocks; clock != NULL; clock = clock->m_next)
+        {
+            for (Process* process = clock->m_activeProcesses; process != NULL; process = process->m_next)
+            {
+                if (process->m_wakeup == 0)
+                {
+                    AcquireJob job = {process, clock, order++};
+                    m_acquireWorkers[process->m_group % nthreads].jobs.push_back(job);
+                }
+            }
+        }
+
+        m_parallel = true;
+        m_workers->Run(m_acquireJob);
+        m_parallel = false;
+
+        // The processes have only requested arbitration. Activate the
+        // arbitrators in the order of the requests in a serial run, so
+        // that the arbitration phase is the same.
+        const AcquireWorker* failed = NULL;
+        m_arbitrations.clear();
+        for (AcquireWorker& worker : m_acquireWorkers)
+        {
+            m_arbitrations.insert(m_arbitrations.end(), worker.arbitrations.begin(), worker.arbitrations.end());
+            worker.arbitrations.clear();
+            if (worker.error && (failed == NULL || worker.jobs[worker.errorJob].order < failed->jobs[failed->errorJob].order))
+            {
+                failed = &worker;
+            }
+        }
+        std::stable_sort(m_arbitrations.begin(), m_arbitrations.end(),
+                         [](const ArbitrationList::value_type& a, const ArbitrationList::value_type& b) { return a.first < b.first; });
+
+        // A serial run stops at the first process that throws
+        const AcquireJob* failedJob = (failed != NULL) ? &failed->jobs[failed->errorJob] : NULL;
+        const size_t end = (failedJob != NULL) ? failedJob->order : order;
+        for (auto& p : m_arbitrations)
+        {
+            if (p.first > end)
+            {
+                break;
+            }
+            p.second->RequestArbitration();
+        }
+
+        if (failed != NULL)
+        {
+            std::exception_ptr error = failed->error;
+            m_process = failedJob->process;
+            m_clock   = failedJob->clock;
+            for (AcquireWorker& worker : m_acquireWorkers)
+            {
+                worker.error = std::exception_ptr();
+            }
+            std::rethrow_exception(error);
+        }
+    }
+
+    void Kernel::DeferArbitration(Arbitrator& arbitrator)
+    {
+        t_worker->arbitrations.push_back(std::make_pair(t_worker->order, &arbitrator));
+    }
+
+    size_t Kernel::GetProcessGroup(const Object& object)
+    {
+        // The group of a process is the component just below the root
+        // of the object tree.
+        const Object* top = &object;
+        while (top->GetParent() != NULL && top->GetParent()->GetParent() != NULL)
+        {
+            top = top->GetParent();
+        }
+        const size_t group = m_processGroups.size();
+        return m_processGroups.insert(std::make_pair(top, group)).first->second;
+    }
+
+    void Kernel::SetNumThreads(size_t threads)
+    {
+        delete m_workers;
+        m_workers = NULL;
+        m_acquireWorkers.clear();
+        if (threads > 1)
+        {
+            m_workers = new WorkerPool(threads);
+            m_acquireWorkers.resize(threads);
+        }
+    }
+
+    inline Result Kernel::RunProcess(Process& process)
+    {
+        if (!m_profiling)
+            return process.m_delegate();
+        return RunProcessProfiled(process);
+    }
+
+    Result Kernel::RunProcessProfiled(Process& process)
+    {
+        const uint64_t start = ReadHostTicks();
+        const Result result = process.m_delegate();
+        process.m_profile.ticks += ReadHostTicks() - start;
+        process.m_profile.calls++;
+        return result;
+    }
+
+    inline void Kernel::UpdateStorage(Storage& storage)
+    {
+        if (!m_profiling)
+        {
+            storage.Update();
+            return;
+        }
+
+        const uint64_t start = ReadHostTicks();
+        storage.Update();
+        if (storage.m_profile.calls++ == 0)
+            m_profStorages.push_back(&storage);
+        storage.m_profile.ticks += ReadHostTicks() - start;
+    }
+
+    inline void Kernel::Arbitrate(Arbitrator& arbitrator)
+    {
+        if (!m_profiling)
+        {
+            arbitrator.OnArbitrate();
+            return;
+        }
+
+        const uint64_t start = ReadHostTicks();
+        arbitrator.OnArbitrate();
+        if (arbitrator.m_profile.calls++ == 0)
+            m_profArbitrators.push_back(&arbitrator);
+        arbitrator.m_profile.ticks += ReadHostTicks() - start;
+    }
+
+    void Kernel::SetProfiling(bool enable)
+    {
+        if (enable && m_profTicks == 0)
+        {
+            // Starting a new profile; remember when, to calibrate the ticks
+            m_profTicks = ReadHostTicks();
+            m_profTime  = std::chrono::steady_clock::now();
+        }
+        m_profiling = enable;
+    }
+
+    void Kernel::SetSnapshotHandler(std::function<void()> handler)
+    {
+        m_snapshotHandler = std::move(handler);
+        m_snapshotRequested.store(false, std::memory_order_relaxed);
+    }
+
+    size_t Kernel::AddIntervalHandler(CycleNo interval, std::function<void()> handler)
+    {
+        assert(interval > 0 && handler);
+        const size_t id = m_nextIntervalId++;
+        const CycleNo next = (m_cycle / interval + 1) * interval;
+        m_nextInterval = std::min(m_nextInterval, next);
+        m_intervalHandlers.push_back(IntervalHandler(id, interval, next, std::move(handler)));
+        return id;
+    }
+
+    void Kernel::RemoveIntervalHandler(size_t id)
+    {
+        m_nextInterval = INFINITE_CYCLES;
+        for (auto i = m_intervalHandlers.begin(); i != m_intervalHandlers.end(); )
+        {
+            if (i->id == id)
+            {
+                if (m_inIntervalHandlers)
+                {
+                    // RunIntervalHandlers may be calling it; it is
+                    // erased there.
+                    i->next = INFINITE_CYCLES;
+                    ++i;
+                    continue;
+                }
+                i = m_intervalHandlers.erase(i);
+                continue;
+            }
+            m_nextInterval = std::min(m_nextInterval, i->next);
+            ++i;
+        }
+    }
+
+    void Kernel::RunIntervalHandlers()
+    {
+        // The handlers can add or remove handlers. Added handlers go to
+        // the back and are not due yet. Removed handlers are not called
+        // again, and are only erased once all handlers have been called.
+        m_inIntervalHandlers = true;
+        try
+        {
+            for (size_t i = 0; i < m_intervalHandlers.size(); ++i)
+            {
+                IntervalHandler& h = m_intervalHandlers[i];
+                if (m_cycle >= h.next)
+                {
+                    h.next = (m_cycle / h.interval + 1) * h.interval;
+                    h.handler();
+                }
+            }
+        }
+        catch (...)
+        {
+            m_inIntervalHandlers = false;
+            throw;
+        }
+        m_inIntervalHandlers = false;
+
+        m_nextInterval = INFINITE_CYCLES;
+        for (auto i = m_intervalHandlers.begin(); i != m_intervalHandlers.end(); )
+        {
+            if (i->next == INFINITE_CYCLES)
+            {
+                i = m_intervalHandlers.erase(i);
+                continue;
+            }
+            m_nextInterval = std::min(m_nextInterval, i->next);
+            ++i;
+        }
+    }
+
+    void Kernel::ResetProfile()
+    {
+        for (Process* p : m_proc_registry)
+            p->m_profile = ProfileCounter();
+        for (Storage* s : m_profStorages)
+            s->m_profile = ProfileCounter();
+        for (Arbitrator* a : m_profArbitrators)
+            a->m_profile = ProfileCounter();
+        m_profStorages.clear();
+        m_profArbitrators.clear();
+        m_profTotal = 0;
+        m_profTicks = 0;
+        SetProfiling(m_profiling);
+    }
+
+    Profile Kernel::GetProfile() const
+    {
+        Profile profile;
+        profile.total = m_profTotal;
+
+        // Convert the ticks with the average rate since the profile started
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_profTime).count();
+        profile.ticksPerSecond = (m_profTicks != 0 && secs > 0) ? (ReadHostTicks() - m_profTicks) / secs : 1e9;
+
+        uint64_t used = 0;
+        for (const Process* p : m_proc_registry)
+        {
+            if (p->m_profile.calls > 0)
+            {
+                profile.entries.push_back(ProfileEntry{p->GetName(), ProfileEntry::PROCESS, p->m_profile});
+                used += p->m_profile.ticks;
+            }
+        }
+        for (const Storage* s : m_profStorages)
+        {
+            profile.entries.push_back(ProfileEntry{s->GetName(), ProfileEntry::STORAGE, s->m_profile});
+            used += s->m_profile.ticks;
+        }
+        for (const Arbitrator* a : m_profArbitrators)
+        {
+            profile.entries.push_back(ProfileEntry{a->GetName(), ProfileEntry::ARBITRATOR, a->m_profile});
+            used += a->m_profile.ticks;
+        }
+
+        ProfileEntry kernel{"kernel", ProfileEntry::KERNEL, ProfileCounter()};
+        kernel.counter.ticks = (m_profTotal > used) ? m_profTotal - used : 0;
+        profile.entries.push_back(kernel);
+        return profile;
+    }
+
 
     void Kernel::SetDebugMode(int flags)
     {
@@ -352,6 +996,147 @@ namespace Simulator
         m_proc_registry.insert(&p);
     }
 
+    // Empties the schedule before it is restored.
+    void Kernel::ClearSchedule()
+    {
+        m_clockQueue.Clear();
+        m_runningClocks = NULL;
+        for (auto c : m_clocks)
+        {
+            // Pending updates are dropped; the storages are restored separately.
+            for (Storage* s = c->m_activeStorages; s != NULL; s = s->GetNext())
+                s->Deactivate();
+            for (Arbitrator* a = c->m_activeArbitrators; a != NULL; a = a->GetNext())
+                a->Deactivate();
+
+            for (Process *next, *p = c->m_activeProcesses; p != NULL; p = next)
+            {
+                next = p->m_next;
+                if (p->m_wakeup != 0)
+                    CancelSleep(*p);
+                p->m_activations = 0;
+                p->m_next  = NULL;
+                p->m_pPrev = NULL;
+            }
+
+            c->m_activeProcesses   = NULL;
+            c->m_activeStorages    = NULL;
+            c->m_activeArbitrators = NULL;
+            c->m_next      = NULL;
+            c->m_activated = false;
+        }
+        assert(m_wheel.Empty());
+    }
+
+    // The processes are identified by their index in the order of their
+    // names and the clocks by their index in m_clocks, which are the same
+    // in every simulation with the same configuration.
+    template<typename A>
+    void Kernel::serialize(A& arch)
+    {
+        vector<Process*> procs(m_proc_registry.begin(), m_proc_registry.end());
+        sort(procs.begin(), procs.end(),
+             [](const Process* a, const Process* b) { return a->GetName() < b->GetName(); });
+
+        size_t nclocks = m_clocks.size(), nprocs = procs.size();
+        CycleNo now = m_wheel.GetTime();
+        vector<size_t> running, queued;
+
+        if (arch.reading())
+        {
+            for (auto c : m_clocks)
+            {
+                if (c->m_activeStorages != NULL || c->m_activeArbitrators != NULL)
+                    throw exceptf<>("The schedule can only be saved between cycles; run the simulation for at least one cycle first");
+            }
+            for (const Clock* c = m_runningClocks; c != NULL; c = c->m_next)
+                running.push_back(find(m_clocks.begin(), m_clocks.end(), c) - m_clocks.begin());
+            for (auto c : m_clockQueue.GetSorted())
+                queued.push_back(find(m_clocks.begin(), m_clocks.end(), c) - m_clocks.begin());
+        }
+
+        arch & "[sched" & nclocks & nprocs & now;
+        if (nclocks != m_clocks.size() || nprocs != procs.size())
+            throw exceptf<>("The saved schedule has %zu clocks and %zu processes instead of %zu and %zu",
+                            nclocks, nprocs, m_clocks.size(), procs.size());
+
+        if (!arch.reading())
+        {
+            ClearSchedule();
+            m_wheel.Reset(now);
+        }
+
+        map<const Process*, size_t> index;
+        for (size_t i = 0; i < nprocs; ++i)
+            index[procs[i]] = i;
+
+        for (auto c : m_clocks)
+        {
+            arch & c->m_cycle & c->m_activated;
+
+            size_t nactive = 0;
+            for (const Process* p = c->m_activeProcesses; p != NULL; p = p->m_next)
+                ++nactive;
+            arch & nactive;
+
+            // The processes are restored in the same order, at the end of the list
+            Process** tail = &c->m_activeProcesses;
+            Process*  p    = c->m_activeProcesses;
+            for (size_t i = 0; i < nactive; ++i)
+            {
+                size_t id = arch.reading() ? index[p] : 0;
+                unsigned activations = arch.reading() ? p->m_activations : 0;
+                CycleNo  wakeup      = arch.reading() ? p->m_wakeup : 0;
+                arch & id & activations & wakeup;
+
+                if (arch.reading())
+                {
+                    p = p->m_next;
+                    continue;
+                }
+
+                if (id >= nprocs || activations == 0)
+                    throw exceptf<>("Invalid process in the saved schedule");
+                Process& q = *procs[id];
+                q.m_activations = activations;
+                q.m_next  = NULL;
+                q.m_pPrev = tail;
+                *tail = &q;
+                tail  = &q.m_next;
+                if (wakeup != 0)
+                {
+                    q.m_wakeup = wakeup;
+                    q.m_clock  = c;
+                    m_wheel.Insert(q);
+                }
+            }
+        }
+
+        arch & running & queued;
+        arch & "]";
+
+        if (!arch.reading())
+        {
+            Clock** tail = &m_runningClocks;
+            for (auto i : running)
+            {
+                if (i >= nclocks)
+                    throw exceptf<>("Invalid clock in the saved schedule");
+                *tail = m_clocks[i];
+                tail  = &m_clocks[i]->m_next;
+            }
+
+            // Push the clocks in reverse order, since each clock goes in
+            // front of the clocks that tick in the same cycle.
+            for (auto i = queued.rbegin(); i != queued.rend(); ++i)
+            {
+                if (*i >= nclocks)
+                    throw exceptf<>("Invalid clock in the saved schedule");
+                m_clockQueue.Push(*m_clocks[*i]);
+            }
+        }
+    }
+
     Kernel::Kernel()
         : m_lastsuspend((CycleNo)-1),
           m_cycle(0),
@@ -359,21 +1144,48 @@ namespace Simulator
           m_clock(NULL),
           m_process(NULL),
           m_clocks(),
-          m_activeClocks(NULL),
+          m_runningClocks(NULL),
+          m_clockQueue(),
+          m_wheel(),
           m_phase(PHASE_COMMIT),
           m_debugMode(0),
           m_aborted(false),
           m_suspended(false),
           m_config(NULL),
           m_var_registry(),
-          m_proc_registry()
+          m_proc_registry(),
+          m_profiling(false),
+          m_profTotal(0),
+          m_profTicks(0),
+          m_profTime(),
+          m_profStorages(),
+          m_profArbitrators(),
+          m_snapshotHandler(),
+          m_snapshotRequested(false),
+          m_intervalHandlers(),
+          m_nextIntervalId(0),
+          m_nextInterval(INFINITE_CYCLES),
+          m_inIntervalHandlers(false),
+          m_workers(NULL),
+          m_acquireWorkers(),
+          m_acquireJob([this](size_t i) { RunAcquireWorker(m_acquireWorkers[i]); }),
+          m_arbitrations(),
+          m_processGroups(),
+          m_parallel(false)
+#ifndef NDEBUG
+        , m_committed(false)
+#endif
     {
         m_var_registry.RegisterVariable(m_cycle, "kernel.cycle", SVC_CUMULATIVE);
         m_var_registry.RegisterVariable(m_phase, "kernel.phase", SVC_STATE);
+        m_var_registry.RegisterVariable(this, "kernel.schedule", SVC_STATE, Serialization::SV_OTHER, 0, 0,
+                                        &Serialization::serializer<StreamSerializer, Kernel>,
+                                        &Serialization::serializer<BinarySerializer, Kernel>);
     }
 
     Kernel::~Kernel()
     {
+        delete m_workers;
         for (auto c : m_clocks)
             delete c;
     }
@@ -3,9 +3,14 @@
 #define KERNEL_H
 
 #include <vector>
+#include <deque>
 #include <map>
 #include <set>
 #include <cassert>
+#include <chrono>
+#include <atomic>
+#include <exception>
+#include <functional>
 
 // Dependencies of Kernel.
 #include "sim/types.h"
@@ -13,17 +18,22 @@
 #include "sim/delegate.h"
 #include "sim/storagetrace.h"
 #include "sim/sampling.h"
+#include "sim/profile.h"
 
 // Other classes that users of Kernel expect to see defined too.
 #include "sim/clock.h"
 #include "sim/object.h"
 #include "sim/process.h"
 #include "sim/arbitrator.h"
+#include "sim/timingwheel.h"
+#include "sim/clockqueue.h"
 
 class Config;
 
 namespace Simulator
 {
+    class WorkerPool;
+
     /**
      * Enumeration for the phases inside a cycle
      */
@@ -40,6 +50,9 @@ namespace Simulator
      */
     class Kernel
     {
+        friend class Clock;
+        friend class Process;
+        friend class Arbitrator;
 
 public:
         /// Modes of debugging
@@ -67,7 +80,9 @@ public:
         Clock*              m_clock;        ///< The currently active clock.
         Process*            m_process;      ///< The currently executing process.
         std::vector<Clock*> m_clocks;       ///< All clocks in the system.
-        Clock*              m_activeClocks; ///< The clocks that have active components
+        Clock*              m_runningClocks;///< The clocks that run in the current cycle, in order.
+        ClockQueue          m_clockQueue;   ///< The other clocks that have active components.
+        TimingWheel         m_wheel;        ///< The sleeping processes.
 
         CyclePhase          m_phase;        ///< Current sub-cycle phase of the simulation.
         int                 m_debugMode;    ///< Bit mask of enabled debugging modes.
@@ -78,8 +93,103 @@ public:
         VariableRegistry    m_var_registry; ///< Attached variable registry.
         std::set<Process*>  m_proc_registry; ///< Set of all processes instantiated.
 
+        // Profiling
+        bool                              m_profiling;    ///< Time the processes, storages and arbitrators?
+        uint64_t                          m_profTotal;    ///< Host ticks spent in Step() while profiling.
+        uint64_t                          m_profTicks;    ///< Host ticks at the start of the profile.
+        std::chrono::steady_clock::time_point m_profTime; ///< Host time at the start of the profile.
+        std::vector<Storage*>             m_profStorages; ///< Storages that have been updated while profiling.
+        std::vector<Arbitrator*>          m_profArbitrators; ///< Arbitrators that have run while profiling.
+
+        // Snapshots
+        std::function<void()>             m_snapshotHandler;   ///< Takes a snapshot, cf SetSnapshotHandler().
+        std::atomic<bool>                 m_snapshotRequested; ///< Take a snapshot at the end of the cycle?
+        struct IntervalHandler
+        {
+            size_t                id;
+            CycleNo               interval;
+            CycleNo               next;     ///< Cycle at which to call the handler next.
+            std::function<void()> handler;
+
+            IntervalHandler(size_t i, CycleNo ival, CycleNo n, std::function<void()> h)
+                : id(i), interval(ival), next(n), handler(std::move(h)) {}
+        };
+        std::deque<IntervalHandler>       m_intervalHandlers;  ///< cf AddIntervalHandler(); a deque keeps the handlers in place as others are added.
+        size_t                            m_nextIntervalId;
+        CycleNo                           m_nextInterval;      ///< Earliest next cycle of the interval handlers.
+        bool                              m_inIntervalHandlers; ///< Are the interval handlers being called?
+
+        // Parallel acquire phase, cf SetNumThreads()
+        struct AcquireJob
+        {
+            Process* process;
+            Clock*   clock;
+            size_t   order;     ///< Position of the process in the serial order of the cycle.
+        };
+        typedef std::vector<std::pair<size_t, Arbitrator*> > ArbitrationList;
+        struct AcquireWorker
+        {
+            std::vector<AcquireJob> jobs;          ///< The processes of the thread, in serial order.
+            ArbitrationList         arbitrations;  ///< Requested arbitrators, with the order of the requesting process.
+            size_t                  order;         ///< Order of the running process.
+            std::exception_ptr      error;         ///< Exception thrown by a process, which ends the jobs of the thread.
+            size_t                  errorJob;      ///< Index of the job that threw it.
+            char                    padding[64];   ///< Keeps the threads apart in the host caches.
+
+            AcquireWorker() : jobs(), arbitrations(), order(0), error(), errorJob(0), padding() {}
+            AcquireWorker(const AcquireWorker&) = default;
+            AcquireWorker& operator=(const AcquireWorker&) = default;
+        };
+        WorkerPool*                       m_workers;         ///< Host threads of the acquire phase, or NULL to run it serially.
+        std::vector<AcquireWorker>        m_acquireWorkers;  ///< The work of every thread in the acquire phase.
+        std::function<void(size_t)>       m_acquireJob;      ///< Job of the worker pool.
+        ArbitrationList                   m_arbitrations;    ///< Arbitration requests of all threads, merged.
+        std::map<const Object*, size_t>   m_processGroups;   ///< Top-level components with processes, numbered.
+        bool                              m_parallel;        ///< Are processes running on several host threads?
+#ifndef NDEBUG
+        mutable bool                      m_committed;       ///< Has the running process committed anything? cf IsCommitting().
+#endif
+
+        static thread_local Process*       t_process;       ///< The process of this host thread, while m_parallel.
+        static thread_local Clock*         t_clock;         ///< The clock of this host thread, while m_parallel.
+        static thread_local AcquireWorker* t_worker;        ///< The work of this host thread, while m_parallel.
+
+        void RunIntervalHandlers();
+
         bool UpdateStorages();
 
+        void AcquireProcess(Process& process);
+        void AcquireParallel();
+        void RunAcquireWorker(AcquireWorker& worker);
+        void DeferArbitration(Arbitrator& arbitrator);
+        size_t GetProcessGroup(const Object& object);
+
+        Result RunProcess(Process& process);
+        Result RunProcessProfiled(Process& process);
+        void UpdateStorage(Storage& storage);
+        void Arbitrate(Arbitrator& arbitrator);
+
+        void UpdateClocks();
+        void AdvanceClocks();
+        void ClearSchedule();
+
+        void SleepProcess(Process& process, Clock& clock, CycleNo wakeup);
+        void Suspend(Process& process, Clock& clock, CycleNo wakeup);
+        void Resume(Process& process);
+        void CancelSleep(Process& process);
+        void WakeProcesses();
+
+        /// A clock that is taken off the schedule while idle cycles are skipped.
+        struct IdleClock
+        {
+            Clock*  clock;
+            CycleNo first;  ///< First tick after the current cycle.
+            long    rank;   ///< Order among the clocks of the same period on that tick.
+        };
+
+        bool IsIdleCycle() const;
+        void SkipIdleCycles(CycleNo endcycle);
+
 #ifdef STATIC_KERNEL
         static Kernel* g_kernel;
     public:
@@ -106,6 +216,59 @@ public:
          */
         void RegisterProcess(Process&);
 
+        /**
+         * @brief Enable or disable host time profiling.
+         * While enabled, the kernel measures the host time spent in every
+         * process, storage update and arbitration, and in Step() overall.
+         * Disabling keeps the measurements so far.
+         */
+        void SetProfiling(bool enable);
+
+        /**
+         * @brief Check whether host time profiling is enabled.
+         */
+        bool GetProfiling() const { return m_profiling; }
+
+        /**
+         * @brief Set the function that takes snapshots of the simulation.
+         * It runs on the simulation thread at the end of the first cycle
+         * after a snapshot was requested, when all storages have been
+         * updated, so that it sees a consistent state.
+         */
+        void SetSnapshotHandler(std::function<void()> handler);
+
+        /**
+         * @brief Request a snapshot at the end of the current cycle.
+         * This can be called from any host thread.
+         */
+        void RequestSnapshot() { m_snapshotRequested.store(true, std::memory_order_relaxed); }
+
+        /**
+         * @brief Add a function that is called every interval master cycles.
+         * It runs at the end of the first cycle at or after every multiple
+         * of interval, when all storages have been updated. Idle cycles are
+         * skipped, so the current cycle can be past the multiple.
+         * @return an identifier for RemoveIntervalHandler().
+         */
+        size_t AddIntervalHandler(CycleNo interval, std::function<void()> handler);
+
+        /**
+         * @brief Stop calling a function added with AddIntervalHandler().
+         */
+        void RemoveIntervalHandler(size_t id);
+
+        /**
+         * @brief Clear the host time profile.
+         */
+        void ResetProfile();
+
+        /**
+         * @brief Get the host time profile.
+         * The time in Step() that is not spent in any component is
+         * attributed to an entry named "kernel".
+         */
+        Profile GetProfile() const;
+
         /**
          * @brief Inspect all registered processes.
          */
@@ -129,17 +292,56 @@ public:
         /**
          * @brief Get the currently active clock
          */
-        inline Clock* GetActiveClock() const { return m_clock; }
+        inline Clock* GetActiveClock() const { return m_parallel ? t_clock : m_clock; }
 
         /**
          * @brief Get the currently executing process
          */
-        inline Process* GetActiveProcess() const { return m_process; }
+        inline Process* GetActiveProcess() const { return m_parallel ? t_process : m_process; }
+
+        /**
+         * @brief Set the number of host threads that run the acquire phase.
+         * The processes of a top-level component (e.g. a core) all run on
+         * the same thread, one after the other in the serial order. The
+         * arbitration, check and commit phases remain serial, so the
+         * simulation gives the same results with any number of threads.
+         * This relies on the processes changing the state of components
+         * outside their own top-level component only in the commit phase,
+         * and through ports and storages. While deadlocks are debugged,
+         * the acquire phase runs serially. 1 disables the threads.
+         */
+        void SetNumThreads(size_t threads);
+
+        /**
+         * @brief Get the number of host threads that run the acquire phase.
+         */
+        size_t GetNumThreads() const { return m_acquireWorkers.empty() ? 1 : m_acquireWorkers.size(); }
+
+        /**
+         * @brief Check whether processes are running on several host threads.
+         */
+        inline bool IsParallel() const { return m_parallel; }
 
         /**
-         * @brief Get the currently scheduled processes
+         * @brief Get the clocks that have active components, in the order in which they run.
          */
-        inline const Clock* GetActiveClocks() const { return m_activeClocks; }
+        std::vector<const Clock*> GetActiveClocks() const;
+
+        /**
+         * @brief Save or restore the schedule of the simulation.
+         * The schedule consists of the processes that are active on each
+         * clock, in the order in which they run, the sleeping processes
+         * and the clocks that are scheduled to run. It is registered as
+         * the state variable kernel.schedule, so that checkpoints include
+         * it. It can only be saved between cycles after the first, when no
+         * storage update is pending.
+         */
+        SERIALIZE(arch);
+
+        /**
+         * @brief Get the number of sleeping processes
+         */
+        inline size_t GetNumSleepingProcesses() const { return m_wheel.GetSize(); }
 
         /**
          * @brief Get the cycle counter.
@@ -155,6 +357,26 @@ public:
          */
         inline CyclePhase GetCyclePhase() const { return m_phase; }
 
+        /**
+         * @brief Check for the commit phase.
+         * Debug builds also note that the running process has committed
+         * something, cf Process::SetFailsFirst().
+         * @return true if the simulation is in the commit phase.
+         */
+        inline bool IsCommitting() const
+        {
+#ifndef NDEBUG
+            if (m_phase == PHASE_COMMIT)
+            {
+                m_committed = true;
+                return true;
+            }
+            return false;
+#else
+            return m_phase == PHASE_COMMIT;
+#endif
+        }
+
         /**
          * Sets the debug flags.
          * @param mode the debug flags to set (from enum DebugMode).
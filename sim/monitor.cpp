@@ -9,6 +9,7 @@
 #include <fstream>
 #include <iomanip>
 #include <cmath>
+#include <cstring>
 #include <sys/time.h>
 #include <unistd.h>
 
@@ -20,6 +21,29 @@
 
 using namespace std;
 
+// The trace file starts with this, the sizes of a sample and of a
+// block, and the offset and size of the cycle in a sample, and ends
+// with the block index, its size and offset, and INDEX_MAGIC.
+static const char TRACE_MAGIC[8] = { 'M', 'G', 'M', 'O', 'N', 'Z', '0', '1' };
+static const char INDEX_MAGIC[8] = { 'M', 'G', 'M', 'O', 'N', 'I', 'D', 'X' };
+
+template<typename T>
+static void put(vector<char>& buf, T value)
+{
+    const char* p = (const char*)&value;
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+static void putVarint(vector<char>& buf, size_t value)
+{
+    while (value >= 0x80)
+    {
+        buf.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    buf.push_back((char)value);
+}
+
 void* runmonitor(void *arg)
 {
 #ifdef CAN_USE_SIGMASK_ON_STD_THREAD
@@ -42,11 +66,24 @@ Monitor::Monitor(Simulator::MGSystem& sys, bool enabled, const string& mdfile, c
       m_outputfile(0),
       m_tsdelay(),
       m_monitorthread(NULL),
-      m_runlock(),
       m_sampler(0),
       m_quiet(quiet),
       m_running(false),
-      m_enabled(true)
+      m_enabled(true),
+      m_recordSize(0),
+      m_ring(),
+      m_ringMask(0),
+      m_head(0),
+      m_tail(0),
+      m_tailCache(0),
+      m_dropped(0),
+      m_blockSize(0),
+      m_prev(),
+      m_block(),
+      m_blockRecords(0),
+      m_blockCycle(0),
+      m_numRecords(0),
+      m_index()
 {
     if (!enabled)
     {
@@ -62,11 +99,12 @@ Monitor::Monitor(Simulator::MGSystem& sys, bool enabled, const string& mdfile, c
         return ;
     }
 
-    vector<string> pats = sys.GetKernel()->GetConfig()->getWordList("MonitorSampleVariables");
+    Config& config = *sys.GetKernel()->GetConfig();
+    vector<string> pats = config.getWordList("MonitorSampleVariables");
     pats.insert(pats.begin(), "kernel.cycle");
     pats.push_back("kernel.cycle");
     m_sampler = new Simulator::BinarySampler(sys.GetKernel()->GetVariableRegistry());
-    m_sampler->SelectVariables(metadatafile, *sys.GetKernel()->GetConfig(), pats);
+    m_sampler->SelectVariables(metadatafile, config, pats);
     metadatafile << "# tv_sizes: " << sizeof(((struct timeval*)(void*)0)->tv_sec)
                  << ' ' << sizeof(((struct timeval*)(void*)0)->tv_usec)
                  << ' ' << sizeof(struct timeval) << endl;
@@ -85,11 +123,32 @@ Monitor::Monitor(Simulator::MGSystem& sys, bool enabled, const string& mdfile, c
         return ;
     }
 
-    float msd = sys.GetKernel()->GetConfig()->getValue<float>("MonitorSampleDelay");
+    float msd = config.getValue<float>("MonitorSampleDelay");
     msd = fabs(msd);
     m_tsdelay.tv_sec = msd;
     m_tsdelay.tv_nsec = (msd - (float)m_tsdelay.tv_sec) * 1000000000.;
 
+    // Round the ring up to a power of two, so that positions can be
+    // masked instead of divided.
+    m_recordSize = m_sampler->GetBufferSize() + 2 * sizeof(struct timeval);
+    size_t size = max<size_t>(config.getValueOrDefault<size_t>("MonitorBufferSize", 1024), 2);
+    size_t ringSize = 1;
+    while (ringSize < size)
+        ringSize <<= 1;
+    m_ring.resize(ringSize * m_recordSize);
+    m_ringMask = ringSize - 1;
+
+    m_blockSize = max<size_t>(config.getValueOrDefault<size_t>("MonitorBlockSize", 256), 1);
+    m_prev.resize(m_recordSize);
+
+    vector<char> header;
+    header.insert(header.end(), TRACE_MAGIC, TRACE_MAGIC + sizeof TRACE_MAGIC);
+    put<uint32_t>(header, m_recordSize);
+    put<uint32_t>(header, m_blockSize);
+    put<uint32_t>(header, 2 * sizeof(struct timeval));  // kernel.cycle is the first variable
+    put<uint32_t>(header, sizeof(Simulator::CycleNo));
+    m_outputfile->write(header.data(), header.size());
+
     if (!m_quiet)
         clog << "# monitoring enabled, sampling "
                   << m_sampler->GetBufferSize()
@@ -99,6 +158,7 @@ Monitor::Monitor(Simulator::MGSystem& sys, bool enabled, const string& mdfile, c
                   << "s to file " << outfile << endl
                   << "# metadata output to file " << mdfile << endl;
 
+    sys.GetKernel()->SetSnapshotHandler([this] { Snapshot(); });
     m_monitorthread = new std::thread(runmonitor, this);
 
 #ifndef CAN_USE_SIGMASK_ON_STD_THREAD
@@ -113,8 +173,8 @@ Monitor::~Monitor()
         if (!m_quiet)
             clog << "# shutting down monitoring..." << endl;
 
+        m_sys.GetKernel()->SetSnapshotHandler(nullptr);
         m_enabled = false;
-        m_runlock.unlock();
         m_monitorthread->join();
         delete m_monitorthread;
 
@@ -122,7 +182,11 @@ Monitor::~Monitor()
         delete m_outputfile;
         delete m_sampler;
         if (!m_quiet)
+        {
+            if (m_dropped != 0)
+                clog << "# warning: " << m_dropped << " samples dropped, the monitor could not keep up." << endl;
             clog << "# monitoring ended." << endl;
+        }
     }
 }
 
@@ -132,7 +196,6 @@ void Monitor::start()
         if (!m_quiet)
             clog << "# starting monitor..." << endl;
         m_running = true;
-        m_runlock.unlock();
     }
 }
 
@@ -141,26 +204,41 @@ void Monitor::stop()
     if (m_running) {
         if (!m_quiet)
             clog << "# stopping monitor..." << endl;
-        m_runlock.lock();
         m_running = false;
     }
 }
 
-void Monitor::run()
+// Runs on the simulation thread, at the end of a cycle.
+void Monitor::Snapshot()
 {
-    if (!m_quiet)
-        clog << "# monitor thread started." << endl;
+    const uint64_t head = m_head.load(memory_order_relaxed);
+    if (head - m_tailCache > m_ringMask)
+    {
+        m_tailCache = m_tail.load(memory_order_acquire);
+        if (head - m_tailCache > m_ringMask)
+        {
+            ++m_dropped;
+            return;
+        }
+    }
 
-    const size_t datasz = m_sampler->GetBufferSize();
-    const size_t allsz = datasz + 2 * sizeof(struct timeval);
-    char *allbuf = new char[allsz];
+    char* record = &m_ring[(head & m_ringMask) * m_recordSize];
+    struct timeval tv_begin, tv_end;
+    gettimeofday(&tv_begin, 0);
+    m_sampler->SampleToBuffer(record + 2 * sizeof(struct timeval));
+    gettimeofday(&tv_end, 0);
+    memcpy(record, &tv_begin, sizeof tv_begin);
+    memcpy(record + sizeof tv_begin, &tv_end, sizeof tv_end);
 
-    struct timeval *tv_begin = (struct timeval*)(void*)allbuf;
-    struct timeval *tv_end = (struct timeval*)(void*)(allbuf + sizeof(struct timeval));
-    char *databuf = allbuf + 2 * sizeof(struct timeval);
+    m_head.store(head + 1, memory_order_release);
+}
 
-    Simulator::CycleNo lastCycle = 0;
+void Monitor::run()
+{
+    if (!m_quiet)
+        clog << "# monitor thread started." << endl;
 
+    Simulator::Kernel& kernel = *m_sys.GetKernel();
     while (m_enabled)
     {
 #if defined(HAVE_NANOSLEEP)
@@ -171,20 +249,112 @@ void Monitor::run()
 #error No sub-microsecond wait available on this system.
 #endif
 
-        Simulator::CycleNo currentCycle = m_sys.GetKernel()->GetCycleNo();
-        if (currentCycle == lastCycle)
-            // nothing to do
-            continue;
-        lastCycle = currentCycle;
+        if (m_running)
+            kernel.RequestSnapshot();
+
+        Drain();
+    }
+
+    // The simulation has stopped; write the last samples
+    Drain();
+    FlushBlock();
+    WriteIndex();
+}
+
+// Encodes the samples in the ring.
+void Monitor::Drain()
+{
+    uint64_t       tail = m_tail.load(memory_order_relaxed);
+    const uint64_t head = m_head.load(memory_order_acquire);
+    for (; tail != head; ++tail)
+    {
+        Encode(&m_ring[(tail & m_ringMask) * m_recordSize]);
+        m_tail.store(tail + 1, memory_order_release);
+    }
+}
 
-        m_runlock.lock();
+// Appends a sample to the current block, as its difference with the
+// previous sample: pairs of a count of unchanged bytes and a count of
+// changed bytes, followed by the changed bytes XORed with the previous
+// sample.
+void Monitor::Encode(const char* record)
+{
+    if (m_blockRecords == 0)
+    {
+        // The first sample of a block is encoded against zero
+        fill(m_prev.begin(), m_prev.end(), 0);
+        m_blockCycle = m_sampler->GetValue(record + 2 * sizeof(struct timeval), 0);
+    }
 
-        gettimeofday(tv_begin, 0);
-        m_sampler->SampleToBuffer(databuf);
-        gettimeofday(tv_end, 0);
+    size_t pos = 0;
+    do
+    {
+        // Most of a sample is usually unchanged, so skip over that a
+        // word at a time.
+        const size_t zstart = pos;
+        for (uint64_t a, b; pos + sizeof a <= m_recordSize; pos += sizeof a)
+        {
+            memcpy(&a, record + pos, sizeof a);
+            memcpy(&b, &m_prev[pos], sizeof b);
+            if (a != b)
+                break;
+        }
+        while (pos < m_recordSize && record[pos] == m_prev[pos])
+            ++pos;
 
-        m_outputfile->write(allbuf, allsz);
+        // A changed run ends at two unchanged bytes, since one
+        // unchanged byte is cheaper to include than a new pair.
+        const size_t lstart = pos;
+        while (pos < m_recordSize &&
+               (record[pos] != m_prev[pos] ||
+                (pos + 1 < m_recordSize && record[pos + 1] != m_prev[pos + 1])))
+            ++pos;
 
-        m_runlock.unlock();
+        putVarint(m_block, lstart - zstart);
+        putVarint(m_block, pos - lstart);
+        for (size_t i = lstart; i < pos; ++i)
+            m_block.push_back(record[i] ^ m_prev[i]);
+    } while (pos < m_recordSize);
+
+    memcpy(m_prev.data(), record, m_recordSize);
+    if (++m_blockRecords == m_blockSize)
+        FlushBlock();
+}
+
+void Monitor::FlushBlock()
+{
+    if (m_blockRecords == 0)
+        return;
+
+    BlockInfo info;
+    info.offset = m_outputfile->tellp();
+    info.first  = m_numRecords;
+    info.cycle  = m_blockCycle;
+    m_index.push_back(info);
+
+    vector<char> header;
+    put<uint32_t>(header, m_blockRecords);
+    put<uint32_t>(header, m_block.size());
+    m_outputfile->write(header.data(), header.size());
+    m_outputfile->write(m_block.data(), m_block.size());
+
+    m_numRecords  += m_blockRecords;
+    m_blockRecords = 0;
+    m_block.clear();
+}
+
+void Monitor::WriteIndex()
+{
+    vector<char> index;
+    const uint64_t offset = m_outputfile->tellp();
+    for (auto& b : m_index)
+    {
+        put<uint64_t>(index, b.offset);
+        put<uint64_t>(index, b.first);
+        put<uint64_t>(index, b.cycle);
     }
+    put<uint64_t>(index, m_index.size());
+    put<uint64_t>(index, offset);
+    index.insert(index.end(), INDEX_MAGIC, INDEX_MAGIC + sizeof INDEX_MAGIC);
+    m_outputfile->write(index.data(), index.size());
 }
@@ -5,31 +5,78 @@
 #include <fstream>
 #include <ctime>
 #include <thread>
-#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
 
 namespace Simulator {
     class MGSystem;
     class BinarySampler;
 }
 
-
+// Samples the monitoring variables at a regular host time interval.
+//
+// The monitor thread requests a snapshot from the kernel, which takes
+// it on the simulation thread at the end of a cycle, so that every
+// sample is consistent. The snapshot is copied into a ring buffer
+// with a single producer (the simulation) and a single consumer (the
+// monitor thread); when the ring is full, the sample is dropped
+// instead of stalling the simulation.
+//
+// The monitor thread writes the samples to the trace file in blocks.
+// Every sample is encoded as the difference (XOR) with the previous
+// sample, with the runs of unchanged bytes left out, and the first
+// sample of a block is encoded against zero, so that every block can
+// be decoded on its own. An index of the blocks at the end of the
+// file allows a decoder to seek to a cycle; see decodetrace(1).
 class Monitor
 {
+    struct BlockInfo
+    {
+        uint64_t offset;        ///< File offset of the block
+        uint64_t first;         ///< Number of its first record
+        uint64_t cycle;         ///< Cycle of its first record
+    };
+
     Simulator::MGSystem&      m_sys;
     std::ofstream*            m_outputfile;
     struct timespec           m_tsdelay;
 
     std::thread*              m_monitorthread;
-    std::mutex                m_runlock;
     Simulator::BinarySampler* m_sampler;
 
     bool                      m_quiet;
-    bool                      m_running;
-    volatile bool             m_enabled;
+    std::atomic<bool>         m_running;
+    std::atomic<bool>         m_enabled;
+
+    // The ring buffer of samples. m_head is only written by the
+    // simulation thread and m_tail only by the monitor thread.
+    size_t                    m_recordSize;   ///< Size of a sample: two timevals and the data
+    std::vector<char>         m_ring;
+    size_t                    m_ringMask;     ///< Number of samples in the ring - 1
+    std::atomic<uint64_t>     m_head;         ///< Next sample to take
+    std::atomic<uint64_t>     m_tail;         ///< Next sample to encode
+    uint64_t                  m_tailCache;    ///< Simulation's copy of m_tail
+    uint64_t                  m_dropped;      ///< Samples dropped because the ring was full
+
+    // The encoder state, only used by the monitor thread
+    size_t                    m_blockSize;    ///< Number of samples per block
+    std::vector<char>         m_prev;         ///< Previous sample in the block
+    std::vector<char>         m_block;        ///< Encoded samples of the current block
+    size_t                    m_blockRecords; ///< Number of samples in m_block
+    uint64_t                  m_blockCycle;   ///< Cycle of the first sample in m_block
+    uint64_t                  m_numRecords;   ///< Samples written so far
+    std::vector<BlockInfo>    m_index;
 
     friend void* runmonitor(void*);
     void run();
 
+    void Snapshot();
+    void Drain();
+    void Encode(const char* record);
+    void FlushBlock();
+    void WriteIndex();
+
 public:
     Monitor(Simulator::MGSystem& sys, bool enable, const std::string& mdfile, const std::string& outfile, bool quiet);
     Monitor(const Monitor&) = delete;
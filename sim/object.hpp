@@ -23,7 +23,7 @@ namespace Simulator
     inline
     bool Object::IsCommitting() const
     {
-        return GetKernel()->GetCyclePhase() == PHASE_COMMIT;
+        return GetKernel()->IsCommitting();
     }
 
 #ifdef STATIC_KERNEL
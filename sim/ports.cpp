@@ -1,5 +1,6 @@
 #include "ports.h"
 #include "sampling.h"
+#include "ctz.h"
 #include <sstream>
 #include <algorithm>
 
@@ -11,18 +12,56 @@ namespace Simulator
     ArbitratedPort::ArbitratedPort(Kernel& k, const string& name)
         : m_name(name),
           m_selected(NULL),
-          m_busyCycles(0)
+          m_busyCycles(0),
+          m_locked(false)
     {
         k.GetVariableRegistry().RegisterVariable(m_busyCycles,
                                                  GetName() + ":busyCycles",
                                                  SVC_CUMULATIVE);
     }
 
+    ProcessSet::ProcessSet()
+        : m_processes(),
+          m_positions(4),
+          m_requests(),
+          m_numRequests(0)
+    {}
+
+    void ProcessSet::Add(const Process& process)
+    {
+        assert(Find(process) == npos);
+        m_positions[(uintptr_t)&process] = m_processes.size();
+        m_processes.push_back(&process);
+        m_requests.resize((m_processes.size() + 31) / 32, 0);
+    }
+
+    size_t ProcessSet::FindRequest(size_t start) const
+    {
+        assert(m_numRequests > 0);
+        if (start >= m_processes.size())
+            start = 0;
+
+        // Scan the words from the one holding start, and end with the
+        // bits before start in that same word.
+        const size_t nwords = m_requests.size();
+        size_t   w    = start / 32;
+        uint32_t bits = m_requests[w] & (~0u << (start % 32));
+        for (size_t i = 0; i < nwords; ++i)
+        {
+            if (bits != 0)
+                return w * 32 + ctz(bits);
+            w    = (w + 1) % nwords;
+            bits = m_requests[w];
+        }
+        assert(bits != 0);
+        return w * 32 + ctz(bits);
+    }
+
     SimpleArbitratedPort::SimpleArbitratedPort(Kernel& k, const string& name)
         : ArbitratedPort(k, name),
           m_processes(),
-          m_requests(),
-          m_lastrequest((CycleNo)-1)
+          m_lastrequest((CycleNo)-1),
+          m_selectedPos(ProcessSet::npos)
     {
         k.GetVariableRegistry().RegisterVariable(m_lastrequest,
                                                  GetName() + ":lastrequest",
@@ -31,28 +70,8 @@ namespace Simulator
 
     void SimpleArbitratedPort::AddProcess(const Process& process)
     {
-        assert(find(m_processes.begin(),
-                    m_processes.end(),
-                    &process) == m_processes.end());
-        m_processes.push_back(&process);
-    }
-
-    void SimpleArbitratedPort::AddRequest(const Process& process, CycleNo c)
-    {
-        if (find(m_requests.begin(),
-                 m_requests.end(),
-                 &process) != m_requests.end())
-        {
-            // A process can request more than once in an arbitrator cycle
-            // if the requester is in a higher frequency domain than the
-            // arbitrator.
-            // However the same process cannot request more than once
-            // in the same cycle.
-            assert(c != m_lastrequest);
-            return;
-        }
-        m_requests.push_back(&process);
-        m_lastrequest = c;
+        assert(!CanAccess(process));
+        m_processes.Add(process);
     }
 
     PriorityArbitratedPort::PriorityArbitratedPort(Kernel& k,
@@ -65,30 +84,12 @@ namespace Simulator
     void PriorityArbitratedPort::Arbitrate()
     {
         SetSelectedProcess(NULL);
-        if (m_requests.empty()) return;
+        if (!m_processes.HasRequests()) return;
 
-        if (m_requests.size() == 1)
-        {
-            // Optimization for common case
-            SetSelectedProcess(*m_requests.begin());
-        }
-        else
-        {
-            // Choose the request with the highest priority
-            auto min = m_processes.size();
-            for (auto i : m_requests)
-            {
-                // The position in the vector is its priority
-                size_t priority = find(m_processes.begin(), m_processes.end(), i) - m_processes.begin();
-                if (priority < min)
-                {
-                    min = priority;
-                    SetSelectedProcess(i);
-                }
-            }
-        }
-        assert(GetSelectedProcess() != NULL);
-        m_requests.clear();
+        // The position in the set is its priority
+        Select(m_processes.FindRequest());
+
+        m_processes.ClearRequests();
         MarkBusy();
     }
 
@@ -108,43 +109,14 @@ namespace Simulator
         assert(m_lastSelected < m_processes.size());
 
         SetSelectedProcess(NULL);
-        if (m_requests.empty()) return;
+        if (!m_processes.HasRequests()) return;
 
-        if (m_requests.size() == 1)
-        {
-            SetSelectedProcess(*m_requests.begin());
-            m_lastSelected = find(m_processes.begin(),
-                                  m_processes.end(),
-                                  GetSelectedProcess()) - m_processes.begin();
-        }
-        else
-        {
-            auto sz = m_processes.size();
-            auto min = sz;
-            for (auto i : m_requests)
-            {
-                // pos = position of the requesting process in the
-                // list of all processes.
-                auto pos = find(m_processes.begin(),
-                                m_processes.end(),
-                                i) - m_processes.begin();
+        // Select the first requesting process after the last
+        // selected, which itself only comes last.
+        m_lastSelected = m_processes.FindRequest(m_lastSelected + 1);
+        Select(m_lastSelected);
 
-                // Compute the distance between the requesting process
-                // and the last selected.
-                auto d = (pos + sz - m_lastSelected) % sz;
-                if (d != 0 && d < min)
-                {
-                    // Different process, shortest distance, select
-                    // this one.
-                    min = d;
-                    SetSelectedProcess(i);
-                }
-            }
-            // Remember which one we selected
-            m_lastSelected = (m_lastSelected + min) % sz;
-        }
-        assert(GetSelectedProcess() != NULL);
-        m_requests.clear();
+        m_processes.ClearRequests();
         MarkBusy();
     }
 
@@ -157,73 +129,26 @@ namespace Simulator
     void PriorityCyclicArbitratedPort::Arbitrate()
     {
         SetSelectedProcess(NULL);
-        if (m_requests.empty()) return;
-
-        if (m_requests.size() == 1)
+        if (m_processes.HasRequests())
         {
-            // Optimization for common case
-            SetSelectedProcess(*m_requests.begin());
-
-            // If we just selected a cyclic process, remember it for
-            // the next round of cyclic arbitration.
-            size_t maybe_cyclic_last = find(m_cyclicprocesses.begin(),
-                                            m_cyclicprocesses.end(),
-                                            GetSelectedProcess()) - m_cyclicprocesses.begin();
-            if (maybe_cyclic_last < m_cyclicprocesses.size())
-                m_lastSelected = maybe_cyclic_last;
+            // The priority processes go first.
+            Select(m_processes.FindRequest());
+        }
+        else if (m_cyclicprocesses.HasRequests())
+        {
+            // No priority process, the request is for a cyclic
+            // process. Remember which one we selected for the next
+            // round of cyclic arbitration.
+            m_lastSelected = m_cyclicprocesses.FindRequest(m_lastSelected + 1);
+            SetSelectedProcess(m_cyclicprocesses[m_lastSelected]);
         }
         else
         {
-            // First try to select using priorities.
-            auto sz = m_processes.size();
-            auto min = sz;
-            for (auto i : m_requests)
-            {
-                // The position in the vector is its priority
-                size_t priority = find(m_processes.begin(), m_processes.end(), i) - m_processes.begin();
-                if (priority == sz)
-                {
-                    // this request is for a cyclic process, don't use
-                    // it as a candidate.
-                    continue;
-                }
-                if (priority < min)
-                {
-                    min = priority;
-                    SetSelectedProcess(i);
-                }
-            }
-
-            if (min == sz)
-            {
-                // no priority process found, the request is for a
-                // cyclic process.
-                min = sz = m_cyclicprocesses.size();
-                for (auto i : m_requests)
-                {
-                    // pos = position of the requesting process in the
-                    // list of all processes.
-                    auto pos = find(m_cyclicprocesses.begin(),
-                                    m_cyclicprocesses.end(),
-                                    i) - m_cyclicprocesses.begin();
-
-                    // Find the distance between the requesting process
-                    // and the last selected
-                    auto d = (pos + sz - m_lastSelected) % sz;
-                    if (d != 0 && d < min)
-                    {
-                        // Different process, shortest distance,
-                        // select this one.
-                        min = d;
-                        SetSelectedProcess(i);
-                    }
-                }
-                // Remember which one we selected
-                m_lastSelected = (m_lastSelected + min) % sz;
-            }
+            return;
         }
-        assert(GetSelectedProcess() != NULL);
-        m_requests.clear();
+
+        m_processes.ClearRequests();
+        m_cyclicprocesses.ClearRequests();
         MarkBusy();
     }
 
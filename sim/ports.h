@@ -3,11 +3,12 @@
 #define PORTS_H
 
 #include "kernel.h"
+#include "flatmap.h"
 #include <cassert>
 #include <algorithm>
-#include <map>
 #include <set>
 #include <limits>
+#include <vector>
 
 namespace Simulator
 {
@@ -35,7 +36,31 @@ namespace Simulator
         // The number of cycles the arbitrator was actively arbitrating
         uint64_t       m_busyCycles;
 
+        // Held while a request is added, when the processes run on
+        // several host threads (cf Kernel::SetNumThreads).
+        std::atomic<bool> m_locked;
+
     protected:
+        // Serializes the requests to the port in the acquire phase.
+        class RequestLock
+        {
+            std::atomic<bool>* m_locked;
+        public:
+            RequestLock(ArbitratedPort& port, const Kernel& kernel)
+                : m_locked(kernel.IsParallel() ? &port.m_locked : NULL)
+            {
+                if (m_locked != NULL)
+                    while (m_locked->exchange(true, std::memory_order_acquire)) {}
+            }
+            ~RequestLock()
+            {
+                if (m_locked != NULL)
+                    m_locked->store(false, std::memory_order_release);
+            }
+            RequestLock(const RequestLock&) = delete;
+            RequestLock& operator=(const RequestLock&) = delete;
+        };
+
         // Accessors for m_selected (the process that acquires the port)
         const Process* GetSelectedProcess() const { return m_selected; }
         void SetSelectedProcess(const Process* p) { m_selected = p; }
@@ -62,6 +87,72 @@ namespace Simulator
         const std::string& GetName() const { return m_name; }
     };
 
+    //
+    // ProcessSet: the processes that may access a port, numbered in
+    // the order in which they were added, with a bit mask of those
+    // that requested access within this cycle.
+    //
+    // The position of every process is looked up in a hash table,
+    // and the requests are found back with a scan of the mask, so
+    // arbitration does not search lists or allocate memory.
+    class ProcessSet
+    {
+        std::vector<const Process*>    m_processes;  // In order of addition
+        FlatMap<uintptr_t, size_t>     m_positions;  // Process -> position
+        std::vector<uint32_t>          m_requests;   // Bit per position
+        size_t                         m_numRequests;
+
+    public:
+        static const size_t npos = (size_t)-1;
+
+        // Add a process; it gets the next position.
+        void Add(const Process& process);
+
+        // Returns the position of a process, or npos.
+        size_t Find(const Process& process) const
+        {
+            auto p = m_positions.find((uintptr_t)&process);
+            return (p == m_positions.end()) ? npos : p->second;
+        }
+
+        size_t         size() const { return m_processes.size(); }
+        const Process* operator[](size_t pos) const { return m_processes[pos]; }
+
+        // Mark the process at a position as requesting. Returns false
+        // if it already was.
+        bool Request(size_t pos)
+        {
+            assert(pos < m_processes.size());
+            uint32_t& w = m_requests[pos / 32];
+            const uint32_t bit = 1u << (pos % 32);
+            if (w & bit)
+                return false;
+            w |= bit;
+            ++m_numRequests;
+            return true;
+        }
+
+        bool   HasRequests() const { return m_numRequests != 0; }
+        size_t GetNumRequests() const { return m_numRequests; }
+
+        // Returns the first requesting position at or after start,
+        // wrapping around to the beginning. There must be a request.
+        size_t FindRequest(size_t start = 0) const;
+
+        void ClearRequests()
+        {
+            if (m_numRequests != 0)
+            {
+                std::fill(m_requests.begin(), m_requests.end(), 0);
+                m_numRequests = 0;
+            }
+        }
+
+        ProcessSet();
+        ProcessSet(const ProcessSet&) = delete;
+        ProcessSet& operator=(const ProcessSet&) = delete;
+    };
+
     //
     // SimpleArbitratedPort: simple base class for ports using a
     // simple list of processes.
@@ -73,18 +164,16 @@ namespace Simulator
     class SimpleArbitratedPort : public ArbitratedPort
     {
     protected:
-        typedef std::vector<const Process*> ProcessList;
-
-        // The list of all processes that *may* access the port.
-        ProcessList    m_processes;
-
-        // The list of all processes that have requested access within
-        // this cycle.
-        ProcessList    m_requests;
+        // The set of all processes that *may* access the port, with
+        // those that have requested access within this cycle.
+        ProcessSet     m_processes;
 
         // The last cycle counter of a request.
         CycleNo        m_lastrequest;
 
+        // The position of the selected process in m_processes.
+        size_t         m_selectedPos;
+
     public:
         // Register a process that may access the port.
         void AddProcess(const Process& process);
@@ -93,14 +182,40 @@ namespace Simulator
         // Test if a process may access the port.
         bool CanAccess(const Process& process) const
         {
-            return std::find(m_processes.begin(),
-                             m_processes.end(),
-                             &process) != m_processes.end();
+            return m_processes.Find(process) != ProcessSet::npos;
         }
 
         // Register a process as wanting to access the port (candidate for
-        // arbitration).
-        void AddRequest(const Process& process, CycleNo c);
+        // arbitration). Returns the position of the process.
+        size_t AddRequest(const Process& process, CycleNo c)
+        {
+            const size_t pos = m_processes.Find(process);
+            AddRequest(m_processes, pos, c);
+            return pos;
+        }
+
+        // Register the request of the process at a position in a set.
+        void AddRequest(ProcessSet& set, size_t pos, CycleNo c)
+        {
+            if (!set.Request(pos))
+            {
+                // A process can request more than once in an arbitrator cycle
+                // if the requester is in a higher frequency domain than the
+                // arbitrator.
+                // However the same process cannot request more than once
+                // in the same cycle.
+                assert(c != m_lastrequest);
+                return;
+            }
+            m_lastrequest = c;
+        }
+
+        // Give the port to the process at a position in m_processes.
+        void Select(size_t pos)
+        {
+            m_selectedPos = pos;
+            SetSelectedProcess(m_processes[pos]);
+        }
 
         // Constructor, destructor etc.
         SimpleArbitratedPort(Kernel&, const std::string& name);
@@ -176,14 +291,22 @@ namespace Simulator
     {
     protected:
         // The set of cyclic processes (that have lowest priority)
-        ProcessList m_cyclicprocesses;
+        ProcessSet m_cyclicprocesses;
 
         // Test if a process may access the port.
         bool CanAccess(const Process& process) const {
             return SimpleArbitratedPort::CanAccess(process)
-                || (std::find(m_cyclicprocesses.begin(),
-                              m_cyclicprocesses.end(),
-                              &process) != m_cyclicprocesses.end());
+                || m_cyclicprocesses.Find(process) != ProcessSet::npos;
+        }
+
+        // Register a process as wanting to access the port.
+        void AddRequest(const Process& process, CycleNo c)
+        {
+            const size_t pos = m_processes.Find(process);
+            if (pos != ProcessSet::npos)
+                SimpleArbitratedPort::AddRequest(m_processes, pos, c);
+            else
+                SimpleArbitratedPort::AddRequest(m_cyclicprocesses, m_cyclicprocesses.Find(process), c);
         }
 
     private:
@@ -199,7 +322,8 @@ namespace Simulator
             SimpleArbitratedPort::AddProcess(process);
         }
         void AddCyclicProcess(const Process& process) {
-            m_cyclicprocesses.push_back(&process);
+            assert(m_cyclicprocesses.Find(process) == ProcessSet::npos);
+            m_cyclicprocesses.Add(process);
         }
 
     protected:
@@ -242,6 +366,7 @@ namespace Simulator
 
             if (kernel.GetCyclePhase() == PHASE_ACQUIRE)
             {
+                typename Base::RequestLock lock(*this, kernel);
                 Base::AddRequest(process, kernel.GetCycleNo());
                 Arbitrator::RequestArbitration();
                 return true;
@@ -388,6 +513,25 @@ namespace Simulator
         // The order is set by AddPort below.
         WritePortList           m_priorities;
 
+        // All write ports in the order in which they are arbitrated:
+        // the ports in m_priorities, followed by the ports without a
+        // priority, which never win.
+        WritePortList           m_order;
+
+        // The requests of the current cycle, with whether they are
+        // chosen. Reserved for all ports, so this does not allocate.
+        std::vector<std::pair<WritePort<I>*, bool> > m_pending;
+
+        // Set m_order after a change to the ports or their priorities.
+        void UpdateOrder()
+        {
+            m_order = m_priorities;
+            for (auto p : m_writePorts)
+                if (std::find(m_priorities.begin(), m_priorities.end(), p) == m_priorities.end())
+                    m_order.push_back(p);
+            m_pending.reserve(m_writePorts.size());
+        }
+
     protected:
         // Perform process arbitration of all arbitrated write ports.
         // The result of this gives access to each port to only 1 process.
@@ -400,46 +544,37 @@ namespace Simulator
         // Required by Arbitrator
         void OnArbitrate() override
         {
-            typedef std::map<I, std::vector<WritePort<I>*> > RequestPortMap;
-
             // Tell each port to arbitrate.
             // The result is at most 1 process remaining per port.
             ArbitrateReadPorts();
             ArbitrateWritePorts();
 
-            // Get the final requests from all ports
-            // Mapping of index -> list of ports requesting that index
-            RequestPortMap requests;
-            for (auto p : m_writePorts)
+            // Get the final requests from all ports, in priority order.
+            // A port is chosen if it has a priority and no port before
+            // it requests the same index.
+            m_pending.clear();
+            for (size_t i = 0; i < m_order.size(); ++i)
             {
-                const I* i = p->GetIndex();
-                if (i != NULL)
-                    requests[*i].push_back(p);
-            }
+                WritePort<I>* p = m_order[i];
+                const I* index = p->GetIndex();
+                if (index == NULL)
+                    continue;
 
-            // Arbitrate between the ports for each request
-            for (auto& req : requests)
-            {
-                const WritePort<I>* selected = NULL;
-
-                // Find the port earliest in the list.
-                auto sz = m_priorities.size();
-                auto min = sz;
-                for (auto p : req.second)
+                bool chosen = (i < m_priorities.size());
+                for (auto& q : m_pending)
                 {
-                    size_t prio = std::find(m_priorities.begin(),
-                                            m_priorities.end(),
-                                            p) - m_priorities.begin();
-                    if (prio < min)
+                    if (*q.first->GetIndex() == *index)
                     {
-                        min = prio;
-                        selected = p;
+                        chosen = false;
+                        break;
                     }
                 }
-                // Report the selection to every port.
-                for (auto p : req.second)
-                    p->Notify( selected == p );
+                m_pending.push_back(std::make_pair(p, chosen));
             }
+
+            // Report the selection to every port.
+            for (auto& q : m_pending)
+                q.first->Notify(q.second);
         }
 
 
@@ -452,6 +587,7 @@ namespace Simulator
                              m_writePorts.end(),
                              &port) == m_writePorts.end());
             m_writePorts.push_back(&port);
+            UpdateOrder();
         }
 
         // Register an arbitrated write port.
@@ -475,6 +611,7 @@ namespace Simulator
                              &port) == m_priorities.end());
 
             m_priorities.push_back(&port);
+            UpdateOrder();
         }
 
         // Constructor, destructor etc.
@@ -483,7 +620,9 @@ namespace Simulator
               ReadOnlyStructure(name, parent, clock),
               m_writePorts(),
               m_arbitratedWritePorts(),
-              m_priorities()
+              m_priorities(),
+              m_order(),
+              m_pending()
         {}
         virtual ~ReadWriteStructure() {}
         ReadWriteStructure(const ReadWriteStructure&) = delete;
@@ -514,6 +653,7 @@ namespace Simulator
             if (kernel->GetCyclePhase() == PHASE_ACQUIRE)
             {
                 // In the first phase, register the request.
+                RequestLock lock(*this, *kernel);
                 AddRequest(process, kernel->GetCycleNo());
                 m_structure.RequestArbitration();
                 return true;
@@ -541,18 +681,18 @@ namespace Simulator
         : public PriorityArbitratedPort,
           public WritePort<I>
     {
-        typedef std::map<const Process*, I> IndexMap;
-
         ReadWriteStructure<I>& m_structure;
-        IndexMap               m_indices;
+        std::vector<I>         m_indices;    // Requested index per process position
 
     protected:
         // Register a request to access the structure for
         // write.
         void AddRequest(const Process& process, const I& index, CycleNo c)
         {
-            PriorityArbitratedPort::AddRequest(process, c);
-            m_indices[&process] = index;
+            const size_t pos = PriorityArbitratedPort::AddRequest(process, c);
+            if (pos >= m_indices.size())
+                m_indices.resize(m_processes.size());
+            m_indices[pos] = index;
         }
 
     public:
@@ -570,6 +710,7 @@ namespace Simulator
             if (kernel->GetCyclePhase() == PHASE_ACQUIRE)
             {
                 // In the first phase, register the request.
+                RequestLock lock(*this, *kernel);
                 AddRequest(process, index, kernel->GetCycleNo());
                 m_structure.RequestArbitration();
                 return true;
@@ -584,14 +725,12 @@ namespace Simulator
         void Arbitrate()
         {
             PriorityArbitratedPort::Arbitrate();
-            auto process = GetSelectedProcess();
-            if (process != NULL)
+            if (GetSelectedProcess() != NULL)
             {
                 // A process was selected; make its index active for
                 // write port arbitration
-                auto p = m_indices.find(process);
-                assert(p != m_indices.end());
-                WritePort<I>::SetRequestIndex(p->second);
+                assert(m_selectedPos < m_indices.size());
+                WritePort<I>::SetRequestIndex(m_indices[m_selectedPos]);
             }
         }
 
@@ -4,8 +4,8 @@
 
 namespace Simulator
 {
-    static std::string&& renameProcess(std::string cname,
-                                       const std::string& pname)
+    static std::string renameProcess(std::string cname,
+                                     const std::string& pname)
     {
         assert(pname.size() > 0);
         size_t i = 0;
@@ -24,7 +24,7 @@ namespace Simulator
             else
                 cname += pname[i];
         }
-        return std::move(cname);
+        return cname;
     }
 
 
@@ -35,7 +35,14 @@ namespace Simulator
           m_activations(0),
           m_next(0),
           m_pPrev(0),
-          m_stalls(0)
+          m_stalls(0),
+          m_wakeup(0),
+          m_clock(0),
+          m_wheelNext(0),
+          m_wheelPrev(0),
+          m_profile(),
+          m_group(parent.GetKernel()->GetProcessGroup(parent)),
+          m_failsFirst(false)
 #if !defined(NDEBUG) && !defined(DISABLE_TRACE_CHECKS)
         , m_storages(),
           m_currentStorages()
@@ -52,6 +52,7 @@ namespace Simulator
     {
         friend class Kernel;
         friend class Clock;
+        friend class TimingWheel;
 
         const std::string m_name;          ///< The fully qualified name of this process
         const delegate    m_delegate;      ///< The callback for the execution of the process
@@ -62,6 +63,14 @@ namespace Simulator
 
         uint64_t          m_stalls;        ///< Number of times the process stalled (failed).
 
+        CycleNo           m_wakeup;        ///< Master cycle at which the sleeping process resumes, 0 if awake.
+        Clock*            m_clock;         ///< Clock to resume the sleeping process on.
+        Process*          m_wheelNext;     ///< Next pointer in the timing wheel slot
+        Process**         m_wheelPrev;     ///< Prev pointer in the timing wheel slot
+        ProfileCounter    m_profile;       ///< Host time spent in the process, when profiling.
+        size_t            m_group;         ///< Top-level component of the process, cf Kernel::SetNumThreads().
+        bool              m_failsFirst;    ///< Does the process commit in a single pass? cf SetFailsFirst().
+
 #if !defined(NDEBUG) && !defined(DISABLE_TRACE_CHECKS)
         StorageTraceSet   m_storages;         ///< Set of storage traces this process can have
         StorageTrace      m_currentStorages;  ///< Storage trace for this cycle
@@ -79,11 +88,20 @@ namespace Simulator
         const Process* GetNext() const { return m_next;  }
         RunState GetState() const { return m_state; }
         const std::string& GetName() const { return m_name; }
+        bool IsSleeping() const { return m_wakeup != 0; }
+        CycleNo GetWakeupCycle() const { return m_wakeup; }
 
         // Deactivate a process from receiving invocations from its
         // clock. Used by storages (cf storage.h) when they become empty.
         void Deactivate();
 
+        // Declare that the process fails first: it returns FAILED, if
+        // at all, before it runs any COMMIT code, directly or through
+        // the storages, ports and components that it calls. The kernel
+        // then runs its commit without the check, as a failed commit
+        // does the same as a failed check. Debug builds assert this.
+        void SetFailsFirst() { m_failsFirst = true; }
+
         // The following functions are for verification of storage accesses.
         // They check that the process does not violate its contract for
         // accessing storages. The contract is set up when the system is created.
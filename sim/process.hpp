@@ -21,6 +21,11 @@ namespace Simulator
             if (m_next != NULL) {
                 m_next->m_pPrev = m_pPrev;
             }
+
+            if (m_wakeup != 0) {
+                // It has nothing left to wake up for
+                m_clock->GetKernel().CancelSleep(*this);
+            }
             m_state = STATE_IDLE;
         }
     }
@@ -0,0 +1,129 @@
+#include "sim/profile.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <fnmatch.h>
+
+using namespace std;
+
+namespace Simulator
+{
+    // Splits a process, storage or arbitrator name into its component
+    // path, e.g. "cpu0.pipeline:pipeline" into cpu0, pipeline, pipeline.
+    static vector<string> SplitName(const string& name)
+    {
+        vector<string> path;
+        size_t start = 0;
+        for (size_t i = 0; i <= name.size(); ++i)
+        {
+            if (i == name.size() || name[i] == '.' || name[i] == ':')
+            {
+                path.push_back(name.substr(start, i - start));
+                start = i + 1;
+            }
+        }
+        return path;
+    }
+
+    static const char* GetKindName(ProfileEntry::Kind kind)
+    {
+        switch (kind)
+        {
+        case ProfileEntry::PROCESS:    return "process";
+        case ProfileEntry::STORAGE:    return "update";
+        case ProfileEntry::ARBITRATOR: return "arbitrate";
+        case ProfileEntry::KERNEL:     return "kernel";
+        case ProfileEntry::COMPONENT:  return "component";
+        }
+        return "";
+    }
+
+    void Profile::Print(ostream& os, const string& pattern, size_t depth) const
+    {
+        vector<ProfileEntry> lines;
+        if (depth == 0)
+        {
+            for (auto& e : entries)
+            {
+                if (FNM_NOMATCH != fnmatch(pattern.c_str(), e.name.c_str(), 0))
+                    lines.push_back(e);
+            }
+        }
+        else
+        {
+            // Add up the entries per component
+            map<string, ProfileEntry> groups;
+            for (auto& e : entries)
+            {
+                if (FNM_NOMATCH == fnmatch(pattern.c_str(), e.name.c_str(), 0))
+                    continue;
+
+                const vector<string> path = SplitName(e.name);
+                string key;
+                for (size_t i = 0; i < path.size() && i < depth; ++i)
+                    key += (i > 0 ? "." : "") + path[i];
+
+                auto g = groups.find(key);
+                if (g == groups.end())
+                {
+                    ProfileEntry& n = groups[key];
+                    n.name    = key;
+                    n.kind    = (path.size() > depth) ? ProfileEntry::COMPONENT : e.kind;
+                    n.counter = e.counter;
+                }
+                else
+                {
+                    g->second.kind = ProfileEntry::COMPONENT;
+                    g->second.counter.ticks += e.counter.ticks;
+                    g->second.counter.calls += e.counter.calls;
+                }
+            }
+            for (auto& g : groups)
+                lines.push_back(g.second);
+        }
+
+        sort(lines.begin(), lines.end(), [](const ProfileEntry& a, const ProfileEntry& b) {
+                return a.counter.ticks > b.counter.ticks;
+            });
+
+        os << "Host time in the simulation kernel: " << fixed << setprecision(3)
+           << total / ticksPerSecond << " s" << endl << endl
+           << "      time(s)      %         calls   ns/call  type       name" << endl;
+        for (auto& l : lines)
+        {
+            const double secs = l.counter.ticks / ticksPerSecond;
+            os << setw(13) << setprecision(6) << secs
+               << setw(7) << setprecision(2) << (total > 0 ? 100.0 * l.counter.ticks / total : 0.0)
+               << setw(14) << l.counter.calls
+               << setw(10) << setprecision(1)
+               << (l.counter.calls > 0 ? secs * 1e9 / l.counter.calls : 0.0)
+               << "  " << setw(9) << left << GetKindName(l.kind)
+               << right << "  " << l.name << endl;
+        }
+        os.unsetf(ios::floatfield);
+    }
+
+    void Profile::WriteFolded(ostream& os) const
+    {
+        for (auto& e : entries)
+        {
+            const uint64_t ns = (uint64_t)(e.counter.ticks * 1e9 / ticksPerSecond);
+            if (ns == 0)
+                continue;
+
+            const vector<string> path = SplitName(e.name);
+            for (size_t i = 0; i < path.size(); ++i)
+            {
+                os << (i > 0 ? ";" : "") << path[i];
+            }
+            if (e.kind == ProfileEntry::STORAGE || e.kind == ProfileEntry::ARBITRATOR)
+            {
+                os << '(' << GetKindName(e.kind) << ')';
+            }
+            os << ' ' << ns << endl;
+        }
+    }
+
+}
@@ -0,0 +1,84 @@
+// -*- c++ -*-
+#ifndef SIM_PROFILE_H
+#define SIM_PROFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace Simulator
+{
+    /// Returns a timestamp from the host's cycle counter, or in
+    /// nanoseconds if the host has no usable cycle counter.
+    inline uint64_t ReadHostTicks()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /// Host time spent in a simulation callback.
+    struct ProfileCounter
+    {
+        uint64_t ticks;     ///< Host ticks spent in the callback.
+        uint64_t calls;     ///< Number of times the callback was run.
+
+        ProfileCounter() : ticks(0), calls(0) {}
+    };
+
+    /// The host time spent in one process, storage or arbitrator.
+    struct ProfileEntry
+    {
+        enum Kind {
+            PROCESS,        ///< Process::m_delegate
+            STORAGE,        ///< Storage::Update
+            ARBITRATOR,     ///< Arbitrator::OnArbitrate
+            KERNEL,         ///< Everything else in Kernel::Step
+            COMPONENT,      ///< The sum of the entries of a component
+        };
+
+        std::string    name;
+        Kind           kind;
+        ProfileCounter counter;
+
+        ProfileEntry() : name(), kind(PROCESS), counter() {}
+        ProfileEntry(const std::string& n, Kind k, const ProfileCounter& c) : name(n), kind(k), counter(c) {}
+    };
+
+    /// A host time profile of the simulation.
+    struct Profile
+    {
+        std::vector<ProfileEntry> entries;
+        uint64_t                  total;            ///< Host ticks spent in Kernel::Step.
+        double                    ticksPerSecond;   ///< Rate of the host ticks.
+
+        Profile() : entries(), total(0), ticksPerSecond(1e9) {}
+
+        /**
+         * @brief Print the entries that match a pattern, most expensive first.
+         * @param depth if non-zero, add up the entries per component at
+         * this depth of the component hierarchy.
+         */
+        void Print(std::ostream& os, const std::string& pattern, size_t depth) const;
+
+        /**
+         * @brief Write the profile as folded stacks for flame graphs.
+         * Each line is the component path of an entry, separated by
+         * semicolons, followed by the time in nanoseconds.
+         */
+        void WriteFolded(std::ostream& os) const;
+    };
+
+}
+
+#endif
@@ -26,7 +26,8 @@ namespace Simulator
 
 #define RegisterStateObject(LValue, Name) \
     RegisterSampleVariableInObjectWithName(&(LValue), Name, SVC_STATE, Serialization::SV_OTHER, 0, 0, \
-                                           &Serialization::serializer<StreamSerializer, typename std::remove_reference<decltype(LValue)>::type>)
+                                           &Serialization::serializer<StreamSerializer, typename std::remove_reference<decltype(LValue)>::type>, \
+                                           &Serialization::serializer<BinarySerializer, typename std::remove_reference<decltype(LValue)>::type>)
 
 #define RegisterStateArray(LValue, Size, Name) \
     RegisterSampleVariableInObjectWithName(LValue, Name, SVC_STATE, Size)
@@ -0,0 +1,179 @@
+// -*- c++ -*-
+#ifndef SIM_RINGBUFFER_H
+#define SIM_RINGBUFFER_H
+
+#include "sim/serialization.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Simulator
+{
+    /// A FIFO container stored in a contiguous circular array whose
+    /// capacity is a power of two. Items are only allocated when the
+    /// capacity is exceeded, which never happens for users that
+    /// bound the size up front. The interface is a subset of
+    /// std::deque.
+    template <typename T>
+    class RingBuffer
+    {
+        typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+
+        Slot*  m_slots;  ///< The storage, m_mask + 1 slots
+        size_t m_mask;   ///< Capacity - 1
+        size_t m_head;   ///< Slot of the first item
+        size_t m_size;   ///< Number of items
+
+        T&       slot(size_t i)       { return *reinterpret_cast<T*>(&m_slots[(m_head + i) & m_mask]); }
+        const T& slot(size_t i) const { return *reinterpret_cast<const T*>(&m_slots[(m_head + i) & m_mask]); }
+
+        void grow(size_t capacity)
+        {
+            size_t n = 1;
+            while (n < capacity)
+                n *= 2;
+
+            Slot* slots = new Slot[n];
+            for (size_t i = 0; i < m_size; ++i)
+            {
+                new (&slots[i]) T(std::move(slot(i)));
+                slot(i).~T();
+            }
+            delete[] m_slots;
+            m_slots = slots;
+            m_mask  = n - 1;
+            m_head  = 0;
+        }
+
+        // Random-access iterator over the items, from front to back.
+        template <typename R, typename V>
+        class basic_iterator
+        {
+            friend class RingBuffer;
+            R*     m_ring;
+            size_t m_index;
+            basic_iterator(R* ring, size_t index) : m_ring(ring), m_index(index) {}
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef typename std::remove_const<V>::type value_type;
+            typedef ptrdiff_t difference_type;
+            typedef V* pointer;
+            typedef V& reference;
+
+            basic_iterator() : m_ring(NULL), m_index(0) {}
+            // Allow conversion from iterator to const_iterator
+            template <typename R2, typename V2>
+            basic_iterator(const basic_iterator<R2, V2>& o) : m_ring(o.m_ring), m_index(o.m_index) {}
+
+            V& operator*()  const { return m_ring->slot(m_index); }
+            V* operator->() const { return &m_ring->slot(m_index); }
+            V& operator[](ptrdiff_t n) const { return m_ring->slot(m_index + n); }
+
+            basic_iterator& operator++() { ++m_index; return *this; }
+            basic_iterator& operator--() { --m_index; return *this; }
+            basic_iterator  operator++(int) { basic_iterator t(*this); ++m_index; return t; }
+            basic_iterator  operator--(int) { basic_iterator t(*this); --m_index; return t; }
+            basic_iterator& operator+=(ptrdiff_t n) { m_index += n; return *this; }
+            basic_iterator& operator-=(ptrdiff_t n) { m_index -= n; return *this; }
+            basic_iterator  operator+(ptrdiff_t n) const { return basic_iterator(m_ring, m_index + n); }
+            basic_iterator  operator-(ptrdiff_t n) const { return basic_iterator(m_ring, m_index - n); }
+            ptrdiff_t operator-(const basic_iterator& o) const { return (ptrdiff_t)(m_index - o.m_index); }
+
+            bool operator==(const basic_iterator& o) const { return m_index == o.m_index; }
+            bool operator!=(const basic_iterator& o) const { return m_index != o.m_index; }
+            bool operator< (const basic_iterator& o) const { return m_index <  o.m_index; }
+            bool operator> (const basic_iterator& o) const { return m_index >  o.m_index; }
+            bool operator<=(const basic_iterator& o) const { return m_index <= o.m_index; }
+            bool operator>=(const basic_iterator& o) const { return m_index >= o.m_index; }
+
+            template <typename R2, typename V2> friend class basic_iterator;
+        };
+
+    public:
+        typedef T                                                value_type;
+        typedef basic_iterator<RingBuffer, T>                    iterator;
+        typedef basic_iterator<const RingBuffer, const T>        const_iterator;
+        typedef std::reverse_iterator<iterator>                  reverse_iterator;
+        typedef std::reverse_iterator<const_iterator>            const_reverse_iterator;
+
+        bool   empty()    const { return m_size == 0; }
+        size_t size()     const { return m_size; }
+        size_t capacity() const { return m_mask + 1; }
+
+        T&       front()       { assert(m_size > 0); return slot(0); }
+        const T& front() const { assert(m_size > 0); return slot(0); }
+        T&       back()        { assert(m_size > 0); return slot(m_size - 1); }
+        const T& back()  const { assert(m_size > 0); return slot(m_size - 1); }
+
+        void push_back(T&& item)
+        {
+            if (m_size > m_mask)
+                grow(2 * capacity());
+            new (&slot(m_size)) T(std::move(item));
+            ++m_size;
+        }
+
+        void push_back(const T& item) { push_back(T(item)); }
+
+        void pop_front()
+        {
+            assert(m_size > 0);
+            slot(0).~T();
+            m_head = (m_head + 1) & m_mask;
+            --m_size;
+        }
+
+        // Resizes the buffer at the back, like std::deque::resize.
+        void resize(size_t size)
+        {
+            if (size > capacity())
+                grow(size);
+            for (; m_size < size; ++m_size)
+                new (&slot(m_size)) T();
+            while (m_size > size)
+                slot(--m_size).~T();
+        }
+
+        void clear() { resize(0); }
+
+        iterator               begin()        { return iterator(this, 0); }
+        iterator               end()          { return iterator(this, m_size); }
+        const_iterator         begin()  const { return const_iterator(this, 0); }
+        const_iterator         end()    const { return const_iterator(this, m_size); }
+        reverse_iterator       rbegin()       { return reverse_iterator(end()); }
+        reverse_iterator       rend()         { return reverse_iterator(begin()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend()   const { return const_reverse_iterator(begin()); }
+
+        // Constructs an empty buffer that can hold at least capacity
+        // items before it has to allocate.
+        explicit RingBuffer(size_t capacity = 16)
+            : m_slots(NULL), m_mask(0), m_head(0), m_size(0)
+        {
+            grow(capacity > 0 ? capacity : 1);
+        }
+
+        ~RingBuffer()
+        {
+            clear();
+            delete[] m_slots;
+        }
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+    };
+
+    namespace Serialization
+    {
+        // A ring buffer is serialized like a std::deque.
+        template<typename T>
+        struct serialize_trait<RingBuffer<T> >
+            : public container_serializer<RingBuffer<T>, 'q'> {};
+    }
+}
+
+#endif
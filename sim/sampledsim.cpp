@@ -0,0 +1,247 @@
+#include "sim/sampledsim.h"
+#include "sim/config.h"
+#include "arch/MGSystem.h"
+#include "arch/Memory.h"
+
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+using namespace Simulator;
+
+// The two-sided 95% quantile of the normal distribution
+static const double Z95 = 1.96;
+
+SampledSimulation::Quantity::Quantity(const VariableRegistry& registry, const string& pat)
+    : pattern(pat), cat(SVC_LEVEL), sampler(registry), buffer(), start(0), values()
+{
+    sampler.SelectVariables(vector<string>(1, pattern));
+    if (sampler.GetNumVariables() == 0)
+    {
+        throw exceptf<>("No variables match the sampling pattern %s", pattern.c_str());
+    }
+
+    cat = sampler.GetCategory(0);
+    for (size_t i = 1; i < sampler.GetNumVariables(); ++i)
+    {
+        if (sampler.GetCategory(i) != cat)
+        {
+            throw exceptf<>("Variable %s has a different category than %s (both selected by %s)",
+                            sampler.GetName(i).c_str(), sampler.GetName(0).c_str(), pattern.c_str());
+        }
+    }
+    buffer.resize(sampler.GetBufferSize());
+}
+
+double SampledSimulation::Quantity::Sample()
+{
+    sampler.SampleToBuffer(&buffer[0]);
+
+    double sum = 0;
+    for (size_t i = 0; i < sampler.GetNumVariables(); ++i)
+        sum += sampler.GetValue(&buffer[0], i);
+    return sum;
+}
+
+SampledSimulation::SampledSimulation(MGSystem& sys)
+    : m_sys(sys),
+      m_period(sys.GetKernel()->GetConfig()->getValue<CycleNo>("SamplingPeriod")),
+      m_warmup(sys.GetKernel()->GetConfig()->getValue<CycleNo>("SamplingWarmup")),
+      m_window(sys.GetKernel()->GetConfig()->getValue<CycleNo>("SamplingWindow")),
+      m_quantities()
+{
+    if (m_window == 0)
+    {
+        throw InvalidArgumentException("SamplingWindow must be greater than zero");
+    }
+    if (m_warmup + m_window > m_period)
+    {
+        throw InvalidArgumentException("SamplingPeriod must be at least SamplingWarmup + SamplingWindow");
+    }
+
+    const IMemory& memory = sys.GetMemory();
+    if (m_warmup + m_window < m_period && !memory.HasCurrentContents())
+    {
+        throw InvalidArgumentException("Sampled simulation uses direct-memory mode, which is not supported by this memory system");
+    }
+    if (memory.HasTimingState())
+    {
+        // Only the L1 caches are warmed in direct-memory mode
+        cerr << "Warning: the caches, directories or open rows of the memory system are not warmed in direct-memory mode; "
+             << "they are only warmed during SamplingWarmup" << endl;
+    }
+
+    // The first two quantities are the basis of the estimates
+    vector<string> pats = sys.GetKernel()->GetConfig()->getWordList("SamplingVariables");
+    pats.insert(pats.begin(), "kernel.cycle");
+    pats.insert(pats.begin(), "cpu*.pipeline.execute:op");
+
+    const VariableRegistry& registry = sys.GetKernel()->GetVariableRegistry();
+    try
+    {
+        for (auto& p : pats)
+            m_quantities.push_back(new Quantity(registry, p));
+    }
+    catch (...)
+    {
+        for (auto q : m_quantities)
+            delete q;
+        throw;
+    }
+}
+
+SampledSimulation::~SampledSimulation()
+{
+    for (auto q : m_quantities)
+        delete q;
+}
+
+// Runs the system for the specified number of cycles.
+// Returns false if the simulation stopped before that.
+bool SampledSimulation::Advance(const step_t& step, CycleNo cycles)
+{
+    const CycleNo start = m_sys.GetKernel()->GetCycleNo();
+    step(cycles);
+    return m_sys.GetKernel()->GetCycleNo() - start == cycles;
+}
+
+void SampledSimulation::Run(const step_t& step)
+{
+    const CycleNo skip = m_period - m_warmup - m_window;
+    try
+    {
+        for (;;)
+        {
+            // Functional warming
+            if (skip > 0)
+            {
+                // Switching waits until the memory system is idle; these
+                // cycles are part of the skipped ones.
+                const CycleNo start = m_sys.GetKernel()->GetCycleNo();
+                m_sys.SetDirectMemory(true);
+                const CycleNo drained = m_sys.GetKernel()->GetCycleNo() - start;
+                bool done = drained < skip && !Advance(step, skip - drained);
+                m_sys.SetDirectMemory(false);
+                if (done)
+                    break;
+            }
+
+            // Detailed warming
+            if (m_warmup > 0 && !Advance(step, m_warmup))
+                break;
+
+            // Detailed measurement; a window that is cut short by the
+            // end of the simulation is discarded.
+            for (auto q : m_quantities)
+                q->start = q->Sample();
+
+            if (!Advance(step, m_window))
+                break;
+
+            for (auto q : m_quantities)
+            {
+                const double value = q->Sample();
+                q->values.push_back(q->cat == SVC_CUMULATIVE ? value - q->start : value);
+            }
+        }
+    }
+    catch (...)
+    {
+        if (m_sys.IsDirectMemory())
+            m_sys.SetDirectMemory(false);
+        throw;
+    }
+}
+
+void SampledSimulation::PrintStatistics(ostream& os) const
+{
+    const Quantity& ops    = *m_quantities[0];
+    const size_t    k      = ops.values.size();
+
+    os << dec
+       << m_period << "\t# sampling period (master cycles)" << endl
+       << m_warmup << "\t# detailed warm-up per sample (master cycles)" << endl
+       << m_window << "\t# measurement window per sample (master cycles)" << endl
+       << k << "\t# number of samples" << endl;
+
+    if (k < 2)
+    {
+        os << "# not enough samples for estimates; decrease SamplingPeriod" << endl;
+        return;
+    }
+
+    // The cumulative quantities are estimated with the ratio of their
+    // increase to the number of executed instructions in the windows,
+    // which is extrapolated to the instruction count of the program.
+    // The confidence interval follows from the variance of the residuals.
+    const double N = (double)m_sys.GetOp();
+    double sum_n = 0;
+    for (double n : ops.values)
+        sum_n += n;
+    const double mean_n = sum_n / k;
+    if (mean_n == 0)
+    {
+        os << "# no instructions executed in the windows" << endl;
+        return;
+    }
+
+    os << (uint64_t)N << "\t# total executed instructions" << endl;
+
+    double cycles_total = 0;
+    for (size_t i = 1; i < m_quantities.size(); ++i)
+    {
+        const Quantity& q = *m_quantities[i];
+        double estimate, ci;
+        const char *kind;
+        if (q.cat == SVC_CUMULATIVE)
+        {
+            double sum_v = 0;
+            for (double v : q.values)
+                sum_v += v;
+            const double ratio = sum_v / sum_n;
+
+            double s2 = 0;
+            for (size_t j = 0; j < k; ++j)
+            {
+                const double e = q.values[j] - ratio * ops.values[j];
+                s2 += e * e;
+            }
+            s2 /= (k - 1);
+
+            estimate = ratio * N;
+            ci       = Z95 * sqrt(s2 / k) / mean_n * N;
+            kind     = "estimated total";
+        }
+        else if (q.cat == SVC_WATERMARK)
+        {
+            estimate = q.values.back();
+            ci       = 0;
+            kind     = "last sample";
+        }
+        else
+        {
+            double sum = 0, sum2 = 0;
+            for (double v : q.values)
+            {
+                sum  += v;
+                sum2 += v * v;
+            }
+            estimate = sum / k;
+            ci       = Z95 * sqrt(max(0.0, (sum2 - sum * estimate) / (k - 1)) / k);
+            kind     = "estimated mean";
+        }
+
+        if (i == 1)
+            cycles_total = estimate;
+
+        os << estimate << "\t# " << q.pattern << " (" << kind;
+        if (ci > 0)
+            os << ", +/- " << ci << " at 95% confidence";
+        os << ")" << endl;
+    }
+
+    if (cycles_total > 0)
+    {
+        os << N / cycles_total << "\t# estimated instructions per master cycle" << endl;
+    }
+}
@@ -0,0 +1,70 @@
+// -*- c++ -*-
+#ifndef SAMPLEDSIM_H
+#define SAMPLEDSIM_H
+
+#include <sim/kernel.h>
+#include <sim/binarysampler.h>
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Simulator {
+    class MGSystem;
+}
+
+/*
+ * Statistical sampled simulation, after SMARTS: the program runs in
+ * direct-memory mode with the caches kept warm, except for a detailed
+ * warm-up and measurement window at the end of every sampling period.
+ * The quantities measured in the windows are extrapolated to the
+ * whole program, per executed instruction.
+ *
+ * A quantity is the sum of the monitoring variables that match a
+ * pattern, and all the variables must have the same category.
+ * Cumulative quantities are estimated from their increase in the
+ * windows, level quantities from their value at the end of the
+ * windows, and for watermarks the final value is reported.
+ */
+class SampledSimulation
+{
+    struct Quantity
+    {
+        std::string                         pattern;
+        Simulator::VariableCategory         cat;
+        Simulator::BinarySampler            sampler;
+        std::vector<char>                   buffer;
+        double                              start;  ///< Value at the start of the window.
+        std::vector<double>                 values; ///< Value per window.
+
+        Quantity(const Simulator::VariableRegistry& registry, const std::string& pattern);
+        double Sample();
+    };
+
+    Simulator::MGSystem&   m_sys;
+    Simulator::CycleNo     m_period;    ///< Config: Master cycles from the start of one window to the next.
+    Simulator::CycleNo     m_warmup;    ///< Config: Detailed cycles before a window.
+    Simulator::CycleNo     m_window;    ///< Config: Detailed cycles in a window.
+    std::vector<Quantity*> m_quantities;///< The instructions, the cycles and the configured variables.
+
+    typedef std::function<void(Simulator::CycleNo)> step_t;
+    bool Advance(const step_t& step, Simulator::CycleNo cycles);
+
+public:
+    SampledSimulation(Simulator::MGSystem& sys);
+    SampledSimulation(const SampledSimulation&) = delete;
+    SampledSimulation& operator=(const SampledSimulation&) = delete;
+    ~SampledSimulation();
+
+    /**
+     * @brief Run the simulation to completion.
+     * @param step runs the system for a number of master cycles.
+     */
+    void Run(const step_t& step);
+
+    /// Print the estimates in the format of the end-of-simulation statistics.
+    void PrintStatistics(std::ostream& os) const;
+};
+
+#endif
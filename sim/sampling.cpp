@@ -1,23 +1,28 @@
 #include <sys_config.h>
 #include <sim/sampling.h>
 #include <sim/except.h>
+#include <sim/glob.h>
 
 #include <sstream>
-#include <fnmatch.h>
 
 using namespace std;
 
 namespace Simulator
 {
     VariableRegistry::VariableRegistry()
-        : m_registry()
+        : m_registry(),
+          m_trie(),
+          m_trieValid(false),
+          m_matches(),
+          m_lock()
     {}
 
     void VariableRegistry::RegisterVariable(void *var, const string& name,
                                             VariableCategory cat,
                                             ValueType type,
                                             size_t width, void *maxval,
-                                            serializer_func_t ser)
+                                            serializer_func_t ser,
+                                            bin_serializer_func_t bser)
     {
         if (m_registry.find(name) != m_registry.end())
             throw exceptf<>("Duplicate variable registration: %s",
@@ -30,13 +35,112 @@ namespace Simulator
         vinfo.type = type;
         vinfo.cat = cat;
         vinfo.ser = ser;
+        vinfo.bser = bser;
 
         const char *maxdata = (const char*)maxval;
         if (maxdata)
             for (size_t i = 0; i < width; ++i)
                 vinfo.max.push_back(maxdata[i]);
 
+        std::lock_guard<std::mutex> lock(m_lock);
         m_registry[name] = vinfo;
+        m_trieValid = false;
+        m_matches.clear();
+    }
+
+    void VariableRegistry::BuildTrie() const
+    {
+        m_trie.assign(1, NameNode());
+
+        // The names come in order, so the names below an inner edge
+        // follow each other and the edge is the last one of its node.
+        for (auto& i : m_registry)
+        {
+            const string& name = i.first;
+            size_t node = 0, pos = 0, dot;
+            while ((dot = name.find('.', pos)) != string::npos)
+            {
+                const size_t len = dot + 1 - pos;
+                NameNode& edges = m_trie[node];
+                if (edges.empty() || edges.back().var != NULL ||
+                    edges.back().label.compare(0, string::npos, name, pos, len) != 0)
+                {
+                    edges.push_back(NameEdge{name.substr(pos, len), m_trie.size(), NULL});
+                    m_trie.push_back(NameNode());
+                }
+                node = m_trie[node].back().node;
+                pos  = dot + 1;
+            }
+            m_trie[node].push_back(NameEdge{name.substr(pos), 0, &i});
+        }
+        m_trieValid = true;
+    }
+
+    void VariableRegistry::MatchNode(const GlobPattern& pat, size_t node,
+                                     uint64_t state, match_t& result) const
+    {
+        for (auto& e : m_trie[node])
+        {
+            const uint64_t s = pat.Advance(state, e.label);
+            if (s == 0)
+                continue;
+
+            if (e.var != NULL)
+            {
+                if (pat.Accepts(s))
+                    result.push_back(e.var);
+            }
+            else if (pat.AcceptsAll(s))
+                CollectNode(e.node, result);
+            else
+                MatchNode(pat, e.node, s, result);
+        }
+    }
+
+    void VariableRegistry::CollectNode(size_t node, match_t& result) const
+    {
+        for (auto& e : m_trie[node])
+        {
+            if (e.var != NULL)
+                result.push_back(e.var);
+            else
+                CollectNode(e.node, result);
+        }
+    }
+
+    VariableRegistry::match_t VariableRegistry::Match(const string& pat) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        auto c = m_matches.find(pat);
+        if (c != m_matches.end())
+            return c->second;
+
+        match_t result;
+        GlobPattern g(pat);
+        if (!g.IsCompiled())
+        {
+            for (auto& i : m_registry)
+                if (g.Match(i.first))
+                    result.push_back(&i);
+        }
+        else if (g.IsLiteral())
+        {
+            auto i = m_registry.find(g.GetLiteral());
+            if (i != m_registry.end())
+                result.push_back(&*i);
+        }
+        else
+        {
+            if (!m_trieValid)
+                BuildTrie();
+            MatchNode(g, 0, g.Start(), result);
+        }
+
+        if (m_matches.size() >= MATCH_CACHE_SIZE)
+            m_matches.clear();
+        m_matches[pat] = result;
+        return result;
     }
 
     void VariableRegistry::ListVariables_onevar(ostream& os,
@@ -86,35 +190,29 @@ namespace Simulator
     void VariableRegistry::ListVariables(ostream& os, const string& pat) const
     {
         ListVariables_header(os);
-        for (auto& i : GetRegistry())
-        {
-            if (FNM_NOMATCH == fnmatch(pat.c_str(), i.first.c_str(), 0))
-                continue;
-            ListVariables_onevar(os, i.first, i.second);
-        }
+        for (auto i : Match(pat))
+            ListVariables_onevar(os, i->first, i->second);
     }
 
 
     void VariableRegistry::SetVariables(ostream& os, const string& pat,
                                         const string& val) const
     {
-        for (auto& i : m_registry)
+        for (auto i : Match(pat))
         {
-            if (FNM_NOMATCH == fnmatch(pat.c_str(), i.first.c_str(), 0))
-                continue;
-            os << "Writing " << i.first << "..." << std::endl;
+            os << "Writing " << i->first << "..." << std::endl;
 
             istringstream is(val);
             StreamSerializer s(is);
 
-            switch(i.second.type)
+            switch(i->second.type)
             {
             case Serialization::SV_BITS:
             case Serialization::SV_BINARY:
-                s.serialize_raw(i.second.type, i.second.var, i.second.width);
+                s.serialize_raw(i->second.type, i->second.var, i->second.width);
                 break;
             default:
-                i.second.ser(s, i.second.var);
+                i->second.ser(s, i->second.var);
                 break;
             }
         }
@@ -125,16 +223,13 @@ namespace Simulator
                                            bool compact) const
     {
         bool some = false;
-        for (auto& i : m_registry)
+        for (auto i : Match(pat))
         {
-            if (FNM_NOMATCH == fnmatch(pat.c_str(), i.first.c_str(), 0))
-                continue;
-
-            os << i.first << " =";
+            os << i->first << " =";
 
             StreamSerializer s(os, compact);
 
-            const VarInfo& vinfo = i.second;
+            const VarInfo& vinfo = i->second;
             switch(vinfo.type)
             {
             case Serialization::SV_BITS:
@@ -5,12 +5,17 @@
 #include <type_traits>
 #include <vector>
 #include <string>
+#include <map>
+#include <mutex>
 
 #include <sim/serialization.h>
 #include <sim/streamserializer.h>
+#include <sim/binaryserializer.h>
 
 namespace Simulator
 {
+    class GlobPattern;
+
     enum VariableCategory
     {
         SVC_STATE,      // state variable
@@ -24,6 +29,7 @@ namespace Simulator
     public:
         typedef Serialization::SerializationValueType ValueType;
         typedef void (*serializer_func_t)(StreamSerializer&, void*);
+        typedef void (*bin_serializer_func_t)(BinarySerializer&, void*);
 
     private:
         struct VarInfo
@@ -32,32 +38,68 @@ namespace Simulator
             void *                 var;
             size_t                 width;
             serializer_func_t      ser;
+            bin_serializer_func_t  bser;
             VariableCategory       cat;
             std::vector<char>      max;
 
             VarInfo()
                 : type(Serialization::SV_INTEGER), var(0), width(0), ser(0),
-                  cat(SVC_LEVEL), max() {};
+                  bser(0), cat(SVC_LEVEL), max() {};
             VarInfo(const VarInfo&) = default;
             VarInfo& operator=(const VarInfo&) = default;
         };
 
         typedef std::map<std::string, VarInfo> var_registry_t;
+        typedef var_registry_t::value_type var_entry_t;
         var_registry_t m_registry;
 
         const var_registry_t& GetRegistry() const { return m_registry; }
 
+        // The names split at the dots into a trie, so that a pattern
+        // is matched against a common prefix once for all the names
+        // below it. The label of an edge is a name component,
+        // followed by a dot if the edge leads to a node. The edges
+        // of a node are sorted on label, so that a depth-first walk
+        // visits the variables in the order of m_registry.
+        struct NameEdge
+        {
+            std::string        label;
+            size_t             node;  ///< Index in m_trie, for inner edges
+            const var_entry_t* var;   ///< The variable, for leaf edges
+        };
+        typedef std::vector<NameEdge> NameNode;
+
+        typedef std::vector<const var_entry_t*> match_t;
+
+        // The trie is built by the first lookup after variables were
+        // registered. The results of the last lookups are cached.
+        mutable std::vector<NameNode>        m_trie;
+        mutable bool                         m_trieValid;
+        mutable std::map<std::string, match_t> m_matches;
+        mutable std::mutex                   m_lock;
+
+        static const size_t MATCH_CACHE_SIZE = 64;
+
+        // Returns the variables whose name matches the pattern, in
+        // name order.
+        match_t Match(const std::string& pat) const;
+
+        void BuildTrie() const;
+        void MatchNode(const GlobPattern& pat, size_t node, uint64_t state, match_t& result) const;
+        void CollectNode(size_t node, match_t& result) const;
+
     public:
         VariableRegistry();
-        VariableRegistry(const VariableRegistry&) = default;
-        VariableRegistry& operator=(const VariableRegistry&) = default;
+        VariableRegistry(const VariableRegistry&) = delete;
+        VariableRegistry& operator=(const VariableRegistry&) = delete;
 
         // Register a variable.
         void RegisterVariable(void* ptr, const std::string& name,
                               VariableCategory cat,
                               ValueType t,
                               size_t s, void* ref,
-                              serializer_func_t ser);
+                              serializer_func_t ser,
+                              bin_serializer_func_t bser = 0);
         template<typename T>
         void RegisterVariable(T& var,
                               const std::string& name,
@@ -104,6 +146,7 @@ namespace Simulator
         void ListVariables_header(std::ostream& os);
 
         friend class BinarySampler;
+        friend class Checkpoint;
     };
 
 }
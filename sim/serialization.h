@@ -5,6 +5,7 @@
 #include <type_traits>
 #include <vector>
 #include <deque>
+#include <queue>
 #include <map>
 #include <cstddef>
 #include <cstdint>
@@ -154,6 +155,46 @@ namespace Simulator
         struct serialize_trait<std::deque<T> >
             : public container_serializer<std::deque<T>, 'q'> {};
 
+        // General serializer for std::queue. This serializes the
+        // underlying container, which std::queue keeps as a
+        // protected member.
+        template<typename T, typename Container>
+        struct serialize_trait<std::queue<T, Container> >
+        {
+            template<typename A>
+            static void serialize(A& arch, std::queue<T, Container>& q)
+            {
+                struct access : public std::queue<T, Container>
+                {
+                    static Container& get(std::queue<T, Container>& q) { return q.*(&access::c); }
+                };
+                arch & access::get(q);
+            }
+        };
+
+        // Serializer for std::vector<bool>, whose elements
+        // cannot be referenced individually.
+        template<>
+        struct serialize_trait<std::vector<bool> >
+        {
+            template<typename A>
+            static void serialize(A& arch, std::vector<bool>& container)
+            {
+                size_t sz = container.size();
+                arch & "[b" & sz;
+                container.resize(sz);
+
+                for (size_t i = 0; i < sz; ++i)
+                {
+                    bool v = container[i];
+                    arch & v;
+                    container[i] = v;
+                }
+
+                arch & "]";
+            }
+        };
+
         // General serializer for std::vector<char>
         // (array of bytes)
         template<typename ByteType>
@@ -299,6 +340,34 @@ namespace Simulator
             return s;
         }
 
+        // Serialization::bitmask(V, N) Serializes the N low-order
+        // bits of the integer V as a bit array, like bitvec.
+        struct bitmask
+        {
+            uint64_t *p;
+            size_t sz;
+
+            inline
+            bitmask(uint64_t *_p, size_t _sz)
+                : p(_p), sz(_sz) {}
+        };
+
+        template<typename A>
+        A& operator&(A& s, const bitmask& bs)
+        {
+            bool bits[64];
+            for (size_t i = 0; i < bs.sz; ++i)
+                bits[i] = (*bs.p >> i) & 1;
+            s.serialize_raw(SV_BITS, bits, bs.sz);
+            if (!s.reading())
+            {
+                *bs.p = 0;
+                for (size_t i = 0; i < bs.sz; ++i)
+                    *bs.p |= (uint64_t)bits[i] << i;
+            }
+            return s;
+        }
+
     }
 }
 
@@ -0,0 +1,248 @@
+#include "sim/statsdump.h"
+#include "sim/config.h"
+#include "arch/MGSystem.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+using namespace Simulator;
+
+static const char FILE_MAGIC[8] = {'M','G','S','T','A','T','S','1'};
+static const char END_MAGIC[8]  = {'M','G','S','T','A','E','N','D'};
+
+// The categories of the variables that are dumped
+static const unsigned STATS_CATEGORIES =
+    (1u << SVC_LEVEL) | (1u << SVC_WATERMARK) | (1u << SVC_CUMULATIVE);
+
+//
+// Encoding helpers
+//
+static void PutFixed(vector<char>& buf, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i, value >>= 8)
+        buf.push_back((char)(value & 0xff));
+}
+
+static void PutVarint(vector<char>& buf, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buf.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    buf.push_back((char)value);
+}
+
+static uint64_t ZigZag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static uint64_t DoubleBits(double d)
+{
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof bits);
+    return bits;
+}
+
+static double BitsDouble(uint64_t bits)
+{
+    double d;
+    memcpy(&d, &bits, sizeof d);
+    return d;
+}
+
+StatsDumper::StatsDumper(MGSystem& sys, const string& filename)
+    : m_sys(sys),
+      m_filename(filename),
+      m_file(),
+      m_sampler(sys.GetKernel()->GetVariableRegistry()),
+      m_interval(sys.GetKernel()->GetConfig()->getValue<CycleNo>("StatsDumpInterval")),
+      m_chunkRows(sys.GetKernel()->GetConfig()->getValueOrDefault<size_t>("StatsDumpChunkSize", 1024)),
+      m_sample(),
+      m_start(),
+      m_last(),
+      m_columns(),
+      m_count(0),
+      m_first(0),
+      m_cycle(0),
+      m_index(),
+      m_offset(0),
+      m_handler(0)
+{
+    if (m_interval == 0)
+    {
+        throw InvalidArgumentException("StatsDumpInterval must be greater than zero");
+    }
+    if (m_chunkRows == 0)
+    {
+        throw InvalidArgumentException("StatsDumpChunkSize must be greater than zero");
+    }
+
+    vector<string> pats = sys.GetKernel()->GetConfig()->getWordList("StatsDumpVariables");
+    m_sampler.SelectVariables(pats, STATS_CATEGORIES);
+    if (m_sampler.GetNumVariables() == 0)
+    {
+        throw InvalidArgumentException("No statistics variables match StatsDumpVariables");
+    }
+
+    m_file.open(filename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!m_file)
+    {
+        throw exceptf<IOException>("Unable to create statistics dump %s: %s", filename.c_str(), strerror(errno));
+    }
+
+    const size_t nvars = m_sampler.GetNumVariables();
+    vector<char> header(FILE_MAGIC, FILE_MAGIC + sizeof FILE_MAGIC);
+    PutFixed(header, nvars + 1, 4);
+    PutFixed(header, m_chunkRows, 4);
+    PutFixed(header, m_interval, 8);
+
+    static const string cycle_name = "cycle";
+    PutFixed(header, SVC_LEVEL, 1);
+    PutFixed(header, 0, 1);
+    PutFixed(header, cycle_name.size(), 2);
+    header.insert(header.end(), cycle_name.begin(), cycle_name.end());
+    for (size_t i = 0; i < nvars; ++i)
+    {
+        const string& name = m_sampler.GetName(i);
+        PutFixed(header, m_sampler.GetCategory(i), 1);
+        PutFixed(header, m_sampler.IsFloat(i) ? 1 : 0, 1);
+        PutFixed(header, name.size(), 2);
+        header.insert(header.end(), name.begin(), name.end());
+    }
+    m_file.write(header.data(), header.size());
+    m_offset = header.size();
+
+    // The first interval starts now, which is not necessarily cycle 0
+    // after a checkpoint was restored.
+    m_sample.resize(m_sampler.GetBufferSize());
+    m_sampler.SampleToBuffer(&m_sample[0]);
+    m_start.resize(nvars);
+    for (size_t i = 0; i < nvars; ++i)
+        m_start[i] = ReadValue(i);
+    m_last.resize(nvars + 1);
+    m_columns.resize(nvars + 1);
+    m_cycle = sys.GetKernel()->GetCycleNo();
+
+    m_handler = sys.GetKernel()->AddIntervalHandler(m_interval, [this]{ Sample(); });
+}
+
+StatsDumper::~StatsDumper()
+{
+    try
+    {
+        Close();
+    }
+    catch (const IOException& e)
+    {
+        cerr << "Warning: statistics dump " << m_filename << " is incomplete: " << e.what() << endl;
+    }
+}
+
+// Returns the value of a variable in m_sample, with the bits of a
+// double for floats.
+uint64_t StatsDumper::ReadValue(size_t i) const
+{
+    return m_sampler.IsFloat(i)
+        ? DoubleBits(m_sampler.GetValue(&m_sample[0], i))
+        : m_sampler.GetIntegerValue(&m_sample[0], i);
+}
+
+void StatsDumper::Sample()
+{
+    const CycleNo cycle = m_sys.GetKernel()->GetCycleNo();
+
+    if (m_count == 0)
+    {
+        // Start a new chunk
+        m_first = cycle;
+        fill(m_last.begin(), m_last.end(), 0);
+    }
+
+    PutVarint(m_columns[0], ZigZag((int64_t)(cycle - m_last[0])));
+    m_last[0] = cycle;
+
+    m_sampler.SampleToBuffer(&m_sample[0]);
+    for (size_t i = 0; i < m_start.size(); ++i)
+    {
+        const uint64_t value = ReadValue(i);
+        uint64_t v = value;
+        if (m_sampler.GetCategory(i) == SVC_CUMULATIVE)
+        {
+            v = m_sampler.IsFloat(i)
+                ? DoubleBits(BitsDouble(value) - BitsDouble(m_start[i]))
+                : value - m_start[i];
+            m_start[i] = value;
+        }
+
+        vector<char>& column = m_columns[i + 1];
+        if (m_sampler.IsFloat(i))
+            PutVarint(column, v ^ m_last[i + 1]);
+        else
+            PutVarint(column, ZigZag((int64_t)(v - m_last[i + 1])));
+        m_last[i + 1] = v;
+    }
+
+    m_cycle = cycle;
+    if (++m_count == m_chunkRows)
+        FlushChunk();
+}
+
+void StatsDumper::FlushChunk()
+{
+    if (m_count == 0)
+        return;
+
+    vector<char> header;
+    PutFixed(header, m_count, 4);
+    m_file.write(header.data(), header.size());
+    uint64_t size = header.size();
+    for (auto& column : m_columns)
+    {
+        header.clear();
+        PutFixed(header, column.size(), 4);
+        m_file.write(header.data(), header.size());
+        m_file.write(column.data(), column.size());
+        size += header.size() + column.size();
+        column.clear();
+    }
+
+    m_index.push_back(ChunkInfo{m_first, m_offset, m_count});
+    m_offset += size;
+    m_count = 0;
+}
+
+void StatsDumper::Close()
+{
+    if (!m_file.is_open())
+        return;
+
+    m_sys.GetKernel()->RemoveIntervalHandler(m_handler);
+    if (m_sys.GetKernel()->GetCycleNo() != m_cycle)
+    {
+        // The last interval ended with the simulation
+        Sample();
+    }
+    FlushChunk();
+
+    vector<char> index;
+    for (const ChunkInfo& c : m_index)
+    {
+        PutFixed(index, c.first, 8);
+        PutFixed(index, c.offset, 8);
+        PutFixed(index, c.count, 8);
+    }
+    PutFixed(index, m_offset, 8);
+    PutFixed(index, m_index.size(), 8);
+    index.insert(index.end(), END_MAGIC, END_MAGIC + sizeof END_MAGIC);
+    m_file.write(index.data(), index.size());
+
+    m_file.close();
+    if (!m_file)
+    {
+        throw exceptf<IOException>("Unable to write statistics dump %s", m_filename.c_str());
+    }
+}
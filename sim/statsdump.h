@@ -0,0 +1,86 @@
+// -*- c++ -*-
+#ifndef STATSDUMP_H
+#define STATSDUMP_H
+
+#include <sim/kernel.h>
+#include <sim/binarysampler.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Simulator {
+    class MGSystem;
+}
+
+/*
+ * Writes the statistics variables that match StatsDumpVariables every
+ * StatsDumpInterval master cycles, for phase analysis of long runs.
+ * Every row holds the master cycle at the end of the interval, the
+ * increase of the cumulative variables over the interval, and the
+ * value of the level and watermark variables at its end. State
+ * variables are not selected.
+ *
+ * The rows are stored by column: they are grouped in chunks, and in a
+ * chunk the values of every column are stored contiguously as the
+ * differences from the previous value of the column in the chunk
+ * (zigzag varints for integers, the XOR of the bits for floats). As
+ * most variables change little between intervals this takes one byte
+ * per value, and a reader can extract a column without decoding the
+ * others. Every chunk can be decoded on its own.
+ *
+ * Layout, all integers little-endian:
+ *   file header:   "MGSTATS1", u32 columns, u32 rows per chunk,
+ *                  u64 interval; per column: u8 category, u8 float,
+ *                  u16 name length, name
+ *   chunk:         u32 rows, per column: u32 size, values
+ *   index:         per chunk: u64 first cycle, u64 offset, u64 rows
+ *   trailer:       u64 index offset, u64 chunks, "MGSTAEND"
+ *
+ * The first column, "cycle", is the master cycle. See readstats(1).
+ */
+class StatsDumper
+{
+    struct ChunkInfo
+    {
+        Simulator::CycleNo first;
+        uint64_t           offset;
+        uint64_t           count;
+    };
+
+    Simulator::MGSystem&          m_sys;
+    std::string                   m_filename;
+    std::ofstream                 m_file;
+    Simulator::BinarySampler      m_sampler;
+    Simulator::CycleNo            m_interval;   ///< Config: Master cycles between rows
+    size_t                        m_chunkRows;  ///< Config: Rows per chunk
+    std::vector<char>             m_sample;     ///< Current values of the variables
+    std::vector<uint64_t>         m_start;      ///< Values of the variables at the start of the interval
+    std::vector<uint64_t>         m_last;       ///< Last value of every column in the chunk
+    std::vector<std::vector<char> > m_columns;  ///< Encoded columns of the current chunk
+    size_t                        m_count;      ///< Rows in the current chunk
+    Simulator::CycleNo            m_first;      ///< First cycle of the current chunk
+    Simulator::CycleNo            m_cycle;      ///< Cycle of the last row
+    std::vector<ChunkInfo>        m_index;
+    uint64_t                      m_offset;     ///< Current file offset
+    size_t                        m_handler;    ///< Interval handler in the kernel
+
+    uint64_t ReadValue(size_t i) const;
+    void Sample();
+    void FlushChunk();
+
+public:
+    StatsDumper(Simulator::MGSystem& sys, const std::string& filename);
+    StatsDumper(const StatsDumper&) = delete;
+    StatsDumper& operator=(const StatsDumper&) = delete;
+    ~StatsDumper();
+
+    // Adds a row for the last, partial interval, and writes the last
+    // chunk and the index. This is done by the destructor, but only
+    // Close() reports errors.
+    void Close();
+
+    size_t GetNumVariables() const { return m_sampler.GetNumVariables(); }
+};
+
+#endif
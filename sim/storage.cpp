@@ -31,7 +31,8 @@ namespace Simulator
         : Object(name, parent),
           m_next(NULL),
           m_clock(clock),
-          InitStateVariable(activated, false)
+          InitStateVariable(activated, false),
+          m_profile()
     {}
 
     Storage::~Storage()
@@ -13,9 +13,12 @@ namespace Simulator
     class Storage
         : public virtual Object
     {
+        friend class Kernel;
+
         Storage*              m_next;         ///< Next pointer in the list of storages that require updates
         Clock&                m_clock;        ///< The clock that governs this storage
         DefineStateVariable(bool, activated); ///< Has the storage already been activated this cycle?
+        ProfileCounter        m_profile;      ///< Host time spent in Update(), when profiling.
 
     protected:
 
@@ -0,0 +1,199 @@
+#include "sim/kernel.h"
+#include "sim/ctz.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Simulator
+{
+    TimingWheel::TimingWheel()
+        : m_now(0),
+          m_overflow(NULL),
+          m_size(0),
+          m_next(0),
+          m_nextValid(false)
+    {
+        for (unsigned l = 0; l < NUM_LEVELS; ++l)
+        {
+            for (unsigned s = 0; s < NUM_SLOTS; ++s)
+                m_slots[l][s] = NULL;
+            m_occupied[l] = 0;
+        }
+    }
+
+    // Returns the list that holds processes waking up at the specified
+    // cycle. The level is NUM_LEVELS for the overflow list.
+    Process** TimingWheel::GetList(CycleNo when, unsigned& level, unsigned& slot) const
+    {
+        CycleNo diff = when ^ m_now;
+        level = 0;
+        while (diff >= NUM_SLOTS)
+        {
+            diff >>= LEVEL_BITS;
+            if (++level == NUM_LEVELS)
+            {
+                slot = 0;
+                return const_cast<Process**>(&m_overflow);
+            }
+        }
+        slot = (when >> (level * LEVEL_BITS)) % NUM_SLOTS;
+        return const_cast<Process**>(&m_slots[level][slot]);
+    }
+
+    void TimingWheel::Link(Process& process)
+    {
+        unsigned level, slot;
+        Process** list = GetList(process.m_wakeup, level, slot);
+
+        process.m_wheelNext = *list;
+        process.m_wheelPrev = list;
+        if (process.m_wheelNext != NULL) {
+            process.m_wheelNext->m_wheelPrev = &process.m_wheelNext;
+        }
+        *list = &process;
+
+        if (level < NUM_LEVELS) {
+            m_occupied[level] |= 1U << slot;
+        }
+    }
+
+    // Re-distributes a list of processes after the time has changed.
+    void TimingWheel::Spread(Process* list)
+    {
+        for (Process* next; list != NULL; list = next)
+        {
+            next = list->m_wheelNext;
+            Link(*list);
+        }
+    }
+
+    void TimingWheel::Insert(Process& process)
+    {
+        assert(process.m_wakeup > m_now);
+        assert(process.m_wheelPrev == NULL);
+
+        Link(process);
+
+        if (m_size++ == 0) {
+            m_next      = process.m_wakeup;
+            m_nextValid = true;
+        } else if (m_nextValid && process.m_wakeup < m_next) {
+            m_next = process.m_wakeup;
+        }
+    }
+
+    void TimingWheel::Reset(CycleNo now)
+    {
+        assert(m_size == 0);
+        m_now       = now;
+        m_nextValid = false;
+    }
+
+    void TimingWheel::Remove(Process& process)
+    {
+        assert(process.m_wheelPrev != NULL);
+
+        *process.m_wheelPrev = process.m_wheelNext;
+        if (process.m_wheelNext != NULL) {
+            process.m_wheelNext->m_wheelPrev = process.m_wheelPrev;
+        }
+        process.m_wheelPrev = NULL;
+
+        unsigned level, slot;
+        if (*GetList(process.m_wakeup, level, slot) == NULL && level < NUM_LEVELS) {
+            m_occupied[level] &= ~(1U << slot);
+        }
+
+        --m_size;
+        if (process.m_wakeup == m_next) {
+            m_nextValid = false;
+        }
+    }
+
+    CycleNo TimingWheel::GetNextEvent()
+    {
+        assert(m_size > 0);
+        if (m_nextValid) {
+            return m_next;
+        }
+
+        // The lowest non-empty level holds the earliest processes.
+        const Process* list = m_overflow;
+        for (unsigned l = 0; l < NUM_LEVELS; ++l)
+        {
+            if (m_occupied[l] != 0)
+            {
+                const unsigned slot = ctz(m_occupied[l]);
+                if (l == 0)
+                {
+                    // All processes in a level-0 slot wake up at the same time.
+                    m_next      = (m_now & ~(CycleNo)(NUM_SLOTS - 1)) | slot;
+                    m_nextValid = true;
+                    return m_next;
+                }
+                list = m_slots[l][slot];
+                break;
+            }
+        }
+
+        assert(list != NULL);
+        m_next = list->m_wakeup;
+        for (list = list->m_wheelNext; list != NULL; list = list->m_wheelNext) {
+            m_next = std::min(m_next, list->m_wakeup);
+        }
+        m_nextValid = true;
+        return m_next;
+    }
+
+    Process* TimingWheel::Advance(CycleNo now)
+    {
+        assert(now >= m_now);
+        if (now == m_now) {
+            return NULL;
+        }
+
+        // Find the highest level whose slot changes. The slot that time
+        // moves into at that level is spread out over the lower levels,
+        // which are empty since no process is due before now.
+        CycleNo  diff  = m_now ^ now;
+        unsigned level = 0;
+        while (diff >= NUM_SLOTS && level < NUM_LEVELS)
+        {
+            diff >>= LEVEL_BITS;
+            ++level;
+        }
+
+        m_now       = now;
+        m_nextValid = false;
+
+        if (level == NUM_LEVELS)
+        {
+            Process* list = m_overflow;
+            m_overflow = NULL;
+            Spread(list);
+        }
+        else if (level > 0)
+        {
+            const unsigned slot = (now >> (level * LEVEL_BITS)) % NUM_SLOTS;
+            Process* list = m_slots[level][slot];
+            m_slots[level][slot] = NULL;
+            m_occupied[level] &= ~(1U << slot);
+            Spread(list);
+        }
+
+        // Take out the processes that are due now
+        const unsigned slot = now % NUM_SLOTS;
+        Process* due = m_slots[0][slot];
+        m_slots[0][slot] = NULL;
+        m_occupied[0] &= ~(1U << slot);
+
+        for (Process* p = due; p != NULL; p = p->m_wheelNext)
+        {
+            assert(p->m_wakeup == now);
+            p->m_wheelPrev = NULL;
+            --m_size;
+        }
+        return due;
+    }
+
+}
@@ -0,0 +1,82 @@
+// -*- c++ -*-
+#ifndef SIM_TIMINGWHEEL_H
+#define SIM_TIMINGWHEEL_H
+
+#ifndef KERNEL_H
+#error This file should be included in kernel.h
+#endif
+
+#include <cstdint>
+
+namespace Simulator
+{
+    class Process;
+
+    /*
+     * A hierarchical timing wheel holding the sleeping processes.
+     *
+     * Each level has 32 slots, and each slot of a level spans a whole
+     * turn of the level below it. A process is kept at the highest
+     * level at which its wakeup cycle differs from the current time of
+     * the wheel, so that all processes in the lowest non-empty level
+     * wake up before those in the higher levels. When time advances
+     * into a slot, that slot is spread out over the lower levels.
+     * Wakeups too far in the future for the top level go into an
+     * overflow list.
+     *
+     * The processes are linked into the slots through their m_wheelNext
+     * and m_wheelPrev fields, so insertion and removal do not allocate.
+     */
+    class TimingWheel
+    {
+        static const unsigned LEVEL_BITS = 5;
+        static const unsigned NUM_SLOTS  = 1 << LEVEL_BITS;
+        static const unsigned NUM_LEVELS = 6;
+
+        CycleNo   m_now;                            ///< Current time of the wheel.
+        Process*  m_slots[NUM_LEVELS][NUM_SLOTS];   ///< Lists of processes per slot.
+        uint32_t  m_occupied[NUM_LEVELS];           ///< Bit mask of non-empty slots per level.
+        Process*  m_overflow;                       ///< Processes beyond the top level.
+        size_t    m_size;                           ///< Number of processes in the wheel.
+        CycleNo   m_next;                           ///< Earliest wakeup, if m_nextValid.
+        bool      m_nextValid;                      ///< Is m_next up to date?
+
+        Process** GetList(CycleNo when, unsigned& level, unsigned& slot) const;
+        void Link(Process& process);
+        void Spread(Process* list);
+
+    public:
+        TimingWheel();
+        TimingWheel(const TimingWheel&) = delete;
+        TimingWheel& operator=(const TimingWheel&) = delete;
+
+        bool   Empty() const { return m_size == 0; }
+        size_t GetSize() const { return m_size; }
+
+        /// Add a process; its m_wakeup must be later than the current time.
+        void Insert(Process& process);
+
+        /// Remove a process before it wakes up.
+        void Remove(Process& process);
+
+        /// Returns the earliest wakeup cycle. The wheel must not be empty.
+        CycleNo GetNextEvent();
+
+        /// Returns the current time of the wheel.
+        CycleNo GetTime() const { return m_now; }
+
+        /// Set the current time; the wheel must be empty.
+        void Reset(CycleNo now);
+
+        /**
+         * @brief Advance the wheel to the specified time.
+         * No process may be due before that time.
+         * @return the list of processes that wake up at that time,
+         * linked through their m_wheelNext fields.
+         */
+        Process* Advance(CycleNo now);
+    };
+
+}
+
+#endif
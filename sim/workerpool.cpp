@@ -0,0 +1,125 @@
+#include <sys_config.h>
+#include "sim/workerpool.h"
+
+#include <cassert>
+
+#ifdef CAN_USE_SIGMASK_ON_STD_THREAD
+#include <csignal>
+#include <pthread.h>
+#endif
+
+namespace Simulator
+{
+    // Number of polls of a waiting thread before it blocks.
+    static const unsigned SPIN_LIMIT = 1 << 16;
+
+    static inline void CPURelax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    void WorkerPool::Work(size_t index)
+    {
+#ifdef CAN_USE_SIGMASK_ON_STD_THREAD
+        // Leave the interrupts to the simulation thread.
+        sigset_t sigset;
+        sigemptyset(&sigset);
+        sigaddset(&sigset, SIGINT);
+        sigaddset(&sigset, SIGQUIT);
+        sigaddset(&sigset, SIGHUP);
+        sigaddset(&sigset, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &sigset, 0);
+#endif
+
+        uint64_t seen = 0;
+        for (;;)
+        {
+            uint64_t generation;
+            for (unsigned spins = 0; (generation = m_generation.load(std::memory_order_acquire)) == seen; ++spins)
+            {
+                if (spins < SPIN_LIMIT)
+                {
+                    CPURelax();
+                    continue;
+                }
+
+                // No job for a while; block. Run() looks at m_sleepers
+                // after it starts a job, so either it sees this thread
+                // or this thread sees the new generation.
+                m_sleepers.fetch_add(1);
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wakeup.wait(lock, [&]{ return m_generation.load() != seen; });
+                }
+                m_sleepers.fetch_sub(1);
+                spins = 0;
+            }
+            seen = generation;
+
+            if (m_stop.load(std::memory_order_acquire))
+            {
+                return;
+            }
+            (*m_job)(index);
+            m_pending.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    void WorkerPool::Run(const std::function<void(size_t)>& job)
+    {
+        if (m_threads.empty())
+        {
+            job(0);
+            return;
+        }
+
+        m_job = &job;
+        m_pending.store(m_threads.size(), std::memory_order_relaxed);
+        m_generation.fetch_add(1);
+        if (m_sleepers.load() != 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_wakeup.notify_all();
+        }
+
+        job(0);
+
+        while (m_pending.load(std::memory_order_acquire) != 0)
+        {
+            CPURelax();
+        }
+    }
+
+    WorkerPool::WorkerPool(size_t numThreads)
+        : m_threads(),
+          m_job(NULL),
+          m_generation(0),
+          m_pending(0),
+          m_sleepers(0),
+          m_stop(false),
+          m_mutex(),
+          m_wakeup()
+    {
+        assert(numThreads > 0);
+        for (size_t i = 1; i < numThreads; ++i)
+        {
+            m_threads.push_back(std::thread(&WorkerPool::Work, this, i));
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        m_stop.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_generation.fetch_add(1);
+            m_wakeup.notify_all();
+        }
+        for (auto& t : m_threads)
+        {
+            t.join();
+        }
+    }
+}
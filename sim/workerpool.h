@@ -0,0 +1,53 @@
+// -*- c++ -*-
+#ifndef SIM_WORKERPOOL_H
+#define SIM_WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Simulator
+{
+    /*
+     * A fixed set of host threads that run a job together, for the
+     * parts of a simulated cycle that the kernel runs in parallel.
+     *
+     * Run() is called for every cycle, so the threads spin for a while
+     * between jobs rather than sleep at once; they only block when no
+     * job comes for some time, e.g. at the interactive prompt.
+     */
+    class WorkerPool
+    {
+        std::vector<std::thread>               m_threads;     ///< The host threads besides the caller.
+        const std::function<void(size_t)>*     m_job;         ///< Job of the current generation.
+        std::atomic<uint64_t>                  m_generation;  ///< Incremented for every job.
+        std::atomic<size_t>                    m_pending;     ///< Threads that have not finished the job.
+        std::atomic<size_t>                    m_sleepers;    ///< Threads that are about to block or blocked.
+        std::atomic<bool>                      m_stop;        ///< Set to end the threads.
+        std::mutex                             m_mutex;
+        std::condition_variable                m_wakeup;
+
+        void Work(size_t index);
+
+    public:
+        /// Create a pool of numThreads threads, including the caller of Run().
+        explicit WorkerPool(size_t numThreads);
+        ~WorkerPool();
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /// Number of threads, including the caller of Run().
+        size_t GetNumThreads() const { return m_threads.size() + 1; }
+
+        /// Call job(i) for i in [0, GetNumThreads()) in parallel, and
+        /// return when all calls have returned. job(0) runs on the
+        /// calling thread. The job must not throw.
+        void Run(const std::function<void(size_t)>& job);
+    };
+}
+
+#endif
@@ -0,0 +1,160 @@
+// Checks that variable patterns select the same variables, in the same
+// order, as fnmatch(3) over the registry in name order. Prints the
+// mismatches and returns a non-zero exit code if there are any.
+
+#include "sim/glob.h"
+#include "sim/sampling.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fnmatch.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Simulator;
+
+namespace {
+
+const char* patterns[] = {
+    "", "*", "**", "?", "*?", "?*", "a*", "*a", "a*b*c", "*.*", "*.", ".*",
+    "a?c", "a??", "cpu1*", "cpu1?", "cpu1*.*", "cpu*.a:*", "*:*", "*a*a*a",
+
+    // Brackets
+    "[abc]", "[a-c]", "[!a]", "[^a]", "[]a]", "[!]]", "[a-]", "[-a]", "[]-a]",
+    "[a-c-e]", "[z-a]", "[\\]]", "[\\!a]", "[a\\-c]", "[!a-c]*", "cpu[0-3].*",
+    "cpu[!0-3]*", "[*]", "[?]", "[.]*", "a[.]b",
+
+    // Unterminated brackets and classes, which go through fnmatch()
+    "[", "a[", "[a", "[!", "[]", "[!]", "a[b", "[[:alpha:]]", "[[:digit:]]*",
+    "[[.a.]]", "[[=a=]]", "[a-[:digit:]]",
+
+    // Escapes
+    "\\*", "\\?", "\\[", "\\\\", "a\\", "\\", "\\a", "a\\*b", "*\\*", "\\[a]",
+};
+
+const char* names[] = {
+    "", "a", "b", "c", "ab", "abc", "abd", "aXc", "a.b", ".a", "a.", "..",
+    "a*b", "a?c", "*", "?", "[", "]", "[a]", "-", "!", "^", "\\", "a\\",
+    "aaa", "aXaYa", "z", "cpu1", "cpu10", "cpu1.a", "cpu1.a:x", "cpu9.b",
+    "cpu1-x", "x:y.z",
+};
+
+// Names in registration order, which is not the name order.
+const char* variables[] = {
+    "kernel.cycle", "cpu10.a:x", "cpu2.a:x", "cpu1.a:x", "cpu1.a.b:y",
+    "cpu1-x", "cpu1", "cpu1.a-b:z", "cpu1.a:w", "a", "a.b", "a.b.c", "a-b",
+    "b..c", ".d", "e.", "cpu1.a.b:x", "cpu2.a.c:x", "x:y.z", "cpu1.b",
+};
+
+const char* selections[] = {
+    "*", "cpu*", "cpu1*", "cpu1.*", "cpu1.a*", "cpu?.a:x", "*:x", "*.*",
+    "a*", "a.b*", "*.", ".*", "*..*", "b..c", "cpu1", "cpu[12]*", "[!c]*",
+    "x:y.z", "*y*", "kernel.cycle", "none*",
+};
+
+bool CheckGlob()
+{
+    bool ok = true;
+    for (const char* p : patterns)
+    {
+        GlobPattern g(p);
+        for (const char* n : names)
+        {
+            const std::string name(n);
+            const bool expected = fnmatch(p, n, 0) == 0;
+            if (g.Match(name) != expected)
+            {
+                std::cerr << "pattern \"" << p << "\" on \"" << name << "\": "
+                          << g.Match(name) << " instead of " << expected << std::endl;
+                ok = false;
+            }
+
+            if (!g.IsCompiled() || g.IsLiteral())
+                continue;
+
+            // Advancing over the name in two pieces must give the same
+            // state as in one, and a state that accepts all names must
+            // accept this one.
+            const GlobPattern::State s = g.Advance(g.Start(), name);
+            for (size_t i = 0; i <= name.size(); ++i)
+            {
+                const GlobPattern::State head = g.Advance(g.Start(), name.substr(0, i));
+                if (g.Advance(head, name.substr(i)) != s)
+                {
+                    std::cerr << "pattern \"" << p << "\" on \"" << name << "\": split at " << i
+                              << " gives a different state" << std::endl;
+                    ok = false;
+                }
+                if (g.AcceptsAll(head) && !expected)
+                {
+                    std::cerr << "pattern \"" << p << "\" accepts all names that start with \""
+                              << name.substr(0, i) << "\", but not \"" << name << "\"" << std::endl;
+                    ok = false;
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+bool CheckRegistry()
+{
+    VariableRegistry registry;
+    std::vector<std::string> sorted;
+    std::vector<uint64_t> storage(sizeof(variables) / sizeof(variables[0]));
+    size_t k = 0;
+    for (const char* v : variables)
+    {
+        registry.RegisterVariable(storage[k++], v, SVC_CUMULATIVE);
+        sorted.push_back(v);
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    bool ok = true;
+    for (const char* p : selections)
+    {
+        std::vector<std::string> expected;
+        for (auto& n : sorted)
+            if (fnmatch(p, n.c_str(), 0) == 0)
+                expected.push_back(n);
+
+        // Twice, to also check the cached result
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            // The name is the last field of each line after the header
+            std::ostringstream os;
+            registry.ListVariables(os, p);
+            std::istringstream is(os.str());
+            std::vector<std::string> actual;
+            std::string line;
+            std::getline(is, line);
+            while (std::getline(is, line))
+                actual.push_back(line.substr(line.rfind('\t') + 1));
+
+            if (actual != expected)
+            {
+                std::cerr << "pattern \"" << p << "\" selects";
+                for (auto& n : actual)
+                    std::cerr << " " << n;
+                std::cerr << " instead of";
+                for (auto& n : expected)
+                    std::cerr << " " << n;
+                std::cerr << std::endl;
+                ok = false;
+                break;
+            }
+        }
+    }
+    return ok;
+}
+
+}
+
+int main()
+{
+    const bool glob = CheckGlob();
+    const bool registry = CheckRegistry();
+    return (glob && registry) ? 0 : 1;
+}
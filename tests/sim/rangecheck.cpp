@@ -0,0 +1,140 @@
+// Checks that RangeTable finds the same reservation range as a search
+// of a std::map of the ranges, while ranges of all sizes are reserved
+// and released. Prints the mismatches and returns a non-zero exit code
+// if there are any.
+
+#include "arch/RangeTable.h"
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+
+using namespace Simulator;
+
+namespace {
+
+// A small linear congruential generator, so that the check is the same
+// on every host.
+uint32_t Random(uint32_t& state)
+{
+    state = state * 1103515245 + 12345;
+    return state >> 8;
+}
+
+MemAddr RandomAddr(uint32_t& seed)
+{
+    MemAddr addr = 0;
+    for (size_t i = 0; i < sizeof(MemAddr); i += 2)
+    {
+        addr = (addr << 16) | (Random(seed) & 0xffff);
+    }
+    return addr;
+}
+
+// Sizes from a few bytes to a large part of the address space.
+MemSize RandomSize(uint32_t& seed)
+{
+    const unsigned bits = Random(seed) % (sizeof(MemAddr) * 8 - 2);
+    return ((MemSize)1 << bits) + Random(seed) % 4096;
+}
+
+typedef std::map<MemAddr, MemSize> Ranges;
+
+// The range that contains [address, address+size), like
+// VirtualMemory::CheckPermissions used to find it.
+Ranges::const_iterator Search(const Ranges& ranges, MemAddr address, MemSize size)
+{
+    auto p = ranges.upper_bound(address);
+    if (p == ranges.begin())
+        return ranges.end();
+    --p;
+    return (p->second >= size && address - p->first <= p->second - size) ? p : ranges.end();
+}
+
+bool Overlaps(const Ranges& ranges, MemAddr address, MemSize size)
+{
+    if (address + (size - 1) < address)
+        return true;
+    auto p = ranges.lower_bound(address);
+    if (p != ranges.end() && p->first - address < size)
+        return true;
+    return p != ranges.begin() && address - (--p)->first < p->second;
+}
+
+bool Check(const RangeTable& table, const Ranges& ranges, MemAddr address, MemSize size)
+{
+    auto p = Search(ranges, address, size);
+    const RangeTable::Range* r = table.Find(address, size);
+    const bool ok = (p == ranges.end()) ? r == NULL
+                  : (r != NULL && r->address == p->first && r->size == p->second && r->permissions == (int)(p->first & 7));
+    if (!ok)
+    {
+        std::cerr << "lookup of " << std::hex << address << ", size " << size << ": found "
+                  << (r != NULL ? r->address : 0) << ", expected " << (p != ranges.end() ? p->first : 0)
+                  << std::dec << std::endl;
+    }
+    return ok;
+}
+
+}
+
+int main()
+{
+    uint32_t   seed = 1;
+    bool       ok = true;
+    RangeTable table;
+    Ranges     ranges;
+
+    for (int round = 0; round < 2000 && ok; ++round)
+    {
+        if (ranges.size() < 64 && Random(seed) % 3 != 0)
+        {
+            // Reserve a range after an existing one, or anywhere
+            MemAddr address = RandomAddr(seed);
+            if (!ranges.empty() && Random(seed) % 2 == 0)
+            {
+                auto p = ranges.lower_bound(address);
+                if (p == ranges.end())
+                    --p;
+                address = p->first + p->second + Random(seed) % 8;
+            }
+            const MemSize size = RandomSize(seed);
+            if (!Overlaps(ranges, address, size))
+            {
+                ranges[address] = size;
+                table.Insert(address, size, 0, (int)(address & 7));
+            }
+        }
+        else if (!ranges.empty())
+        {
+            auto p = ranges.lower_bound(RandomAddr(seed));
+            if (p == ranges.end())
+                --p;
+            table.Remove(p->first);
+            ranges.erase(p);
+        }
+
+        // Look up the edges of every range, and some random addresses
+        for (auto& p : ranges)
+        {
+            const MemAddr last = p.first + (p.second - 1);
+            ok = Check(table, ranges, p.first, 1) && ok;
+            ok = Check(table, ranges, p.first, p.second) && ok;
+            ok = Check(table, ranges, p.first, p.second + 1) && ok;
+            ok = Check(table, ranges, last, 1) && ok;
+            ok = Check(table, ranges, last, 2) && ok;
+            ok = Check(table, ranges, p.first - 1, 1) && ok;
+            ok = Check(table, ranges, last + 1, 1) && ok;
+            ok = Check(table, ranges, p.first + p.second / 2, 8) && ok;
+        }
+        for (int i = 0; i < 16; ++i)
+        {
+            ok = Check(table, ranges, RandomAddr(seed), 1 + Random(seed) % 64) && ok;
+        }
+    }
+
+    table.Clear();
+    ranges.clear();
+    ok = Check(table, ranges, 0, 1) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+// Checks that TagArray finds the same way as a search of the set in
+// way order, for the MemAddr width of the configured target. Prints
+// the mismatches and returns a non-zero exit code if there are any.
+
+#include "arch/TagArray.h"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+using namespace Simulator;
+
+namespace {
+
+const size_t assocs[] = { 1, 2, 3, 4, 5, 7, 8, 9, 12, 15, 16, 17, 24, 31, 32, 33 };
+
+const size_t NUM_SETS = 5;
+
+// A small linear congruential generator, so that the check is the same
+// on every host.
+uint32_t Random(uint32_t& state)
+{
+    state = state * 1103515245 + 12345;
+    return state >> 8;
+}
+
+// The tags that a set is filled with. Besides the searched tag, they
+// include tags that share one half of it and tags that differ only in
+// the top bit, so that a compare of the wrong width finds them.
+std::vector<MemAddr> Candidates(MemAddr tag)
+{
+    const unsigned bits = sizeof(MemAddr) * 8;
+    const MemAddr  low  = ((MemAddr)1 << (bits / 2)) - 1;
+    std::vector<MemAddr> c;
+    c.push_back(tag);
+    c.push_back(tag & low);
+    c.push_back(tag & ~low);
+    c.push_back(tag ^ ((MemAddr)1 << (bits - 1)));
+    c.push_back(tag + 1);
+    c.push_back(0);
+    return c;
+}
+
+bool CheckAssoc(size_t assoc, uint32_t& seed)
+{
+    const MemAddr tag = (MemAddr)0x9e3779b97f4a7c15ULL;
+    const std::vector<MemAddr> candidates = Candidates(tag);
+
+    bool ok = true;
+    for (int round = 0; round < 200; ++round)
+    {
+        TagArray tags(NUM_SETS, assoc);
+        std::vector<bool> present(NUM_SETS * assoc);
+        for (size_t i = 0; i < NUM_SETS * assoc; ++i)
+        {
+            tags[i]    = candidates[Random(seed) % candidates.size()];
+            present[i] = Random(seed) % 4 != 0;
+
+            // Like in a cache, the present lines of a set have distinct tags
+            for (size_t j = i - i % assoc; j < i && present[i]; ++j)
+            {
+                present[i] = !(present[j] && tags[j] == tags[i]);
+            }
+        }
+        auto is_present = [&](size_t index) { return present[index]; };
+
+        for (size_t set = 0; set < NUM_SETS; ++set)
+        {
+            for (const MemAddr t : candidates)
+            {
+                size_t expect = 0;
+                while (expect < assoc && !(tags[set * assoc + expect] == t && present[set * assoc + expect]))
+                {
+                    ++expect;
+                }
+
+                // Look the tag up twice through Find, so that the way
+                // prediction is used as well.
+                const size_t found[3] = {
+                    tags.Lookup(set, t, is_present),
+                    tags.Find(set, t, is_present),
+                    tags.Find(set, t, is_present),
+                };
+                for (size_t way : found)
+                {
+                    if (way != expect)
+                    {
+                        std::cerr << "assoc " << assoc << ", set " << set << ", tag " << std::hex << t << std::dec
+                                  << ": found way " << way << ", expected " << expect << std::endl;
+                        ok = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+}
+
+int main()
+{
+    uint32_t seed = 1;
+    bool ok = true;
+    for (size_t assoc : assocs)
+    {
+        ok = CheckAssoc(assoc, seed) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+// Checks that the kernel gives the same results when it runs the
+// acquire phase of the cycles on several host threads as when it runs
+// it serially. Clients on two clocks compete in every cycle for a
+// service, for the write port of a structure and for the one push per
+// cycle into the buffer of a sink, which drains it at irregular times.
+// Every component hashes its outcome in every cycle, and the hashes
+// must be the same with any number of threads, and when the processes,
+// which all fail first, commit without a check (cf
+// Process::SetFailsFirst()). Prints the mismatches and returns a
+// non-zero exit code if there are any.
+
+#include "sim/kernel.h"
+#include "sim/buffer.h"
+#include "sim/flag.h"
+#include "sim/ports.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Simulator;
+
+namespace {
+
+const size_t  NUM_CLIENTS = 24;
+const size_t  NUM_SINKS   = 3;
+const CycleNo NUM_CYCLES  = 20000;
+
+uint64_t Mix(uint64_t hash, uint64_t value)
+{
+    return (hash ^ value) * 0x100000001b3ULL;
+}
+
+class Registers : public ReadWriteStructure<size_t>
+{
+public:
+    ArbitratedWritePort<size_t> p_write;
+
+    Registers(const std::string& name, Object& parent, Clock& clock)
+        : Object(name, parent),
+          ReadWriteStructure<size_t>(name, parent, clock),
+          p_write(*this, GetName() + ".p_write")
+    {
+        AddPort(p_write);
+    }
+};
+
+// Takes an item from its buffer in most cycles.
+class Sink : public Object
+{
+public:
+    uint64_t         m_hash;
+    Buffer<uint64_t> m_input;
+    Process          p_Drain;
+
+    Result DoDrain()
+    {
+        const CycleNo cycle = GetKernel()->GetCycleNo();
+        if ((cycle * 7 + m_hash % 5) % 11 < 3)
+        {
+            return FAILED;
+        }
+
+        const uint64_t value = m_input.Front();
+        m_input.Pop();
+        COMMIT {
+            m_hash = Mix(m_hash, value ^ (cycle << 32));
+        }
+        return SUCCESS;
+    }
+
+    Sink(const std::string& name, Object& parent, Clock& clock, bool failsFirst)
+        : Object(name, parent),
+          m_hash(0),
+          m_input("b_input", *this, clock, 4),
+          p_Drain(*this, "drain", delegate::create<Sink, &Sink::DoDrain>(*this))
+    {
+        m_input.Sensitive(p_Drain);
+        p_Drain.SetStorageTraces(StorageTraceSet(StorageTrace()));
+        if (failsFirst)
+        {
+            p_Drain.SetFailsFirst();
+        }
+    }
+};
+
+// Requests the service and the write port, and pushes into a sink.
+class Client : public Object
+{
+public:
+    size_t                                   m_id;
+    uint64_t                                 m_hash;
+    ArbitratedService<CyclicArbitratedPort>& m_service;
+    Registers&                               m_regs;
+    Sink&                                    m_sink;
+    Process                                  p_Run;
+    Flag                                     m_enabled;
+
+    Result DoRun()
+    {
+        const CycleNo cycle   = GetKernel()->GetCycleNo();
+        const bool    service = m_service.Invoke();
+        const bool    write   = m_regs.p_write.Write((cycle + m_id) % 3);
+        if (!m_sink.m_input.Push(cycle * NUM_CLIENTS + m_id))
+        {
+            return FAILED;
+        }
+
+        COMMIT {
+            m_hash = Mix(m_hash, cycle * 4 + service * 2 + write);
+        }
+        return SUCCESS;
+    }
+
+    Client(const std::string& name, Object& parent, Clock& clock, size_t id,
+           ArbitratedService<CyclicArbitratedPort>& service, Registers& regs, Sink& sink, bool failsFirst)
+        : Object(name, parent),
+          m_id(id),
+          m_hash(0),
+          m_service(service),
+          m_regs(regs),
+          m_sink(sink),
+          p_Run(*this, "run", delegate::create<Client, &Client::DoRun>(*this)),
+          m_enabled("f_enabled", *this, clock, true)
+    {
+        m_enabled.Sensitive(p_Run);
+        p_Run.SetStorageTraces(opt(sink.m_input));
+        m_service.AddProcess(p_Run);
+        m_regs.p_write.AddProcess(p_Run);
+        if (failsFirst)
+        {
+            p_Run.SetFailsFirst();
+        }
+    }
+};
+
+// Runs the system with a number of threads and returns the hashes of
+// the components and the stall counts, one per line.
+std::string Run(size_t threads, bool failsFirst)
+{
+    Kernel kernel;
+    Clock& fast = kernel.CreateClock(3);
+    Clock& slow = kernel.CreateClock(2);
+
+    Object root("", kernel);
+    ArbitratedService<CyclicArbitratedPort> service(fast, "service");
+    Registers regs("regs", root, fast);
+
+    std::vector<std::unique_ptr<Sink> > sinks;
+    for (size_t i = 0; i < NUM_SINKS; ++i)
+    {
+        sinks.emplace_back(new Sink("sink" + std::to_string(i), root, (i % 2 == 0) ? fast : slow, failsFirst));
+    }
+
+    std::vector<std::unique_ptr<Client> > clients;
+    for (size_t i = 0; i < NUM_CLIENTS; ++i)
+    {
+        clients.emplace_back(new Client("client" + std::to_string(i), root, (i % 3 == 0) ? slow : fast, i,
+                                        service, regs, *sinks[i % NUM_SINKS], failsFirst));
+    }
+
+    kernel.SetNumThreads(threads);
+    kernel.Step(NUM_CYCLES);
+
+    std::ostringstream os;
+    os << "cycle " << kernel.GetCycleNo() << std::endl;
+    for (auto& s : sinks)
+    {
+        os << s->GetName() << " " << std::hex << s->m_hash << std::dec << std::endl;
+    }
+    for (auto& c : clients)
+    {
+        os << c->GetName() << " " << std::hex << c->m_hash << std::dec << std::endl;
+    }
+    kernel.GetVariableRegistry().RenderVariables(os, "*stalls");
+    return os.str();
+}
+
+}
+
+int main()
+{
+    const std::string serial = Run(1, false);
+    bool ok = true;
+    for (bool failsFirst : { false, true })
+    {
+        for (size_t threads : { 1, 2, 4, 7 })
+        {
+            if (threads == 1 && !failsFirst)
+            {
+                continue;
+            }
+
+            const std::string result = Run(threads, failsFirst);
+            if (result != serial)
+            {
+                std::cerr << "with " << threads << " threads" << (failsFirst ? " and single-pass commits" : "")
+                          << ":" << std::endl << result << "expected:" << std::endl << serial;
+                ok = false;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}